@@ -31,10 +31,14 @@
 #include "gdscript.h"
 
 #include "gdscript_analyzer.h"
+#include "gdscript_byte_codegen.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_cache.h"
 #include "gdscript_compiler.h"
+#include "gdscript_inline_cache.h"
 #include "gdscript_parser.h"
 #include "gdscript_rpc_callable.h"
+#include "gdscript_sampling_profiler.h"
 #include "gdscript_tokenizer_buffer.h"
 #include "gdscript_warning.h"
 
@@ -799,6 +803,14 @@ Error GDScript::reload(bool p_keep_state) {
 #endif
 
 	valid = false;
+
+	// Compiled in an earlier run, parsing and compiling can be skipped.
+	if (GDScriptBytecodeCache::load(this) == OK) {
+		reloading = false;
+		can_run = ScriptServer::is_scripting_enabled() || is_tool();
+		return can_run ? _static_init() : OK;
+	}
+
 	GDScriptParser parser;
 	Error err;
 	if (!binary_tokens.is_empty()) {
@@ -852,6 +864,8 @@ Error GDScript::reload(bool p_keep_state) {
 		}
 	}
 
+	GDScriptBytecodeCache::save(this, parser);
+
 #ifdef TOOLS_ENABLED
 	// Done after compilation because it needs the GDScript object's inner class GDScript objects,
 	// which are made by calling make_scripts() within compiler.compile() above.
@@ -1518,6 +1532,7 @@ void GDScript::clear(ClearData *p_clear_data) {
 		return;
 	}
 	clearing = true;
+	GDScriptInlineCache::invalidate();
 
 	ClearData data;
 	ClearData *clear_data = p_clear_data;
@@ -2236,6 +2251,12 @@ void GDScriptLanguage::init() {
 		_add_global(E.name, E.ptr);
 	}
 
+#ifdef DEBUG_ENABLED
+	if (GLOBAL_GET("debug/gdscript/sampling_profiler/enabled") && !Engine::get_singleton()->is_editor_hint()) {
+		GDScriptSamplingProfiler::start(GLOBAL_GET("debug/gdscript/sampling_profiler/interval_usec"));
+	}
+#endif
+
 #ifdef TESTS_ENABLED
 	GDScriptTests::GDScriptTestRunner::handle_cmdline();
 #endif
@@ -2255,6 +2276,14 @@ void GDScriptLanguage::finish() {
 	}
 	finishing = true;
 
+#ifdef DEBUG_ENABLED
+	if (GDScriptSamplingProfiler::is_running()) {
+		GDScriptSamplingProfiler::stop();
+		const String path = GLOBAL_GET("debug/gdscript/sampling_profiler/output_path");
+		GDScriptSamplingProfiler::save(path, path.get_extension() == "json" ? GDScriptSamplingProfiler::FORMAT_CHROME_TRACE : GDScriptSamplingProfiler::FORMAT_COLLAPSED);
+	}
+#endif
+
 	_call_stack.free();
 
 	// Clear the cache before parsing the script_list
@@ -2291,6 +2320,8 @@ void GDScriptLanguage::finish() {
 	script_list.clear();
 	function_list.clear();
 
+	GDScriptBytecodeCache::finish();
+
 	finishing = false;
 }
 
@@ -2862,15 +2893,16 @@ GDScriptLanguage::GDScriptLanguage() {
 
 	int dmcs = GLOBAL_DEF(PropertyInfo(Variant::INT, "debug/settings/gdscript/max_call_stack", PROPERTY_HINT_RANGE, "512," + itos(GDScriptFunction::MAX_CALL_DEPTH - 1) + ",1"), 1024);
 
-	if (EngineDebugger::is_active()) {
-		//debugging enabled!
+	// Also used without a debugger, when the sampling profiler is started.
+	_debug_max_call_stack = dmcs;
 
-		_debug_max_call_stack = dmcs;
-	} else {
-		_debug_max_call_stack = 0;
-	}
+	GDScriptBytecodeCache::set_enabled(GLOBAL_DEF("gdscript/bytecode_cache/enabled", false));
+	GDScriptByteCodeGenerator::set_optimizations_enabled(GLOBAL_DEF("gdscript/compiler/optimize_bytecode", true));
 
 #ifdef DEBUG_ENABLED
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/enabled", false);
+	GLOBAL_DEF(PropertyInfo(Variant::INT, "debug/gdscript/sampling_profiler/interval_usec", PROPERTY_HINT_RANGE, "100,100000,1,suffix:µs"), 1000);
+	GLOBAL_DEF(PropertyInfo(Variant::STRING, "debug/gdscript/sampling_profiler/output_path", PROPERTY_HINT_SAVE_FILE, "*.folded,*.json"), "user://gdscript_profile.folded");
 	GLOBAL_DEF("debug/gdscript/warnings/enable", true);
 	GLOBAL_DEF("debug/gdscript/warnings/exclude_addons", true);
 	for (int i = 0; i < (int)GDScriptWarning::WARNING_MAX; i++) {
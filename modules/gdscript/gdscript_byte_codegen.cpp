@@ -31,9 +31,12 @@
 #include "gdscript_byte_codegen.h"
 
 #include "gdscript.h"
+#include "gdscript_inline_cache.h"
 
 #include "core/debugger/engine_debugger.h"
 
+bool GDScriptByteCodeGenerator::optimizations_enabled = true;
+
 uint32_t GDScriptByteCodeGenerator::add_parameter(const StringName &p_name, bool p_is_optional, const GDScriptDataType &p_type) {
 	function->_argument_count++;
 	function->argument_types.push_back(p_type);
@@ -47,6 +50,7 @@ uint32_t GDScriptByteCodeGenerator::add_parameter(const StringName &p_name, bool
 uint32_t GDScriptByteCodeGenerator::add_local(const StringName &p_name, const GDScriptDataType &p_type) {
 	int stack_pos = locals.size() + GDScriptFunction::FIXED_ADDRESSES_MAX;
 	locals.push_back(StackSlot(p_type.builtin_type, p_type.can_contain_object()));
+	initialized_locals.erase(stack_pos);
 	add_stack_identifier(p_name, stack_pos);
 	return stack_pos;
 }
@@ -152,6 +156,7 @@ void GDScriptByteCodeGenerator::start_parameters() {
 	if (function->_default_arg_count > 0) {
 		append(GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT);
 		function->default_arguments.push_back(opcodes.size());
+		mark_jump_target(opcodes.size());
 	}
 }
 
@@ -221,6 +226,11 @@ GDScriptFunction *GDScriptByteCodeGenerator::write_end() {
 		function->_global_names_count = 0;
 	}
 
+	if (inline_cache_count) {
+		function->_inline_caches_ptr = memnew_arr(GDScriptInlineCache, inline_cache_count);
+		function->_inline_caches_count = inline_cache_count;
+	}
+
 	if (opcodes.size()) {
 		function->code = opcodes;
 		function->_code_ptr = &function->code.write[0];
@@ -431,6 +441,108 @@ void GDScriptByteCodeGenerator::set_initial_line(int p_line) {
 #define IS_BUILTIN_TYPE(m_var, m_type) \
 	(m_var.type.has_type && m_var.type.kind == GDScriptDataType::BUILTIN && m_var.type.builtin_type == m_type && m_type != Variant::NIL)
 
+bool GDScriptByteCodeGenerator::is_last_operator_result(const Address &p_address) const {
+	// The operator must be the last instruction written, and no jump may land right after it.
+	return optimizations_enabled && last_operator_position >= 0 && last_operator_position + 5 == opcodes.size() && last_jump_target <= last_operator_position &&
+			p_address.mode == Address::TEMPORARY && last_operator_target.mode == Address::TEMPORARY && p_address.address == last_operator_target.address;
+}
+
+int GDScriptByteCodeGenerator::write_jump_if_result(bool p_jump_if, const Address &p_condition) {
+	if (is_last_operator_result(p_condition)) {
+		// Fuse with the operator that computed the condition, saving a dispatch on every branch. The result is still stored.
+		opcodes.write[last_operator_position] = p_jump_if ? GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF : GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT;
+		last_operator_position = -1;
+	} else {
+		append_opcode(p_jump_if ? GDScriptFunction::OPCODE_JUMP_IF : GDScriptFunction::OPCODE_JUMP_IF_NOT);
+		append(p_condition);
+	}
+	int jump_address = opcodes.size();
+	append(0); // Jump destination, will be patched.
+	return jump_address;
+}
+
+bool GDScriptByteCodeGenerator::retarget_last_operator(const Address &p_target, const Address &p_source) {
+	if (p_target.mode != Address::LOCAL_VARIABLE || !is_last_operator_result(p_source)) {
+		return false;
+	}
+	// Validated operators write into the internal value, so the local must already hold the result type.
+	if (!initialized_locals.has(p_target.address) || !HAS_BUILTIN_TYPE(p_target) || p_target.type.builtin_type != last_operator_result_type) {
+		return false;
+	}
+	switch (last_operator_result_type) {
+		// Results computed before they are stored, so the local can be an operand too.
+		case Variant::BOOL:
+		case Variant::INT:
+		case Variant::FLOAT:
+		case Variant::VECTOR2:
+		case Variant::VECTOR2I:
+		case Variant::VECTOR3:
+		case Variant::VECTOR3I:
+		case Variant::VECTOR4:
+		case Variant::VECTOR4I:
+			break;
+		default:
+			return false;
+	}
+
+	// Write straight into the local, dropping the temporary and the assignment.
+	int target_index = last_operator_position + 3;
+	temporaries.write[p_source.address].bytecode_indices.erase(target_index);
+	opcodes.write[target_index] = address_of(p_target);
+
+	// An untyped temporary was adjusted to the result type right before the operator, it isn't written anymore
+	// so drop the adjust too. Only the operator's own words move back over it, along with the bytecode indices
+	// recorded for temporaries past the adjust. The operator is the last thing written and no recorded jump target
+	// falls between the adjust and the end of the code, so nothing else refers to the moved positions.
+	int adjust_position = last_operator_position - 2;
+	if (adjust_position >= 0 && adjust_position == last_type_adjust_position && last_jump_target <= adjust_position && temporaries[p_source.address].bytecode_indices.has(adjust_position + 1)) {
+		temporaries.write[p_source.address].bytecode_indices.erase(adjust_position + 1);
+		for (int i = last_operator_position; i < opcodes.size(); i++) {
+			opcodes.write[i - 2] = opcodes[i];
+		}
+		opcodes.resize(opcodes.size() - 2);
+		// Temporaries read by the operator moved along with it.
+		for (int i = 0; i < temporaries.size(); i++) {
+			Vector<int> &indices = temporaries.write[i].bytecode_indices;
+			for (int j = indices.size() - 1; j >= 0 && indices[j] > adjust_position; j--) {
+				indices.write[j] -= 2;
+			}
+		}
+		last_type_adjust_position = -1;
+	}
+
+	last_operator_position = -1;
+	return true;
+}
+
+bool GDScriptByteCodeGenerator::fold_constant_conversion(const Address &p_target, const Address &p_source) {
+	if (!optimizations_enabled || p_source.mode != Address::CONSTANT) {
+		return false;
+	}
+
+	for (const KeyValue<Variant, int> &E : constant_map) {
+		if (E.value != int(p_source.address)) {
+			continue;
+		}
+		if (!Variant::can_convert_strict(E.key.get_type(), p_target.type.builtin_type)) {
+			return false;
+		}
+		// Convert once here instead of on every assignment.
+		Variant converted;
+		const Variant *value = &E.key;
+		Callable::CallError ce;
+		Variant::construct(p_target.type.builtin_type, converted, &value, 1, ce);
+		if (ce.error != Callable::CallError::CALL_OK) {
+			return false;
+		}
+		append_opcode(GDScriptFunction::OPCODE_ASSIGN);
+		append(p_target);
+		append(get_constant_pos(converted) | (GDScriptFunction::ADDR_TYPE_CONSTANT << GDScriptFunction::ADDR_BITS));
+		return true;
+	}
+	return false;
+}
+
 void GDScriptByteCodeGenerator::write_type_adjust(const Address &p_target, Variant::Type p_new_type) {
 	switch (p_new_type) {
 		case Variant::BOOL:
@@ -551,6 +663,7 @@ void GDScriptByteCodeGenerator::write_type_adjust(const Address &p_target, Varia
 		case Variant::VARIANT_MAX:
 			return;
 	}
+	last_type_adjust_position = opcodes.size() - 1;
 	append(p_target);
 }
 
@@ -559,6 +672,10 @@ void GDScriptByteCodeGenerator::write_unary_operator(const Address &p_target, Va
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, Variant::NIL);
 
+		last_operator_position = opcodes.size();
+		last_operator_target = p_target;
+		last_operator_result_type = Variant::get_operator_return_type(p_operator, p_left_operand.type.builtin_type, Variant::NIL);
+
 		append_opcode(GDScriptFunction::OPCODE_OPERATOR_VALIDATED);
 		append(p_left_operand);
 		append(Address());
@@ -598,6 +715,10 @@ void GDScriptByteCodeGenerator::write_binary_operator(const Address &p_target, V
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, p_right_operand.type.builtin_type);
 
+		last_operator_position = opcodes.size();
+		last_operator_target = p_target;
+		last_operator_result_type = Variant::get_operator_return_type(p_operator, p_left_operand.type.builtin_type, p_right_operand.type.builtin_type);
+
 		append_opcode(GDScriptFunction::OPCODE_OPERATOR_VALIDATED);
 		append(p_left_operand);
 		append(p_right_operand);
@@ -664,17 +785,11 @@ void GDScriptByteCodeGenerator::write_type_test(const Address &p_target, const A
 }
 
 void GDScriptByteCodeGenerator::write_and_left_operand(const Address &p_left_operand) {
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-	append(p_left_operand);
-	logic_op_jump_pos1.push_back(opcodes.size());
-	append(0); // Jump target, will be patched.
+	logic_op_jump_pos1.push_back(write_jump_if_result(false, p_left_operand));
 }
 
 void GDScriptByteCodeGenerator::write_and_right_operand(const Address &p_right_operand) {
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-	append(p_right_operand);
-	logic_op_jump_pos2.push_back(opcodes.size());
-	append(0); // Jump target, will be patched.
+	logic_op_jump_pos2.push_back(write_jump_if_result(false, p_right_operand));
 }
 
 void GDScriptByteCodeGenerator::write_end_and(const Address &p_target) {
@@ -684,6 +799,7 @@ void GDScriptByteCodeGenerator::write_end_and(const Address &p_target) {
 	// Jump away from the fail condition.
 	append_opcode(GDScriptFunction::OPCODE_JUMP);
 	append(opcodes.size() + 3);
+	mark_jump_target(opcodes.size() + 2);
 	// Here it means one of operands is false.
 	patch_jump(logic_op_jump_pos1.back()->get());
 	patch_jump(logic_op_jump_pos2.back()->get());
@@ -694,17 +810,11 @@ void GDScriptByteCodeGenerator::write_end_and(const Address &p_target) {
 }
 
 void GDScriptByteCodeGenerator::write_or_left_operand(const Address &p_left_operand) {
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF);
-	append(p_left_operand);
-	logic_op_jump_pos1.push_back(opcodes.size());
-	append(0); // Jump target, will be patched.
+	logic_op_jump_pos1.push_back(write_jump_if_result(true, p_left_operand));
 }
 
 void GDScriptByteCodeGenerator::write_or_right_operand(const Address &p_right_operand) {
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF);
-	append(p_right_operand);
-	logic_op_jump_pos2.push_back(opcodes.size());
-	append(0); // Jump target, will be patched.
+	logic_op_jump_pos2.push_back(write_jump_if_result(true, p_right_operand));
 }
 
 void GDScriptByteCodeGenerator::write_end_or(const Address &p_target) {
@@ -714,6 +824,7 @@ void GDScriptByteCodeGenerator::write_end_or(const Address &p_target) {
 	// Jump away from the success condition.
 	append_opcode(GDScriptFunction::OPCODE_JUMP);
 	append(opcodes.size() + 3);
+	mark_jump_target(opcodes.size() + 2);
 	// Here it means one of operands is true.
 	patch_jump(logic_op_jump_pos1.back()->get());
 	patch_jump(logic_op_jump_pos2.back()->get());
@@ -728,10 +839,7 @@ void GDScriptByteCodeGenerator::write_start_ternary(const Address &p_target) {
 }
 
 void GDScriptByteCodeGenerator::write_ternary_condition(const Address &p_condition) {
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-	append(p_condition);
-	ternary_jump_fail_pos.push_back(opcodes.size());
-	append(0); // Jump target, will be patched.
+	ternary_jump_fail_pos.push_back(write_jump_if_result(false, p_condition));
 }
 
 void GDScriptByteCodeGenerator::write_ternary_true_expr(const Address &p_expr) {
@@ -763,6 +871,14 @@ void GDScriptByteCodeGenerator::write_set(const Address &p_target, const Address
 	if (HAS_BUILTIN_TYPE(p_target)) {
 		if (IS_BUILTIN_TYPE(p_index, Variant::INT) && Variant::get_member_validated_indexed_setter(p_target.type.builtin_type) &&
 				IS_BUILTIN_TYPE(p_source, Variant::get_indexed_element_type(p_target.type.builtin_type))) {
+			if (p_target.type.builtin_type == Variant::PACKED_FLOAT32_ARRAY || p_target.type.builtin_type == Variant::PACKED_VECTOR2_ARRAY) {
+				// Index the storage directly.
+				append_opcode(p_target.type.builtin_type == Variant::PACKED_FLOAT32_ARRAY ? GDScriptFunction::OPCODE_SET_INDEXED_PACKED_FLOAT32_ARRAY : GDScriptFunction::OPCODE_SET_INDEXED_PACKED_VECTOR2_ARRAY);
+				append(p_target);
+				append(p_index);
+				append(p_source);
+				return;
+			}
 			// Use indexed setter instead.
 			Variant::ValidatedIndexedSetter setter = Variant::get_member_validated_indexed_setter(p_target.type.builtin_type);
 			append_opcode(GDScriptFunction::OPCODE_SET_INDEXED_VALIDATED);
@@ -790,7 +906,14 @@ void GDScriptByteCodeGenerator::write_set(const Address &p_target, const Address
 
 void GDScriptByteCodeGenerator::write_get(const Address &p_target, const Address &p_index, const Address &p_source) {
 	if (HAS_BUILTIN_TYPE(p_source)) {
-		if (IS_BUILTIN_TYPE(p_index, Variant::INT) && Variant::get_member_validated_indexed_getter(p_source.type.builtin_type)) {
+		if (IS_BUILTIN_TYPE(p_index, Variant::INT) && (p_source.type.builtin_type == Variant::PACKED_FLOAT32_ARRAY || p_source.type.builtin_type == Variant::PACKED_VECTOR2_ARRAY)) {
+			// Index the storage directly.
+			append_opcode(p_source.type.builtin_type == Variant::PACKED_FLOAT32_ARRAY ? GDScriptFunction::OPCODE_GET_INDEXED_PACKED_FLOAT32_ARRAY : GDScriptFunction::OPCODE_GET_INDEXED_PACKED_VECTOR2_ARRAY);
+			append(p_source);
+			append(p_index);
+			append(p_target);
+			return;
+		} else if (IS_BUILTIN_TYPE(p_index, Variant::INT) && Variant::get_member_validated_indexed_getter(p_source.type.builtin_type)) {
 			// Use indexed getter instead.
 			Variant::ValidatedIndexedGetter getter = Variant::get_member_validated_indexed_getter(p_source.type.builtin_type);
 			append_opcode(GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED);
@@ -832,6 +955,7 @@ void GDScriptByteCodeGenerator::write_set_named(const Address &p_target, const S
 	append(p_target);
 	append(p_source);
 	append(p_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const StringName &p_name, const Address &p_source) {
@@ -850,6 +974,7 @@ void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const S
 	append(p_source);
 	append(p_target);
 	append(p_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_set_member(const Address &p_value, const StringName &p_name) {
@@ -879,6 +1004,8 @@ void GDScriptByteCodeGenerator::write_get_static_variable(const Address &p_targe
 }
 
 void GDScriptByteCodeGenerator::write_assign_with_conversion(const Address &p_target, const Address &p_source) {
+	mark_local_initialized(p_target);
+
 	switch (p_target.type.kind) {
 		case GDScriptDataType::BUILTIN: {
 			if (p_target.type.builtin_type == Variant::ARRAY && p_target.type.has_container_element_type(0)) {
@@ -927,6 +1054,11 @@ void GDScriptByteCodeGenerator::write_assign_with_conversion(const Address &p_ta
 }
 
 void GDScriptByteCodeGenerator::write_assign(const Address &p_target, const Address &p_source) {
+	if (retarget_last_operator(p_target, p_source)) {
+		return;
+	}
+	mark_local_initialized(p_target);
+
 	if (p_target.type.kind == GDScriptDataType::BUILTIN && p_target.type.builtin_type == Variant::ARRAY && p_target.type.has_container_element_type(0)) {
 		const GDScriptDataType &element_type = p_target.type.get_container_element_type(0);
 		append_opcode(GDScriptFunction::OPCODE_ASSIGN_TYPED_ARRAY);
@@ -937,6 +1069,9 @@ void GDScriptByteCodeGenerator::write_assign(const Address &p_target, const Addr
 		append(element_type.native_type);
 	} else if (p_target.type.kind == GDScriptDataType::BUILTIN && p_source.type.kind == GDScriptDataType::BUILTIN && p_target.type.builtin_type != p_source.type.builtin_type) {
 		// Need conversion.
+		if (fold_constant_conversion(p_target, p_source)) {
+			return;
+		}
 		append_opcode(GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN);
 		append(p_target);
 		append(p_source);
@@ -970,11 +1105,13 @@ void GDScriptByteCodeGenerator::write_assign_default_parameter(const Address &p_
 		write_assign(p_dst, p_src);
 	}
 	function->default_arguments.push_back(opcodes.size());
+	mark_jump_target(opcodes.size());
 }
 
 void GDScriptByteCodeGenerator::write_store_global(const Address &p_dst, int p_global_index) {
 	append_opcode(GDScriptFunction::OPCODE_STORE_GLOBAL);
 	append(p_dst);
+	function->global_index_positions.push_back(opcodes.size());
 	append(p_global_index);
 }
 
@@ -1040,6 +1177,7 @@ void GDScriptByteCodeGenerator::write_call(const Address &p_target, const Addres
 	append(ct.target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 	ct.cleanup();
 }
 
@@ -1065,6 +1203,7 @@ void GDScriptByteCodeGenerator::write_call_async(const Address &p_target, const
 	append(ct.target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 	ct.cleanup();
 }
 
@@ -1168,6 +1307,14 @@ void GDScriptByteCodeGenerator::write_call_builtin_type(const Address &p_target,
 		return;
 	}
 
+	if (p_target.mode == Address::NIL && (p_type == Variant::PACKED_FLOAT32_ARRAY || p_type == Variant::PACKED_VECTOR2_ARRAY) && (p_method == SNAME("append") || p_method == SNAME("push_back"))) {
+		// Appends whose result is unused push to the storage directly.
+		append_opcode(p_type == Variant::PACKED_FLOAT32_ARRAY ? GDScriptFunction::OPCODE_APPEND_PACKED_FLOAT32_ARRAY : GDScriptFunction::OPCODE_APPEND_PACKED_VECTOR2_ARRAY);
+		append(p_base);
+		append(p_arguments[0]);
+		return;
+	}
+
 	Variant::Type result_type = Variant::get_builtin_method_return_type(p_type, p_method);
 	CallTarget ct = get_call_target(p_target, result_type);
 	Variant::Type temp_type = temporaries[ct.target.address].type;
@@ -1299,6 +1446,7 @@ void GDScriptByteCodeGenerator::write_call_self(const Address &p_target, const S
 	append(ct.target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 	ct.cleanup();
 }
 
@@ -1312,6 +1460,7 @@ void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, c
 	append(ct.target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 	ct.cleanup();
 }
 
@@ -1325,6 +1474,7 @@ void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_targ
 	append(ct.target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 	ct.cleanup();
 }
 
@@ -1442,10 +1592,7 @@ void GDScriptByteCodeGenerator::write_await(const Address &p_target, const Addre
 }
 
 void GDScriptByteCodeGenerator::write_if(const Address &p_condition) {
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-	append(p_condition);
-	if_jmp_addrs.push_back(opcodes.size());
-	append(0); // Jump destination, will be patched.
+	if_jmp_addrs.push_back(write_jump_if_result(false, p_condition));
 }
 
 void GDScriptByteCodeGenerator::write_else() {
@@ -1604,9 +1751,11 @@ void GDScriptByteCodeGenerator::write_for(const Address &p_variable, bool p_use_
 	append(0); // End of loop address, will be patched.
 	append_opcode(GDScriptFunction::OPCODE_JUMP);
 	append(opcodes.size() + 6); // Skip over 'continue' code.
+	mark_jump_target(opcodes.size() + 5);
 
 	// Next iteration.
 	int continue_addr = opcodes.size();
+	mark_jump_target(continue_addr);
 	continue_addrs.push_back(continue_addr);
 	append_opcode(iterate_opcode);
 	append(counter);
@@ -1649,14 +1798,12 @@ void GDScriptByteCodeGenerator::write_endfor() {
 void GDScriptByteCodeGenerator::start_while_condition() {
 	current_breaks_to_patch.push_back(List<int>());
 	continue_addrs.push_back(opcodes.size());
+	mark_jump_target(opcodes.size());
 }
 
 void GDScriptByteCodeGenerator::write_while(const Address &p_condition) {
 	// Condition check.
-	append_opcode(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-	append(p_condition);
-	while_jmp_addrs.push_back(opcodes.size());
-	append(0); // End of loop address, will be patched.
+	while_jmp_addrs.push_back(write_jump_if_result(false, p_condition));
 }
 
 void GDScriptByteCodeGenerator::write_endwhile() {
@@ -1825,6 +1972,7 @@ void GDScriptByteCodeGenerator::clear_address(const Address &p_address) {
 	if (p_address.mode == Address::LOCAL_VARIABLE) {
 		dirty_locals.erase(p_address.address);
 	}
+	mark_local_initialized(p_address);
 }
 
 // Returns `true` if the local has been re-used and not cleaned up with `clear_address()`.
@@ -98,6 +98,17 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	int max_locals = 0;
 	int current_line = 0;
 	int instr_args_max = 0;
+	int inline_cache_count = 0;
+
+	// Peephole optimizations rewrite the last validated operator, as long as nothing jumps past its start.
+	static bool optimizations_enabled;
+	int last_jump_target = 0;
+	int last_operator_position = -1;
+	Address last_operator_target;
+	Variant::Type last_operator_result_type = Variant::NIL;
+	int last_type_adjust_position = -1;
+	// Typed locals that were initialized since they were declared, so they hold a value of their type.
+	HashSet<int> initialized_locals;
 
 #ifdef DEBUG_ENABLED
 	List<int> temp_stack;
@@ -447,11 +458,35 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 		opcodes.push_back(get_lambda_function_pos(p_lambda_function));
 	}
 
+	// Every untyped named access and call gets its own cache.
+	void append_inline_cache() {
+		opcodes.push_back(inline_cache_count++);
+	}
+
 	void patch_jump(int p_address) {
 		opcodes.write[p_address] = opcodes.size();
+		mark_jump_target(opcodes.size());
 	}
 
+	void mark_jump_target(int p_address) {
+		last_jump_target = MAX(last_jump_target, p_address);
+	}
+
+	void mark_local_initialized(const Address &p_address) {
+		if (p_address.mode == Address::LOCAL_VARIABLE) {
+			initialized_locals.insert(p_address.address);
+		}
+	}
+
+	bool is_last_operator_result(const Address &p_address) const;
+	int write_jump_if_result(bool p_jump_if, const Address &p_condition);
+	bool retarget_last_operator(const Address &p_target, const Address &p_source);
+	bool fold_constant_conversion(const Address &p_target, const Address &p_source);
+
 public:
+	static void set_optimizations_enabled(bool p_enabled) { optimizations_enabled = p_enabled; }
+	static bool is_optimizations_enabled() { return optimizations_enabled; }
+
 	virtual uint32_t add_parameter(const StringName &p_name, bool p_is_optional, const GDScriptDataType &p_type) override;
 	virtual uint32_t add_local(const StringName &p_name, const GDScriptDataType &p_type) override;
 	virtual uint32_t add_local_constant(const StringName &p_name, const Variant &p_constant) override;
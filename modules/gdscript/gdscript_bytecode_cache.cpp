@@ -0,0 +1,2251 @@
+/**************************************************************************/
+/*  gdscript_bytecode_cache.cpp                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "gdscript_bytecode_cache.h"
+
+#include "gdscript.h"
+#include "gdscript_cache.h"
+#include "gdscript_function.h"
+#include "gdscript_inline_cache.h"
+#include "gdscript_parser.h"
+#include "gdscript_utility_functions.h"
+
+#include "core/config/engine.h"
+#include "core/config/project_settings.h"
+#include "core/crypto/crypto_core.h"
+#include "core/debugger/engine_debugger.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/marshalls.h"
+#include "core/io/resource_loader.h"
+#include "core/os/os.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/rb_map.h"
+#include "core/version.h"
+
+#define CACHE_DIRECTORY "user://gdscript_cache"
+
+enum VariantTag {
+	VARIANT_TAG_PLAIN,
+	VARIANT_TAG_ARRAY,
+	VARIANT_TAG_DICTIONARY,
+	VARIANT_TAG_NULL_OBJECT,
+	VARIANT_TAG_SCRIPT,
+	VARIANT_TAG_NATIVE_CLASS,
+	VARIANT_TAG_SINGLETON,
+	VARIANT_TAG_RESOURCE,
+};
+
+enum LambdaUse {
+	LAMBDA_USE_PLAIN = 1,
+	LAMBDA_USE_SELF = 2,
+};
+
+struct GDScriptBytecodeCache::Writer {
+	LocalVector<uint8_t> data;
+
+	void put_u8(uint8_t p_value) {
+		data.push_back(p_value);
+	}
+
+	void put_u32(uint32_t p_value) {
+		uint32_t ofs = data.size();
+		data.resize(ofs + 4);
+		encode_uint32(p_value, &data[ofs]);
+	}
+
+	void put_i32(int32_t p_value) {
+		put_u32(uint32_t(p_value));
+	}
+
+	void put_buffer(const uint8_t *p_buffer, uint32_t p_size) {
+		uint32_t ofs = data.size();
+		data.resize(ofs + p_size);
+		if (p_size > 0) {
+			memcpy(&data[ofs], p_buffer, p_size);
+		}
+	}
+
+	void put_string(const String &p_string) {
+		CharString utf8 = p_string.utf8();
+		put_u32(utf8.length());
+		put_buffer((const uint8_t *)utf8.get_data(), utf8.length());
+	}
+};
+
+// Every read past the end, or of a count that can't fit in what is left, fails the whole reader.
+struct GDScriptBytecodeCache::Reader {
+	const uint8_t *data = nullptr;
+	uint32_t size = 0;
+	uint32_t position = 0;
+	bool failed = false;
+
+	bool has(uint32_t p_bytes) {
+		if (failed || size - position < p_bytes) {
+			failed = true;
+			return false;
+		}
+		return true;
+	}
+
+	uint8_t get_u8() {
+		if (!has(1)) {
+			return 0;
+		}
+		return data[position++];
+	}
+
+	uint32_t get_u32() {
+		if (!has(4)) {
+			return 0;
+		}
+		uint32_t value = decode_uint32(data + position);
+		position += 4;
+		return value;
+	}
+
+	int32_t get_i32() {
+		return int32_t(get_u32());
+	}
+
+	// Element counts, each element takes at least p_element_size bytes.
+	uint32_t get_count(uint32_t p_element_size = 1) {
+		uint32_t count = get_u32();
+		if (!failed && uint64_t(count) * p_element_size > size - position) {
+			failed = true;
+			return 0;
+		}
+		return count;
+	}
+
+	String get_string() {
+		uint32_t length = get_count();
+		if (failed || length == 0) {
+			return String();
+		}
+		String string = String::utf8((const char *)data + position, length);
+		position += length;
+		return string;
+	}
+
+	StringName get_string_name() {
+		return StringName(get_string());
+	}
+
+	Variant::Type get_variant_type() {
+		uint32_t type = get_u32();
+		if (type >= Variant::VARIANT_MAX) {
+			failed = true;
+			return Variant::NIL;
+		}
+		return Variant::Type(type);
+	}
+};
+
+struct GDScriptBytecodeCache::Context {
+	// Argument counts the validated calls in a function have to be made with, -1 when there is no validated form.
+	struct CallArguments {
+		LocalVector<int> constructors;
+		LocalVector<int> builtin_methods;
+		LocalVector<int> utilities;
+		// Smallest and largest, GDScript utility functions only check them in debug builds.
+		LocalVector<Pair<int, int>> gds_utilities;
+	};
+
+	GDScript *root = nullptr;
+	// Top level functions created so far, deleted along with their lambdas if loading fails.
+	LocalVector<GDScriptFunction *> functions;
+	HashMap<GDScriptFunction *, GDScript::LambdaInfo> lambda_info;
+	HashMap<const GDScriptFunction *, CallArguments> call_arguments;
+	HashMap<const GDScript *, int> static_variable_counts;
+};
+
+struct GDScriptBytecodeCache::ClassData {
+	GDScript *script = nullptr;
+	bool tool = false;
+	Ref<GDScriptNativeClass> native;
+	Ref<GDScript> base;
+	HashMap<StringName, GDScript::MemberInfo> member_indices;
+	HashSet<StringName> members;
+	HashMap<StringName, GDScript::MemberInfo> static_variables_indices;
+	HashMap<StringName, Variant> constants;
+	HashMap<StringName, MethodInfo> signals;
+	Dictionary rpc_config;
+	HashMap<StringName, GDScriptFunction *> member_functions;
+	GDScriptFunction *implicit_initializer = nullptr;
+	GDScriptFunction *implicit_ready = nullptr;
+	GDScriptFunction *static_initializer = nullptr;
+	LocalVector<ClassData> subclasses;
+};
+
+// Functions referred to by pointer in the compiled code, mapped back to how the compiler looked them up.
+struct GDScriptBytecodeCache::PointerNames {
+	struct Operator {
+		Variant::Operator op = Variant::OP_MAX;
+		Variant::Type type_a = Variant::NIL;
+		Variant::Type type_b = Variant::NIL;
+	};
+
+	RBMap<Variant::ValidatedOperatorEvaluator, Operator> operators;
+	RBMap<Variant::ValidatedSetter, Pair<Variant::Type, StringName>> setters;
+	RBMap<Variant::ValidatedGetter, Pair<Variant::Type, StringName>> getters;
+	RBMap<Variant::ValidatedKeyedSetter, Variant::Type> keyed_setters;
+	RBMap<Variant::ValidatedKeyedGetter, Variant::Type> keyed_getters;
+	RBMap<Variant::ValidatedIndexedSetter, Variant::Type> indexed_setters;
+	RBMap<Variant::ValidatedIndexedGetter, Variant::Type> indexed_getters;
+	RBMap<Variant::ValidatedBuiltInMethod, Pair<Variant::Type, StringName>> builtin_methods;
+	RBMap<Variant::ValidatedConstructor, Pair<Variant::Type, int>> constructors;
+	RBMap<Variant::ValidatedUtilityFunction, StringName> utilities;
+	RBMap<GDScriptUtilityFunctions::FunctionPtr, StringName> gds_utilities;
+};
+
+template <typename K, typename V>
+static const V *_find_pointer_name(const RBMap<K, V> &p_map, K p_key) {
+	const typename RBMap<K, V>::Element *E = p_map.find(p_key);
+	return E ? &E->value() : nullptr;
+}
+
+bool GDScriptBytecodeCache::enabled = false;
+bool GDScriptBytecodeCache::testing = false;
+Mutex GDScriptBytecodeCache::mutex;
+HashMap<String, String> GDScriptBytecodeCache::file_hashes;
+GDScriptBytecodeCache::PointerNames *GDScriptBytecodeCache::pointer_names = nullptr;
+
+bool GDScriptBytecodeCache::is_enabled() {
+#ifdef TOOLS_ENABLED
+	// The editor needs what only the parser knows (docs, default values of exports), and changes scripts all the time.
+	if (!testing) {
+		return false;
+	}
+#endif
+	// The debugger wants stack info and profiling signatures, which aren't cached.
+	return enabled && !EngineDebugger::is_active();
+}
+
+String GDScriptBytecodeCache::_get_environment_key() {
+	String key = String(VERSION_FULL_BUILD) + "." + VERSION_HASH;
+	key += "." + itos(FORMAT_VERSION) + "." + itos(GDScriptFunction::OPCODE_END) + "." + itos(Variant::VARIANT_MAX) + "." + itos(Variant::OP_MAX);
+#ifdef DEBUG_ENABLED
+	key += ".debug";
+#endif
+#ifdef REAL_T_IS_DOUBLE
+	key += ".double";
+#endif
+	// Autoload singletons are compiled as global lookups, everything else refers to its target directly.
+	for (const KeyValue<StringName, ProjectSettings::AutoloadInfo> &E : ProjectSettings::get_singleton()->get_autoload_list()) {
+		if (E.value.is_singleton) {
+			key += "|" + String(E.key);
+		}
+	}
+	return key;
+}
+
+Vector<uint8_t> GDScriptBytecodeCache::_get_encryption_key() {
+	// Scripts of games exported with a key are only stored encrypted, like in the pack.
+	Vector<uint8_t> key;
+	for (int i = 0; i < 32; i++) {
+		if (script_encryption_key[i] != 0) {
+			key.resize(32);
+			memcpy(key.ptrw(), script_encryption_key, 32);
+			break;
+		}
+	}
+	return key;
+}
+
+Vector<uint8_t> GDScriptBytecodeCache::_read_cache_file(const String &p_script_path) {
+	String cache_path = get_cache_path(p_script_path);
+	if (!FileAccess::exists(cache_path)) {
+		return Vector<uint8_t>();
+	}
+
+	Vector<uint8_t> key = _get_encryption_key();
+	Ref<FileAccess> file = key.is_empty() ? FileAccess::open(cache_path, FileAccess::READ) : FileAccess::open_encrypted(cache_path, FileAccess::READ, key);
+	if (file.is_null()) {
+		return Vector<uint8_t>();
+	}
+	Vector<uint8_t> buffer;
+	buffer.resize(file->get_length());
+	if (file->get_buffer(buffer.ptrw(), buffer.size()) != uint64_t(buffer.size())) {
+		return Vector<uint8_t>();
+	}
+	return buffer;
+}
+
+String GDScriptBytecodeCache::get_cache_path(const String &p_script_path) {
+	return String(CACHE_DIRECTORY).path_join(p_script_path.md5_text() + ".gdbc");
+}
+
+bool GDScriptBytecodeCache::_is_cacheable_path(const String &p_script_path) {
+	// Built-in scripts live inside their scene or resource, which is cached as a whole.
+	return !p_script_path.is_empty() && !p_script_path.contains("::");
+}
+
+String GDScriptBytecodeCache::_get_source_hash(const GDScript *p_script) {
+	unsigned char hash[32];
+	if (!p_script->binary_tokens.is_empty()) {
+		CryptoCore::sha256(p_script->binary_tokens.ptr(), p_script->binary_tokens.size(), hash);
+	} else {
+		CharString utf8 = p_script->source.utf8();
+		CryptoCore::sha256((const uint8_t *)utf8.get_data(), utf8.length(), hash);
+	}
+	return String::hex_encode_buffer(hash, 32);
+}
+
+String GDScriptBytecodeCache::_get_file_hash(const String &p_path) {
+	MutexLock lock(mutex);
+	// Scripts don't change on disk while an exported game runs, so each one is hashed once.
+	if (const String *hash = file_hashes.getptr(p_path)) {
+		return *hash;
+	}
+	String hash = FileAccess::get_sha256(ResourceLoader::path_remap(p_path));
+	file_hashes.insert(p_path, hash);
+	return hash;
+}
+
+void GDScriptBytecodeCache::_collect_dependencies(GDScriptParser *p_parser, const String &p_script_path, HashMap<String, String> &r_dependencies) {
+	for (const KeyValue<String, Ref<GDScriptParserRef>> &E : p_parser->get_depended_parsers()) {
+		if (E.key == p_script_path || r_dependencies.has(E.key)) {
+			continue;
+		}
+		r_dependencies.insert(E.key, _get_file_hash(E.key));
+		// The analyzer only went as deep as it needed, which is also as deep as changes can affect this script.
+		if (E.value.is_valid() && E.value->get_status() != GDScriptParserRef::EMPTY) {
+			_collect_dependencies(E.value->get_parser(), p_script_path, r_dependencies);
+		}
+	}
+}
+
+const GDScriptBytecodeCache::PointerNames &GDScriptBytecodeCache::_get_pointer_names() {
+	MutexLock lock(mutex);
+	if (pointer_names) {
+		return *pointer_names;
+	}
+
+	pointer_names = memnew(PointerNames);
+	for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+		Variant::Type type = Variant::Type(i);
+
+		for (int op = 0; op < Variant::OP_MAX; op++) {
+			for (int j = 0; j < Variant::VARIANT_MAX; j++) {
+				Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(Variant::Operator(op), type, Variant::Type(j));
+				if (evaluator && !pointer_names->operators.has(evaluator)) {
+					pointer_names->operators.insert(evaluator, { Variant::Operator(op), type, Variant::Type(j) });
+				}
+			}
+		}
+
+		List<StringName> members;
+		Variant::get_member_list(type, &members);
+		for (const StringName &member : members) {
+			Variant::ValidatedSetter setter = Variant::get_member_validated_setter(type, member);
+			if (setter && !pointer_names->setters.has(setter)) {
+				pointer_names->setters.insert(setter, Pair<Variant::Type, StringName>(type, member));
+			}
+			Variant::ValidatedGetter getter = Variant::get_member_validated_getter(type, member);
+			if (getter && !pointer_names->getters.has(getter)) {
+				pointer_names->getters.insert(getter, Pair<Variant::Type, StringName>(type, member));
+			}
+		}
+
+		Variant::ValidatedKeyedSetter keyed_setter = Variant::get_member_validated_keyed_setter(type);
+		if (keyed_setter && !pointer_names->keyed_setters.has(keyed_setter)) {
+			pointer_names->keyed_setters.insert(keyed_setter, type);
+		}
+		Variant::ValidatedKeyedGetter keyed_getter = Variant::get_member_validated_keyed_getter(type);
+		if (keyed_getter && !pointer_names->keyed_getters.has(keyed_getter)) {
+			pointer_names->keyed_getters.insert(keyed_getter, type);
+		}
+		Variant::ValidatedIndexedSetter indexed_setter = Variant::get_member_validated_indexed_setter(type);
+		if (indexed_setter && !pointer_names->indexed_setters.has(indexed_setter)) {
+			pointer_names->indexed_setters.insert(indexed_setter, type);
+		}
+		Variant::ValidatedIndexedGetter indexed_getter = Variant::get_member_validated_indexed_getter(type);
+		if (indexed_getter && !pointer_names->indexed_getters.has(indexed_getter)) {
+			pointer_names->indexed_getters.insert(indexed_getter, type);
+		}
+
+		List<StringName> methods;
+		Variant::get_builtin_method_list(type, &methods);
+		for (const StringName &method : methods) {
+			Variant::ValidatedBuiltInMethod builtin_method = Variant::get_validated_builtin_method(type, method);
+			if (builtin_method && !pointer_names->builtin_methods.has(builtin_method)) {
+				pointer_names->builtin_methods.insert(builtin_method, Pair<Variant::Type, StringName>(type, method));
+			}
+		}
+
+		for (int j = 0; j < Variant::get_constructor_count(type); j++) {
+			Variant::ValidatedConstructor constructor = Variant::get_validated_constructor(type, j);
+			if (constructor && !pointer_names->constructors.has(constructor)) {
+				pointer_names->constructors.insert(constructor, Pair<Variant::Type, int>(type, j));
+			}
+		}
+	}
+
+	List<StringName> utilities;
+	Variant::get_utility_function_list(&utilities);
+	for (const StringName &utility : utilities) {
+		Variant::ValidatedUtilityFunction function = Variant::get_validated_utility_function(utility);
+		if (function && !pointer_names->utilities.has(function)) {
+			pointer_names->utilities.insert(function, utility);
+		}
+	}
+
+	List<StringName> gds_utilities;
+	GDScriptUtilityFunctions::get_function_list(&gds_utilities);
+	for (const StringName &utility : gds_utilities) {
+		GDScriptUtilityFunctions::FunctionPtr function = GDScriptUtilityFunctions::get_function(utility);
+		if (function && !pointer_names->gds_utilities.has(function)) {
+			pointer_names->gds_utilities.insert(function, utility);
+		}
+	}
+
+	return *pointer_names;
+}
+
+bool GDScriptBytecodeCache::_is_pristine(const GDScript *p_script) {
+	// Loading only fills scripts that were never compiled, replacing compiled code is left to the compiler.
+	if (p_script->valid || !p_script->member_functions.is_empty() || p_script->implicit_initializer || p_script->implicit_ready || p_script->static_initializer) {
+		return false;
+	}
+	for (const KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		if (!_is_pristine(E.value.ptr())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Writing.
+
+void GDScriptBytecodeCache::_write_shape(Writer &p_writer, const GDScript *p_script) {
+	p_writer.put_string(p_script->global_name);
+	p_writer.put_string(p_script->simplified_icon_path);
+	p_writer.put_u32(p_script->subclasses.size());
+	for (const KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		p_writer.put_string(E.key);
+		p_writer.put_string(E.value->fully_qualified_name);
+		_write_shape(p_writer, E.value.ptr());
+	}
+}
+
+bool GDScriptBytecodeCache::_write_script_ref(Writer &p_writer, const GDScript *p_script) {
+	Vector<StringName> names;
+	const GDScript *root = p_script;
+	while (root->_owner) {
+		names.push_back(root->local_name);
+		root = root->_owner;
+	}
+	if (!_is_cacheable_path(root->path)) {
+		return false;
+	}
+
+	p_writer.put_string(root->path);
+	p_writer.put_u32(names.size());
+	for (int i = names.size() - 1; i >= 0; i--) {
+		p_writer.put_string(names[i]);
+	}
+	return true;
+}
+
+bool GDScriptBytecodeCache::_write_data_type(Writer &p_writer, const GDScriptDataType &p_type) {
+	p_writer.put_u8(p_type.has_type);
+	p_writer.put_u8(p_type.kind);
+	p_writer.put_u32(p_type.builtin_type);
+	p_writer.put_string(p_type.native_type);
+
+	if (p_type.script_type) {
+		// Other script languages would need their own way of finding the class again.
+		const GDScript *script = Object::cast_to<GDScript>(p_type.script_type);
+		if (!script) {
+			return false;
+		}
+		// Types pointing into the script itself don't hold a reference, to avoid cycles.
+		p_writer.put_u8(p_type.script_type_ref.is_valid() ? 2 : 1);
+		if (!_write_script_ref(p_writer, script)) {
+			return false;
+		}
+	} else {
+		p_writer.put_u8(0);
+	}
+
+	p_writer.put_u32(p_type.container_element_types.size());
+	for (const GDScriptDataType &element_type : p_type.container_element_types) {
+		if (!_write_data_type(p_writer, element_type)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool GDScriptBytecodeCache::_write_property_info(Writer &p_writer, const PropertyInfo &p_info) {
+	p_writer.put_u32(p_info.type);
+	p_writer.put_string(p_info.name);
+	p_writer.put_string(p_info.class_name);
+	p_writer.put_u32(p_info.hint);
+	p_writer.put_string(p_info.hint_string);
+	p_writer.put_u32(p_info.usage);
+	return true;
+}
+
+bool GDScriptBytecodeCache::_write_method_info(Writer &p_writer, const MethodInfo &p_info) {
+	p_writer.put_string(p_info.name);
+	_write_property_info(p_writer, p_info.return_val);
+	p_writer.put_u32(p_info.flags);
+	p_writer.put_i32(p_info.id);
+	p_writer.put_u32(p_info.arguments.size());
+	for (const PropertyInfo &argument : p_info.arguments) {
+		_write_property_info(p_writer, argument);
+	}
+	p_writer.put_u32(p_info.default_arguments.size());
+	for (const Variant &default_argument : p_info.default_arguments) {
+		if (!_write_variant(p_writer, default_argument)) {
+			return false;
+		}
+	}
+	p_writer.put_i32(p_info.return_val_metadata);
+	p_writer.put_u32(p_info.arguments_metadata.size());
+	for (int metadata : p_info.arguments_metadata) {
+		p_writer.put_i32(metadata);
+	}
+	return true;
+}
+
+bool GDScriptBytecodeCache::_write_variant(Writer &p_writer, const Variant &p_value) {
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			Object *object = p_value.get_validated_object();
+			if (!object) {
+				p_writer.put_u8(VARIANT_TAG_NULL_OBJECT);
+				return true;
+			}
+
+			if (const GDScript *script = Object::cast_to<GDScript>(object)) {
+				p_writer.put_u8(VARIANT_TAG_SCRIPT);
+				return _write_script_ref(p_writer, script);
+			}
+
+			if (const GDScriptNativeClass *native_class = Object::cast_to<GDScriptNativeClass>(object)) {
+				p_writer.put_u8(VARIANT_TAG_NATIVE_CLASS);
+				p_writer.put_string(native_class->get_name());
+				return true;
+			}
+
+			// Engine singletons used by name become constants.
+			List<Engine::Singleton> singletons;
+			Engine::get_singleton()->get_singletons(&singletons);
+			for (const Engine::Singleton &singleton : singletons) {
+				if (singleton.ptr == object) {
+					p_writer.put_u8(VARIANT_TAG_SINGLETON);
+					p_writer.put_string(singleton.name);
+					return true;
+				}
+			}
+
+			// Preloaded resources, loaded again by path.
+			const Resource *resource = Object::cast_to<Resource>(object);
+			if (resource && _is_cacheable_path(resource->get_path())) {
+				p_writer.put_u8(VARIANT_TAG_RESOURCE);
+				p_writer.put_string(resource->get_path());
+				return true;
+			}
+			return false;
+		}
+
+		case Variant::ARRAY: {
+			Array array = p_value;
+			p_writer.put_u8(VARIANT_TAG_ARRAY);
+			p_writer.put_u8(array.is_read_only());
+			p_writer.put_u32(array.get_typed_builtin());
+			p_writer.put_string(array.get_typed_class_name());
+			Ref<Script> typed_script = array.get_typed_script();
+			if (typed_script.is_valid()) {
+				const GDScript *script = Object::cast_to<GDScript>(typed_script.ptr());
+				p_writer.put_u8(1);
+				if (!script || !_write_script_ref(p_writer, script)) {
+					return false;
+				}
+			} else {
+				p_writer.put_u8(0);
+			}
+			p_writer.put_u32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				if (!_write_variant(p_writer, array[i])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		case Variant::DICTIONARY: {
+			Dictionary dictionary = p_value;
+			p_writer.put_u8(VARIANT_TAG_DICTIONARY);
+			p_writer.put_u8(dictionary.is_read_only());
+			Array keys = dictionary.keys();
+			p_writer.put_u32(keys.size());
+			for (int i = 0; i < keys.size(); i++) {
+				if (!_write_variant(p_writer, keys[i]) || !_write_variant(p_writer, dictionary[keys[i]])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		case Variant::RID:
+		case Variant::CALLABLE:
+		case Variant::SIGNAL:
+			return false;
+
+		default: {
+			int length = 0;
+			if (encode_variant(p_value, nullptr, length) != OK) {
+				return false;
+			}
+			p_writer.put_u8(VARIANT_TAG_PLAIN);
+			p_writer.put_u32(length);
+			uint32_t ofs = p_writer.data.size();
+			p_writer.data.resize(ofs + length);
+			return encode_variant(p_value, &p_writer.data[ofs], length) == OK;
+		}
+	}
+}
+
+bool GDScriptBytecodeCache::_write_function(Writer &p_writer, const GDScriptFunction *p_function) {
+	const PointerNames &names = _get_pointer_names();
+
+	p_writer.put_string(p_function->name);
+	p_writer.put_u8(p_function->_static);
+	p_writer.put_u32(p_function->argument_types.size());
+	for (const GDScriptDataType &argument_type : p_function->argument_types) {
+		if (!_write_data_type(p_writer, argument_type)) {
+			return false;
+		}
+	}
+	if (!_write_data_type(p_writer, p_function->return_type) || !_write_method_info(p_writer, p_function->method_info) || !_write_variant(p_writer, p_function->rpc_config)) {
+		return false;
+	}
+	p_writer.put_i32(p_function->_initial_line);
+	p_writer.put_i32(p_function->_argument_count);
+	p_writer.put_i32(p_function->_stack_size);
+	p_writer.put_i32(p_function->_instruction_args_size);
+
+	p_writer.put_u32(p_function->temporary_slots.size());
+	for (const KeyValue<int, Variant::Type> &E : p_function->temporary_slots) {
+		p_writer.put_i32(E.key);
+		p_writer.put_u32(E.value);
+	}
+
+	p_writer.put_u32(p_function->code.size());
+	for (int code : p_function->code) {
+		p_writer.put_i32(code);
+	}
+
+	// Indices into the global array depend on registration order, so they are stored by name.
+	const HashMap<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	p_writer.put_u32(p_function->global_index_positions.size());
+	for (int position : p_function->global_index_positions) {
+		StringName global_name;
+		for (const KeyValue<StringName, int> &E : global_map) {
+			if (E.value == p_function->code[position]) {
+				global_name = E.key;
+				break;
+			}
+		}
+		if (global_name == StringName()) {
+			return false;
+		}
+		p_writer.put_i32(position);
+		p_writer.put_string(global_name);
+	}
+
+	p_writer.put_u32(p_function->default_arguments.size());
+	for (int default_argument : p_function->default_arguments) {
+		p_writer.put_i32(default_argument);
+	}
+
+	p_writer.put_u32(p_function->constants.size());
+	for (const Variant &constant : p_function->constants) {
+		if (!_write_variant(p_writer, constant)) {
+			return false;
+		}
+	}
+
+	p_writer.put_u32(p_function->global_names.size());
+	for (const StringName &global_name : p_function->global_names) {
+		p_writer.put_string(global_name);
+	}
+
+	p_writer.put_u32(p_function->operator_funcs.size());
+	for (Variant::ValidatedOperatorEvaluator evaluator : p_function->operator_funcs) {
+		const PointerNames::Operator *op = _find_pointer_name(names.operators, evaluator);
+		if (!op) {
+			return false;
+		}
+		p_writer.put_u32(op->op);
+		p_writer.put_u32(op->type_a);
+		p_writer.put_u32(op->type_b);
+	}
+
+	p_writer.put_u32(p_function->setters.size());
+	for (Variant::ValidatedSetter setter : p_function->setters) {
+		const Pair<Variant::Type, StringName> *member = _find_pointer_name(names.setters, setter);
+		if (!member) {
+			return false;
+		}
+		p_writer.put_u32(member->first);
+		p_writer.put_string(member->second);
+	}
+
+	p_writer.put_u32(p_function->getters.size());
+	for (Variant::ValidatedGetter getter : p_function->getters) {
+		const Pair<Variant::Type, StringName> *member = _find_pointer_name(names.getters, getter);
+		if (!member) {
+			return false;
+		}
+		p_writer.put_u32(member->first);
+		p_writer.put_string(member->second);
+	}
+
+	p_writer.put_u32(p_function->keyed_setters.size());
+	for (Variant::ValidatedKeyedSetter keyed_setter : p_function->keyed_setters) {
+		const Variant::Type *type = _find_pointer_name(names.keyed_setters, keyed_setter);
+		if (!type) {
+			return false;
+		}
+		p_writer.put_u32(*type);
+	}
+
+	p_writer.put_u32(p_function->keyed_getters.size());
+	for (Variant::ValidatedKeyedGetter keyed_getter : p_function->keyed_getters) {
+		const Variant::Type *type = _find_pointer_name(names.keyed_getters, keyed_getter);
+		if (!type) {
+			return false;
+		}
+		p_writer.put_u32(*type);
+	}
+
+	p_writer.put_u32(p_function->indexed_setters.size());
+	for (Variant::ValidatedIndexedSetter indexed_setter : p_function->indexed_setters) {
+		const Variant::Type *type = _find_pointer_name(names.indexed_setters, indexed_setter);
+		if (!type) {
+			return false;
+		}
+		p_writer.put_u32(*type);
+	}
+
+	p_writer.put_u32(p_function->indexed_getters.size());
+	for (Variant::ValidatedIndexedGetter indexed_getter : p_function->indexed_getters) {
+		const Variant::Type *type = _find_pointer_name(names.indexed_getters, indexed_getter);
+		if (!type) {
+			return false;
+		}
+		p_writer.put_u32(*type);
+	}
+
+	p_writer.put_u32(p_function->builtin_methods.size());
+	for (Variant::ValidatedBuiltInMethod builtin_method : p_function->builtin_methods) {
+		const Pair<Variant::Type, StringName> *method = _find_pointer_name(names.builtin_methods, builtin_method);
+		if (!method) {
+			return false;
+		}
+		p_writer.put_u32(method->first);
+		p_writer.put_string(method->second);
+	}
+
+	p_writer.put_u32(p_function->constructors.size());
+	for (Variant::ValidatedConstructor constructor : p_function->constructors) {
+		const Pair<Variant::Type, int> *index = _find_pointer_name(names.constructors, constructor);
+		if (!index) {
+			return false;
+		}
+		p_writer.put_u32(index->first);
+		p_writer.put_i32(index->second);
+	}
+
+	p_writer.put_u32(p_function->utilities.size());
+	for (Variant::ValidatedUtilityFunction utility : p_function->utilities) {
+		const StringName *utility_name = _find_pointer_name(names.utilities, utility);
+		if (!utility_name) {
+			return false;
+		}
+		p_writer.put_string(*utility_name);
+	}
+
+	p_writer.put_u32(p_function->gds_utilities.size());
+	for (GDScriptUtilityFunctions::FunctionPtr gds_utility : p_function->gds_utilities) {
+		const StringName *utility_name = _find_pointer_name(names.gds_utilities, gds_utility);
+		if (!utility_name) {
+			return false;
+		}
+		p_writer.put_string(*utility_name);
+	}
+
+	p_writer.put_u32(p_function->methods.size());
+	for (const MethodBind *method : p_function->methods) {
+		p_writer.put_string(method->get_instance_class());
+		p_writer.put_string(method->get_name());
+		p_writer.put_u32(method->get_hash());
+	}
+
+	p_writer.put_u32(p_function->lambdas.size());
+	for (const GDScriptFunction *lambda : p_function->lambdas) {
+		// Lambdas are compiled into the class of the function that contains them.
+		if (lambda->_script != p_function->_script || !_write_function(p_writer, lambda)) {
+			return false;
+		}
+		const GDScript::LambdaInfo *info = p_function->_script->lambda_info.getptr(const_cast<GDScriptFunction *>(lambda));
+		p_writer.put_u8(info != nullptr);
+		p_writer.put_i32(info ? info->capture_count : 0);
+		p_writer.put_u8(info ? info->use_self : false);
+	}
+
+	p_writer.put_i32(p_function->_inline_caches_count);
+
+#ifdef DEBUG_ENABLED
+	const Vector<String> *debug_names[] = {
+		&p_function->operator_names,
+		&p_function->setter_names,
+		&p_function->getter_names,
+		&p_function->builtin_methods_names,
+		&p_function->constructors_names,
+		&p_function->utilities_names,
+		&p_function->gds_utilities_names,
+	};
+	for (const Vector<String> *debug_name_list : debug_names) {
+		p_writer.put_u32(debug_name_list->size());
+		for (const String &debug_name : *debug_name_list) {
+			p_writer.put_string(debug_name);
+		}
+	}
+	p_writer.put_string(p_function->profile.signature);
+#endif
+
+	return true;
+}
+
+bool GDScriptBytecodeCache::_write_class(Writer &p_writer, const GDScript *p_script) {
+	if (p_script->native.is_null()) {
+		return false;
+	}
+	p_writer.put_u8(p_script->tool);
+	p_writer.put_string(p_script->native->get_name());
+	p_writer.put_u8(p_script->base.is_valid());
+	if (p_script->base.is_valid() && !_write_script_ref(p_writer, p_script->base.ptr())) {
+		return false;
+	}
+
+	const HashMap<StringName, GDScript::MemberInfo> *member_maps[] = { &p_script->member_indices, &p_script->static_variables_indices };
+	for (const HashMap<StringName, GDScript::MemberInfo> *member_map : member_maps) {
+		p_writer.put_u32(member_map->size());
+		for (const KeyValue<StringName, GDScript::MemberInfo> &E : *member_map) {
+			p_writer.put_string(E.key);
+			p_writer.put_i32(E.value.index);
+			p_writer.put_string(E.value.setter);
+			p_writer.put_string(E.value.getter);
+			if (!_write_data_type(p_writer, E.value.data_type) || !_write_property_info(p_writer, E.value.property_info)) {
+				return false;
+			}
+		}
+	}
+
+	p_writer.put_u32(p_script->members.size());
+	for (const StringName &member : p_script->members) {
+		p_writer.put_string(member);
+	}
+
+	p_writer.put_u32(p_script->constants.size());
+	for (const KeyValue<StringName, Variant> &E : p_script->constants) {
+		p_writer.put_string(E.key);
+		if (!_write_variant(p_writer, E.value)) {
+			return false;
+		}
+	}
+
+	p_writer.put_u32(p_script->_signals.size());
+	for (const KeyValue<StringName, MethodInfo> &E : p_script->_signals) {
+		p_writer.put_string(E.key);
+		if (!_write_method_info(p_writer, E.value)) {
+			return false;
+		}
+	}
+
+	if (!_write_variant(p_writer, p_script->rpc_config)) {
+		return false;
+	}
+
+	p_writer.put_u32(p_script->member_functions.size());
+	for (const KeyValue<StringName, GDScriptFunction *> &E : p_script->member_functions) {
+		p_writer.put_string(E.key);
+		if (!_write_function(p_writer, E.value)) {
+			return false;
+		}
+	}
+
+	const GDScriptFunction *implicit_functions[] = { p_script->implicit_initializer, p_script->implicit_ready, p_script->static_initializer };
+	for (const GDScriptFunction *function : implicit_functions) {
+		p_writer.put_u8(function != nullptr);
+		if (function && !_write_function(p_writer, function)) {
+			return false;
+		}
+	}
+
+	for (const KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		if (!_write_class(p_writer, E.value.ptr())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Error GDScriptBytecodeCache::save_to_buffer(const GDScript *p_script, const HashMap<String, String> &p_dependencies, Vector<uint8_t> &r_buffer) {
+	ERR_FAIL_COND_V(!p_script->is_root_script() || !p_script->valid, ERR_INVALID_PARAMETER);
+	if (!_is_cacheable_path(p_script->path)) {
+		return ERR_UNAVAILABLE;
+	}
+
+	Writer payload;
+	payload.put_string(p_script->path);
+	payload.put_string(_get_source_hash(p_script));
+	payload.put_u32(p_dependencies.size());
+	for (const KeyValue<String, String> &E : p_dependencies) {
+		payload.put_string(E.key);
+		payload.put_string(E.value);
+	}
+
+	payload.put_string(p_script->local_name);
+	payload.put_string(p_script->fully_qualified_name);
+	_write_shape(payload, p_script);
+	// Scripts with static variables stay loaded unless `@static_unload` was used, which the compiler tracked here.
+	{
+		MutexLock lock(GDScriptCache::singleton->mutex);
+		payload.put_u8(GDScriptCache::singleton->static_gdscript_cache.has(p_script->fully_qualified_name));
+	}
+
+	if (!_write_class(payload, p_script)) {
+		return ERR_UNAVAILABLE;
+	}
+
+	Writer header;
+	header.put_buffer((const uint8_t *)"GDBC", 4);
+	header.put_u32(FORMAT_VERSION);
+	header.put_string(_get_environment_key());
+	header.put_u32(payload.data.size());
+	header.put_u32(hash_murmur3_buffer(payload.data.ptr(), payload.data.size()));
+
+	r_buffer.resize(header.data.size() + payload.data.size());
+	memcpy(r_buffer.ptrw(), header.data.ptr(), header.data.size());
+	memcpy(r_buffer.ptrw() + header.data.size(), payload.data.ptr(), payload.data.size());
+	return OK;
+}
+
+void GDScriptBytecodeCache::save(const GDScript *p_script, GDScriptParser &p_parser) {
+	if (!is_enabled() || !p_script->is_root_script() || !_is_cacheable_path(p_script->path)) {
+		return;
+	}
+
+	HashMap<String, String> dependencies;
+	_collect_dependencies(&p_parser, p_script->path, dependencies);
+
+	Vector<uint8_t> buffer;
+	Error err = save_to_buffer(p_script, dependencies, buffer);
+	if (err != OK) {
+		print_verbose(vformat(R"(GDScript: "%s" uses values that can't be cached, it will be compiled on every run.)", p_script->path));
+		return;
+	}
+
+	err = DirAccess::make_dir_recursive_absolute(CACHE_DIRECTORY);
+	ERR_FAIL_COND_MSG(err != OK, vformat(R"(Can't create the GDScript bytecode cache directory "%s".)", CACHE_DIRECTORY));
+
+	// Written next to the entry and renamed over it, so a crash or another instance of the game never sees half of it.
+	String cache_path = get_cache_path(p_script->path);
+	String temp_path = cache_path + "." + itos(OS::get_singleton()->get_process_id()) + ".tmp";
+	{
+		Vector<uint8_t> key = _get_encryption_key();
+		Ref<FileAccess> file = key.is_empty() ? FileAccess::open(temp_path, FileAccess::WRITE, &err) : FileAccess::open_encrypted(temp_path, FileAccess::WRITE, key);
+		ERR_FAIL_COND_MSG(file.is_null(), vformat(R"(Can't write the GDScript bytecode cache of "%s".)", p_script->path));
+		file->store_buffer(buffer.ptr(), buffer.size());
+		file->close();
+		err = file->get_error();
+	}
+	if (err == OK) {
+		err = DirAccess::rename_absolute(temp_path, cache_path);
+	}
+	if (err != OK) {
+		DirAccess::remove_absolute(temp_path);
+		ERR_FAIL_MSG(vformat(R"(Can't write the GDScript bytecode cache of "%s".)", p_script->path));
+	}
+}
+
+// Reading.
+
+bool GDScriptBytecodeCache::_read_header(Reader &p_reader, const GDScript *p_script) {
+	if (!p_reader.has(4) || memcmp(p_reader.data, "GDBC", 4) != 0) {
+		return false;
+	}
+	p_reader.position += 4;
+	if (p_reader.get_u32() != FORMAT_VERSION || p_reader.get_string() != _get_environment_key()) {
+		return false;
+	}
+
+	uint32_t payload_size = p_reader.get_u32();
+	uint32_t checksum = p_reader.get_u32();
+	if (p_reader.failed || payload_size != p_reader.size - p_reader.position || checksum != hash_murmur3_buffer(p_reader.data + p_reader.position, payload_size)) {
+		return false;
+	}
+
+	return p_reader.get_string() == p_script->path && p_reader.get_string() == _get_source_hash(p_script) && !p_reader.failed;
+}
+
+bool GDScriptBytecodeCache::_read_dependencies(Reader &p_reader) {
+	uint32_t dependency_count = p_reader.get_count();
+	for (uint32_t i = 0; i < dependency_count; i++) {
+		String path = p_reader.get_string();
+		String hash = p_reader.get_string();
+		if (p_reader.failed || _get_file_hash(path) != hash) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void GDScriptBytecodeCache::_read_shape(Reader &p_reader, GDScript *p_script) {
+	// Same as GDScriptCompiler::make_scripts() when keeping state.
+	p_script->global_name = p_reader.get_string_name();
+	p_script->simplified_icon_path = p_reader.get_string();
+
+	HashMap<StringName, Ref<GDScript>> old_subclasses = p_script->subclasses;
+	p_script->subclasses.clear();
+
+	uint32_t subclass_count = p_reader.get_count();
+	for (uint32_t i = 0; i < subclass_count && !p_reader.failed; i++) {
+		StringName name = p_reader.get_string_name();
+		String fully_qualified_name = p_reader.get_string();
+
+		Ref<GDScript> subclass;
+		if (old_subclasses.has(name)) {
+			subclass = old_subclasses[name];
+		} else {
+			subclass = GDScriptLanguage::get_singleton()->get_orphan_subclass(fully_qualified_name);
+		}
+		if (subclass.is_null()) {
+			subclass.instantiate();
+		}
+
+		subclass->_owner = p_script;
+		subclass->path = p_script->path;
+		subclass->local_name = name;
+		subclass->fully_qualified_name = fully_qualified_name;
+		p_script->subclasses.insert(name, subclass);
+
+		_read_shape(p_reader, subclass.ptr());
+	}
+}
+
+GDScript *GDScriptBytecodeCache::_read_script_ref(Reader &p_reader, Context &p_context) {
+	String path = p_reader.get_string();
+	uint32_t name_count = p_reader.get_count();
+	if (p_reader.failed) {
+		return nullptr;
+	}
+
+	GDScript *script = nullptr;
+	if (path == p_context.root->path) {
+		script = p_context.root;
+	} else {
+		// Other scripts are handled like the compiler does, the cache finishes loading them once this one is done.
+		Error err = OK;
+		Ref<GDScript> other = GDScriptCache::get_shallow_script(path, err, p_context.root->path);
+		if (err != OK || other.is_null()) {
+			p_reader.failed = true;
+			return nullptr;
+		}
+		script = other.ptr();
+	}
+
+	for (uint32_t i = 0; i < name_count; i++) {
+		HashMap<StringName, Ref<GDScript>>::Iterator E = script->subclasses.find(p_reader.get_string_name());
+		if (p_reader.failed || !E) {
+			p_reader.failed = true;
+			return nullptr;
+		}
+		script = E->value.ptr();
+	}
+	return script;
+}
+
+bool GDScriptBytecodeCache::_read_data_type(Reader &p_reader, Context &p_context, GDScriptDataType &r_type) {
+	r_type.has_type = p_reader.get_u8();
+	uint8_t kind = p_reader.get_u8();
+	if (kind > GDScriptDataType::GDSCRIPT) {
+		return false;
+	}
+	r_type.kind = GDScriptDataType::Kind(kind);
+	r_type.builtin_type = p_reader.get_variant_type();
+	r_type.native_type = p_reader.get_string_name();
+
+	uint8_t script_mode = p_reader.get_u8();
+	if (script_mode != 0) {
+		GDScript *script = _read_script_ref(p_reader, p_context);
+		if (!script) {
+			return false;
+		}
+		r_type.script_type = script;
+		if (script_mode == 2) {
+			r_type.script_type_ref = Ref<Script>(script);
+		}
+	}
+
+	uint32_t element_count = p_reader.get_count();
+	for (uint32_t i = 0; i < element_count; i++) {
+		GDScriptDataType element_type;
+		if (!_read_data_type(p_reader, p_context, element_type)) {
+			return false;
+		}
+		r_type.container_element_types.push_back(element_type);
+	}
+	return !p_reader.failed;
+}
+
+bool GDScriptBytecodeCache::_read_property_info(Reader &p_reader, PropertyInfo &r_info) {
+	r_info.type = p_reader.get_variant_type();
+	r_info.name = p_reader.get_string();
+	r_info.class_name = p_reader.get_string_name();
+	r_info.hint = PropertyHint(p_reader.get_u32());
+	r_info.hint_string = p_reader.get_string();
+	r_info.usage = p_reader.get_u32();
+	return !p_reader.failed;
+}
+
+bool GDScriptBytecodeCache::_read_method_info(Reader &p_reader, Context &p_context, MethodInfo &r_info) {
+	r_info.name = p_reader.get_string();
+	if (!_read_property_info(p_reader, r_info.return_val)) {
+		return false;
+	}
+	r_info.flags = p_reader.get_u32();
+	r_info.id = p_reader.get_i32();
+
+	uint32_t argument_count = p_reader.get_count();
+	for (uint32_t i = 0; i < argument_count; i++) {
+		PropertyInfo argument;
+		if (!_read_property_info(p_reader, argument)) {
+			return false;
+		}
+		r_info.arguments.push_back(argument);
+	}
+
+	uint32_t default_argument_count = p_reader.get_count();
+	for (uint32_t i = 0; i < default_argument_count; i++) {
+		Variant default_argument;
+		if (!_read_variant(p_reader, p_context, default_argument)) {
+			return false;
+		}
+		r_info.default_arguments.push_back(default_argument);
+	}
+
+	r_info.return_val_metadata = p_reader.get_i32();
+	uint32_t metadata_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < metadata_count; i++) {
+		r_info.arguments_metadata.push_back(p_reader.get_i32());
+	}
+	return !p_reader.failed;
+}
+
+bool GDScriptBytecodeCache::_read_variant(Reader &p_reader, Context &p_context, Variant &r_value) {
+	switch (p_reader.get_u8()) {
+		case VARIANT_TAG_PLAIN: {
+			uint32_t length = p_reader.get_count();
+			if (p_reader.failed) {
+				return false;
+			}
+			int used = 0;
+			if (decode_variant(r_value, p_reader.data + p_reader.position, length, &used) != OK || uint32_t(used) != length) {
+				return false;
+			}
+			p_reader.position += length;
+			return true;
+		}
+
+		case VARIANT_TAG_ARRAY: {
+			bool read_only = p_reader.get_u8();
+			Variant::Type typed_builtin = p_reader.get_variant_type();
+			StringName typed_class_name = p_reader.get_string_name();
+			Ref<Script> typed_script;
+			if (p_reader.get_u8()) {
+				GDScript *script = _read_script_ref(p_reader, p_context);
+				if (!script) {
+					return false;
+				}
+				typed_script = Ref<Script>(script);
+			}
+
+			Array array;
+			if (typed_builtin != Variant::NIL || typed_class_name != StringName() || typed_script.is_valid()) {
+				array.set_typed(typed_builtin, typed_class_name, typed_script);
+			}
+			uint32_t size = p_reader.get_count();
+			for (uint32_t i = 0; i < size; i++) {
+				Variant element;
+				if (!_read_variant(p_reader, p_context, element)) {
+					return false;
+				}
+				array.push_back(element);
+			}
+			if (read_only) {
+				array.make_read_only();
+			}
+			r_value = array;
+			return !p_reader.failed;
+		}
+
+		case VARIANT_TAG_DICTIONARY: {
+			bool read_only = p_reader.get_u8();
+			Dictionary dictionary;
+			uint32_t size = p_reader.get_count(2);
+			for (uint32_t i = 0; i < size; i++) {
+				Variant key;
+				Variant value;
+				if (!_read_variant(p_reader, p_context, key) || !_read_variant(p_reader, p_context, value)) {
+					return false;
+				}
+				dictionary[key] = value;
+			}
+			if (read_only) {
+				dictionary.make_read_only();
+			}
+			r_value = dictionary;
+			return !p_reader.failed;
+		}
+
+		case VARIANT_TAG_NULL_OBJECT: {
+			r_value = (Object *)nullptr;
+			return true;
+		}
+
+		case VARIANT_TAG_SCRIPT: {
+			GDScript *script = _read_script_ref(p_reader, p_context);
+			if (!script) {
+				return false;
+			}
+			r_value = Ref<GDScript>(script);
+			return true;
+		}
+
+		case VARIANT_TAG_NATIVE_CLASS: {
+			StringName name = p_reader.get_string_name();
+			const int *index = GDScriptLanguage::get_singleton()->get_global_map().getptr(name);
+			if (p_reader.failed || !index) {
+				return false;
+			}
+			const Variant &native_class = GDScriptLanguage::get_singleton()->get_global_array()[*index];
+			if (!Object::cast_to<GDScriptNativeClass>(native_class)) {
+				return false;
+			}
+			r_value = native_class;
+			return true;
+		}
+
+		case VARIANT_TAG_SINGLETON: {
+			Object *singleton = Engine::get_singleton()->get_singleton_object(p_reader.get_string_name());
+			if (p_reader.failed || !singleton) {
+				return false;
+			}
+			r_value = singleton;
+			return true;
+		}
+
+		case VARIANT_TAG_RESOURCE: {
+			String path = p_reader.get_string();
+			if (p_reader.failed) {
+				return false;
+			}
+			Ref<Resource> resource = ResourceLoader::load(path);
+			if (resource.is_null()) {
+				return false;
+			}
+			r_value = resource;
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+bool GDScriptBytecodeCache::_read_function(Reader &p_reader, Context &p_context, GDScriptFunction *p_function) {
+	p_function->name = p_reader.get_string_name();
+	p_function->_static = p_reader.get_u8();
+
+	uint32_t argument_count = p_reader.get_count();
+	for (uint32_t i = 0; i < argument_count; i++) {
+		GDScriptDataType argument_type;
+		if (!_read_data_type(p_reader, p_context, argument_type)) {
+			return false;
+		}
+		p_function->argument_types.push_back(argument_type);
+	}
+	if (!_read_data_type(p_reader, p_context, p_function->return_type) || !_read_method_info(p_reader, p_context, p_function->method_info) || !_read_variant(p_reader, p_context, p_function->rpc_config)) {
+		return false;
+	}
+	p_function->_initial_line = p_reader.get_i32();
+	p_function->_argument_count = p_reader.get_i32();
+	p_function->_stack_size = p_reader.get_i32();
+	p_function->_instruction_args_size = p_reader.get_i32();
+
+	uint32_t temporary_count = p_reader.get_count(8);
+	for (uint32_t i = 0; i < temporary_count; i++) {
+		int slot = p_reader.get_i32();
+		p_function->temporary_slots[slot] = p_reader.get_variant_type();
+	}
+
+	uint32_t code_size = p_reader.get_count(4);
+	p_function->code.resize(code_size);
+	int *code = p_function->code.ptrw();
+	for (uint32_t i = 0; i < code_size; i++) {
+		code[i] = p_reader.get_i32();
+	}
+
+	const HashMap<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	uint32_t global_index_count = p_reader.get_count(8);
+	for (uint32_t i = 0; i < global_index_count; i++) {
+		int position = p_reader.get_i32();
+		const int *global_index = global_map.getptr(p_reader.get_string_name());
+		if (p_reader.failed || !global_index || position < 0 || position >= int(code_size)) {
+			return false;
+		}
+		code[position] = *global_index;
+		p_function->global_index_positions.push_back(position);
+	}
+
+	uint32_t default_argument_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < default_argument_count; i++) {
+		p_function->default_arguments.push_back(p_reader.get_i32());
+	}
+
+	uint32_t constant_count = p_reader.get_count();
+	p_function->constants.resize(constant_count);
+	for (uint32_t i = 0; i < constant_count; i++) {
+		if (!_read_variant(p_reader, p_context, p_function->constants.write[i])) {
+			return false;
+		}
+	}
+
+	uint32_t global_name_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < global_name_count; i++) {
+		p_function->global_names.push_back(p_reader.get_string_name());
+	}
+
+	uint32_t operator_count = p_reader.get_count(12);
+	for (uint32_t i = 0; i < operator_count; i++) {
+		uint32_t op = p_reader.get_u32();
+		Variant::Type type_a = p_reader.get_variant_type();
+		Variant::Type type_b = p_reader.get_variant_type();
+		Variant::ValidatedOperatorEvaluator evaluator = op < Variant::OP_MAX ? Variant::get_validated_operator_evaluator(Variant::Operator(op), type_a, type_b) : nullptr;
+		if (!evaluator) {
+			return false;
+		}
+		p_function->operator_funcs.push_back(evaluator);
+	}
+
+	uint32_t setter_count = p_reader.get_count(8);
+	for (uint32_t i = 0; i < setter_count; i++) {
+		Variant::Type type = p_reader.get_variant_type();
+		Variant::ValidatedSetter setter = Variant::get_member_validated_setter(type, p_reader.get_string_name());
+		if (!setter) {
+			return false;
+		}
+		p_function->setters.push_back(setter);
+	}
+
+	uint32_t getter_count = p_reader.get_count(8);
+	for (uint32_t i = 0; i < getter_count; i++) {
+		Variant::Type type = p_reader.get_variant_type();
+		Variant::ValidatedGetter getter = Variant::get_member_validated_getter(type, p_reader.get_string_name());
+		if (!getter) {
+			return false;
+		}
+		p_function->getters.push_back(getter);
+	}
+
+	uint32_t keyed_setter_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < keyed_setter_count; i++) {
+		Variant::ValidatedKeyedSetter keyed_setter = Variant::get_member_validated_keyed_setter(p_reader.get_variant_type());
+		if (!keyed_setter) {
+			return false;
+		}
+		p_function->keyed_setters.push_back(keyed_setter);
+	}
+
+	uint32_t keyed_getter_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < keyed_getter_count; i++) {
+		Variant::ValidatedKeyedGetter keyed_getter = Variant::get_member_validated_keyed_getter(p_reader.get_variant_type());
+		if (!keyed_getter) {
+			return false;
+		}
+		p_function->keyed_getters.push_back(keyed_getter);
+	}
+
+	uint32_t indexed_setter_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < indexed_setter_count; i++) {
+		Variant::ValidatedIndexedSetter indexed_setter = Variant::get_member_validated_indexed_setter(p_reader.get_variant_type());
+		if (!indexed_setter) {
+			return false;
+		}
+		p_function->indexed_setters.push_back(indexed_setter);
+	}
+
+	uint32_t indexed_getter_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < indexed_getter_count; i++) {
+		Variant::ValidatedIndexedGetter indexed_getter = Variant::get_member_validated_indexed_getter(p_reader.get_variant_type());
+		if (!indexed_getter) {
+			return false;
+		}
+		p_function->indexed_getters.push_back(indexed_getter);
+	}
+
+	Context::CallArguments &call_arguments = p_context.call_arguments[p_function];
+
+	uint32_t builtin_method_count = p_reader.get_count(8);
+	for (uint32_t i = 0; i < builtin_method_count; i++) {
+		Variant::Type type = p_reader.get_variant_type();
+		StringName method = p_reader.get_string_name();
+		Variant::ValidatedBuiltInMethod builtin_method = Variant::get_validated_builtin_method(type, method);
+		if (!builtin_method) {
+			return false;
+		}
+		p_function->builtin_methods.push_back(builtin_method);
+		call_arguments.builtin_methods.push_back(Variant::is_builtin_method_vararg(type, method) ? -1 : Variant::get_builtin_method_argument_count(type, method));
+	}
+
+	uint32_t constructor_count = p_reader.get_count(8);
+	for (uint32_t i = 0; i < constructor_count; i++) {
+		Variant::Type type = p_reader.get_variant_type();
+		int index = p_reader.get_i32();
+		if (p_reader.failed || index < 0 || index >= Variant::get_constructor_count(type)) {
+			return false;
+		}
+		p_function->constructors.push_back(Variant::get_validated_constructor(type, index));
+		call_arguments.constructors.push_back(Variant::get_constructor_argument_count(type, index));
+	}
+
+	uint32_t utility_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < utility_count; i++) {
+		StringName name = p_reader.get_string_name();
+		Variant::ValidatedUtilityFunction utility = Variant::get_validated_utility_function(name);
+		if (!utility) {
+			return false;
+		}
+		p_function->utilities.push_back(utility);
+		call_arguments.utilities.push_back(Variant::is_utility_function_vararg(name) ? -1 : Variant::get_utility_function_argument_count(name));
+	}
+
+	uint32_t gds_utility_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < gds_utility_count; i++) {
+		StringName name = p_reader.get_string_name();
+		GDScriptUtilityFunctions::FunctionPtr gds_utility = GDScriptUtilityFunctions::get_function(name);
+		if (!gds_utility) {
+			return false;
+		}
+		p_function->gds_utilities.push_back(gds_utility);
+		if (GDScriptUtilityFunctions::is_function_vararg(name)) {
+			call_arguments.gds_utilities.push_back(Pair<int, int>(0, INT_MAX));
+		} else {
+			int argument_count = GDScriptUtilityFunctions::get_function_argument_count(name);
+			int default_count = GDScriptUtilityFunctions::get_function_info(name).default_arguments.size();
+			call_arguments.gds_utilities.push_back(Pair<int, int>(argument_count - default_count, argument_count));
+		}
+	}
+
+	uint32_t method_count = p_reader.get_count(12);
+	for (uint32_t i = 0; i < method_count; i++) {
+		StringName class_name = p_reader.get_string_name();
+		StringName method_name = p_reader.get_string_name();
+		uint32_t hash = p_reader.get_u32();
+		// Also catches extension classes that changed their API.
+		MethodBind *method = p_reader.failed ? nullptr : ClassDB::get_method_with_compatibility(class_name, method_name, hash);
+		if (!method) {
+			return false;
+		}
+		p_function->methods.push_back(method);
+	}
+
+	uint32_t lambda_count = p_reader.get_count();
+	for (uint32_t i = 0; i < lambda_count; i++) {
+		GDScriptFunction *lambda = memnew(GDScriptFunction);
+		lambda->_script = p_function->_script;
+		// Owned by the function from the start, so it's deleted with it if loading fails.
+		p_function->lambdas.push_back(lambda);
+		if (!_read_function(p_reader, p_context, lambda)) {
+			return false;
+		}
+		bool has_info = p_reader.get_u8();
+		GDScript::LambdaInfo info;
+		info.capture_count = p_reader.get_i32();
+		info.use_self = p_reader.get_u8();
+		if (has_info) {
+			p_context.lambda_info.insert(lambda, info);
+		}
+	}
+
+	p_function->_inline_caches_count = p_reader.get_i32();
+	if (p_function->_inline_caches_count < 0) {
+		return false;
+	}
+
+#ifdef DEBUG_ENABLED
+	Vector<String> *debug_names[] = {
+		&p_function->operator_names,
+		&p_function->setter_names,
+		&p_function->getter_names,
+		&p_function->builtin_methods_names,
+		&p_function->constructors_names,
+		&p_function->utilities_names,
+		&p_function->gds_utilities_names,
+	};
+	for (Vector<String> *debug_name_list : debug_names) {
+		uint32_t debug_name_count = p_reader.get_count(4);
+		for (uint32_t i = 0; i < debug_name_count; i++) {
+			debug_name_list->push_back(p_reader.get_string());
+		}
+	}
+	p_function->profile.signature = p_reader.get_string_name();
+#endif
+
+	return !p_reader.failed;
+}
+
+bool GDScriptBytecodeCache::_read_class(Reader &p_reader, Context &p_context, GDScript *p_script, ClassData &r_data) {
+	r_data.script = p_script;
+	r_data.tool = p_reader.get_u8();
+
+	const int *native_index = GDScriptLanguage::get_singleton()->get_global_map().getptr(p_reader.get_string_name());
+	if (p_reader.failed || !native_index) {
+		return false;
+	}
+	r_data.native = GDScriptLanguage::get_singleton()->get_global_array()[*native_index];
+	if (r_data.native.is_null()) {
+		return false;
+	}
+
+	if (p_reader.get_u8()) {
+		GDScript *base = _read_script_ref(p_reader, p_context);
+		if (!base) {
+			return false;
+		}
+		r_data.base = Ref<GDScript>(base);
+	}
+
+	HashMap<StringName, GDScript::MemberInfo> *member_maps[] = { &r_data.member_indices, &r_data.static_variables_indices };
+	for (HashMap<StringName, GDScript::MemberInfo> *member_map : member_maps) {
+		uint32_t member_count = p_reader.get_count();
+		for (uint32_t i = 0; i < member_count; i++) {
+			StringName name = p_reader.get_string_name();
+			GDScript::MemberInfo info;
+			info.index = p_reader.get_i32();
+			info.setter = p_reader.get_string_name();
+			info.getter = p_reader.get_string_name();
+			if (!_read_data_type(p_reader, p_context, info.data_type) || !_read_property_info(p_reader, info.property_info)) {
+				return false;
+			}
+			member_map->insert(name, info);
+		}
+	}
+
+	uint32_t member_count = p_reader.get_count(4);
+	for (uint32_t i = 0; i < member_count; i++) {
+		r_data.members.insert(p_reader.get_string_name());
+	}
+
+	uint32_t constant_count = p_reader.get_count();
+	for (uint32_t i = 0; i < constant_count; i++) {
+		StringName name = p_reader.get_string_name();
+		Variant value;
+		if (!_read_variant(p_reader, p_context, value)) {
+			return false;
+		}
+		r_data.constants.insert(name, value);
+	}
+
+	uint32_t signal_count = p_reader.get_count();
+	for (uint32_t i = 0; i < signal_count; i++) {
+		StringName name = p_reader.get_string_name();
+		MethodInfo info;
+		if (!_read_method_info(p_reader, p_context, info)) {
+			return false;
+		}
+		r_data.signals.insert(name, info);
+	}
+
+	Variant rpc_config;
+	if (!_read_variant(p_reader, p_context, rpc_config) || rpc_config.get_type() != Variant::DICTIONARY) {
+		return false;
+	}
+	r_data.rpc_config = rpc_config;
+
+	uint32_t function_count = p_reader.get_count();
+	for (uint32_t i = 0; i < function_count; i++) {
+		StringName name = p_reader.get_string_name();
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		function->_script = p_script;
+		p_context.functions.push_back(function);
+		if (!_read_function(p_reader, p_context, function)) {
+			return false;
+		}
+		r_data.member_functions.insert(name, function);
+	}
+
+	GDScriptFunction **implicit_functions[] = { &r_data.implicit_initializer, &r_data.implicit_ready, &r_data.static_initializer };
+	for (GDScriptFunction **implicit_function : implicit_functions) {
+		if (!p_reader.get_u8()) {
+			continue;
+		}
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		function->_script = p_script;
+		p_context.functions.push_back(function);
+		if (!_read_function(p_reader, p_context, function)) {
+			return false;
+		}
+		*implicit_function = function;
+	}
+
+	// Written in the same order, since the shape was read first.
+	r_data.subclasses.resize(p_script->subclasses.size());
+	uint32_t subclass_index = 0;
+	for (const KeyValue<StringName, Ref<GDScript>> &E : p_script->subclasses) {
+		if (!_read_class(p_reader, p_context, E.value.ptr(), r_data.subclasses[subclass_index++])) {
+			return false;
+		}
+	}
+	return !p_reader.failed;
+}
+
+// Checking.
+
+// Release builds of the VM trust the compiler, addresses, table indices, argument counts and jump targets are used
+// without checking them. Everything the compiler guarantees about them is checked here once instead, so an entry that
+// was damaged on disk is compiled from source rather than run.
+bool GDScriptBytecodeCache::_validate_function(const Context &p_context, const ClassData &p_class, const GDScriptFunction *p_function, bool p_has_instance, bool p_static_initializer) {
+	const int *code = p_function->code.ptr();
+	const int code_size = p_function->code.size();
+	const int stack_size = p_function->_stack_size;
+	const int instruction_args_size = p_function->_instruction_args_size;
+	const int argument_count = p_function->_argument_count;
+
+	if (argument_count < 0 || argument_count != p_function->argument_types.size() || p_function->default_arguments.size() > argument_count + 1) {
+		return false;
+	}
+	// Both are allocated on the native stack on every call, so they are kept within what the code can refer to.
+	if (stack_size < GDScriptFunction::FIXED_ADDRESSES_MAX + argument_count || stack_size - GDScriptFunction::FIXED_ADDRESSES_MAX - argument_count > code_size) {
+		return false;
+	}
+	if (instruction_args_size < 0 || instruction_args_size > code_size || p_function->_inline_caches_count > code_size) {
+		return false;
+	}
+	for (const KeyValue<int, Variant::Type> &E : p_function->temporary_slots) {
+		if (E.key < GDScriptFunction::FIXED_ADDRESSES_MAX || E.key >= stack_size) {
+			return false;
+		}
+	}
+	if (code_size == 0 || code[code_size - 1] != GDScriptFunction::OPCODE_END) {
+		return false;
+	}
+
+	const Context::CallArguments *call_arguments = p_context.call_arguments.getptr(p_function);
+	if (!call_arguments) {
+		return false;
+	}
+
+	Vector<uint8_t> instruction_starts;
+	instruction_starts.resize(code_size);
+	instruction_starts.fill(0);
+	LocalVector<int> jump_targets;
+	// STORE_GLOBAL operands were written by name and resolved while reading, no other word may have been.
+	Vector<uint8_t> global_operands;
+	global_operands.resize(code_size);
+	global_operands.fill(0);
+	for (int position : p_function->global_index_positions) {
+		if (global_operands[position]) {
+			return false;
+		}
+		global_operands.write[position] = 1;
+	}
+	int store_global_count = 0;
+	// Lambdas created with CREATE_LAMBDA run without an instance, only those created with CREATE_SELF_LAMBDA have one.
+	Vector<uint8_t> lambda_uses;
+	lambda_uses.resize(p_function->lambdas.size());
+	lambda_uses.fill(0);
+
+	const int member_count = p_has_instance ? p_class.member_indices.size() : 0;
+	const int constant_count = p_function->constants.size();
+	const int global_name_count = p_function->global_names.size();
+
+	int ip = 0;
+	int length = 0;
+	int instruction_args = 0;
+	const int *fields = nullptr;
+
+	auto in_range = [](int p_value, int p_count) {
+		return p_value >= 0 && p_value < p_count;
+	};
+	auto fits = [&](int p_length) {
+		length = p_length;
+		return p_length <= code_size - ip;
+	};
+	auto addresses = [&](int p_from, int p_count) {
+		for (int i = p_from; i < p_from + p_count; i++) {
+			const int index = code[ip + i] & GDScriptFunction::ADDR_MASK;
+			switch (uint32_t(code[ip + i]) >> GDScriptFunction::ADDR_BITS) {
+				case GDScriptFunction::ADDR_TYPE_STACK:
+					if (index >= stack_size) {
+						return false;
+					}
+					break;
+				case GDScriptFunction::ADDR_TYPE_CONSTANT:
+					if (index >= constant_count) {
+						return false;
+					}
+					break;
+				case GDScriptFunction::ADDR_TYPE_MEMBER:
+					if (index >= member_count) {
+						return false;
+					}
+					break;
+				default:
+					return false;
+			}
+		}
+		return true;
+	};
+	// For the opcodes that load their addresses into the instruction arguments first, then read p_fields more words.
+	auto fits_arguments = [&](int p_fields) {
+		if (!fits(2)) {
+			return false;
+		}
+		instruction_args = code[ip + 1];
+		if (!in_range(instruction_args, instruction_args_size + 1) || !fits(2 + instruction_args + p_fields)) {
+			return false;
+		}
+		fields = code + ip + 2 + instruction_args;
+		return addresses(2, instruction_args);
+	};
+	// Calls pass p_argc instruction arguments, followed by p_extra more (base, return value).
+	auto has_arguments = [&](int p_argc, int p_extra) {
+		return p_argc >= 0 && p_argc <= instruction_args - p_extra;
+	};
+	auto is_type = [&](int p_type) {
+		return in_range(p_type, Variant::VARIANT_MAX);
+	};
+	auto jump = [&](int p_target) {
+		jump_targets.push_back(p_target);
+		return true;
+	};
+	auto static_variable_count = [&](int p_address) -> int {
+		if (p_address == GDScriptFunction::ADDR_CLASS) {
+			// The class of the function itself, only used by the static initializer which has no instance.
+			return p_static_initializer ? p_context.static_variable_counts[p_class.script] : 0;
+		}
+		if (uint32_t(p_address) >> GDScriptFunction::ADDR_BITS != GDScriptFunction::ADDR_TYPE_CONSTANT) {
+			return 0;
+		}
+		const GDScript *script = Object::cast_to<GDScript>(p_function->constants[p_address & GDScriptFunction::ADDR_MASK].operator Object *());
+		if (!script) {
+			return 0;
+		}
+		if (const int *count = p_context.static_variable_counts.getptr(script)) {
+			return *count;
+		}
+		// Scripts from other files that aren't compiled yet don't have static variables, the script is compiled instead.
+		return script->valid ? script->static_variables.size() : 0;
+	};
+	auto is_validated_method = [&](int p_index, int p_argc) {
+		if (!in_range(p_index, p_function->methods.size())) {
+			return false;
+		}
+		const MethodBind *method = p_function->methods[p_index];
+		return !method->is_vararg() && method->get_argument_count() == p_argc;
+	};
+
+	while (ip < code_size) {
+		instruction_starts.write[ip] = 1;
+		bool valid = false;
+
+		switch (code[ip]) {
+			case GDScriptFunction::OPCODE_OPERATOR: {
+				// The signature, return type and evaluator are filled in by the first run, so they must be empty.
+				constexpr int pointer_size = sizeof(Variant::ValidatedOperatorEvaluator) / sizeof(*code);
+				valid = fits(7 + pointer_size) && addresses(1, 3) && in_range(code[ip + 4], Variant::OP_MAX);
+				for (int i = 5; valid && i < 7 + pointer_size; i++) {
+					valid = code[ip + i] == 0;
+				}
+			} break;
+			case GDScriptFunction::OPCODE_OPERATOR_VALIDATED:
+				valid = fits(5) && addresses(1, 3) && in_range(code[ip + 4], p_function->operator_funcs.size());
+				break;
+			case GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF:
+			case GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT:
+				valid = fits(6) && addresses(1, 3) && in_range(code[ip + 4], p_function->operator_funcs.size()) && jump(code[ip + 5]);
+				break;
+			case GDScriptFunction::OPCODE_TYPE_TEST_BUILTIN:
+			case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN:
+			case GDScriptFunction::OPCODE_CAST_TO_BUILTIN:
+				valid = fits(4) && addresses(1, 2) && is_type(code[ip + 3]);
+				break;
+			case GDScriptFunction::OPCODE_TYPE_TEST_ARRAY:
+			case GDScriptFunction::OPCODE_ASSIGN_TYPED_ARRAY:
+				valid = fits(6) && addresses(1, 3) && is_type(code[ip + 4]) && in_range(code[ip + 5], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_TYPE_TEST_NATIVE:
+				valid = fits(4) && addresses(1, 2) && in_range(code[ip + 3], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_TYPE_TEST_SCRIPT:
+			case GDScriptFunction::OPCODE_SET_KEYED:
+			case GDScriptFunction::OPCODE_GET_KEYED:
+			case GDScriptFunction::OPCODE_SET_INDEXED_PACKED_FLOAT32_ARRAY:
+			case GDScriptFunction::OPCODE_SET_INDEXED_PACKED_VECTOR2_ARRAY:
+			case GDScriptFunction::OPCODE_GET_INDEXED_PACKED_FLOAT32_ARRAY:
+			case GDScriptFunction::OPCODE_GET_INDEXED_PACKED_VECTOR2_ARRAY:
+			case GDScriptFunction::OPCODE_ASSIGN_TYPED_NATIVE:
+			case GDScriptFunction::OPCODE_ASSIGN_TYPED_SCRIPT:
+			case GDScriptFunction::OPCODE_CAST_TO_NATIVE:
+			case GDScriptFunction::OPCODE_CAST_TO_SCRIPT:
+				valid = fits(4) && addresses(1, 3);
+				break;
+			case GDScriptFunction::OPCODE_SET_KEYED_VALIDATED:
+				valid = fits(5) && addresses(1, 3) && in_range(code[ip + 4], p_function->keyed_setters.size());
+				break;
+			case GDScriptFunction::OPCODE_GET_KEYED_VALIDATED:
+				valid = fits(5) && addresses(1, 3) && in_range(code[ip + 4], p_function->keyed_getters.size());
+				break;
+			case GDScriptFunction::OPCODE_SET_INDEXED_VALIDATED:
+				valid = fits(5) && addresses(1, 3) && in_range(code[ip + 4], p_function->indexed_setters.size());
+				break;
+			case GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED:
+				valid = fits(5) && addresses(1, 3) && in_range(code[ip + 4], p_function->indexed_getters.size());
+				break;
+			case GDScriptFunction::OPCODE_APPEND_PACKED_FLOAT32_ARRAY:
+			case GDScriptFunction::OPCODE_APPEND_PACKED_VECTOR2_ARRAY:
+			case GDScriptFunction::OPCODE_ASSIGN:
+				valid = fits(3) && addresses(1, 2);
+				break;
+			case GDScriptFunction::OPCODE_SET_NAMED:
+			case GDScriptFunction::OPCODE_GET_NAMED:
+				valid = fits(5) && addresses(1, 2) && in_range(code[ip + 3], global_name_count) && in_range(code[ip + 4], p_function->_inline_caches_count);
+				break;
+			case GDScriptFunction::OPCODE_SET_NAMED_VALIDATED:
+				valid = fits(4) && addresses(1, 2) && in_range(code[ip + 3], p_function->setters.size());
+				break;
+			case GDScriptFunction::OPCODE_GET_NAMED_VALIDATED:
+				valid = fits(4) && addresses(1, 2) && in_range(code[ip + 3], p_function->getters.size());
+				break;
+			case GDScriptFunction::OPCODE_SET_MEMBER:
+			case GDScriptFunction::OPCODE_GET_MEMBER:
+				valid = p_has_instance && fits(3) && addresses(1, 1) && in_range(code[ip + 2], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_SET_STATIC_VARIABLE:
+			case GDScriptFunction::OPCODE_GET_STATIC_VARIABLE:
+				valid = fits(4) && addresses(1, 2) && in_range(code[ip + 3], static_variable_count(code[ip + 2]));
+				break;
+			case GDScriptFunction::OPCODE_ASSIGN_NULL:
+			case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+			case GDScriptFunction::OPCODE_ASSIGN_FALSE:
+			case GDScriptFunction::OPCODE_AWAIT_RESUME:
+			case GDScriptFunction::OPCODE_RETURN:
+				valid = fits(2) && addresses(1, 1);
+				break;
+			case GDScriptFunction::OPCODE_CONSTRUCT:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && is_type(fields[1]);
+				break;
+			case GDScriptFunction::OPCODE_CONSTRUCT_VALIDATED:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], p_function->constructors.size()) && call_arguments->constructors[fields[1]] == fields[0];
+				break;
+			case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY:
+				valid = fits_arguments(1) && has_arguments(fields[0], 1);
+				break;
+			case GDScriptFunction::OPCODE_CONSTRUCT_TYPED_ARRAY:
+				valid = fits_arguments(3) && has_arguments(fields[0], 2) && is_type(fields[1]) && in_range(fields[2], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY:
+				// Keys and values, then the result.
+				valid = fits_arguments(1) && fields[0] >= 0 && int64_t(fields[0]) * 2 + 1 <= instruction_args;
+				break;
+			case GDScriptFunction::OPCODE_CALL:
+			case GDScriptFunction::OPCODE_CALL_RETURN:
+			case GDScriptFunction::OPCODE_CALL_ASYNC:
+				valid = fits_arguments(3) && has_arguments(fields[0], code[ip] == GDScriptFunction::OPCODE_CALL ? 1 : 2) && in_range(fields[1], global_name_count) && in_range(fields[2], p_function->_inline_caches_count);
+				break;
+			case GDScriptFunction::OPCODE_CALL_UTILITY:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_CALL_UTILITY_VALIDATED:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], p_function->utilities.size()) && call_arguments->utilities[fields[1]] == fields[0];
+				break;
+			case GDScriptFunction::OPCODE_CALL_GDSCRIPT_UTILITY:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], p_function->gds_utilities.size()) && fields[0] >= call_arguments->gds_utilities[fields[1]].first && fields[0] <= call_arguments->gds_utilities[fields[1]].second;
+				break;
+			case GDScriptFunction::OPCODE_CALL_BUILTIN_TYPE_VALIDATED:
+				valid = fits_arguments(2) && has_arguments(fields[0], 2) && in_range(fields[1], p_function->builtin_methods.size()) && call_arguments->builtin_methods[fields[1]] == fields[0];
+				break;
+			case GDScriptFunction::OPCODE_CALL_SELF_BASE:
+				valid = p_has_instance && fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_CALL_METHOD_BIND:
+			case GDScriptFunction::OPCODE_CALL_METHOD_BIND_RET:
+				valid = fits_arguments(2) && has_arguments(fields[0], code[ip] == GDScriptFunction::OPCODE_CALL_METHOD_BIND ? 1 : 2) && in_range(fields[1], p_function->methods.size());
+				break;
+			case GDScriptFunction::OPCODE_CALL_BUILTIN_STATIC:
+				valid = fits_arguments(3) && is_type(fields[0]) && in_range(fields[1], global_name_count) && has_arguments(fields[2], 1);
+				break;
+			case GDScriptFunction::OPCODE_CALL_NATIVE_STATIC:
+				valid = fits_arguments(2) && in_range(fields[0], p_function->methods.size()) && has_arguments(fields[1], 1);
+				break;
+			case GDScriptFunction::OPCODE_CALL_NATIVE_STATIC_VALIDATED_RETURN:
+			case GDScriptFunction::OPCODE_CALL_NATIVE_STATIC_VALIDATED_NO_RETURN:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && is_validated_method(fields[1], fields[0]);
+				break;
+			case GDScriptFunction::OPCODE_CALL_METHOD_BIND_VALIDATED_RETURN:
+			case GDScriptFunction::OPCODE_CALL_METHOD_BIND_VALIDATED_NO_RETURN:
+				valid = fits_arguments(2) && has_arguments(fields[0], 2) && is_validated_method(fields[1], fields[0]);
+				break;
+			case GDScriptFunction::OPCODE_AWAIT:
+				// Resumes at the AWAIT_RESUME that always follows.
+				valid = fits(2) && addresses(1, 1) && code_size - ip > 2 && code[ip + 2] == GDScriptFunction::OPCODE_AWAIT_RESUME;
+				break;
+			case GDScriptFunction::OPCODE_CREATE_LAMBDA:
+				valid = fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], p_function->lambdas.size());
+				if (valid) {
+					lambda_uses.write[fields[1]] |= LAMBDA_USE_PLAIN;
+				}
+				break;
+			case GDScriptFunction::OPCODE_CREATE_SELF_LAMBDA:
+				valid = p_has_instance && fits_arguments(2) && has_arguments(fields[0], 1) && in_range(fields[1], p_function->lambdas.size());
+				if (valid) {
+					lambda_uses.write[fields[1]] |= LAMBDA_USE_SELF;
+				}
+				break;
+			case GDScriptFunction::OPCODE_JUMP:
+				valid = fits(2) && jump(code[ip + 1]);
+				break;
+			case GDScriptFunction::OPCODE_JUMP_IF:
+			case GDScriptFunction::OPCODE_JUMP_IF_NOT:
+			case GDScriptFunction::OPCODE_JUMP_IF_SHARED:
+				valid = fits(3) && addresses(1, 1) && jump(code[ip + 2]);
+				break;
+			case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT:
+				valid = fits(1) && !p_function->default_arguments.is_empty();
+				break;
+			case GDScriptFunction::OPCODE_RETURN_TYPED_BUILTIN:
+				valid = fits(3) && addresses(1, 1) && is_type(code[ip + 2]);
+				break;
+			case GDScriptFunction::OPCODE_RETURN_TYPED_ARRAY:
+				valid = fits(5) && addresses(1, 2) && is_type(code[ip + 3]) && in_range(code[ip + 4], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_RETURN_TYPED_NATIVE:
+			case GDScriptFunction::OPCODE_RETURN_TYPED_SCRIPT:
+			case GDScriptFunction::OPCODE_ASSERT:
+				valid = fits(3) && addresses(1, 2);
+				break;
+			case GDScriptFunction::OPCODE_STORE_GLOBAL:
+				valid = fits(3) && addresses(1, 1) && global_operands[ip + 2] && in_range(code[ip + 2], GDScriptLanguage::get_singleton()->get_global_array_size());
+				store_global_count++;
+				break;
+			case GDScriptFunction::OPCODE_STORE_NAMED_GLOBAL:
+				valid = fits(3) && addresses(1, 1) && in_range(code[ip + 2], global_name_count);
+				break;
+			case GDScriptFunction::OPCODE_BREAKPOINT:
+			case GDScriptFunction::OPCODE_END:
+				valid = fits(1);
+				break;
+			case GDScriptFunction::OPCODE_LINE:
+				valid = fits(2);
+				break;
+			default:
+				if (code[ip] >= GDScriptFunction::OPCODE_ITERATE_BEGIN && code[ip] <= GDScriptFunction::OPCODE_ITERATE_OBJECT) {
+					valid = fits(5) && addresses(1, 3) && jump(code[ip + 4]);
+				} else if (code[ip] >= GDScriptFunction::OPCODE_TYPE_ADJUST_BOOL && code[ip] <= GDScriptFunction::OPCODE_TYPE_ADJUST_PACKED_VECTOR4_ARRAY) {
+					valid = fits(2) && addresses(1, 1);
+				}
+				break;
+		}
+
+		if (!valid) {
+			return false;
+		}
+		ip += length;
+	}
+
+	if (store_global_count != int(p_function->global_index_positions.size())) {
+		return false;
+	}
+	for (int target : jump_targets) {
+		if (!in_range(target, code_size) || !instruction_starts[target]) {
+			return false;
+		}
+	}
+	for (int default_argument : p_function->default_arguments) {
+		if (!in_range(default_argument, code_size) || !instruction_starts[default_argument]) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < p_function->lambdas.size(); i++) {
+		if (!_validate_function(p_context, p_class, p_function->lambdas[i], lambda_uses[i] == LAMBDA_USE_SELF, false)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool GDScriptBytecodeCache::_validate_class(const Context &p_context, const ClassData &p_data) {
+	for (const KeyValue<StringName, GDScriptFunction *> &E : p_data.member_functions) {
+		if (!_validate_function(p_context, p_data, E.value, !E.value->_static, false)) {
+			return false;
+		}
+	}
+	const GDScriptFunction *instance_functions[] = { p_data.implicit_initializer, p_data.implicit_ready };
+	for (const GDScriptFunction *function : instance_functions) {
+		if (function && !_validate_function(p_context, p_data, function, true, false)) {
+			return false;
+		}
+	}
+	if (p_data.static_initializer && !_validate_function(p_context, p_data, p_data.static_initializer, false, true)) {
+		return false;
+	}
+
+	for (const ClassData &subclass : p_data.subclasses) {
+		if (!_validate_class(p_context, subclass)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void GDScriptBytecodeCache::_collect_static_variable_counts(Context &p_context, const ClassData &p_data) {
+	p_context.static_variable_counts.insert(p_data.script, p_data.static_variables_indices.size());
+	for (const ClassData &subclass : p_data.subclasses) {
+		_collect_static_variable_counts(p_context, subclass);
+	}
+}
+
+void GDScriptBytecodeCache::_finish_function(GDScriptFunction *p_function) {
+	// Same as GDScriptByteCodeGenerator::write_end().
+	p_function->source = p_function->_script->get_script_path();
+#ifdef DEBUG_ENABLED
+	p_function->func_cname = (String(p_function->source) + " - " + String(p_function->name)).utf8();
+	p_function->_func_cname = p_function->func_cname.get_data();
+#endif
+
+	p_function->_code_size = p_function->code.size();
+	p_function->_code_ptr = p_function->code.is_empty() ? nullptr : p_function->code.ptrw();
+	p_function->_default_arg_count = MAX(p_function->default_arguments.size() - 1, 0);
+	p_function->_default_arg_ptr = p_function->default_arguments.is_empty() ? nullptr : p_function->default_arguments.ptr();
+	p_function->_constant_count = p_function->constants.size();
+	p_function->_constants_ptr = p_function->constants.is_empty() ? nullptr : p_function->constants.ptrw();
+	p_function->_global_names_count = p_function->global_names.size();
+	p_function->_global_names_ptr = p_function->global_names.is_empty() ? nullptr : p_function->global_names.ptr();
+	p_function->_operator_funcs_count = p_function->operator_funcs.size();
+	p_function->_operator_funcs_ptr = p_function->operator_funcs.is_empty() ? nullptr : p_function->operator_funcs.ptr();
+	p_function->_setters_count = p_function->setters.size();
+	p_function->_setters_ptr = p_function->setters.is_empty() ? nullptr : p_function->setters.ptr();
+	p_function->_getters_count = p_function->getters.size();
+	p_function->_getters_ptr = p_function->getters.is_empty() ? nullptr : p_function->getters.ptr();
+	p_function->_keyed_setters_count = p_function->keyed_setters.size();
+	p_function->_keyed_setters_ptr = p_function->keyed_setters.is_empty() ? nullptr : p_function->keyed_setters.ptr();
+	p_function->_keyed_getters_count = p_function->keyed_getters.size();
+	p_function->_keyed_getters_ptr = p_function->keyed_getters.is_empty() ? nullptr : p_function->keyed_getters.ptr();
+	p_function->_indexed_setters_count = p_function->indexed_setters.size();
+	p_function->_indexed_setters_ptr = p_function->indexed_setters.is_empty() ? nullptr : p_function->indexed_setters.ptr();
+	p_function->_indexed_getters_count = p_function->indexed_getters.size();
+	p_function->_indexed_getters_ptr = p_function->indexed_getters.is_empty() ? nullptr : p_function->indexed_getters.ptr();
+	p_function->_builtin_methods_count = p_function->builtin_methods.size();
+	p_function->_builtin_methods_ptr = p_function->builtin_methods.is_empty() ? nullptr : p_function->builtin_methods.ptr();
+	p_function->_constructors_count = p_function->constructors.size();
+	p_function->_constructors_ptr = p_function->constructors.is_empty() ? nullptr : p_function->constructors.ptr();
+	p_function->_utilities_count = p_function->utilities.size();
+	p_function->_utilities_ptr = p_function->utilities.is_empty() ? nullptr : p_function->utilities.ptr();
+	p_function->_gds_utilities_count = p_function->gds_utilities.size();
+	p_function->_gds_utilities_ptr = p_function->gds_utilities.is_empty() ? nullptr : p_function->gds_utilities.ptr();
+	p_function->_methods_count = p_function->methods.size();
+	p_function->_methods_ptr = p_function->methods.is_empty() ? nullptr : p_function->methods.ptrw();
+	p_function->_lambdas_count = p_function->lambdas.size();
+	p_function->_lambdas_ptr = p_function->lambdas.is_empty() ? nullptr : p_function->lambdas.ptrw();
+	if (p_function->_inline_caches_count > 0) {
+		p_function->_inline_caches_ptr = memnew_arr(GDScriptInlineCache, p_function->_inline_caches_count);
+	}
+
+	for (GDScriptFunction *lambda : p_function->lambdas) {
+		_finish_function(lambda);
+	}
+}
+
+void GDScriptBytecodeCache::_apply_class(ClassData &p_data) {
+	// Same as GDScriptCompiler::_prepare_compilation() and _compile_class(), the script was checked to be empty.
+	GDScript *script = p_data.script;
+	script->tool = p_data.tool;
+	script->native = p_data.native;
+	script->base = p_data.base;
+	script->_base = p_data.base.ptr();
+	script->member_indices = p_data.member_indices;
+	script->members = p_data.members;
+	script->static_variables_indices = p_data.static_variables_indices;
+	script->static_variables.resize(script->static_variables_indices.size());
+	script->constants = p_data.constants;
+	script->_signals = p_data.signals;
+	script->rpc_config = p_data.rpc_config;
+
+	script->member_functions = p_data.member_functions;
+	for (const KeyValue<StringName, GDScriptFunction *> &E : script->member_functions) {
+		_finish_function(E.value);
+	}
+	HashMap<StringName, GDScriptFunction *>::Iterator initializer = script->member_functions.find(GDScriptLanguage::get_singleton()->strings._init);
+	script->initializer = initializer ? initializer->value : nullptr;
+
+	script->implicit_initializer = p_data.implicit_initializer;
+	script->implicit_ready = p_data.implicit_ready;
+	script->static_initializer = p_data.static_initializer;
+	GDScriptFunction *implicit_functions[] = { script->implicit_initializer, script->implicit_ready, script->static_initializer };
+	for (GDScriptFunction *function : implicit_functions) {
+		if (function) {
+			_finish_function(function);
+		}
+	}
+
+	for (ClassData &subclass : p_data.subclasses) {
+		_apply_class(subclass);
+	}
+
+	script->_static_default_init();
+	script->valid = true;
+}
+
+Error GDScriptBytecodeCache::load_from_buffer(GDScript *p_script, const Vector<uint8_t> &p_buffer) {
+	ERR_FAIL_COND_V(!p_script->is_root_script(), ERR_INVALID_PARAMETER);
+	if (!_is_pristine(p_script)) {
+		return ERR_ALREADY_IN_USE;
+	}
+
+	Reader reader;
+	reader.data = p_buffer.ptr();
+	reader.size = p_buffer.size();
+	if (!_read_header(reader, p_script)) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	if (!_read_dependencies(reader)) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	p_script->local_name = reader.get_string_name();
+	p_script->fully_qualified_name = reader.get_string();
+	_read_shape(reader, p_script);
+	bool keep_static = reader.get_u8();
+	if (reader.failed) {
+		return ERR_FILE_CORRUPT;
+	}
+
+	Context context;
+	context.root = p_script;
+	ClassData data;
+	bool valid = _read_class(reader, context, p_script, data) && reader.position == reader.size;
+	if (valid) {
+		_collect_static_variable_counts(context, data);
+		valid = _validate_class(context, data);
+	}
+	if (!valid) {
+		// Nothing was applied yet, so the functions are only referenced from here.
+		for (GDScriptFunction *function : context.functions) {
+			memdelete(function);
+		}
+		return ERR_FILE_CORRUPT;
+	}
+
+	_apply_class(data);
+	for (const KeyValue<GDScriptFunction *, GDScript::LambdaInfo> &E : context.lambda_info) {
+		E.key->_script->lambda_info.insert(E.key, E.value);
+	}
+
+	if (keep_static) {
+		GDScriptCache::add_static_script(p_script);
+	}
+	return GDScriptCache::finish_compiling(p_script->path);
+}
+
+Error GDScriptBytecodeCache::load(GDScript *p_script) {
+	if (!is_enabled() || !p_script->is_root_script() || !_is_cacheable_path(p_script->path)) {
+		return ERR_UNAVAILABLE;
+	}
+
+	Vector<uint8_t> buffer = _read_cache_file(p_script->path);
+	if (buffer.is_empty()) {
+		return ERR_FILE_NOT_FOUND;
+	}
+
+	Error err = load_from_buffer(p_script, buffer);
+	if (err != OK) {
+		print_verbose(vformat(R"(GDScript: The bytecode cache of "%s" is out of date, compiling it again.)", p_script->path));
+	}
+	return err;
+}
+
+bool GDScriptBytecodeCache::make_scripts(GDScript *p_script) {
+	if (!is_enabled() || !p_script->is_root_script() || !_is_cacheable_path(p_script->path)) {
+		return false;
+	}
+
+	Vector<uint8_t> buffer = _read_cache_file(p_script->path);
+	if (buffer.is_empty()) {
+		return false;
+	}
+
+	Reader reader;
+	reader.data = buffer.ptr();
+	reader.size = buffer.size();
+	if (!_read_header(reader, p_script) || !_read_dependencies(reader)) {
+		return false;
+	}
+
+	// The script being shallow means nobody is using its inner classes yet, so they can be replaced.
+	StringName local_name = reader.get_string_name();
+	String fully_qualified_name = reader.get_string();
+	if (reader.failed) {
+		return false;
+	}
+	p_script->local_name = local_name;
+	p_script->fully_qualified_name = fully_qualified_name;
+	_read_shape(reader, p_script);
+	return !reader.failed;
+}
+
+void GDScriptBytecodeCache::finish() {
+	MutexLock lock(mutex);
+	if (pointer_names) {
+		memdelete(pointer_names);
+		pointer_names = nullptr;
+	}
+	file_hashes.clear();
+}
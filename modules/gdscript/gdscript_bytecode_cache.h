@@ -0,0 +1,126 @@
+/**************************************************************************/
+/*  gdscript_bytecode_cache.h                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_CACHE_H
+#define GDSCRIPT_BYTECODE_CACHE_H
+
+#include "core/os/mutex.h"
+#include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/vector.h"
+
+class GDScript;
+class GDScriptDataType;
+class GDScriptFunction;
+class GDScriptParser;
+class Variant;
+struct MethodInfo;
+struct PropertyInfo;
+
+// Keeps the compiled form of scripts (functions with their bytecode, constants and name tables, member and type
+// information) in user://, so later runs load them instead of tokenizing, parsing, analyzing and compiling again.
+// An entry is keyed by the engine build, the script source and the sources of every script it was analyzed against.
+// When the key doesn't match, or anything it refers to can't be found anymore (a native method, a resource), the
+// script is compiled from source like before and the entry is rewritten.
+// The checksum in the header only catches damage, it isn't a signature: the bytecode is checked against everything the
+// compiler guarantees before it's used, and games exported with an encryption key encrypt their entries with it too.
+// Only used by export templates without a debugger, editor builds always compile.
+class GDScriptBytecodeCache {
+	struct Writer;
+	struct Reader;
+	struct Context;
+	struct ClassData;
+	struct PointerNames;
+
+	static bool enabled;
+	static bool testing;
+	static Mutex mutex;
+	static HashMap<String, String> file_hashes;
+	static PointerNames *pointer_names;
+
+	static String _get_environment_key();
+	static Vector<uint8_t> _get_encryption_key();
+	static Vector<uint8_t> _read_cache_file(const String &p_script_path);
+	static bool _is_cacheable_path(const String &p_script_path);
+	static String _get_source_hash(const GDScript *p_script);
+	static String _get_file_hash(const String &p_path);
+	static void _collect_dependencies(GDScriptParser *p_parser, const String &p_script_path, HashMap<String, String> &r_dependencies);
+	static const PointerNames &_get_pointer_names();
+	static bool _is_pristine(const GDScript *p_script);
+
+	static void _write_shape(Writer &p_writer, const GDScript *p_script);
+	static bool _write_class(Writer &p_writer, const GDScript *p_script);
+	static bool _write_function(Writer &p_writer, const GDScriptFunction *p_function);
+	static bool _write_script_ref(Writer &p_writer, const GDScript *p_script);
+	static bool _write_data_type(Writer &p_writer, const GDScriptDataType &p_type);
+	static bool _write_property_info(Writer &p_writer, const PropertyInfo &p_info);
+	static bool _write_method_info(Writer &p_writer, const MethodInfo &p_info);
+	static bool _write_variant(Writer &p_writer, const Variant &p_value);
+
+	static bool _read_header(Reader &p_reader, const GDScript *p_script);
+	static bool _read_dependencies(Reader &p_reader);
+	static void _read_shape(Reader &p_reader, GDScript *p_script);
+	static bool _read_class(Reader &p_reader, Context &p_context, GDScript *p_script, ClassData &r_data);
+	static bool _read_function(Reader &p_reader, Context &p_context, GDScriptFunction *p_function);
+	static GDScript *_read_script_ref(Reader &p_reader, Context &p_context);
+	static bool _read_data_type(Reader &p_reader, Context &p_context, GDScriptDataType &r_type);
+	static bool _read_property_info(Reader &p_reader, PropertyInfo &r_info);
+	static bool _read_method_info(Reader &p_reader, Context &p_context, MethodInfo &r_info);
+	static bool _read_variant(Reader &p_reader, Context &p_context, Variant &r_value);
+	static bool _validate_function(const Context &p_context, const ClassData &p_class, const GDScriptFunction *p_function, bool p_has_instance, bool p_static_initializer);
+	static bool _validate_class(const Context &p_context, const ClassData &p_data);
+	static void _collect_static_variable_counts(Context &p_context, const ClassData &p_data);
+	static void _finish_function(GDScriptFunction *p_function);
+	static void _apply_class(ClassData &p_data);
+
+public:
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+	static void set_enabled(bool p_enabled) { enabled = p_enabled; }
+	static bool is_enabled();
+	// Editor builds never use the cache, tests turn this on to run it anyway.
+	static void set_testing(bool p_testing) { testing = p_testing; }
+
+	static String get_cache_path(const String &p_script_path);
+
+	// The buffer versions don't check whether the cache is enabled, nor touch the disk.
+	static Error save_to_buffer(const GDScript *p_script, const HashMap<String, String> &p_dependencies, Vector<uint8_t> &r_buffer);
+	static Error load_from_buffer(GDScript *p_script, const Vector<uint8_t> &p_buffer);
+
+	// Called by GDScript::reload() after compiling from source, and before parsing to try to skip it.
+	static void save(const GDScript *p_script, GDScriptParser &p_parser);
+	static Error load(GDScript *p_script);
+	// Creates the inner class scripts of a shallow script from its cache entry, instead of parsing it.
+	static bool make_scripts(GDScript *p_script);
+
+	static void finish();
+};
+
+#endif // GDSCRIPT_BYTECODE_CACHE_H
@@ -90,6 +90,7 @@ class GDScriptCache {
 	friend class GDScript;
 	friend class GDScriptParserRef;
 	friend class GDScriptInstance;
+	friend class GDScriptBytecodeCache;
 
 	static GDScriptCache *singleton;
 
@@ -33,6 +33,7 @@
 #include "gdscript.h"
 #include "gdscript_byte_codegen.h"
 #include "gdscript_cache.h"
+#include "gdscript_inline_cache.h"
 #include "gdscript_utility_functions.h"
 
 #include "core/config/engine.h"
@@ -3234,6 +3235,9 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 
 	ScriptLambdaInfo old_lambda_info = _get_script_lambda_replacement_info(p_script);
 
+	// Inline caches may point into the members and functions about to be replaced, both while and after compiling.
+	GDScriptInlineCache::invalidate();
+
 	// Create scripts for subclasses beforehand so they can be referenced
 	make_scripts(p_script, root, p_keep_state);
 
@@ -3241,10 +3245,12 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 	Error err = _prepare_compilation(main_script, parser->get_tree(), p_keep_state);
 
 	if (err) {
+		GDScriptInlineCache::invalidate();
 		return err;
 	}
 
 	err = _compile_class(main_script, root, p_keep_state);
+	GDScriptInlineCache::invalidate();
 	if (err) {
 		return err;
 	}
@@ -31,6 +31,8 @@
 #include "gdscript_function.h"
 
 #include "gdscript.h"
+#include "gdscript_inline_cache.h"
+#include "gdscript_sampling_profiler.h"
 
 Variant GDScriptFunction::get_constant(int p_idx) const {
 	ERR_FAIL_INDEX_V(p_idx, constants.size(), "<errconst>");
@@ -121,6 +123,10 @@ GDScriptFunction::~GDScriptFunction() {
 		memdelete(lambdas[i]);
 	}
 
+	if (_inline_caches_ptr) {
+		memdelete_arr(_inline_caches_ptr);
+	}
+
 	for (int i = 0; i < argument_types.size(); i++) {
 		argument_types.write[i].script_type_ref = Ref<Script>();
 	}
@@ -129,6 +135,7 @@ GDScriptFunction::~GDScriptFunction() {
 #ifdef DEBUG_ENABLED
 	MutexLock lock(GDScriptLanguage::get_singleton()->mutex);
 	GDScriptLanguage::get_singleton()->function_list.remove(&function_list);
+	GDScriptSamplingProfiler::function_freed(this);
 #endif
 }
 
@@ -238,7 +245,7 @@ Variant GDScriptFunctionState::resume(const Variant &p_arg) {
 		}
 
 #ifdef DEBUG_ENABLED
-		if (EngineDebugger::is_active()) {
+		if (state.call_stack_tracked) {
 			GDScriptLanguage::get_singleton()->exit_function();
 		}
 
@@ -42,6 +42,7 @@
 #include "core/variant/variant.h"
 
 class GDScriptInstance;
+class GDScriptInlineCache;
 class GDScript;
 
 class GDScriptDataType {
@@ -218,6 +219,8 @@ public:
 	enum Opcode {
 		OPCODE_OPERATOR,
 		OPCODE_OPERATOR_VALIDATED,
+		OPCODE_OPERATOR_VALIDATED_JUMP_IF,
+		OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT,
 		OPCODE_TYPE_TEST_BUILTIN,
 		OPCODE_TYPE_TEST_ARRAY,
 		OPCODE_TYPE_TEST_NATIVE,
@@ -225,9 +228,15 @@ public:
 		OPCODE_SET_KEYED,
 		OPCODE_SET_KEYED_VALIDATED,
 		OPCODE_SET_INDEXED_VALIDATED,
+		OPCODE_SET_INDEXED_PACKED_FLOAT32_ARRAY,
+		OPCODE_SET_INDEXED_PACKED_VECTOR2_ARRAY,
 		OPCODE_GET_KEYED,
 		OPCODE_GET_KEYED_VALIDATED,
 		OPCODE_GET_INDEXED_VALIDATED,
+		OPCODE_GET_INDEXED_PACKED_FLOAT32_ARRAY,
+		OPCODE_GET_INDEXED_PACKED_VECTOR2_ARRAY,
+		OPCODE_APPEND_PACKED_FLOAT32_ARRAY,
+		OPCODE_APPEND_PACKED_VECTOR2_ARRAY,
 		OPCODE_SET_NAMED,
 		OPCODE_SET_NAMED_VALIDATED,
 		OPCODE_GET_NAMED,
@@ -401,6 +410,7 @@ private:
 	friend class GDScript;
 	friend class GDScriptCompiler;
 	friend class GDScriptByteCodeGenerator;
+	friend class GDScriptBytecodeCache;
 	friend class GDScriptLanguage;
 
 	StringName name;
@@ -423,6 +433,8 @@ private:
 	List<StackDebug> stack_debug;
 
 	Vector<int> code;
+	// Where `code` holds indices into the global array, which only stay the same within a run.
+	Vector<int> global_index_positions;
 	Vector<int> default_arguments;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
@@ -457,6 +469,7 @@ private:
 	int _gds_utilities_count = 0;
 	int _methods_count = 0;
 	int _lambdas_count = 0;
+	int _inline_caches_count = 0;
 
 	int *_code_ptr = nullptr;
 	const int *_default_arg_ptr = nullptr;
@@ -475,6 +488,7 @@ private:
 	const GDScriptUtilityFunctions::FunctionPtr *_gds_utilities_ptr = nullptr;
 	MethodBind **_methods_ptr = nullptr;
 	GDScriptFunction **_lambdas_ptr = nullptr;
+	GDScriptInlineCache *_inline_caches_ptr = nullptr;
 
 #ifdef DEBUG_ENABLED
 	CharString func_cname;
@@ -521,6 +535,8 @@ public:
 #ifdef DEBUG_ENABLED
 		StringName function_name;
 		String script_path;
+		// Whether the resumed call was pushed on the call stack, so it is popped when it completes.
+		bool call_stack_tracked = false;
 #endif
 		Vector<uint8_t> stack;
 		int stack_size = 0;
@@ -0,0 +1,353 @@
+/**************************************************************************/
+/*  gdscript_inline_cache.cpp                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "gdscript_inline_cache.h"
+
+#include "gdscript.h"
+
+#include "core/config/engine.h"
+#include "core/object/class_db.h"
+#include "scene/scene_string_names.h"
+
+SafeNumeric<uint32_t> GDScriptInlineCache::epoch(1);
+
+bool GDScriptInlineCache::_get_receiver(Object *p_object, Receiver &r_receiver) {
+	ScriptInstance *script_instance = p_object->get_script_instance();
+	if (script_instance) {
+		// Other languages and placeholders get and call in their own ways.
+		if (script_instance->is_placeholder() || script_instance->get_language() != GDScriptLanguage::get_singleton()) {
+			return false;
+		}
+		r_receiver.instance = static_cast<GDScriptInstance *>(script_instance);
+		r_receiver.script = r_receiver.instance->script.ptr();
+	}
+
+	r_receiver.object = p_object;
+	r_receiver.class_key = p_object->get_class_name().data_unique_pointer();
+	r_receiver.epoch = epoch.get();
+	return true;
+}
+
+static bool _is_extension_class(const StringName &p_class) {
+	// Extension classes can be unloaded and reloaded, which frees their binds without any compile.
+	const ClassDB::APIType api = ClassDB::get_api_type(p_class);
+	return api == ClassDB::API_EXTENSION || api == ClassDB::API_EDITOR_EXTENSION;
+}
+
+// The resolvers follow GDScriptInstance::get()/set()/callp() and Object::get()/set()/callp(), and give up on anything
+// that isn't a plain member, script function or property/method bind.
+
+GDScriptInlineCache::Target GDScriptInlineCache::_resolve_get(const Receiver &p_receiver, const StringName &p_name) {
+	Target target;
+
+	const GDScript *script = p_receiver.script;
+	if (script) {
+		HashMap<StringName, GDScript::MemberInfo>::ConstIterator E = script->member_indices.find(p_name);
+		if (E) {
+			if (!(script->valid && E->value.getter)) {
+				target.kind = KIND_MEMBER;
+				target.member_index = E->value.index;
+			}
+			return target;
+		}
+
+		for (const GDScript *sptr = script; sptr; sptr = sptr->_base) {
+			if (sptr->constants.has(p_name) || sptr->static_variables_indices.has(p_name) || sptr->_signals.has(p_name) || sptr->subclasses.has(p_name)) {
+				return target;
+			}
+			if (sptr->valid && (sptr->member_functions.has(p_name) || sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._get))) {
+				return target;
+			}
+		}
+	}
+
+	const StringName &class_name = p_receiver.object->get_class_name();
+	if (_is_extension_class(class_name)) {
+		return target;
+	}
+
+	MethodBind *getter = ClassDB::get_property_getter_method(class_name, p_name);
+	if (getter) {
+		target.kind = KIND_NATIVE_METHOD;
+		target.target = getter;
+	}
+	return target;
+}
+
+GDScriptInlineCache::Target GDScriptInlineCache::_resolve_set(const Receiver &p_receiver, const StringName &p_name) {
+	Target target;
+
+#ifdef TOOLS_ENABLED
+	// Object::set() marks objects as edited, which the editor relies on.
+	if (Engine::get_singleton()->is_editor_hint()) {
+		return target;
+	}
+#endif
+
+	const GDScript *script = p_receiver.script;
+	if (script) {
+		HashMap<StringName, GDScript::MemberInfo>::ConstIterator E = script->member_indices.find(p_name);
+		if (E) {
+			if (!(script->valid && E->value.setter)) {
+				target.kind = KIND_MEMBER;
+				target.member_index = E->value.index;
+				// Values that need converting take the regular path.
+				target.member_type = E->value.data_type.has_type ? &E->value.data_type : nullptr;
+			}
+			return target;
+		}
+
+		for (const GDScript *sptr = script; sptr; sptr = sptr->_base) {
+			if (sptr->static_variables_indices.has(p_name) || (sptr->valid && sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._set))) {
+				return target;
+			}
+		}
+	}
+
+	const StringName &class_name = p_receiver.object->get_class_name();
+	if (_is_extension_class(class_name)) {
+		return target;
+	}
+
+	MethodBind *setter = ClassDB::get_property_setter_method(class_name, p_name);
+	if (setter) {
+		target.kind = KIND_NATIVE_METHOD;
+		target.target = setter;
+	}
+	return target;
+}
+
+GDScriptInlineCache::Target GDScriptInlineCache::_resolve_call(const Receiver &p_receiver, const StringName &p_name) {
+	Target target;
+
+	// Both do more than calling a function.
+	if (p_name == CoreStringName(free_) || p_name == SceneStringName(_ready)) {
+		return target;
+	}
+
+	for (const GDScript *sptr = p_receiver.script; sptr; sptr = sptr->_base) {
+		if (sptr->valid) {
+			HashMap<StringName, GDScriptFunction *>::ConstIterator E = sptr->member_functions.find(p_name);
+			if (E) {
+				target.kind = KIND_SCRIPT_FUNCTION;
+				target.target = E->value;
+				return target;
+			}
+		}
+	}
+
+	const StringName &class_name = p_receiver.object->get_class_name();
+	if (_is_extension_class(class_name)) {
+		return target;
+	}
+
+	MethodBind *method = ClassDB::get_method(class_name, p_name);
+	if (method) {
+		target.kind = KIND_NATIVE_METHOD;
+		target.target = method;
+	}
+	return target;
+}
+
+bool GDScriptInlineCache::_find(const Receiver &p_receiver, Target &r_target) const {
+	for (const Entry &entry : entries) {
+		const uint32_t seq_begin = entry.seq.load(std::memory_order_acquire);
+		if ((seq_begin & 1) != 0 || entry.epoch.load(std::memory_order_relaxed) != p_receiver.epoch) {
+			continue;
+		}
+		if (entry.class_key.load(std::memory_order_relaxed) != p_receiver.class_key || entry.script.load(std::memory_order_relaxed) != p_receiver.script) {
+			continue;
+		}
+
+		r_target.kind = Kind(entry.kind.load(std::memory_order_relaxed));
+		r_target.member_index = entry.member_index.load(std::memory_order_relaxed);
+		r_target.member_type = entry.member_type.load(std::memory_order_relaxed);
+		r_target.target = entry.target.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (entry.seq.load(std::memory_order_relaxed) == seq_begin) {
+			return true;
+		}
+		// Rewritten while reading, count it as a miss.
+	}
+	return false;
+}
+
+bool GDScriptInlineCache::_miss(const Receiver &p_receiver) {
+	if (misses_epoch.load(std::memory_order_relaxed) != p_receiver.epoch) {
+		misses_epoch.store(p_receiver.epoch, std::memory_order_relaxed);
+		misses.store(0, std::memory_order_relaxed);
+	}
+	return misses.fetch_add(1, std::memory_order_relaxed) < MEGAMORPHIC_MISSES;
+}
+
+void GDScriptInlineCache::_store(const Receiver &p_receiver, const Target &p_target) {
+	// Entries from before the last compile go first, then the oldest one.
+	int index = -1;
+	for (int i = 0; i < MAX_ENTRIES && index < 0; i++) {
+		if (entries[i].epoch.load(std::memory_order_relaxed) != p_receiver.epoch) {
+			index = i;
+		}
+	}
+	if (index < 0) {
+		index = next_entry.fetch_add(1, std::memory_order_relaxed) % MAX_ENTRIES;
+	}
+
+	Entry &entry = entries[index];
+	uint32_t seq = entry.seq.load(std::memory_order_relaxed);
+	// Another thread is filling this entry, let it.
+	if ((seq & 1) != 0 || !entry.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed)) {
+		return;
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+
+	entry.epoch.store(p_receiver.epoch, std::memory_order_relaxed);
+	entry.class_key.store(p_receiver.class_key, std::memory_order_relaxed);
+	entry.script.store(p_receiver.script, std::memory_order_relaxed);
+	entry.kind.store(p_target.kind, std::memory_order_relaxed);
+	entry.member_index.store(p_target.member_index, std::memory_order_relaxed);
+	entry.member_type.store(p_target.member_type, std::memory_order_relaxed);
+	entry.target.store(p_target.target, std::memory_order_relaxed);
+
+	entry.seq.store(seq + 2, std::memory_order_release);
+}
+
+Variant GDScriptInlineCache::_get_named_object(const Variant &p_base, const StringName &p_name, bool &r_valid) {
+	Receiver receiver;
+	Object *object = p_base.get_validated_object();
+	if (!object || !_get_receiver(object, receiver)) {
+		return p_base.get_named(p_name, r_valid);
+	}
+
+	Target target;
+	if (!_find(receiver, target)) {
+		if (!_miss(receiver)) {
+			return p_base.get_named(p_name, r_valid);
+		}
+		target = _resolve_get(receiver, p_name);
+		_store(receiver, target);
+	}
+
+	switch (target.kind) {
+		case KIND_MEMBER: {
+			// Instances catch up with a recompiled script after the compile is done.
+			if (likely(target.member_index < receiver.instance->members.size())) {
+				r_valid = true;
+				return receiver.instance->members[target.member_index];
+			}
+		} break;
+		case KIND_NATIVE_METHOD: {
+			Callable::CallError ce;
+			r_valid = true;
+			return static_cast<MethodBind *>(target.target)->call(object, nullptr, 0, ce);
+		}
+		default: {
+		} break;
+	}
+
+	return p_base.get_named(p_name, r_valid);
+}
+
+void GDScriptInlineCache::_set_named_object(Variant &p_base, const StringName &p_name, const Variant &p_value, bool &r_valid) {
+	Receiver receiver;
+	Object *object = p_base.get_validated_object();
+	if (!object || !_get_receiver(object, receiver)) {
+		p_base.set_named(p_name, p_value, r_valid);
+		return;
+	}
+
+	Target target;
+	if (!_find(receiver, target)) {
+		if (!_miss(receiver)) {
+			p_base.set_named(p_name, p_value, r_valid);
+			return;
+		}
+		target = _resolve_set(receiver, p_name);
+		_store(receiver, target);
+	}
+
+	switch (target.kind) {
+		case KIND_MEMBER: {
+			if (likely(target.member_index < receiver.instance->members.size()) && (!target.member_type || target.member_type->is_type(p_value))) {
+				receiver.instance->members.write[target.member_index] = p_value;
+				r_valid = true;
+				return;
+			}
+		} break;
+		case KIND_NATIVE_METHOD: {
+			const Variant *args[1] = { &p_value };
+			Callable::CallError ce;
+			static_cast<MethodBind *>(target.target)->call(object, args, 1, ce);
+			r_valid = ce.error == Callable::CallError::CALL_OK;
+			return;
+		}
+		default: {
+		} break;
+	}
+
+	p_base.set_named(p_name, p_value, r_valid);
+}
+
+void GDScriptInlineCache::_call_object(Variant &p_base, const StringName &p_name, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) {
+	Receiver receiver;
+	Object *object = p_base.get_validated_object();
+	if (!object || !_get_receiver(object, receiver)) {
+		p_base.callp(p_name, p_args, p_argcount, r_ret, r_error);
+		return;
+	}
+
+	Target target;
+	if (!_find(receiver, target)) {
+		if (!_miss(receiver)) {
+			p_base.callp(p_name, p_args, p_argcount, r_ret, r_error);
+			return;
+		}
+		target = _resolve_call(receiver, p_name);
+		_store(receiver, target);
+	}
+
+	// Like the other direct calls from the VM, these skip the debug lock Object::callp() takes.
+	switch (target.kind) {
+		case KIND_SCRIPT_FUNCTION: {
+			r_error.error = Callable::CallError::CALL_OK;
+			r_ret = static_cast<GDScriptFunction *>(target.target)->call(receiver.instance, p_args, p_argcount, r_error);
+			return;
+		}
+		case KIND_NATIVE_METHOD: {
+			r_error.error = Callable::CallError::CALL_OK;
+			r_ret = static_cast<MethodBind *>(target.target)->call(object, p_args, p_argcount, r_error);
+			return;
+		}
+		default: {
+		} break;
+	}
+
+	p_base.callp(p_name, p_args, p_argcount, r_ret, r_error);
+}
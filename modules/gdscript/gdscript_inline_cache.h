@@ -0,0 +1,138 @@
+/**************************************************************************/
+/*  gdscript_inline_cache.h                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef GDSCRIPT_INLINE_CACHE_H
+#define GDSCRIPT_INLINE_CACHE_H
+
+#include "core/templates/safe_refcount.h"
+#include "core/variant/variant.h"
+
+#include <atomic>
+
+class GDScript;
+class GDScriptDataType;
+class GDScriptInstance;
+
+// Cache attached to one untyped OPCODE_GET_NAMED, OPCODE_SET_NAMED or OPCODE_CALL site. It remembers what the name
+// resolved to for the last few receivers (native class plus script), so repeated accesses skip the ClassDB and
+// script member lookups. Anything it can't resolve to a member slot, a script function or a MethodBind goes through
+// Variant like before, as do non-object bases and sites that see too many different receivers.
+// Functions can run on several threads at once, so entries are seqlocked and any compile bumps the global epoch,
+// which makes every entry stale instead of tracking which ones point into the recompiled script.
+class GDScriptInlineCache {
+public:
+	enum Kind {
+		KIND_UNCACHEABLE,
+		KIND_MEMBER,
+		KIND_SCRIPT_FUNCTION,
+		KIND_NATIVE_METHOD,
+	};
+
+	static constexpr int MAX_ENTRIES = 4;
+	// Misses within one epoch after which the site gives up on caching.
+	static constexpr uint32_t MEGAMORPHIC_MISSES = 32;
+
+private:
+	struct Entry {
+		std::atomic<uint32_t> seq = { 0 };
+		std::atomic<uint32_t> epoch = { 0 };
+		std::atomic<const void *> class_key = { nullptr };
+		std::atomic<const GDScript *> script = { nullptr };
+		std::atomic<uint32_t> kind = { KIND_UNCACHEABLE };
+		std::atomic<int> member_index = { -1 };
+		std::atomic<const GDScriptDataType *> member_type = { nullptr };
+		// MethodBind or GDScriptFunction, depending on the kind.
+		std::atomic<void *> target = { nullptr };
+	};
+
+	struct Receiver {
+		Object *object = nullptr;
+		GDScriptInstance *instance = nullptr;
+		const GDScript *script = nullptr;
+		const void *class_key = nullptr;
+		uint32_t epoch = 0;
+	};
+
+	struct Target {
+		Kind kind = KIND_UNCACHEABLE;
+		int member_index = -1;
+		const GDScriptDataType *member_type = nullptr;
+		void *target = nullptr;
+	};
+
+	static SafeNumeric<uint32_t> epoch;
+
+	Entry entries[MAX_ENTRIES];
+	std::atomic<uint32_t> next_entry = { 0 };
+	std::atomic<uint32_t> misses = { 0 };
+	std::atomic<uint32_t> misses_epoch = { 0 };
+
+	static bool _get_receiver(Object *p_object, Receiver &r_receiver);
+	static Target _resolve_get(const Receiver &p_receiver, const StringName &p_name);
+	static Target _resolve_set(const Receiver &p_receiver, const StringName &p_name);
+	static Target _resolve_call(const Receiver &p_receiver, const StringName &p_name);
+
+	bool _find(const Receiver &p_receiver, Target &r_target) const;
+	bool _miss(const Receiver &p_receiver);
+	void _store(const Receiver &p_receiver, const Target &p_target);
+
+	Variant _get_named_object(const Variant &p_base, const StringName &p_name, bool &r_valid);
+	void _set_named_object(Variant &p_base, const StringName &p_name, const Variant &p_value, bool &r_valid);
+	void _call_object(Variant &p_base, const StringName &p_name, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error);
+
+public:
+	// Call whenever scripts get compiled or cleared, so no entry keeps pointing into them.
+	static void invalidate() { epoch.increment(); }
+
+	_FORCE_INLINE_ Variant get_named(const Variant &p_base, const StringName &p_name, bool &r_valid) {
+		if (p_base.get_type() != Variant::OBJECT) {
+			return p_base.get_named(p_name, r_valid);
+		}
+		return _get_named_object(p_base, p_name, r_valid);
+	}
+
+	_FORCE_INLINE_ void set_named(Variant &p_base, const StringName &p_name, const Variant &p_value, bool &r_valid) {
+		if (p_base.get_type() != Variant::OBJECT) {
+			p_base.set_named(p_name, p_value, r_valid);
+			return;
+		}
+		_set_named_object(p_base, p_name, p_value, r_valid);
+	}
+
+	_FORCE_INLINE_ void call(Variant &p_base, const StringName &p_name, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) {
+		if (p_base.get_type() != Variant::OBJECT) {
+			p_base.callp(p_name, p_args, p_argcount, r_ret, r_error);
+			return;
+		}
+		_call_object(p_base, p_name, p_args, p_argcount, r_ret, r_error);
+	}
+};
+
+#endif // GDSCRIPT_INLINE_CACHE_H
@@ -0,0 +1,241 @@
+/**************************************************************************/
+/*  gdscript_sampling_profiler.cpp                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "gdscript_sampling_profiler.h"
+
+#ifdef DEBUG_ENABLED
+
+#include "gdscript_function.h"
+
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "core/string/string_builder.h"
+
+Thread GDScriptSamplingProfiler::thread;
+SafeFlag GDScriptSamplingProfiler::running;
+const GDScriptLanguage::CallStack *GDScriptSamplingProfiler::target = nullptr;
+uint64_t GDScriptSamplingProfiler::interval_usec = 1000;
+uint64_t GDScriptSamplingProfiler::start_time = 0;
+Mutex GDScriptSamplingProfiler::mutex;
+LocalVector<GDScriptSamplingProfiler::StackNode> GDScriptSamplingProfiler::nodes;
+LocalVector<GDScriptSamplingProfiler::Sample> GDScriptSamplingProfiler::samples;
+HashMap<GDScriptFunction *, String> GDScriptSamplingProfiler::function_names;
+
+void GDScriptSamplingProfiler::_thread_func(void *p_userdata) {
+	while (running.is_set()) {
+		OS::get_singleton()->delay_usec(interval_usec);
+		_take_sample();
+	}
+}
+
+int GDScriptSamplingProfiler::_get_child(int p_node, GDScriptFunction *p_function) {
+	const int *child = nodes[p_node].children.getptr(p_function);
+	if (child) {
+		return *child;
+	}
+	StackNode node;
+	node.function = p_function;
+	node.parent = p_node;
+	nodes.push_back(node);
+	nodes[p_node].children.insert(p_function, nodes.size() - 1);
+	if (!function_names.has(p_function)) {
+		function_names.insert(p_function, String());
+	}
+	return nodes.size() - 1;
+}
+
+void GDScriptSamplingProfiler::_take_sample() {
+	// The sampled thread doesn't wait for this one. It only ever writes a level before counting it, and the levels
+	// outlive the thread's calls, so a torn read gives a wrong stack for one sample at worst.
+	const GDScriptLanguage::CallLevel *levels = target->levels;
+	const int depth = MIN(target->stack_pos, GDScriptLanguage::get_singleton()->_debug_max_call_stack);
+	const uint64_t time = OS::get_singleton()->get_ticks_usec() - start_time;
+
+	MutexLock lock(mutex);
+	int node = 0;
+	for (int i = 0; i < depth && levels; i++) {
+		if (levels[i].function) {
+			node = _get_child(node, levels[i].function);
+		}
+	}
+	nodes[node].samples++;
+	samples.push_back({ time, node });
+}
+
+String GDScriptSamplingProfiler::_get_function_name(GDScriptFunction *p_function) {
+	return p_function->get_script()->get_script_path() + ":" + p_function->get_name();
+}
+
+void GDScriptSamplingProfiler::_resolve_function_names() {
+	// Only functions still in the list are alive, the others were named when they were freed.
+	MutexLock language_lock(GDScriptLanguage::get_singleton()->mutex);
+	MutexLock lock(mutex);
+	for (SelfList<GDScriptFunction> *E = GDScriptLanguage::get_singleton()->function_list.first(); E; E = E->next()) {
+		String *name = function_names.getptr(E->self());
+		if (name && name->is_empty()) {
+			*name = _get_function_name(E->self());
+		}
+	}
+}
+
+String GDScriptSamplingProfiler::_get_frame_name(int p_node) {
+	const String *name = function_names.getptr(nodes[p_node].function);
+	return name && !name->is_empty() ? *name : String("<unknown>");
+}
+
+Error GDScriptSamplingProfiler::start(uint64_t p_interval_usec) {
+	ERR_FAIL_COND_V_MSG(running.is_set(), ERR_ALREADY_IN_USE, "The GDScript sampling profiler is already running.");
+	ERR_FAIL_COND_V(p_interval_usec == 0, ERR_INVALID_PARAMETER);
+
+	clear();
+	target = &GDScriptLanguage::_call_stack;
+	interval_usec = p_interval_usec;
+	start_time = OS::get_singleton()->get_ticks_usec();
+	GDScriptLanguage::get_singleton()->call_stack_sampled.set();
+	running.set();
+	thread.start(_thread_func, nullptr);
+	return OK;
+}
+
+void GDScriptSamplingProfiler::stop() {
+	if (!running.is_set()) {
+		return;
+	}
+	running.clear();
+	thread.wait_to_finish();
+	GDScriptLanguage::get_singleton()->call_stack_sampled.clear();
+	_resolve_function_names();
+}
+
+void GDScriptSamplingProfiler::clear() {
+	MutexLock lock(mutex);
+	nodes.clear();
+	nodes.push_back(StackNode());
+	samples.clear();
+	function_names.clear();
+}
+
+int GDScriptSamplingProfiler::get_sample_count() {
+	MutexLock lock(mutex);
+	return samples.size();
+}
+
+String GDScriptSamplingProfiler::get_collapsed_stacks() {
+	_resolve_function_names();
+
+	MutexLock lock(mutex);
+	StringBuilder sb;
+	for (uint32_t i = 1; i < nodes.size(); i++) {
+		if (nodes[i].samples == 0) {
+			continue;
+		}
+		String stack = _get_frame_name(i);
+		for (int parent = nodes[i].parent; parent > 0; parent = nodes[parent].parent) {
+			stack = _get_frame_name(parent) + ";" + stack;
+		}
+		sb.append(stack);
+		sb.append(" ");
+		sb.append(itos(nodes[i].samples));
+		sb.append("\n");
+	}
+	return sb.as_string();
+}
+
+String GDScriptSamplingProfiler::get_chrome_trace() {
+	_resolve_function_names();
+
+	MutexLock lock(mutex);
+	StringBuilder sb;
+	sb.append("{\"traceEvents\":[");
+	bool first = true;
+
+	// The calls open at the previous sample, outermost first, with the time they were first seen.
+	LocalVector<int> open_nodes;
+	LocalVector<uint64_t> open_times;
+	LocalVector<int> path;
+	for (uint32_t i = 0; i <= samples.size(); i++) {
+		// One past the last sample closes everything, an interval after it.
+		const bool last = i == samples.size();
+		const uint64_t time = last ? (samples.is_empty() ? 0 : samples[samples.size() - 1].time + interval_usec) : samples[i].time;
+		path.clear();
+		for (int node = last ? 0 : samples[i].node; node > 0; node = nodes[node].parent) {
+			path.push_back(node);
+		}
+		path.invert();
+
+		uint32_t common = 0;
+		while (common < open_nodes.size() && common < path.size() && open_nodes[common] == path[common]) {
+			common++;
+		}
+		while (open_nodes.size() > common) {
+			const uint32_t level = open_nodes.size() - 1;
+			if (!first) {
+				sb.append(",");
+			}
+			first = false;
+			sb.append("{\"name\":\"");
+			sb.append(_get_frame_name(open_nodes[level]).json_escape());
+			sb.append("\",\"cat\":\"gdscript\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":");
+			sb.append(itos(open_times[level]));
+			sb.append(",\"dur\":");
+			sb.append(itos(time - open_times[level]));
+			sb.append("}");
+			open_nodes.resize(level);
+			open_times.resize(level);
+		}
+		for (uint32_t j = common; j < path.size(); j++) {
+			open_nodes.push_back(path[j]);
+			open_times.push_back(time);
+		}
+	}
+
+	sb.append("],\"displayTimeUnit\":\"ms\"}\n");
+	return sb.as_string();
+}
+
+Error GDScriptSamplingProfiler::save(const String &p_path, Format p_format) {
+	const String contents = p_format == FORMAT_CHROME_TRACE ? get_chrome_trace() : get_collapsed_stacks();
+	Error err;
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, vformat("Can't write the GDScript profile to \"%s\".", p_path));
+	file->store_string(contents);
+	return OK;
+}
+
+void GDScriptSamplingProfiler::function_freed(GDScriptFunction *p_function) {
+	// The language mutex is held by the caller, which is the order _resolve_function_names() locks in.
+	MutexLock lock(mutex);
+	String *name = function_names.getptr(p_function);
+	if (name && name->is_empty()) {
+		*name = _get_function_name(p_function);
+	}
+}
+
+#endif // DEBUG_ENABLED
@@ -0,0 +1,111 @@
+/**************************************************************************/
+/*  gdscript_sampling_profiler.h                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef GDSCRIPT_SAMPLING_PROFILER_H
+#define GDSCRIPT_SAMPLING_PROFILER_H
+
+#ifdef DEBUG_ENABLED
+
+#include "gdscript.h"
+
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/string/ustring.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+
+// Samples the GDScript call stack of one thread from a timer thread, instead of timing every call like
+// GDScriptFunction::Profile does. The sampled thread only keeps its call stack up to date, like it does with a
+// debugger attached, so a profiled session runs close to normal speed.
+// Samples are aggregated by stack, and are exported as collapsed stacks (for flame graph tools) or as a Chrome trace
+// (for chrome://tracing or Perfetto). Only debug builds keep the call stack, so release builds can't be sampled.
+class GDScriptSamplingProfiler {
+public:
+	enum Format {
+		FORMAT_COLLAPSED,
+		FORMAT_CHROME_TRACE,
+	};
+
+private:
+	// Every distinct stack is a path in this tree, so a sample only stores the node of its innermost call.
+	struct StackNode {
+		GDScriptFunction *function = nullptr;
+		int parent = -1;
+		uint32_t samples = 0;
+		HashMap<GDScriptFunction *, int> children;
+	};
+
+	struct Sample {
+		uint64_t time = 0;
+		int node = 0;
+	};
+
+	static Thread thread;
+	static SafeFlag running;
+	static const GDScriptLanguage::CallStack *target;
+	static uint64_t interval_usec;
+	static uint64_t start_time;
+
+	// Guards the results against the timer thread. Lock the language mutex first when both are needed.
+	static Mutex mutex;
+	static LocalVector<StackNode> nodes;
+	static LocalVector<Sample> samples;
+	// Every sampled function, named on the calling thread or when freed. The timer thread never dereferences them.
+	static HashMap<GDScriptFunction *, String> function_names;
+
+	static void _thread_func(void *p_userdata);
+	static void _take_sample();
+	static int _get_child(int p_node, GDScriptFunction *p_function);
+	static String _get_function_name(GDScriptFunction *p_function);
+	static void _resolve_function_names();
+	static String _get_frame_name(int p_node);
+
+public:
+	// Samples the call stack of the calling thread, every p_interval_usec microseconds.
+	static Error start(uint64_t p_interval_usec = 1000);
+	static void stop();
+	static bool is_running() { return running.is_set(); }
+	static void clear();
+
+	static int get_sample_count();
+	// One line per stack, outermost call first: "res://a.gd:_process;res://b.gd:update 42".
+	static String get_collapsed_stacks();
+	// A JSON trace with one complete event per call, merged over consecutive samples.
+	static String get_chrome_trace();
+	static Error save(const String &p_path, Format p_format);
+
+	// Called by GDScriptFunction before it is freed, so samples in it keep their name.
+	static void function_freed(GDScriptFunction *p_function);
+};
+
+#endif // DEBUG_ENABLED
+
+#endif // GDSCRIPT_SAMPLING_PROFILER_H
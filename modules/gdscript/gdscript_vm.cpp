@@ -30,6 +30,7 @@
 
 #include "gdscript.h"
 #include "gdscript_function.h"
+#include "gdscript_inline_cache.h"
 #include "gdscript_lambda_callable.h"
 
 #include "core/os/os.h"
@@ -215,6 +216,8 @@ void (*type_init_function_table[])(Variant *) = {
 	static const void *switch_table_ops[] = {            \
 		&&OPCODE_OPERATOR,                               \
 		&&OPCODE_OPERATOR_VALIDATED,                     \
+		&&OPCODE_OPERATOR_VALIDATED_JUMP_IF,             \
+		&&OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT,         \
 		&&OPCODE_TYPE_TEST_BUILTIN,                      \
 		&&OPCODE_TYPE_TEST_ARRAY,                        \
 		&&OPCODE_TYPE_TEST_NATIVE,                       \
@@ -222,9 +225,15 @@ void (*type_init_function_table[])(Variant *) = {
 		&&OPCODE_SET_KEYED,                              \
 		&&OPCODE_SET_KEYED_VALIDATED,                    \
 		&&OPCODE_SET_INDEXED_VALIDATED,                  \
+		&&OPCODE_SET_INDEXED_PACKED_FLOAT32_ARRAY,       \
+		&&OPCODE_SET_INDEXED_PACKED_VECTOR2_ARRAY,       \
 		&&OPCODE_GET_KEYED,                              \
 		&&OPCODE_GET_KEYED_VALIDATED,                    \
 		&&OPCODE_GET_INDEXED_VALIDATED,                  \
+		&&OPCODE_GET_INDEXED_PACKED_FLOAT32_ARRAY,       \
+		&&OPCODE_GET_INDEXED_PACKED_VECTOR2_ARRAY,       \
+		&&OPCODE_APPEND_PACKED_FLOAT32_ARRAY,            \
+		&&OPCODE_APPEND_PACKED_VECTOR2_ARRAY,            \
 		&&OPCODE_SET_NAMED,                              \
 		&&OPCODE_SET_NAMED_VALIDATED,                    \
 		&&OPCODE_GET_NAMED,                              \
@@ -599,9 +608,14 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #ifdef DEBUG_ENABLED
 
-	if (EngineDebugger::is_active()) {
+	// Decided once per call, so the sampling profiler starting or stopping midway doesn't unbalance the stack.
+	const bool call_stack_tracked = GDScriptLanguage::get_singleton()->is_call_stack_tracked();
+	if (call_stack_tracked) {
 		GDScriptLanguage::get_singleton()->enter_function(p_instance, this, stack, &ip, &line);
 	}
+	if (p_state) {
+		p_state->call_stack_tracked = call_stack_tracked;
+	}
 
 #define GD_ERR_BREAK(m_cond)                                                                                           \
 	{                                                                                                                  \
@@ -792,6 +806,52 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_VALIDATED_JUMP_IF) {
+				CHECK_SPACE(6);
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_VARIANT_PTR(a, 0);
+				GET_VARIANT_PTR(b, 1);
+				GET_VARIANT_PTR(dst, 2);
+
+				operator_func(a, b, dst);
+
+				if (dst->booleanize()) {
+					int to = _code_ptr[ip + 5];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 6;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT) {
+				CHECK_SPACE(6);
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_VARIANT_PTR(a, 0);
+				GET_VARIANT_PTR(b, 1);
+				GET_VARIANT_PTR(dst, 2);
+
+				operator_func(a, b, dst);
+
+				if (!dst->booleanize()) {
+					int to = _code_ptr[ip + 5];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 6;
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_TYPE_TEST_BUILTIN) {
 				CHECK_SPACE(4);
 
@@ -1105,8 +1165,78 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			// Typed packed arrays index their storage directly, without going through the indexed setters and getters.
+			// Writes still go through ptrw(), which only copies when the array is shared.
+#define OPCODE_SET_INDEXED_PACKED_ARRAY(m_var_type, m_elem_type, m_get_func, m_value_get_func)                \
+	OPCODE(OPCODE_SET_INDEXED_PACKED_##m_var_type##_ARRAY) {                                                  \
+		CHECK_SPACE(4);                                                                                       \
+		GET_VARIANT_PTR(dst, 0);                                                                              \
+		GET_VARIANT_PTR(index, 1);                                                                            \
+		GET_VARIANT_PTR(value, 2);                                                                            \
+		Vector<m_elem_type> *array = VariantInternal::m_get_func(dst);                                        \
+		int64_t int_index = *VariantInternal::get_int(index);                                                 \
+		if (int_index < 0) {                                                                                  \
+			int_index += array->size();                                                                       \
+		}                                                                                                     \
+		const bool oob = int_index < 0 || int_index >= array->size();                                         \
+		OPCODE_PACKED_ARRAY_OOB_CHECK("set", dst);                                                            \
+		if (likely(!oob)) {                                                                                   \
+			array->ptrw()[int_index] = *VariantInternal::m_value_get_func(value);                             \
+		}                                                                                                     \
+		ip += 4;                                                                                              \
+	}                                                                                                         \
+	DISPATCH_OPCODE
+
+#define OPCODE_GET_INDEXED_PACKED_ARRAY(m_var_type, m_elem_type, m_get_func, m_ret_type, m_ret_get_func)      \
+	OPCODE(OPCODE_GET_INDEXED_PACKED_##m_var_type##_ARRAY) {                                                  \
+		CHECK_SPACE(4);                                                                                       \
+		GET_VARIANT_PTR(src, 0);                                                                              \
+		GET_VARIANT_PTR(index, 1);                                                                            \
+		GET_VARIANT_PTR(dst, 2);                                                                              \
+		const Vector<m_elem_type> *array = VariantInternal::m_get_func(src);                                  \
+		int64_t int_index = *VariantInternal::get_int(index);                                                 \
+		if (int_index < 0) {                                                                                  \
+			int_index += array->size();                                                                       \
+		}                                                                                                     \
+		const bool oob = int_index < 0 || int_index >= array->size();                                         \
+		OPCODE_PACKED_ARRAY_OOB_CHECK("get", src);                                                            \
+		if (likely(!oob)) {                                                                                   \
+			VariantTypeAdjust<m_ret_type>::adjust(dst);                                                       \
+			*VariantInternal::m_ret_get_func(dst) = array->ptr()[int_index];                                  \
+		}                                                                                                     \
+		ip += 4;                                                                                              \
+	}                                                                                                         \
+	DISPATCH_OPCODE
+
+#define OPCODE_APPEND_PACKED_ARRAY(m_var_type, m_elem_type, m_get_func, m_value_get_func)                     \
+	OPCODE(OPCODE_APPEND_PACKED_##m_var_type##_ARRAY) {                                                       \
+		CHECK_SPACE(3);                                                                                       \
+		GET_VARIANT_PTR(dst, 0);                                                                              \
+		GET_VARIANT_PTR(value, 1);                                                                            \
+		VariantInternal::m_get_func(dst)->push_back(*VariantInternal::m_value_get_func(value));               \
+		ip += 3;                                                                                              \
+	}                                                                                                         \
+	DISPATCH_OPCODE
+
+#ifdef DEBUG_ENABLED
+#define OPCODE_PACKED_ARRAY_OOB_CHECK(m_access, m_base)                                                                            \
+	if (oob) {                                                                                                                     \
+		err_text = "Out of bounds " m_access " index '" + index->operator String() + "' (on base: '" + _get_var_type(m_base) + "')"; \
+		OPCODE_BREAK;                                                                                                              \
+	}
+#else
+#define OPCODE_PACKED_ARRAY_OOB_CHECK(m_access, m_base)
+#endif
+
+			OPCODE_SET_INDEXED_PACKED_ARRAY(FLOAT32, float, get_float32_array, get_float);
+			OPCODE_SET_INDEXED_PACKED_ARRAY(VECTOR2, Vector2, get_vector2_array, get_vector2);
+			OPCODE_GET_INDEXED_PACKED_ARRAY(FLOAT32, float, get_float32_array, double, get_float);
+			OPCODE_GET_INDEXED_PACKED_ARRAY(VECTOR2, Vector2, get_vector2_array, Vector2, get_vector2);
+			OPCODE_APPEND_PACKED_ARRAY(FLOAT32, float, get_float32_array, get_float);
+			OPCODE_APPEND_PACKED_ARRAY(VECTOR2, Vector2, get_vector2_array, get_vector2);
+
 			OPCODE(OPCODE_SET_NAMED) {
-				CHECK_SPACE(3);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(dst, 0);
 				GET_VARIANT_PTR(value, 1);
@@ -1116,8 +1246,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+
 				bool valid;
-				dst->set_named(*index, *value, valid);
+				_inline_caches_ptr[cache_idx].set_named(*dst, *index, *value, valid);
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -1138,7 +1271,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1158,7 +1291,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(src, 0);
 				GET_VARIANT_PTR(dst, 1);
@@ -1168,13 +1301,17 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+				GDScriptInlineCache &cache = _inline_caches_ptr[cache_idx];
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
-				Variant ret = src->get_named(*index, valid);
+				Variant ret = cache.get_named(*src, *index, valid);
 
 #else
-				*dst = src->get_named(*index, valid);
+				*dst = cache.get_named(*src, *index, valid);
 #endif
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -1183,7 +1320,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1719,7 +1856,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				bool call_async = (_code_ptr[ip]) == OPCODE_CALL_ASYNC;
 #endif
 				LOAD_INSTRUCTION_ARGS
-				CHECK_SPACE(3 + instr_arg_count);
+				CHECK_SPACE(4 + instr_arg_count);
 
 				ip += instr_arg_count;
 
@@ -1730,6 +1867,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(methodname_idx < 0 || methodname_idx >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[methodname_idx];
 
+				int cache_idx = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+				GDScriptInlineCache &cache = _inline_caches_ptr[cache_idx];
+
 				GET_INSTRUCTION_ARG(base, argc);
 				Variant **argptrs = instruction_args;
 
@@ -1747,7 +1888,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Callable::CallError err;
 				if (call_ret) {
 					GET_INSTRUCTION_ARG(ret, argc + 1);
-					base->callp(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					cache.call(*base, *methodname, (const Variant **)argptrs, argc, *ret, err);
 #ifdef DEBUG_ENABLED
 					if (ret->get_type() == Variant::NIL) {
 						if (base_type == Variant::OBJECT) {
@@ -1777,7 +1918,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 				} else {
 					Variant ret;
-					base->callp(*methodname, (const Variant **)argptrs, argc, ret, err);
+					cache.call(*base, *methodname, (const Variant **)argptrs, argc, ret, err);
 				}
 #ifdef DEBUG_ENABLED
 
@@ -1827,7 +1968,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
-				ip += 3;
+				ip += 4;
 			}
 			DISPATCH_OPCODE;
 
@@ -3688,7 +3829,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	// If that is the case then we exit the function as normal. Otherwise we postpone it until the last `await` is completed.
 	// This ensures the call stack can be properly shown when using `await`, showing what resumed the function.
 	if (!p_state || awaited) {
-		if (EngineDebugger::is_active()) {
+		if (call_stack_tracked) {
 			GDScriptLanguage::get_singleton()->exit_function();
 		}
 #endif
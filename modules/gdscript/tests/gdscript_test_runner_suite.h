@@ -33,7 +33,18 @@
 
 #include "gdscript_test_runner.h"
 
+#include "../gdscript_byte_codegen.h"
+#include "../gdscript_bytecode_cache.h"
+#include "../gdscript_sampling_profiler.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/io/marshalls.h"
+#include "core/os/os.h"
+
 #include "tests/test_macros.h"
+#include "tests/test_utils.h"
 
 namespace GDScriptTests {
 
@@ -70,6 +81,401 @@ func _init():
 	ref_counted->set_script(gdscript);
 	CHECK_MESSAGE(int(ref_counted->get_meta("result")) == 42, "The script should assign object metadata successfully.");
 }
+
+TEST_CASE("[Modules][GDScript] Compiled bytecode round-trips through the cache") {
+	const String path = "res://bytecode_cache_test.gd";
+	const String source = R"(
+extends RefCounted
+
+const WORDS: Array[String] = ["first", "second"]
+
+class Inner:
+	var scale := 3
+
+	func apply(value: int) -> int:
+		return value * scale
+
+func compute() -> String:
+	var inner := Inner.new()
+	var position := Vector2(1, 2) * 2.0
+	var add := func(a: int, b: int) -> int: return a + b
+	return "%s %d %d %s %d" % [WORDS[1].to_upper(), inner.apply(add.call(1, 2)), absi(-4), position, len(WORDS)]
+)";
+
+	Ref<GDScript> compiled = memnew(GDScript);
+	compiled->set_source_code(source);
+	compiled->set_path(path, true);
+	ERR_PRINT_OFF;
+	const Error error = compiled->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should compile successfully.");
+
+	Vector<uint8_t> buffer;
+	REQUIRE_MESSAGE(GDScriptBytecodeCache::save_to_buffer(compiled.ptr(), HashMap<String, String>(), buffer) == OK, "The compiled script should be cacheable.");
+
+	Ref<GDScript> cached = memnew(GDScript);
+	cached->set_source_code(source);
+	cached->set_path(path, true);
+	REQUIRE_MESSAGE(GDScriptBytecodeCache::load_from_buffer(cached.ptr(), buffer) == OK, "The cached script should load without compiling.");
+	CHECK(cached->is_valid());
+	CHECK(cached->get_subclasses().has("Inner"));
+
+	Ref<RefCounted> compiled_object = memnew(RefCounted);
+	compiled_object->set_script(compiled);
+	Ref<RefCounted> cached_object = memnew(RefCounted);
+	cached_object->set_script(cached);
+	const String expected = compiled_object->call("compute");
+	CHECK(expected == "SECOND 9 4 (2, 4) 2");
+	CHECK_MESSAGE(String(cached_object->call("compute")) == expected, "The cached script should run like the compiled one.");
+
+	Ref<GDScript> changed = memnew(GDScript);
+	changed->set_source_code(source + "\n# Changed.\n");
+	changed->set_path(path, true);
+	CHECK_MESSAGE(GDScriptBytecodeCache::load_from_buffer(changed.ptr(), buffer) != OK, "A cache entry for different source should be rejected.");
+	CHECK_FALSE(changed->is_valid());
+}
+
+// Points the header checksum at a payload that was changed after saving.
+static void update_bytecode_cache_checksum(Vector<uint8_t> &r_buffer) {
+	// "GDBC", format version, environment key, payload size and checksum.
+	const int header_size = 8 + 4 + decode_uint32(r_buffer.ptr() + 8) + 8;
+	encode_uint32(hash_murmur3_buffer(r_buffer.ptr() + header_size, r_buffer.size() - header_size), r_buffer.ptrw() + header_size - 4);
+}
+
+// Finds the code of a function in a cache entry by the line, argument count and stack size in front of it.
+static int find_cached_code(const Vector<uint8_t> &p_buffer, int p_line, const GDScriptFunction *p_function, int &r_code_size, int &r_stack_size_offset) {
+	for (int i = 0; i + 20 <= p_buffer.size(); i++) {
+		const uint8_t *data = p_buffer.ptr() + i;
+		if (int(decode_uint32(data)) != p_line || int(decode_uint32(data + 4)) != p_function->get_argument_count() || int(decode_uint32(data + 8)) != p_function->get_max_stack_size()) {
+			continue;
+		}
+		// Instruction arguments size and the temporaries, each a slot and a type.
+		const int code_size_offset = i + 16 + 4 + 8 * decode_uint32(data + 16);
+		r_code_size = decode_uint32(p_buffer.ptr() + code_size_offset);
+		r_stack_size_offset = i + 8;
+		return code_size_offset + 4;
+	}
+	return -1;
+}
+
+TEST_CASE("[Modules][GDScript] Cached bytecode is checked before it runs") {
+	const String path = "res://bytecode_cache_check_test.gd";
+	const String source = R"(
+extends RefCounted
+
+func target(a: int, b: int) -> int:
+	var values := [a, b]
+	var total := 0
+	for value in values:
+		total += value * 2
+	if total > 10:
+		total -= len(values)
+	return total + Vector2i(a, b).x
+)";
+
+	Ref<GDScript> compiled = memnew(GDScript);
+	compiled->set_source_code(source);
+	compiled->set_path(path, true);
+	ERR_PRINT_OFF;
+	const Error error = compiled->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should compile successfully.");
+
+	Vector<uint8_t> buffer;
+	REQUIRE(GDScriptBytecodeCache::save_to_buffer(compiled.ptr(), HashMap<String, String>(), buffer) == OK);
+	const int line = source.split("\n").find("func target(a: int, b: int) -> int:") + 1;
+	int code_size = 0;
+	int stack_size_offset = 0;
+	const int code_offset = find_cached_code(buffer, line, compiled->get_member_functions()["target"], code_size, stack_size_offset);
+	REQUIRE(code_offset >= 0);
+
+	// Point every word of the code far out of bounds in turn, with a checksum that matches. Only line numbers can
+	// take any value, which are at most half of the code, everything else has to be rejected.
+	int rejected = 0;
+	for (int i = 0; i < code_size; i++) {
+		Vector<uint8_t> changed = buffer;
+		encode_uint32(GDScriptFunction::ADDR_MASK, changed.ptrw() + code_offset + i * 4);
+		update_bytecode_cache_checksum(changed);
+
+		Ref<GDScript> cached = memnew(GDScript);
+		cached->set_source_code(source);
+		cached->set_path(path, true);
+		if (GDScriptBytecodeCache::load_from_buffer(cached.ptr(), changed) != OK) {
+			rejected++;
+			CHECK_FALSE(cached->is_valid());
+			continue;
+		}
+		Ref<RefCounted> object = memnew(RefCounted);
+		object->set_script(cached);
+		CHECK_MESSAGE(int(object->call("target", 3, 4)) == 15, "Cached code that is accepted should run like the compiled one.");
+	}
+	CHECK_MESSAGE(rejected > code_size / 2, "Cached code that doesn't hold up should be rejected.");
+
+	// A stack too small for the arguments.
+	Vector<uint8_t> changed = buffer;
+	encode_uint32(GDScriptFunction::FIXED_ADDRESSES_MAX, changed.ptrw() + stack_size_offset);
+	update_bytecode_cache_checksum(changed);
+	Ref<GDScript> cached = memnew(GDScript);
+	cached->set_source_code(source);
+	cached->set_path(path, true);
+	CHECK(GDScriptBytecodeCache::load_from_buffer(cached.ptr(), changed) != OK);
+}
+
+// Turns the bytecode cache on for the editor build the tests run in, and back off when done.
+struct BytecodeCacheEnabler {
+	BytecodeCacheEnabler() {
+		GDScriptBytecodeCache::set_testing(true);
+		GDScriptBytecodeCache::set_enabled(true);
+	}
+	~BytecodeCacheEnabler() {
+		GDScriptBytecodeCache::set_enabled(false);
+		GDScriptBytecodeCache::set_testing(false);
+		GDScriptBytecodeCache::finish();
+	}
+};
+
+static void write_script_file(const String &p_path, const String &p_source) {
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(file.is_valid());
+	file->store_string(p_source);
+}
+
+static Ref<GDScript> open_script_file(const String &p_path) {
+	Ref<GDScript> script = memnew(GDScript);
+	script->set_path(p_path, true);
+	REQUIRE(script->load_source_code(p_path) == OK);
+	return script;
+}
+
+TEST_CASE("[Modules][GDScript] Bytecode cache entries on disk") {
+	BytecodeCacheEnabler enabler;
+	const String dependency_path = TestUtils::get_temp_path("bytecode_cache_dependency.gd");
+	const String script_path = TestUtils::get_temp_path("bytecode_cache_script.gd");
+	write_script_file(dependency_path, "extends RefCounted\n\nstatic func value() -> int:\n\treturn 20\n");
+	write_script_file(script_path, R"(extends RefCounted
+
+const Dependency = preload("bytecode_cache_dependency.gd")
+
+class Inner:
+	func twice(value: int) -> int:
+		return value * 2
+
+func compute() -> int:
+	return Inner.new().twice(Dependency.value()) + 2
+)");
+	const String cache_path = GDScriptBytecodeCache::get_cache_path(script_path);
+	DirAccess::remove_absolute(cache_path);
+	GDScriptBytecodeCache::finish();
+
+	// Compiling the script writes its entry, without leaving the temporary file behind.
+	Ref<GDScript> compiled = open_script_file(script_path);
+	ERR_PRINT_OFF;
+	const Error error = compiled->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should compile successfully.");
+	REQUIRE(FileAccess::exists(cache_path));
+	for (const String &file : DirAccess::get_files_at(cache_path.get_base_dir())) {
+		CHECK_FALSE(file.ends_with(".tmp"));
+	}
+
+	// The next run loads it instead of compiling.
+	Ref<GDScript> cached = open_script_file(script_path);
+	REQUIRE_MESSAGE(GDScriptBytecodeCache::load(cached.ptr()) == OK, "The cache entry should load without compiling.");
+	CHECK(cached->is_valid());
+	CHECK(cached->get_subclasses().has("Inner"));
+	Ref<RefCounted> object = memnew(RefCounted);
+	object->set_script(cached);
+	CHECK(int(object->call("compute")) == 42);
+
+	// Shallow scripts get their inner classes from it without parsing.
+	Ref<GDScript> shallow = open_script_file(script_path);
+	CHECK(GDScriptBytecodeCache::make_scripts(shallow.ptr()));
+	CHECK(shallow->get_subclasses().has("Inner"));
+	CHECK_FALSE(shallow->is_valid());
+
+	// Changing a dependency makes the entry out of date. File hashes are kept until the cache finishes, like a
+	// new run would start.
+	write_script_file(dependency_path, "extends RefCounted\n\nstatic func value() -> int:\n\treturn 30\n");
+	GDScriptBytecodeCache::finish();
+	Ref<GDScript> outdated = open_script_file(script_path);
+	CHECK_FALSE(GDScriptBytecodeCache::make_scripts(outdated.ptr()));
+	CHECK(GDScriptBytecodeCache::load(outdated.ptr()) == ERR_FILE_UNRECOGNIZED);
+	CHECK_FALSE(outdated->is_valid());
+
+	// Compiling again writes an entry for the changed dependency.
+	ERR_PRINT_OFF;
+	const Error recompile_error = outdated->reload();
+	ERR_PRINT_ON;
+	CHECK(recompile_error == OK);
+	Ref<GDScript> updated = open_script_file(script_path);
+	CHECK(GDScriptBytecodeCache::load(updated.ptr()) == OK);
+
+	DirAccess::remove_absolute(cache_path);
+	DirAccess::remove_absolute(GDScriptBytecodeCache::get_cache_path(dependency_path));
+	DirAccess::remove_absolute(script_path);
+	DirAccess::remove_absolute(dependency_path);
+}
+
+static int64_t run_with_optimizations(const String &p_source, bool p_optimize, int64_t p_count, uint64_t *r_run_usec = nullptr) {
+	const bool was_enabled = GDScriptByteCodeGenerator::is_optimizations_enabled();
+	GDScriptByteCodeGenerator::set_optimizations_enabled(p_optimize);
+	Ref<GDScript> script = memnew(GDScript);
+	script->set_source_code(p_source);
+	const Error error = script->reload();
+	GDScriptByteCodeGenerator::set_optimizations_enabled(was_enabled);
+	REQUIRE_MESSAGE(error == OK, "The script should compile successfully.");
+
+	Ref<RefCounted> object = memnew(RefCounted);
+	object->set_script(script);
+	const uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	const int64_t result = object->call("run", p_count);
+	if (r_run_usec) {
+		*r_run_usec = OS::get_singleton()->get_ticks_usec() - begin;
+	}
+	return result;
+}
+
+TEST_CASE("[Modules][GDScript] Optimized bytecode computes the same result") {
+	const String source = R"(
+extends RefCounted
+
+func run(count: int) -> int:
+	var total := 0
+	var scale := 0.0
+	var i := 0
+	while i < count:
+		if i % 3 == 0 and i > 10:
+			total += i
+		else:
+			total -= 1
+		scale = 2
+		i += 1
+	return total + int(scale)
+)";
+
+	// 30 multiples of 3 from 12 to 99 add up to 1665, the other 70 iterations subtract 1.
+	CHECK(run_with_optimizations(source, false, 100) == 1597);
+	CHECK_MESSAGE(run_with_optimizations(source, true, 100) == 1597, "Optimized bytecode should compute the same result.");
+
+	const int64_t count = 1000000;
+	uint64_t unoptimized_usec = 0;
+	uint64_t optimized_usec = 0;
+	const int64_t unoptimized_result = run_with_optimizations(source, false, count, &unoptimized_usec);
+	CHECK(run_with_optimizations(source, true, count, &optimized_usec) == unoptimized_result);
+	MESSAGE(vformat("%d iterations, unoptimized: %.2f ms, optimized: %.2f ms (%.1f%%).", count, unoptimized_usec / 1000.0, optimized_usec / 1000.0, 100.0 * optimized_usec / MAX(unoptimized_usec, (uint64_t)1)));
+}
+
+TEST_CASE("[Modules][GDScript] Typed packed array access") {
+	// Typed PackedFloat32Array and PackedVector2Array index their storage directly.
+	Ref<GDScript> script = memnew(GDScript);
+	script->set_source_code(R"(
+extends RefCounted
+
+func negative_index(values: PackedFloat32Array, points: PackedVector2Array) -> Array:
+	values[-1] = values[-2] + 0.5
+	points[-2] = points[-1]
+	return [values, points]
+
+func read_past_end(values: PackedFloat32Array) -> String:
+	var value := values[values.size()]
+	return "read %s" % value
+
+func write_past_end(points: PackedVector2Array) -> String:
+	points[-points.size() - 1] = Vector2()
+	return "written"
+
+func append_shared(values: PackedFloat32Array, points: PackedVector2Array) -> Array:
+	values.append(4.0)
+	values[0] = 9.0
+	points.append(Vector2(4, 4))
+	return [values, points]
+
+func write_back_element(points: PackedVector2Array) -> PackedVector2Array:
+	points[1].x = 5.0
+	points[-1].y += 2.0
+	return points
+)");
+	REQUIRE_MESSAGE(script->reload() == OK, "The script should compile successfully.");
+	Ref<RefCounted> object = memnew(RefCounted);
+	object->set_script(script);
+
+	const PackedFloat32Array values = { 1.0, 2.0, 3.0 };
+	const PackedVector2Array points = { Vector2(1, 1), Vector2(2, 2), Vector2(3, 3) };
+
+	Array result = object->call("negative_index", values, points);
+	CHECK(PackedFloat32Array(result[0]) == PackedFloat32Array({ 1.0, 2.0, 2.5 }));
+	CHECK(PackedVector2Array(result[1]) == PackedVector2Array({ Vector2(1, 1), Vector2(3, 3), Vector2(3, 3) }));
+
+#ifdef DEBUG_ENABLED
+	// Out of bounds accesses stop the function with an error instead of touching memory.
+	ERR_PRINT_OFF;
+	CHECK(String(object->call("read_past_end", values)).is_empty());
+	CHECK(String(object->call("write_past_end", points)).is_empty());
+	ERR_PRINT_ON;
+#endif
+
+	// The arguments share their storage with the arrays here, writing through them must copy first.
+	result = object->call("append_shared", values, points);
+	CHECK(PackedFloat32Array(result[0]) == PackedFloat32Array({ 9.0, 2.0, 3.0, 4.0 }));
+	CHECK(PackedVector2Array(result[1]) == PackedVector2Array({ Vector2(1, 1), Vector2(2, 2), Vector2(3, 3), Vector2(4, 4) }));
+	CHECK(values == PackedFloat32Array({ 1.0, 2.0, 3.0 }));
+	CHECK(points == PackedVector2Array({ Vector2(1, 1), Vector2(2, 2), Vector2(3, 3) }));
+
+	// Setting a member of an element writes the element back into the array.
+	const PackedVector2Array written = object->call("write_back_element", points);
+	CHECK(written == PackedVector2Array({ Vector2(1, 1), Vector2(5, 2), Vector2(3, 5) }));
+	CHECK(points[1] == Vector2(2, 2));
+}
+
+TEST_CASE("[Modules][GDScript] Sampling profiler aggregates call stacks") {
+	const String path = "res://sampling_profiler_test.gd";
+	Ref<GDScript> script = memnew(GDScript);
+	script->set_source_code(R"(
+extends RefCounted
+
+func leaf(count: int) -> int:
+	var total := 0
+	for i in count:
+		total += i % 7
+	return total
+
+func branch(count: int) -> int:
+	return leaf(count) + leaf(count)
+
+func run(count: int) -> int:
+	var total := 0
+	for i in count:
+		total += branch(2000)
+	return total
+)");
+	script->set_path(path, true);
+	REQUIRE_MESSAGE(script->reload() == OK, "The profiled script should compile successfully.");
+	Ref<RefCounted> object = memnew(RefCounted);
+	object->set_script(script);
+
+	REQUIRE(GDScriptSamplingProfiler::start(100) == OK);
+	object->call("run", 200);
+	GDScriptSamplingProfiler::stop();
+
+	CHECK_MESSAGE(GDScriptLanguage::get_singleton()->debug_get_stack_level_count() == 0, "Every sampled call should be popped from the call stack.");
+	REQUIRE(GDScriptSamplingProfiler::get_sample_count() > 0);
+
+	const String collapsed = GDScriptSamplingProfiler::get_collapsed_stacks();
+	const String leaf_stack = vformat("%s:run;%s:branch;%s:leaf ", path, path, path);
+	CHECK_MESSAGE(collapsed.contains(leaf_stack), "Most samples should land in the innermost call, under its callers.");
+
+	Variant trace = JSON::parse_string(GDScriptSamplingProfiler::get_chrome_trace());
+	REQUIRE(trace.get_type() == Variant::DICTIONARY);
+	Array events = Dictionary(trace)["traceEvents"];
+	bool has_leaf = false;
+	for (int i = 0; i < events.size() && !has_leaf; i++) {
+		has_leaf = String(Dictionary(events[i])["name"]) == path + ":leaf";
+	}
+	CHECK_MESSAGE(has_leaf, "The trace should have events for the innermost call.");
+
+	GDScriptSamplingProfiler::clear();
+	CHECK(GDScriptSamplingProfiler::get_sample_count() == 0);
+}
 #endif // TOOLS_ENABLED
 
 TEST_CASE("[Modules][GDScript] Validate built-in API") {
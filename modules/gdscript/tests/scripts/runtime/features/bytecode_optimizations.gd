@@ -0,0 +1,37 @@
+# Typed comparisons fused with branches, operators writing into typed locals, and folded constant conversions.
+
+func count_multiples(limit: int) -> int:
+	var count := 0
+	var i := 0
+	while i < limit:
+		if i % 3 == 0 or i % 5 == 0:
+			count += 1
+		i += 1
+	return count
+
+func test():
+	print(count_multiples(30))
+
+	var a := 3
+	var b := 4
+	a = a * b + a
+	print(a)
+	if not (a == b):
+		print("differ")
+	print(a > 10 and b < 10)
+	print("neg" if a < 0 else "pos")
+
+	var v := Vector2(1, 2)
+	v = v + v * 2.0
+	print(v)
+
+	var f: float = 1
+	f += 0.5
+	print(f)
+
+	var total := 0
+	for n in 4:
+		var step := 0
+		step = step + n
+		total += step
+	print(total)
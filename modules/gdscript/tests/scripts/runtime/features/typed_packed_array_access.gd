@@ -0,0 +1,30 @@
+# Indexed access and appends on typed PackedFloat32Array and PackedVector2Array index their storage directly.
+
+func fill(values: PackedFloat32Array, count: int) -> void:
+	for i in count:
+		values.append(i * 0.5)
+
+func test():
+	var floats := PackedFloat32Array()
+	fill(floats, 4)
+	floats.push_back(8.0)
+	print(floats)
+
+	floats[1] = floats[2] + floats[3]
+	floats[-1] = 10.5
+	print(floats[1], " ", floats[-1], " ", floats.size())
+
+	var points := PackedVector2Array()
+	for i in 3:
+		points.append(Vector2(i, i * 2))
+	points[0] = points[2] * 2.0
+	var last: Vector2 = points[-1]
+	print(points, " ", last)
+
+	var copy := floats
+	copy[0] = 42.5
+	print(floats[0])
+
+	var duplicate := floats.duplicate()
+	duplicate[0] = 7.5
+	print(floats[0], " ", duplicate[0])
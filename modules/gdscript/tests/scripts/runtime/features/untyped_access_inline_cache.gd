@@ -0,0 +1,55 @@
+# One untyped access site sees several kinds of receivers in turn.
+
+class Base:
+    var value = 1
+    var typed: int = 2
+    var with_setter = 0:
+        set(v):
+            with_setter = v * 10
+
+    func describe():
+        return "Base %s" % value
+
+class Derived extends Base:
+    var extra = "extra"
+
+    func describe():
+        return "Derived %s %s" % [value, extra]
+
+class Dynamic:
+    func _get(property):
+        if property == &"value":
+            return "dynamic"
+        return null
+
+    func _set(property, v):
+        print("_set ", property, " ", v)
+        return property == &"value"
+
+    func describe():
+        return "Dynamic"
+
+func poke(target):
+    target.value = target.value
+    print(target.value)
+    print(target.describe())
+
+func test():
+    var receivers = [Base.new(), Derived.new(), Dynamic.new(), Base.new(), Derived.new()]
+    for _i in 3:
+        for receiver in receivers:
+            poke(receiver)
+
+    var base = Base.new()
+    for i in 3:
+        base.typed = 5.0 + i
+        print(typeof(base.typed) == TYPE_INT, " ", base.typed)
+        base.with_setter = i
+        print(base.with_setter)
+
+    var node = Node.new()
+    for i in 2:
+        node.name = "Node%s" % i
+        print(node.name)
+        print(node.get_child_count())
+    node.free()
@@ -6,6 +6,7 @@
 
 void DIVABoneDB::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("read_classic", "stream"), &DIVABoneDB::read_classic);
+	ClassDB::bind_method(D_METHOD("read_classic_file", "path"), &DIVABoneDB::read_classic_file);
 	ClassDB::bind_method(D_METHOD("dump_json", "path"), &DIVABoneDB::dump_json);
 	ClassDB::bind_method(D_METHOD("get_skeleton", "name"), &DIVABoneDB::get_skeleton);
 }
@@ -20,118 +21,127 @@ Ref<DIVASkeleton> DIVABoneDB::get_skeleton(const String &p_name) const {
 }
 
 void DIVABoneDB::read_classic(Ref<StreamPeerBuffer> p_stream) {
-	uint32_t signature = p_stream->get_u32();
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_stream_peer_buffer(p_stream);
+	read_classic_span(reader);
+	p_stream->seek(MIN(reader.get_position(), reader.get_size()));
+}
+
+Error DIVABoneDB::read_classic_file(const String &p_path) {
+	DIVAReadHelpers::SpanReader reader;
+	Error err = reader.open_file(p_path);
+	if (err != OK) {
+		return err;
+	}
+	return read_classic_span(reader);
+}
 
-	ERR_FAIL_COND_MSG(signature != 0x09102720, "Bone database magic number invalid!");
+Error DIVABoneDB::read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
+	uint32_t signature = p_reader.get_u32();
 
-	uint32_t skeleton_count = p_stream->get_u32();
-	uint32_t skeleton_offsets_offset = p_stream->get_u32();
-	uint32_t skeleton_name_offsets_offset = p_stream->get_u32();
-	p_stream->seek(p_stream->get_position() + 0x14);
+	ERR_FAIL_COND_V_MSG(signature != 0x09102720, ERR_FILE_UNRECOGNIZED, "Bone database magic number invalid!");
+
+	uint32_t skeleton_count = p_reader.get_u32();
+	uint32_t skeleton_offsets_offset = p_reader.get_u32();
+	uint32_t skeleton_name_offsets_offset = p_reader.get_u32();
+	p_reader.skip(0x14);
 
 	skeletons.resize(skeleton_count);
 	for (Ref<DIVASkeleton> &skel : skeletons) {
 		skel.instantiate();
 	}
 
-	DIVAReadHelpers::OffsetQueue queue{
-		.spb = p_stream
-	};
-
 	// Load skeletons
-	queue.position_push(skeleton_offsets_offset);
+	p_reader.position_push(skeleton_offsets_offset);
 	for (uint32_t i = 0; i < skeleton_count; i++) {
 		Ref<DIVASkeleton> skel = skeletons[i];
-		uint32_t skeleton_offset = p_stream->get_u32();
+		uint32_t skeleton_offset = p_reader.get_u32();
 
-		queue.position_push(skeleton_offset);
-		uint32_t bones_offset = p_stream->get_u32();
-		uint32_t position_count = p_stream->get_u32();
-		uint32_t positions_offset = p_stream->get_u32();
-		uint32_t heel_height_offset = p_stream->get_u32();
-		uint32_t object_bone_count = p_stream->get_u32();
-		uint32_t object_bone_names_offset = p_stream->get_u32();
-		uint32_t motion_bone_count = p_stream->get_u32();
-		uint32_t motion_bone_names_offset = p_stream->get_u32();
-		uint32_t parent_indices_offset = p_stream->get_u32();
+		p_reader.position_push(skeleton_offset);
+		uint32_t bones_offset = p_reader.get_u32();
+		uint32_t position_count = p_reader.get_u32();
+		uint32_t positions_offset = p_reader.get_u32();
+		uint32_t heel_height_offset = p_reader.get_u32();
+		uint32_t object_bone_count = p_reader.get_u32();
+		uint32_t object_bone_names_offset = p_reader.get_u32();
+		uint32_t motion_bone_count = p_reader.get_u32();
+		uint32_t motion_bone_names_offset = p_reader.get_u32();
+		uint32_t parent_indices_offset = p_reader.get_u32();
 
-		p_stream->seek(p_stream->get_position() + 0x14);
+		p_reader.skip(0x14);
 
 		// Obtain bone count
 		uint32_t bone_count = 0;
-		queue.position_push(bones_offset);
-		while (true) {
-			if (p_stream->get_u8() == 0xFF) {
+		p_reader.position_push(bones_offset);
+		while (p_reader.get_available_bytes() > 0) {
+			if (p_reader.get_u8() == 0xFF) {
 				break;
 			}
-			p_stream->seek(p_stream->get_position() + 0x0B);
+			p_reader.skip(0x0B);
 			bone_count++;
 		}
-		queue.position_pop();
+		p_reader.position_pop();
 
 		skel->bones.resize(bone_count);
 
 		// Read bone data
-		queue.position_push(bones_offset);
+		p_reader.position_push(bones_offset);
 		for (uint32_t j = 0; j < bone_count; j++) {
 			DIVASkeleton::bone_database_bone *bone = &skel->bones.ptr()[j];
-			bone->type = (DIVASkeleton::BoneType)p_stream->get_u8();
-			bone->has_parent = p_stream->get_u8();
-			bone->parent = p_stream->get_u8();
-			bone->pole_target = p_stream->get_u8();
-			bone->mirror = p_stream->get_u8();
-			bone->flags = p_stream->get_u8();
-			p_stream->seek(p_stream->get_position() + 0x02);
-			bone->name = DIVAReadHelpers::read_null_terminated_string(p_stream->get_u32(), queue);
+			bone->type = (DIVASkeleton::BoneType)p_reader.get_u8();
+			bone->has_parent = p_reader.get_u8();
+			bone->parent = p_reader.get_u8();
+			bone->pole_target = p_reader.get_u8();
+			bone->mirror = p_reader.get_u8();
+			bone->flags = p_reader.get_u8();
+			p_reader.skip(0x02);
+			bone->name = p_reader.read_string_offset();
 		}
 
-		queue.position_pop();
+		p_reader.position_pop();
 
 		// Bone positions buffer
 		skel->positions.resize(position_count);
 
-		queue.position_push(positions_offset);
-		for (uint32_t j = 0; j < position_count; j++) {
-			skel->positions[j] = Vector3(
-					p_stream->get_float(),
-					p_stream->get_float(),
-					p_stream->get_float());
-		}
-		queue.position_pop();
+		p_reader.position_push(positions_offset);
+		p_reader.read_vector3_array(skel->positions.ptr(), position_count);
+		p_reader.position_pop();
 
 		// heel height
-		queue.position_push(heel_height_offset);
-		skel->heel_height = p_stream->get_float();
-		queue.position_pop();
+		p_reader.position_push(heel_height_offset);
+		skel->heel_height = p_reader.get_float();
+		p_reader.position_pop();
 
 		// Object bone (what even is this?)
 		skel->object_bone_names.resize(object_bone_count);
-		queue.position_push(object_bone_names_offset);
+		p_reader.position_push(object_bone_names_offset);
 		for (uint32_t j = 0; j < object_bone_count; j++) {
-			skel->object_bone_names[j] = DIVAReadHelpers::read_null_terminated_string(p_stream->get_u32(), queue);
+			skel->object_bone_names[j] = p_reader.read_string_offset();
 		}
-		queue.position_pop();
+		p_reader.position_pop();
 
 		// Motion bone names (not sure what this is either)
 		skel->motion_bone_names.resize(motion_bone_count);
-		queue.position_push(motion_bone_names_offset);
+		p_reader.position_push(motion_bone_names_offset);
 		for (uint32_t j = 0; j < motion_bone_count; j++) {
-			skel->motion_bone_names[j] = DIVAReadHelpers::read_null_terminated_string(p_stream->get_u32(), queue);
+			skel->motion_bone_names[j] = p_reader.read_string_offset();
 		}
-		queue.position_pop();
+		p_reader.position_pop();
 
 		// Parent indices
 		skel->bone_parents.resize(motion_bone_count);
-		queue.position_push(parent_indices_offset);
-		p_stream->get_data((uint8_t *)skel->bone_parents.ptr(), motion_bone_count * sizeof(uint16_t));
-		queue.position_pop();
-		queue.position_pop();
+		p_reader.position_push(parent_indices_offset);
+		p_reader.read_array(skel->bone_parents.ptr(), motion_bone_count);
+		p_reader.position_pop();
+		p_reader.position_pop();
 	}
-	queue.position_pop();
-	queue.position_push(skeleton_name_offsets_offset);
+	p_reader.position_pop();
+	p_reader.position_push(skeleton_name_offsets_offset);
 	for (uint32_t i = 0; i < skeleton_count; i++)
-		skeletons[i]->name = DIVAReadHelpers::read_null_terminated_string(p_stream->get_u32(), queue);
-	queue.position_pop();
+		skeletons[i]->name = p_reader.read_string_offset();
+	p_reader.position_pop();
+
+	return p_reader.has_overflowed() ? ERR_FILE_CORRUPT : OK;
 }
 
 void DIVABoneDB::dump_json(const String &p_path) const {
@@ -6,6 +6,7 @@
 #include "core/object/ref_counted.h"
 #include "core/string/ustring.h"
 #include "core/templates/local_vector.h"
+#include "read_helpers.h"
 
 class DIVABoneDB;
 class Skeleton3D;
@@ -74,6 +75,8 @@ protected:
 public:
 	Ref<DIVASkeleton> get_skeleton(const String &p_name) const;
 	void read_classic(Ref<StreamPeerBuffer> p_stream);
+	Error read_classic_file(const String &p_path);
+	Error read_classic_span(DIVAReadHelpers::SpanReader &p_reader);
 	void dump_json(const String &p_path) const;
 };
 
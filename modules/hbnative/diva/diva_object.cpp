@@ -1,77 +1,71 @@
 #include "diva_object.h"
-void DIVAObjectSet::read_submesh_indices(DIVASubmesh *p_submesh, uint32_t p_index_count, Ref<StreamPeerBuffer> p_spb) {
+
+#include "core/object/worker_thread_pool.h"
+
+void DIVAObjectSet::read_submesh_indices(DIVASubmesh *p_submesh, uint32_t p_index_count, DIVAReadHelpers::SpanReader &p_reader) {
 	bool tri_strip = p_submesh->primitive == OBJ_PRIMITIVE_TRIANGLE_STRIP;
 	p_submesh->index_array.resize(p_index_count);
+	int32_t *indices = p_submesh->index_array.ptr();
 
 	switch (p_submesh->index_format) {
 		case OBJ_INDEX_U8: {
+			p_reader.read_array_as<uint8_t>(indices, p_index_count);
 			if (tri_strip) {
 				for (uint32_t i = 0; i < p_index_count; i++) {
-					uint8_t idx = p_spb->get_u8();
-					p_submesh->index_array[i] = idx == 0xFF ? 0xFFFFFFFF : idx;
-				}
-			} else {
-				for (uint32_t i = 0; i < p_index_count; i++) {
-					p_submesh->index_array[i] = p_spb->get_u8();
+					indices[i] = indices[i] == 0xFF ? 0xFFFFFFFF : indices[i];
 				}
 			}
 		} break;
 		case OBJ_INDEX_U16: {
+			p_reader.read_array_as<uint16_t>(indices, p_index_count);
 			if (tri_strip) {
 				for (uint32_t i = 0; i < p_index_count; i++) {
-					uint16_t idx = p_spb->get_u16();
-					p_submesh->index_array[i] = idx == 0xFFFF ? 0xFFFFFFFF : idx;
-				}
-			} else {
-				for (uint32_t i = 0; i < p_index_count; i++) {
-					p_submesh->index_array[i] = p_spb->get_u16();
+					indices[i] = indices[i] == 0xFFFF ? 0xFFFFFFFF : indices[i];
 				}
 			}
 		} break;
 		case OBJ_INDEX_U32: {
-			for (uint32_t i = 0; i < p_index_count; i++) {
-				p_submesh->index_array[i] = p_spb->get_u32();
-			}
+			p_reader.read_array(indices, p_index_count);
 		} break;
 	}
 }
-void DIVAObjectSet::read_submesh(DIVASubmesh *p_submesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset) {
-	p_submesh->flags = p_spb->get_u32();
-	p_submesh->bounding_sphere.center.x = p_spb->get_float();
-	p_submesh->bounding_sphere.center.y = p_spb->get_float();
-	p_submesh->bounding_sphere.center.z = p_spb->get_float();
-	p_submesh->bounding_sphere.radius = p_spb->get_float();
-	p_submesh->material = p_spb->get_u32();
+void DIVAObjectSet::read_submesh(DIVASubmesh *p_submesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset) {
+	p_submesh->flags = p_reader.get_u32();
+	p_submesh->bounding_sphere.center.x = p_reader.get_float();
+	p_submesh->bounding_sphere.center.y = p_reader.get_float();
+	p_submesh->bounding_sphere.center.z = p_reader.get_float();
+	p_submesh->bounding_sphere.radius = p_reader.get_float();
+	p_submesh->material = p_reader.get_u32();
 
-	p_spb->get_data(p_submesh->uv_indices, 8);
+	p_reader.get_data(p_submesh->uv_indices, 8);
 
-	uint32_t bone_index_count = p_spb->get_u32();
-	uint32_t bone_indices_offset = p_spb->get_u32();
-	p_submesh->bones_per_vertex = p_spb->get_u32();
+	uint32_t bone_index_count = p_reader.get_u32();
+	uint32_t bone_indices_offset = p_reader.get_u32();
+	p_submesh->bones_per_vertex = p_reader.get_u32();
 
-	p_submesh->primitive = (DIVAPrimitive)p_spb->get_u32();
-	p_submesh->index_format = (DIVAIndexFormat)p_spb->get_u32();
+	p_submesh->primitive = (DIVAPrimitive)p_reader.get_u32();
+	p_submesh->index_format = (DIVAIndexFormat)p_reader.get_u32();
 
-	uint32_t index_count = p_spb->get_u32();
-	uint32_t indices_offset = p_spb->get_u32();
+	uint32_t index_count = p_reader.get_u32();
+	uint32_t indices_offset = p_reader.get_u32();
 	// ?
-	p_spb->get_u32();
+	p_reader.get_u32();
 	p_submesh->bounding_box.center = p_submesh->bounding_sphere.center;
 	p_submesh->bounding_box.size = Vector3(1.0f, 1.0f, 1.0f) * (p_submesh->bounding_sphere.radius * 2.0f);
 	// ?
-	p_spb->seek(p_spb->get_position() + 0x1C);
+	p_reader.skip(0x1C);
 
 	if (p_submesh->bones_per_vertex == 4 && bone_indices_offset != 0) {
 		p_submesh->bone_index_array.resize(bone_index_count);
-		p_spb->seek(p_base_offset + bone_indices_offset);
-		p_spb->get_data((uint8_t *)p_submesh->bone_index_array.ptr(), bone_index_count * sizeof(uint16_t));
+		p_reader.seek(p_base_offset + bone_indices_offset);
+		p_reader.read_array(p_submesh->bone_index_array.ptr(), bone_index_count);
 	}
 
-	p_spb->seek(p_base_offset + indices_offset);
-	read_submesh_indices(p_submesh, index_count, p_spb);
+	p_reader.seek(p_base_offset + indices_offset);
+	read_submesh_indices(p_submesh, index_count, p_reader);
 }
 
-void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format) {
+void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format) {
 	p_mesh->vertices.resize(p_vertex_count);
 
 	Array mesh_data;
@@ -86,20 +80,13 @@ void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPee
 			continue;
 		}
 
-		p_spb->seek(p_base_offset + p_vertex_offsets[i]);
+		p_reader.seek(p_base_offset + p_vertex_offsets[i]);
 
 		switch (attrib) {
 			case OBJ_VERTEX_FILE_POSITION: {
 				PackedVector3Array positions;
 				positions.resize(p_vertex_count);
-				{
-					Vector3 *positions_ptr = positions.ptrw();
-					for (uint32_t j = 0; j < p_vertex_count; j++) {
-						positions_ptr[j].x = p_spb->get_float();
-						positions_ptr[j].y = p_spb->get_float();
-						positions_ptr[j].z = p_spb->get_float();
-					}
-				}
+				p_reader.read_vector3_array(positions.ptrw(), p_vertex_count);
 				mesh_data[ArrayMesh::ARRAY_VERTEX] = positions;
 				mesh_format.set_flag(ArrayMesh::ARRAY_FORMAT_VERTEX);
 				p_mesh->godot_vertex_data.positions = positions;
@@ -107,14 +94,7 @@ void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPee
 			case OBJ_VERTEX_FILE_NORMAL: {
 				PackedVector3Array normals;
 				normals.resize(p_vertex_count);
-				{
-					Vector3 *normals_ptr = normals.ptrw();
-					for (uint32_t j = 0; j < p_vertex_count; j++) {
-						normals_ptr[j].x = p_spb->get_float();
-						normals_ptr[j].y = p_spb->get_float();
-						normals_ptr[j].z = p_spb->get_float();
-					}
-				}
+				p_reader.read_vector3_array(normals.ptrw(), p_vertex_count);
 				mesh_data[ArrayMesh::ARRAY_NORMAL] = normals;
 				mesh_format.set_flag(ArrayMesh::ARRAY_FORMAT_NORMAL);
 				p_mesh->godot_vertex_data.normals = normals;
@@ -122,30 +102,22 @@ void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPee
 			case OBJ_VERTEX_FILE_TANGENT: {
 				PackedFloat32Array tangents;
 				tangents.resize(p_vertex_count * 4);
-				{
-					float *tangents_ptr = tangents.ptrw();
-					for (uint32_t j = 0; j < tangents.size(); j++) {
-						tangents_ptr[j] = p_spb->get_float();
-					}
-				}
+				p_reader.read_array(tangents.ptrw(), tangents.size());
 				mesh_data[ArrayMesh::ARRAY_TANGENT] = tangents;
 				p_mesh->godot_vertex_data.tangents = tangents;
 				p_mesh->godot_vertex_data.format.set_flag(ArrayMesh::ARRAY_FORMAT_TANGENT);
 			} break;
-			case OBJ_VERTEX_FILE_BINORMAL: {
-				// Unsupported
-				p_spb->seek(p_spb->get_position() + p_vertex_count * sizeof(float) * 3);
+			case OBJ_VERTEX_FILE_BINORMAL:
+			case OBJ_VERTEX_FILE_TEXCOORD2:
+			case OBJ_VERTEX_FILE_TEXCOORD3:
+			case OBJ_VERTEX_FILE_COLOR1:
+			case OBJ_VERTEX_FILE_UNKNOWN: {
+				// Unsupported, every stream has its own offset so there is nothing to skip
 			} break;
 			case OBJ_VERTEX_FILE_TEXCOORD0: {
 				PackedVector2Array uvs;
 				uvs.resize(p_vertex_count);
-				Vector2 *uvs_ptr = uvs.ptrw();
-				{
-					for (uint32_t j = 0; j < p_vertex_count; j++) {
-						uvs_ptr[j].x = p_spb->get_float();
-						uvs_ptr[j].y = p_spb->get_float();
-					}
-				}
+				p_reader.read_vector2_array(uvs.ptrw(), p_vertex_count);
 				p_mesh->godot_vertex_data.texcoord0 = uvs;
 				mesh_data[ArrayMesh::ARRAY_TEX_UV] = uvs;
 				p_mesh->godot_vertex_data.format.set_flag(ArrayMesh::ARRAY_FORMAT_TEX_UV);
@@ -153,80 +125,43 @@ void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPee
 			case OBJ_VERTEX_FILE_TEXCOORD1: {
 				PackedVector2Array uvs;
 				uvs.resize(p_vertex_count);
-				Vector2 *uvs_ptr = uvs.ptrw();
-				{
-					for (uint32_t j = 0; j < p_vertex_count; j++) {
-						uvs_ptr[j].x = p_spb->get_float();
-						uvs_ptr[j].y = p_spb->get_float();
-					}
-				}
+				p_reader.read_vector2_array(uvs.ptrw(), p_vertex_count);
 				mesh_data[ArrayMesh::ARRAY_TEX_UV2] = uvs;
 				p_mesh->godot_vertex_data.texcoord1 = uvs;
 				p_mesh->godot_vertex_data.format.set_flag(ArrayMesh::ARRAY_FORMAT_TEX_UV2);
 			} break;
-			case OBJ_VERTEX_FILE_TEXCOORD2: {
-				// Unsupported
-				p_spb->seek(p_spb->get_position() + p_vertex_count * sizeof(float) * 2);
-			} break;
-			case OBJ_VERTEX_FILE_TEXCOORD3: {
-				// Unsupported
-				p_spb->seek(p_spb->get_position() + p_vertex_count * sizeof(float) * 2);
-			} break;
 			case OBJ_VERTEX_FILE_COLOR0: {
 				PackedColorArray colors;
 				colors.resize(p_vertex_count);
-				{
-					Color *color_ptr = colors.ptrw();
-					for (uint32_t j = 0; j < p_vertex_count; j++) {
-						color_ptr[j].r = p_spb->get_float();
-						color_ptr[j].g = p_spb->get_float();
-						color_ptr[j].b = p_spb->get_float();
-						color_ptr[j].a = p_spb->get_float();
-					}
-				}
+				p_reader.read_color_array(colors.ptrw(), p_vertex_count);
 				mesh_data[ArrayMesh::ARRAY_COLOR] = colors;
 				p_mesh->godot_vertex_data.color0 = colors;
 				p_mesh->godot_vertex_data.format.set_flag(ArrayMesh::ARRAY_FORMAT_COLOR);
 			} break;
-			case OBJ_VERTEX_FILE_COLOR1: {
-				p_spb->seek(p_spb->get_position() + p_vertex_count * sizeof(float) * 4);
-			} break;
 			case OBJ_VERTEX_FILE_BONE_WEIGHT: {
+				// 4 weights per vertex
 				PackedFloat32Array bone_weights;
-				bone_weights.resize(p_vertex_count);
-				{
-					float *bone_weights_ptr = bone_weights.ptrw();
-					for (uint32_t j = 0; j < bone_weights.size(); j++) {
-						bone_weights_ptr[j] = p_spb->get_float();
-					}
-				}
+				bone_weights.resize(p_vertex_count * 4);
+				p_reader.read_array(bone_weights.ptrw(), bone_weights.size());
 				mesh_data[ArrayMesh::ARRAY_WEIGHTS] = bone_weights;
 				p_mesh->godot_vertex_data.bone_weights = bone_weights;
 				p_mesh->godot_vertex_data.format.set_flag(ArrayMesh::ARRAY_FORMAT_WEIGHTS);
 			} break;
 			case OBJ_VERTEX_FILE_BONE_INDEX: {
+				// Stored as floats, multiplied by 3
 				PackedInt32Array bone_indices;
 				bone_indices.resize(p_vertex_count * 4);
 				{
 					int *bone_indices_ptr = bone_indices.ptrw();
-					for (uint32_t j = 0; j < bone_indices.size(); j++) {
-						int32_t bone_index_0 = (int32_t)p_spb->get_float();
-
-						bone_indices_ptr[j] = (int16_t)(bone_index_0 >= 0 ? bone_index_0 / 3 : -1);
+					p_reader.read_array_as<float>(bone_indices_ptr, bone_indices.size());
+					for (int j = 0; j < bone_indices.size(); j++) {
+						bone_indices_ptr[j] = (int16_t)(bone_indices_ptr[j] >= 0 ? bone_indices_ptr[j] / 3 : -1);
 					}
 				}
 				mesh_data[ArrayMesh::ARRAY_BONES] = bone_indices;
 				p_mesh->godot_vertex_data.bone_indices = bone_indices;
 				p_mesh->godot_vertex_data.format.set_flag(ArrayMesh::ARRAY_FORMAT_WEIGHTS);
-			}
-			case OBJ_VERTEX_FILE_UNKNOWN: {
-				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_spb->get_float();
-					p_spb->get_float();
-					p_spb->get_float();
-					p_spb->get_float();
-				}
-			}
+			} break;
 			case OBJ_VERTEX_FILE_MODERN_STORAGE:
 				break;
 		}
@@ -234,7 +169,7 @@ void DIVAObjectSet::read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPee
 	p_mesh->godot_vertex_data.format = mesh_format;
 }
 
-void DIVAObjectSet::read_model_vertex_data(DIVAMesh *p_mesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format) {
+void DIVAObjectSet::read_model_vertex_data(DIVAMesh *p_mesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format) {
 	p_mesh->vertices.resize(p_vertex_count);
 	for (uint32_t i = 0; i < 20; i++) {
 		DIVAVertexFormat attrib = (DIVAVertexFormat)(1 << i);
@@ -242,92 +177,92 @@ void DIVAObjectSet::read_model_vertex_data(DIVAMesh *p_mesh, Ref<StreamPeerBuffe
 			continue;
 		}
 
-		p_spb->seek(p_base_offset + p_vertex_offsets[i]);
+		p_reader.seek(p_base_offset + p_vertex_offsets[i]);
 
 		switch (attrib) {
 			case OBJ_VERTEX_FILE_POSITION: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].position.x = p_spb->get_float();
-					p_mesh->vertices[j].position.y = p_spb->get_float();
-					p_mesh->vertices[j].position.z = p_spb->get_float();
+					p_mesh->vertices[j].position.x = p_reader.get_float();
+					p_mesh->vertices[j].position.y = p_reader.get_float();
+					p_mesh->vertices[j].position.z = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_NORMAL: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].normal.x = p_spb->get_float();
-					p_mesh->vertices[j].normal.y = p_spb->get_float();
-					p_mesh->vertices[j].normal.z = p_spb->get_float();
+					p_mesh->vertices[j].normal.x = p_reader.get_float();
+					p_mesh->vertices[j].normal.y = p_reader.get_float();
+					p_mesh->vertices[j].normal.z = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_TANGENT: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].tangent.x = p_spb->get_float();
-					p_mesh->vertices[j].tangent.y = p_spb->get_float();
-					p_mesh->vertices[j].tangent.z = p_spb->get_float();
-					p_mesh->vertices[j].tangent.w = p_spb->get_float();
+					p_mesh->vertices[j].tangent.x = p_reader.get_float();
+					p_mesh->vertices[j].tangent.y = p_reader.get_float();
+					p_mesh->vertices[j].tangent.z = p_reader.get_float();
+					p_mesh->vertices[j].tangent.w = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_BINORMAL: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].binormal.x = p_spb->get_float();
-					p_mesh->vertices[j].binormal.y = p_spb->get_float();
-					p_mesh->vertices[j].binormal.z = p_spb->get_float();
+					p_mesh->vertices[j].binormal.x = p_reader.get_float();
+					p_mesh->vertices[j].binormal.y = p_reader.get_float();
+					p_mesh->vertices[j].binormal.z = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_TEXCOORD0: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].texcoord0.x = p_spb->get_float();
-					p_mesh->vertices[j].texcoord0.y = p_spb->get_float();
+					p_mesh->vertices[j].texcoord0.x = p_reader.get_float();
+					p_mesh->vertices[j].texcoord0.y = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_TEXCOORD1: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].texcoord1.x = p_spb->get_float();
-					p_mesh->vertices[j].texcoord1.y = p_spb->get_float();
+					p_mesh->vertices[j].texcoord1.x = p_reader.get_float();
+					p_mesh->vertices[j].texcoord1.y = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_TEXCOORD2: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].texcoord2.x = p_spb->get_float();
-					p_mesh->vertices[j].texcoord2.y = p_spb->get_float();
+					p_mesh->vertices[j].texcoord2.x = p_reader.get_float();
+					p_mesh->vertices[j].texcoord2.y = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_TEXCOORD3: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].texcoord3.x = p_spb->get_float();
-					p_mesh->vertices[j].texcoord3.y = p_spb->get_float();
+					p_mesh->vertices[j].texcoord3.x = p_reader.get_float();
+					p_mesh->vertices[j].texcoord3.y = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_COLOR0: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].color0.r = p_spb->get_float();
-					p_mesh->vertices[j].color0.g = p_spb->get_float();
-					p_mesh->vertices[j].color0.b = p_spb->get_float();
-					p_mesh->vertices[j].color0.a = p_spb->get_float();
+					p_mesh->vertices[j].color0.r = p_reader.get_float();
+					p_mesh->vertices[j].color0.g = p_reader.get_float();
+					p_mesh->vertices[j].color0.b = p_reader.get_float();
+					p_mesh->vertices[j].color0.a = p_reader.get_float();
 				}
 			}
 			case OBJ_VERTEX_FILE_COLOR1: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].color1.r = p_spb->get_float();
-					p_mesh->vertices[j].color1.g = p_spb->get_float();
-					p_mesh->vertices[j].color1.b = p_spb->get_float();
-					p_mesh->vertices[j].color1.a = p_spb->get_float();
+					p_mesh->vertices[j].color1.r = p_reader.get_float();
+					p_mesh->vertices[j].color1.g = p_reader.get_float();
+					p_mesh->vertices[j].color1.b = p_reader.get_float();
+					p_mesh->vertices[j].color1.a = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_BONE_WEIGHT: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_mesh->vertices[j].bone_weights[0] = p_spb->get_float();
-					p_mesh->vertices[j].bone_weights[1] = p_spb->get_float();
-					p_mesh->vertices[j].bone_weights[2] = p_spb->get_float();
-					p_mesh->vertices[j].bone_weights[3] = p_spb->get_float();
+					p_mesh->vertices[j].bone_weights[0] = p_reader.get_float();
+					p_mesh->vertices[j].bone_weights[1] = p_reader.get_float();
+					p_mesh->vertices[j].bone_weights[2] = p_reader.get_float();
+					p_mesh->vertices[j].bone_weights[3] = p_reader.get_float();
 				}
 			} break;
 			case OBJ_VERTEX_FILE_BONE_INDEX: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					int32_t bone_index_0 = (int32_t)p_spb->get_float();
-					int32_t bone_index_1 = (int32_t)p_spb->get_float();
-					int32_t bone_index_2 = (int32_t)p_spb->get_float();
-					int32_t bone_index_3 = (int32_t)p_spb->get_float();
+					int32_t bone_index_0 = (int32_t)p_reader.get_float();
+					int32_t bone_index_1 = (int32_t)p_reader.get_float();
+					int32_t bone_index_2 = (int32_t)p_reader.get_float();
+					int32_t bone_index_3 = (int32_t)p_reader.get_float();
 
 					p_mesh->vertices[j].bone_indices[0] = (int16_t)(bone_index_0 >= 0 ? bone_index_0 / 3 : -1);
 					p_mesh->vertices[j].bone_indices[1] = (int16_t)(bone_index_1 >= 0 ? bone_index_1 / 3 : -1);
@@ -337,10 +272,10 @@ void DIVAObjectSet::read_model_vertex_data(DIVAMesh *p_mesh, Ref<StreamPeerBuffe
 			}
 			case OBJ_VERTEX_FILE_UNKNOWN: {
 				for (uint32_t j = 0; j < p_vertex_count; j++) {
-					p_spb->get_float();
-					p_spb->get_float();
-					p_spb->get_float();
-					p_spb->get_float();
+					p_reader.get_float();
+					p_reader.get_float();
+					p_reader.get_float();
+					p_reader.get_float();
 				}
 			}
 			case OBJ_VERTEX_FILE_MODERN_STORAGE:
@@ -348,128 +283,218 @@ void DIVAObjectSet::read_model_vertex_data(DIVAMesh *p_mesh, Ref<StreamPeerBuffe
 		}
 	}
 }
-void DIVAObjectSet::read_mesh(DIVAMesh *p_mesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset) {
+void DIVAObjectSet::read_mesh(DIVAMesh *p_mesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset) {
 	const size_t sub_mesh_size = 0x5C;
 
-	p_mesh->flags = p_spb->get_u32();
-	p_mesh->bounding_sphere.center.x = p_spb->get_float();
-	p_mesh->bounding_sphere.center.y = p_spb->get_float();
-	p_mesh->bounding_sphere.center.z = p_spb->get_float();
-	p_mesh->bounding_sphere.radius = p_spb->get_float();
+	p_mesh->flags = p_reader.get_u32();
+	p_mesh->bounding_sphere.center.x = p_reader.get_float();
+	p_mesh->bounding_sphere.center.y = p_reader.get_float();
+	p_mesh->bounding_sphere.center.z = p_reader.get_float();
+	p_mesh->bounding_sphere.radius = p_reader.get_float();
 
-	uint32_t submesh_count = p_spb->get_u32();
-	uint32_t submesh_offset = p_spb->get_u32();
-	BitField<DIVAVertexFormat> vertex_format = (DIVAVertexFormat)p_spb->get_u32();
-	p_spb->get_u32(); // Vertex size
-	uint32_t vertex_count = p_spb->get_u32();
+	uint32_t submesh_count = p_reader.get_u32();
+	uint32_t submesh_offset = p_reader.get_u32();
+	BitField<DIVAVertexFormat> vertex_format = (DIVAVertexFormat)p_reader.get_u32();
+	p_reader.get_u32(); // Vertex size
+	uint32_t vertex_count = p_reader.get_u32();
 
 	// 20 vertex offsets
 	uint32_t vertex_offsets[20];
-	for (int i = 0; i < 20; i++) {
-		vertex_offsets[i] = p_spb->get_u32();
-	}
+	p_reader.read_array(vertex_offsets, 20);
 
-	p_spb->get_u32(); // Some attribute, no idea what for
-	p_spb->get_u32(); // Vertex format index
+	p_reader.get_u32(); // Some attribute, no idea what for
+	p_reader.get_u32(); // Vertex format index
 
 	// 6 unused uints
-	p_spb->seek(p_spb->get_position() + 6 * sizeof(uint32_t));
+	p_reader.skip(6 * sizeof(uint32_t));
 
-	p_spb->get_data((uint8_t *)p_mesh->name, 64);
+	p_reader.get_data((uint8_t *)p_mesh->name, 64);
 
 	p_mesh->name[sizeof(p_mesh->name) - 1] = 0;
 
 	if (submesh_offset != 0) {
 		p_mesh->submeshes.resize(submesh_count);
 		for (uint32_t i = 0; i < submesh_count; i++) {
-			p_spb->seek(p_base_offset + submesh_offset + sub_mesh_size * i);
-			read_submesh(&p_mesh->submeshes[i], p_spb, p_base_offset);
+			p_reader.seek(p_base_offset + submesh_offset + sub_mesh_size * i);
+			read_submesh(&p_mesh->submeshes[i], p_reader, p_base_offset);
 		}
 	}
 
-	read_model_vertex_data_godot(p_mesh, p_spb, p_base_offset, vertex_offsets, vertex_count, vertex_format);
-	//read_model_vertex_data(p_mesh, p_spb, p_base_offset, vertex_offsets, vertex_count, vertex_format);
+	read_model_vertex_data_godot(p_mesh, p_reader, p_base_offset, vertex_offsets, vertex_count, vertex_format);
+	//read_model_vertex_data(p_mesh, p_reader, p_base_offset, vertex_offsets, vertex_count, vertex_format);
 }
-void DIVAObjectSet::read_model(DIVAObject *p_obj, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset) {
+void DIVAObjectSet::read_model(DIVAObject *p_obj, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset, MeshReadJobs *r_jobs) {
 	const uint32_t mesh_size = 0xD8;
 
-	p_spb->seek(p_base_offset);
+	p_reader.seek(p_base_offset);
 
-	uint32_t signature = p_spb->get_u32();
-	p_spb->get_u32(); // flags
+	uint32_t signature = p_reader.get_u32();
+	p_reader.get_u32(); // flags
 
-	p_obj->bounding_sphere.center.x = p_spb->get_float();
-	p_obj->bounding_sphere.center.y = p_spb->get_float();
-	p_obj->bounding_sphere.center.z = p_spb->get_float();
-	p_obj->bounding_sphere.radius = p_spb->get_float();
+	p_obj->bounding_sphere.center.x = p_reader.get_float();
+	p_obj->bounding_sphere.center.y = p_reader.get_float();
+	p_obj->bounding_sphere.center.z = p_reader.get_float();
+	p_obj->bounding_sphere.radius = p_reader.get_float();
 
-	uint32_t mesh_count = p_spb->get_u32();
-	uint32_t meshes_offset = p_spb->get_u32();
-	uint32_t material_count = p_spb->get_u32();
-	uint32_t materials_offset = p_spb->get_u32();
+	uint32_t mesh_count = p_reader.get_u32();
+	uint32_t meshes_offset = p_reader.get_u32();
+	uint32_t material_count = p_reader.get_u32();
+	uint32_t materials_offset = p_reader.get_u32();
 
 	// 10 unused values?
-	p_spb->seek(p_spb->get_position() + sizeof(uint32_t) * 10);
+	p_reader.skip(sizeof(uint32_t) * 10);
 
 	p_obj->meshes.resize(mesh_count);
 
-	DIVAReadHelpers::OffsetQueue queue{
-		.spb = p_spb
-	};
-
 	for (uint32_t i = 0; i < mesh_count; i++) {
-		queue.position_push(p_base_offset + meshes_offset + mesh_size * i);
+		MeshReadJob job;
+		job.mesh = &p_obj->meshes[i];
+		job.base_offset = p_base_offset;
+		job.mesh_offset = p_base_offset + meshes_offset + mesh_size * i;
+		r_jobs->jobs.push_back(job);
+	}
+};
 
-		read_mesh(&p_obj->meshes[i], p_spb, p_base_offset);
+void DIVAObjectSet::_read_mesh_task(uint32_t p_index, MeshReadJobs *p_jobs) {
+	MeshReadJob &job = p_jobs->jobs[p_index];
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_view(*p_jobs->reader, job.mesh_offset);
+	read_mesh(job.mesh, reader, job.base_offset);
+	job.overflowed = reader.has_overflowed();
+}
+
+Ref<ArrayMesh> DIVAObjectSet::_build_mesh(const DIVAMesh &p_mesh) {
+	Array mesh_data;
+	mesh_data.resize(ArrayMesh::ARRAY_MAX);
+	Ref<ArrayMesh> am;
+	am.instantiate();
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_VERTEX)) {
+		mesh_data[ArrayMesh::ARRAY_VERTEX] = p_mesh.godot_vertex_data.positions;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_NORMAL)) {
+		mesh_data[ArrayMesh::ARRAY_NORMAL] = p_mesh.godot_vertex_data.normals;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_TANGENT)) {
+		mesh_data[ArrayMesh::ARRAY_TANGENT] = p_mesh.godot_vertex_data.tangents;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_TEX_UV)) {
+		mesh_data[ArrayMesh::ARRAY_TEX_UV] = p_mesh.godot_vertex_data.texcoord0;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_TEX_UV2)) {
+		mesh_data[ArrayMesh::ARRAY_TEX_UV2] = p_mesh.godot_vertex_data.texcoord1;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_COLOR)) {
+		mesh_data[ArrayMesh::ARRAY_COLOR] = p_mesh.godot_vertex_data.color0;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_WEIGHTS)) {
+		mesh_data[ArrayMesh::ARRAY_WEIGHTS] = p_mesh.godot_vertex_data.bone_weights;
+	}
+	if (p_mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_BONES)) {
+		mesh_data[ArrayMesh::ARRAY_BONES] = p_mesh.godot_vertex_data.bone_indices;
+	}
 
-		queue.position_pop();
+	for (const DIVASubmesh &submesh : p_mesh.submeshes) {
+		PackedInt32Array lv = submesh.index_array;
+		mesh_data[ArrayMesh::ARRAY_INDEX] = lv;
+		am->add_surface_from_arrays(diva_primitive_to_godot(submesh.primitive), mesh_data, TypedArray<Array>(), Dictionary(), p_mesh.godot_vertex_data.format);
 	}
-};
+	return am;
+}
+
+void DIVAObjectSet::_build_mesh_task(uint32_t p_index, DIVAMesh **p_meshes) {
+	p_meshes[p_index]->godot_mesh = _build_mesh(*p_meshes[p_index]);
+}
+
+void DIVAObjectSet::build_meshes() {
+	LocalVector<DIVAMesh *> meshes;
+	for (DIVAObject &object : objects) {
+		for (DIVAMesh &mesh : object.meshes) {
+			meshes.push_back(&mesh);
+		}
+	}
+	if (meshes.is_empty()) {
+		return;
+	}
+	WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &DIVAObjectSet::_build_mesh_task, meshes.ptr(), meshes.size(), -1, true, SNAME("DIVAObjectSetBuildMeshes"));
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+}
 
 void DIVAObjectSet::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_object_meshes", "object_name"), &DIVAObjectSet::get_object_meshes_bind);
 	ClassDB::bind_method(D_METHOD("read_classic", "spb"), &DIVAObjectSet::read_classic);
+	ClassDB::bind_method(D_METHOD("read_classic_file", "path"), &DIVAObjectSet::read_classic_file);
+	ClassDB::bind_method(D_METHOD("build_meshes"), &DIVAObjectSet::build_meshes);
 }
 
 void DIVAObjectSet::read_classic(Ref<StreamPeerBuffer> p_spb) {
-	uint32_t version = p_spb->get_u32();
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_stream_peer_buffer(p_spb);
+	read_classic_span(reader);
+	p_spb->seek(MIN(reader.get_position(), reader.get_size()));
+}
 
-	if (version != 0x05062500) {
-		return;
+Error DIVAObjectSet::read_classic_file(const String &p_path) {
+	DIVAReadHelpers::SpanReader reader;
+	Error err = reader.open_file(p_path);
+	if (err != OK) {
+		return err;
 	}
+	return read_classic_span(reader);
+}
+
+Error DIVAObjectSet::read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
+	uint32_t version = p_reader.get_u32();
 
-	uint32_t object_count = p_spb->get_u32();
+	ERR_FAIL_COND_V_MSG(version != 0x05062500, ERR_FILE_UNRECOGNIZED, vformat("Unsupported object set version 0x%08x.", version));
+
+	uint32_t object_count = p_reader.get_u32();
 
 	ObjectSetHeader header = {
-		.last_obj_id = p_spb->get_u32(),
-		.obj_datas_offset = p_spb->get_u32(),
-		.obj_skins_offset = p_spb->get_u32(),
-		.obj_names_offset = p_spb->get_u32(),
-		.obj_ids_offset = p_spb->get_u32(),
-		.tex_ids_offset = p_spb->get_u32(),
+		.last_obj_id = p_reader.get_u32(),
+		.obj_datas_offset = p_reader.get_u32(),
+		.obj_skins_offset = p_reader.get_u32(),
+		.obj_names_offset = p_reader.get_u32(),
+		.obj_ids_offset = p_reader.get_u32(),
+		.tex_ids_offset = p_reader.get_u32(),
 	};
 
-	uint32_t tex_id_count = p_spb->get_u32();
+	uint32_t tex_id_count = p_reader.get_u32();
 	// ??
-	p_spb->seek(p_spb->get_position() + 8);
+	p_reader.skip(8);
 
 	objects.resize(object_count);
 
-	DIVAReadHelpers::OffsetQueue queue{
-		.spb = p_spb
-	};
+	p_reader.position_push(header.obj_datas_offset);
 
-	queue.position_push(header.obj_datas_offset);
+	MeshReadJobs mesh_jobs;
+	mesh_jobs.reader = &p_reader;
 
 	for (uint32_t i = 0; i < object_count; i++) {
-		read_model(&objects[i], p_spb, p_spb->get_u32());
+		// read_model seeks to the model, come back to the offset table for the next one
+		uint32_t model_offset = p_reader.get_u32();
+		p_reader.position_push(model_offset);
+		read_model(&objects[i], p_reader, model_offset, &mesh_jobs);
+		p_reader.position_pop();
 	}
 
-	p_spb->seek(header.obj_names_offset);
+	// Vertex conversion is the bulk of the work, do every mesh in parallel
+	if (!mesh_jobs.jobs.is_empty()) {
+		WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &DIVAObjectSet::_read_mesh_task, &mesh_jobs, mesh_jobs.jobs.size(), -1, true, SNAME("DIVAObjectSetReadMeshes"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+		for (const MeshReadJob &job : mesh_jobs.jobs) {
+			if (job.overflowed) {
+				p_reader.set_overflowed();
+			}
+		}
+	}
+
+	p_reader.seek(header.obj_names_offset);
 	for (uint32_t i = 0; i < object_count; i++) {
-		objects[i].name = DIVAReadHelpers::read_null_terminated_string(p_spb->get_u32(), queue);
+		objects[i].name = p_reader.read_string_offset();
 		name_to_object_map.insert(StringName(objects[i].name), i);
 	}
 
-	queue.position_pop();
+	p_reader.position_pop();
+
+	return p_reader.has_overflowed() ? ERR_FILE_CORRUPT : OK;
 }
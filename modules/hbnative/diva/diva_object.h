@@ -2,12 +2,12 @@
 #define DIVA_OBJECT_H
 
 #include "core/io/stream_peer.h"
-#include "core/object/ref_counted.h"
+#include "core/io/resource.h"
 #include "read_helpers.h"
 #include "scene/resources/mesh.h"
 
-class DIVAObjectSet : public RefCounted {
-	GDCLASS(DIVAObjectSet, RefCounted);
+class DIVAObjectSet : public Resource {
+	GDCLASS(DIVAObjectSet, Resource);
 
 	struct DIVAVertexData {
 		Vector3 position;
@@ -114,6 +114,8 @@ class DIVAObjectSet : public RefCounted {
 		} godot_vertex_data;
 
 		DIVABoundingSphere bounding_sphere;
+		// Built by build_meshes()
+		Ref<ArrayMesh> godot_mesh;
 	};
 
 	struct DIVAObject {
@@ -125,18 +127,39 @@ class DIVAObjectSet : public RefCounted {
 	LocalVector<DIVAObject> objects;
 	HashMap<StringName, int> name_to_object_map;
 
-	static void read_submesh_indices(DIVASubmesh *p_submesh, uint32_t p_index_count, Ref<StreamPeerBuffer> p_spb);
-	static void read_submesh(DIVASubmesh *p_submesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset);
-	static void read_model_vertex_data(DIVAMesh *p_mesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format);
-	static void read_model_vertex_data_godot(DIVAMesh *p_mesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format);
-	static void read_mesh(DIVAMesh *p_mesh, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset);
-	static void read_model(DIVAObject *p_obj, Ref<StreamPeerBuffer> p_spb, uint32_t p_base_offset);
+	// Meshes are independent of each other, so they are parsed and built on the WorkerThreadPool
+	struct MeshReadJob {
+		DIVAMesh *mesh = nullptr;
+		uint32_t base_offset = 0;
+		uint32_t mesh_offset = 0;
+		bool overflowed = false;
+	};
+
+	struct MeshReadJobs {
+		const DIVAReadHelpers::SpanReader *reader = nullptr;
+		LocalVector<MeshReadJob> jobs;
+	};
+
+	void _read_mesh_task(uint32_t p_index, MeshReadJobs *p_jobs);
+	void _build_mesh_task(uint32_t p_index, DIVAMesh **p_meshes);
+	static Ref<ArrayMesh> _build_mesh(const DIVAMesh &p_mesh);
+
+	static void read_submesh_indices(DIVASubmesh *p_submesh, uint32_t p_index_count, DIVAReadHelpers::SpanReader &p_reader);
+	static void read_submesh(DIVASubmesh *p_submesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset);
+	static void read_model_vertex_data(DIVAMesh *p_mesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format);
+	static void read_model_vertex_data_godot(DIVAMesh *p_mesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset, uint32_t p_vertex_offsets[20], uint32_t p_vertex_count, uint32_t p_vertex_format);
+	static void read_mesh(DIVAMesh *p_mesh, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset);
+	static void read_model(DIVAObject *p_obj, DIVAReadHelpers::SpanReader &p_reader, uint32_t p_base_offset, MeshReadJobs *r_jobs);
 
 protected:
 	static void _bind_methods();
 
 public:
 	void read_classic(Ref<StreamPeerBuffer> p_spb);
+	Error read_classic_file(const String &p_path);
+	Error read_classic_span(DIVAReadHelpers::SpanReader &p_reader);
+	// Converts every mesh to an ArrayMesh in parallel, get_object_meshes returns these afterwards
+	void build_meshes();
 	const DIVAObject *get_object(const StringName &p_object_name) const {
 		HashMap<StringName, int>::ConstIterator it = name_to_object_map.find(p_object_name);
 		if (it == name_to_object_map.end()) {
@@ -187,42 +210,9 @@ public:
 	Vector<Ref<Mesh>> get_object_meshes(const StringName &p_object_name) const {
 		const DIVAObject *object = get_object(p_object_name);
 		Vector<Ref<Mesh>> meshes;
+		ERR_FAIL_NULL_V(object, meshes);
 		for (const DIVAMesh &mesh : object->meshes) {
-			Array mesh_data;
-			mesh_data.resize(ArrayMesh::ARRAY_MAX);
-			Ref<ArrayMesh> am;
-			am.instantiate();
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_VERTEX)) {
-				mesh_data[ArrayMesh::ARRAY_VERTEX] = mesh.godot_vertex_data.positions;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_NORMAL)) {
-				mesh_data[ArrayMesh::ARRAY_NORMAL] = mesh.godot_vertex_data.normals;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_TANGENT)) {
-				mesh_data[ArrayMesh::ARRAY_TANGENT] = mesh.godot_vertex_data.tangents;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_TEX_UV)) {
-				mesh_data[ArrayMesh::ARRAY_TEX_UV] = mesh.godot_vertex_data.texcoord0;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_TEX_UV2)) {
-				mesh_data[ArrayMesh::ARRAY_TEX_UV2] = mesh.godot_vertex_data.texcoord1;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_COLOR)) {
-				mesh_data[ArrayMesh::ARRAY_COLOR] = mesh.godot_vertex_data.color0;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_WEIGHTS)) {
-				mesh_data[ArrayMesh::ARRAY_WEIGHTS] = mesh.godot_vertex_data.bone_weights;
-			}
-			if (mesh.godot_vertex_data.format.has_flag(Mesh::ARRAY_FORMAT_BONES)) {
-				mesh_data[ArrayMesh::ARRAY_BONES] = mesh.godot_vertex_data.bone_indices;
-			}
-
-			for (const DIVASubmesh &submesh : mesh.submeshes) {
-				PackedInt32Array lv = submesh.index_array;
-				mesh_data[ArrayMesh::ARRAY_INDEX] = lv;
-				am->add_surface_from_arrays(diva_primitive_to_godot(submesh.primitive), mesh_data, TypedArray<Array>(), Dictionary(), mesh.godot_vertex_data.format);
-			}
-			meshes.push_back(am);
+			meshes.push_back(mesh.godot_mesh.is_valid() ? mesh.godot_mesh : _build_mesh(mesh));
 		}
 		return meshes;
 	};
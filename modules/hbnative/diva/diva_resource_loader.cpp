@@ -0,0 +1,93 @@
+#include "diva_resource_loader.h"
+
+#include "diva_object.h"
+#include "read_helpers.h"
+#include "sprite_set.h"
+
+static const uint32_t OBJECT_SET_SIGNATURE = 0x05062500;
+
+String ResourceFormatLoaderDIVA::_get_type_for_path(const String &p_path, const String &p_type_hint) {
+	if (p_path.get_extension().to_lower() != "bin") {
+		return String();
+	}
+	if (p_type_hint == "DIVAObjectSet" || p_type_hint == "DIVASpriteSet") {
+		return p_type_hint;
+	}
+	String file_name = p_path.get_file().get_basename().to_lower();
+	if (file_name.ends_with("_obj")) {
+		return "DIVAObjectSet";
+	}
+	if (file_name.begins_with("spr_")) {
+		return "DIVASpriteSet";
+	}
+	return String();
+}
+
+Ref<Resource> ResourceFormatLoaderDIVA::load(const String &p_path, const String &p_original_path, Error *r_error, bool p_use_sub_threads, float *r_progress, CacheMode p_cache_mode) {
+	DIVAReadHelpers::SpanReader reader;
+	Error err = reader.open_file(p_path);
+	if (r_error) {
+		*r_error = err;
+	}
+	if (err != OK) {
+		return Ref<Resource>();
+	}
+
+	// Object sets have a version signature, sprite sets start straight with their flags
+	bool is_object_set = reader.get_size() >= 4 && reader.get_u32() == OBJECT_SET_SIGNATURE;
+	reader.seek(0);
+
+	Ref<Resource> resource;
+	if (is_object_set) {
+		Ref<DIVAObjectSet> object_set;
+		object_set.instantiate();
+		err = object_set->read_classic_span(reader);
+		if (err != OK) {
+			if (r_error) {
+				*r_error = err;
+			}
+			ERR_FAIL_V_MSG(Ref<Resource>(), vformat("Failed to read DIVA object set \"%s\".", p_path));
+		}
+		if (r_progress) {
+			*r_progress = 0.5f;
+		}
+		object_set->build_meshes();
+		resource = object_set;
+	} else {
+		Ref<DIVASpriteSet> sprite_set;
+		sprite_set.instantiate();
+		err = sprite_set->read_classic_span(reader);
+		if (err != OK) {
+			if (r_error) {
+				*r_error = err;
+			}
+			ERR_FAIL_V_MSG(Ref<Resource>(), vformat("Failed to read DIVA sprite set \"%s\".", p_path));
+		}
+		resource = sprite_set;
+	}
+
+	if (r_progress) {
+		*r_progress = 1.0f;
+	}
+	return resource;
+}
+
+void ResourceFormatLoaderDIVA::get_recognized_extensions(List<String> *p_extensions) const {
+	// Not registering .bin on purpose, every other .bin file would be treated as a resource
+}
+
+bool ResourceFormatLoaderDIVA::recognize_path(const String &p_path, const String &p_for_type) const {
+	String type = _get_type_for_path(p_path, p_for_type);
+	if (type.is_empty()) {
+		return false;
+	}
+	return p_for_type.is_empty() || ClassDB::is_parent_class(type, p_for_type);
+}
+
+bool ResourceFormatLoaderDIVA::handles_type(const String &p_type) const {
+	return p_type == "DIVAObjectSet" || p_type == "DIVASpriteSet";
+}
+
+String ResourceFormatLoaderDIVA::get_resource_type(const String &p_path) const {
+	return _get_type_for_path(p_path, String());
+}
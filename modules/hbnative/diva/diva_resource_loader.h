@@ -0,0 +1,20 @@
+#ifndef DIVA_RESOURCE_LOADER_H
+#define DIVA_RESOURCE_LOADER_H
+
+#include "core/io/resource_loader.h"
+
+// Loads DIVA object sets (*_obj.bin) and sprite sets (spr_*.bin) so they can be loaded in the background with
+// ResourceLoader::load_threaded_request. DIVA files all share the .bin extension, so paths are recognized by
+// their name (or an explicit type hint) instead of registering the extension.
+class ResourceFormatLoaderDIVA : public ResourceFormatLoader {
+	static String _get_type_for_path(const String &p_path, const String &p_type_hint);
+
+public:
+	virtual Ref<Resource> load(const String &p_path, const String &p_original_path = "", Error *r_error = nullptr, bool p_use_sub_threads = false, float *r_progress = nullptr, CacheMode p_cache_mode = CACHE_MODE_REUSE) override;
+	virtual void get_recognized_extensions(List<String> *p_extensions) const override;
+	virtual bool recognize_path(const String &p_path, const String &p_for_type = String()) const override;
+	virtual bool handles_type(const String &p_type) const override;
+	virtual String get_resource_type(const String &p_path) const override;
+};
+
+#endif // DIVA_RESOURCE_LOADER_H
@@ -2,6 +2,7 @@
 #define MOTION_H
 
 #include "core/io/stream_peer.h"
+#include "read_helpers.h"
 
 class DIVAMotion {
 	enum mot_key_set_type {
@@ -50,65 +51,61 @@ class DIVAMotion {
 		LocalVector<key_set_data> key_sets;
 	};
 
-	static void align_read(Ref<StreamPeerBuffer> &p_stream, int align) {
-		int64_t position = p_stream->get_position();
-		size_t temp_align = align - position % align;
-		if (align != temp_align) {
-			p_stream->seek(position + temp_align);
-		}
+public:
+	void read_classic(Ref<StreamPeerBuffer> p_stream) {
+		DIVAReadHelpers::SpanReader reader;
+		reader.set_stream_peer_buffer(p_stream);
+		read_classic_span(reader);
+		p_stream->seek(MIN(reader.get_position(), reader.get_size()));
 	}
 
-	void read_classic(Ref<StreamPeerBuffer> p_stream) {
+	void read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
 		motion_header_classic header{
-			.key_set_info_offset = p_stream->get_u32(),
-			.key_set_types_offset = p_stream->get_u32(),
-			.key_set_offset = p_stream->get_u32(),
-			.bone_info_offset = p_stream->get_u32()
+			.key_set_info_offset = p_reader.get_u32(),
+			.key_set_types_offset = p_reader.get_u32(),
+			.key_set_offset = p_reader.get_u32(),
+			.bone_info_offset = p_reader.get_u32()
 		};
 
-		p_stream->seek(header.key_set_info_offset);
+		p_reader.seek(header.key_set_info_offset);
 
 		motion_data data;
-		data.info = p_stream->get_u16();
-		data.frame_count = p_stream->get_u16();
+		data.info = p_reader.get_u16();
+		data.frame_count = p_reader.get_u16();
 
 		// Bone info
 		{
-			p_stream->seek(header.bone_info_offset);
+			p_reader.seek(header.bone_info_offset);
 			uint32_t bone_info_count = 0;
 			do {
 				bone_info_count++;
-			} while (p_stream->get_u16() != 0 && p_stream->get_position() < p_stream->get_size());
+			} while (p_reader.get_u16() != 0 && p_reader.get_available_bytes() > 0);
 
+			data.bone_info_count = bone_info_count;
 			data.bone_info.resize(bone_info_count);
 
-			p_stream->seek(header.bone_info_offset);
-
-			key_bone_info *bone_info = data.bone_info.ptr();
-			for (int i = 0; i < data.bone_info_count; i++) {
-				bone_info[i].index = p_stream->get_u16();
-			}
+			p_reader.seek(header.bone_info_offset);
+			p_reader.read_array((uint16_t *)data.bone_info.ptr(), bone_info_count);
 		}
 
 		uint32_t key_set_count = data.key_set_count;
+		data.key_sets.resize(key_set_count);
 		key_set_data *key_set_arr = data.key_sets.ptr();
 
 		// Key set type
 		{
-			data.key_sets.resize(key_set_count);
-
-			p_stream->seek(header.key_set_types_offset);
+			p_reader.seek(header.key_set_types_offset);
 
 			for (int32_t j = 0, b = 0; j < data.key_set_count; j++) {
 				if (!(j % 8))
-					b = p_stream->get_u16();
+					b = p_reader.get_u16();
 
 				key_set_arr[j].type = (mot_key_set_type)((b >> (j % 8 * 2)) & 0x03);
 			}
 		}
 
 		{
-			p_stream->seek(header.key_set_offset);
+			p_reader.seek(header.key_set_offset);
 
 			for (uint32_t i = 0; i < key_set_count; i++) {
 				key_set_data *ks_data = &key_set_arr[i];
@@ -120,24 +117,20 @@ class DIVAMotion {
 					ks_data->keys_count = 1;
 					ks_data->frames.clear();
 					ks_data->values.clear();
-					ks_data->values.push_back(p_stream->get_float());
+					ks_data->values.push_back(p_reader.get_float());
 				} else {
 					bool has_tangents = ks_data->type != MOT_KEY_SET_HERMITE;
-					uint16_t keys_count = p_stream->get_u16();
+					uint16_t keys_count = p_reader.get_u16();
 					ks_data->keys_count = keys_count;
 
 					ks_data->frames.resize(keys_count);
 					ks_data->values.resize(has_tangents ? keys_count * 2ULL : keys_count);
 
-					p_stream->get_data((uint8_t *)(ks_data->frames.ptr()), sizeof(uint16_t) * keys_count);
+					p_reader.read_array(ks_data->frames.ptr(), keys_count);
 
-					align_read(p_stream, 0x04);
+					p_reader.align(0x04);
 
-					if (!has_tangents) {
-						p_stream->get_data((uint8_t *)ks_data->values.ptr(), sizeof(float_t) * keys_count);
-					} else {
-						p_stream->get_data((uint8_t *)ks_data->values.ptr(), sizeof(float_t) * keys_count * 2ULL);
-					}
+					p_reader.read_array(ks_data->values.ptr(), ks_data->values.size());
 				}
 			}
 		}
@@ -4,7 +4,14 @@
 #include "read_helpers.h"
 
 void DIVAMotionDB::read(Ref<StreamPeerBuffer> p_stream) {
-	ERR_FAIL_COND_MSG(p_stream->get_u32() != 0x1, "DIVA motion DB had incorrect magic number");
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_stream_peer_buffer(p_stream);
+	read_span(reader);
+	p_stream->seek(MIN(reader.get_position(), reader.get_size()));
+}
+
+void DIVAMotionDB::read_span(DIVAReadHelpers::SpanReader &p_reader) {
+	ERR_FAIL_COND_MSG(p_reader.get_u32() != 0x1, "DIVA motion DB had incorrect magic number");
 	struct {
 		uint32_t motion_sets_offset;
 		uint32_t motion_set_ids_offset;
@@ -12,61 +19,57 @@ void DIVAMotionDB::read(Ref<StreamPeerBuffer> p_stream) {
 		uint32_t bone_name_offsets_offset;
 		uint32_t bone_name_count;
 	} header{
-		.motion_sets_offset = p_stream->get_u32(),
-		.motion_set_ids_offset = p_stream->get_u32(),
-		.motion_set_count = p_stream->get_u32(),
-		.bone_name_offsets_offset = p_stream->get_u32(),
-		.bone_name_count = p_stream->get_u32()
+		.motion_sets_offset = p_reader.get_u32(),
+		.motion_set_ids_offset = p_reader.get_u32(),
+		.motion_set_count = p_reader.get_u32(),
+		.bone_name_offsets_offset = p_reader.get_u32(),
+		.bone_name_count = p_reader.get_u32()
 	};
 
 	motion_set_infos.resize(header.motion_set_count);
 
-	DIVAReadHelpers::OffsetQueue offset_queue{
-		.spb = p_stream,
-	};
-
-	offset_queue.position_push(header.motion_sets_offset);
+	p_reader.position_push(header.motion_sets_offset);
 	MotionSetInfo *mot_set = motion_set_infos.ptr();
 	for (int i = 0; i < header.motion_set_count; i++) {
-		uint32_t name_offset = p_stream->get_u32();
-		uint32_t motion_name_offsets_offset = p_stream->get_u32();
-		uint32_t motion_count = p_stream->get_u32();
-		uint32_t motion_ids_offset = p_stream->get_u32();
+		uint32_t name_offset = p_reader.get_u32();
+		uint32_t motion_name_offsets_offset = p_reader.get_u32();
+		uint32_t motion_count = p_reader.get_u32();
+		uint32_t motion_ids_offset = p_reader.get_u32();
 
-		mot_set[i].name = DIVAReadHelpers::read_null_terminated_string(name_offset, offset_queue);
+		mot_set[i].name = p_reader.read_null_terminated_string(name_offset);
 		mot_set[i].motions.resize(motion_count);
 
 		MotionInfo *mot_infos = mot_set[i].motions.ptr();
 
-		offset_queue.position_push(motion_name_offsets_offset);
+		p_reader.position_push(motion_name_offsets_offset);
 		for (int j = 0; j < motion_count; j++) {
-			uint32_t string_pos = p_stream->get_u32();
-			mot_infos[j].name = DIVAReadHelpers::read_null_terminated_string(string_pos, offset_queue);
+			uint32_t string_pos = p_reader.get_u32();
+			mot_infos[j].name = p_reader.read_null_terminated_string(string_pos);
 		}
-		offset_queue.position_pop();
+		p_reader.position_pop();
 
-		offset_queue.position_push(motion_ids_offset);
+		p_reader.position_push(motion_ids_offset);
 		for (int j = 0; j < motion_count; j++) {
-			mot_infos[j].id = p_stream->get_u32();
+			mot_infos[j].id = p_reader.get_u32();
 		}
-		offset_queue.position_pop();
+		p_reader.position_pop();
 	}
-	offset_queue.position_pop();
+	p_reader.position_pop();
 
-	offset_queue.position_push(header.motion_set_ids_offset);
+	p_reader.position_push(header.motion_set_ids_offset);
 	for (int i = 0; i < header.motion_set_count; i++) {
-		mot_set[i].id = p_stream->get_u32();
+		mot_set[i].id = p_reader.get_u32();
 	}
-	offset_queue.position_pop();
+	p_reader.position_pop();
 
 	bone_names.resize(header.bone_name_count);
-	offset_queue.position_push(header.bone_name_offsets_offset);
+	p_reader.position_push(header.bone_name_offsets_offset);
 	String *bone_names_ptr = bone_names.ptr();
 	for (int i = 0; i < header.bone_name_count; i++) {
-		uint32_t string_pos = p_stream->get_u32();
-		bone_names_ptr[i] = DIVAReadHelpers::read_null_terminated_string(string_pos, offset_queue);
+		uint32_t string_pos = p_reader.get_u32();
+		bone_names_ptr[i] = p_reader.read_null_terminated_string(string_pos);
 	}
-	offset_queue.position_pop();
+	p_reader.position_pop();
 }
 
 void DIVAMotionDB::dump_json(const String &p_path) const {
@@ -4,6 +4,7 @@
 #include "core/io/stream_peer.h"
 #include "core/string/ustring.h"
 #include "core/templates/local_vector.h"
+#include "read_helpers.h"
 
 class DIVAMotionDB {
 	struct MotionInfo {
@@ -21,6 +22,7 @@ class DIVAMotionDB {
 
 public:
 	void read(Ref<StreamPeerBuffer> p_stream);
+	void read_span(DIVAReadHelpers::SpanReader &p_reader);
 	void dump_json(const String &p_path) const;
 };
 
@@ -29,40 +29,43 @@ class DIVAObjectDB : public RefCounted {
 
 public:
 	void read_classic(Ref<StreamPeerBuffer> p_spb) {
-		DIVAReadHelpers::OffsetQueue queue{
-			.spb = p_spb
-		};
+		DIVAReadHelpers::SpanReader reader;
+		reader.set_stream_peer_buffer(p_spb);
+		read_classic_span(reader);
+		p_spb->seek(MIN(reader.get_position(), reader.get_size()));
+	}
 
-		uint32_t object_set_count = p_spb->get_u32();
-		uint32_t max_object_set_id = p_spb->get_u32();
-		uint32_t object_sets_offset = p_spb->get_u32();
-		uint32_t object_count = p_spb->get_u32();
-		uint32_t objects_offset = p_spb->get_u32();
+	void read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
+		uint32_t object_set_count = p_reader.get_u32();
+		uint32_t max_object_set_id = p_reader.get_u32();
+		uint32_t object_sets_offset = p_reader.get_u32();
+		uint32_t object_count = p_reader.get_u32();
+		uint32_t objects_offset = p_reader.get_u32();
 
 		object_sets.resize(object_set_count);
 
-		queue.position_push(object_sets_offset);
+		p_reader.position_push(object_sets_offset);
 		for (uint32_t i = 0; i < object_set_count; i++) {
 			ObjectSet &set = object_sets[i];
-			set.name = DIVAReadHelpers::read_null_terminated_string(p_spb->get_u32(), queue);
-			set.id = p_spb->get_u32();
-			set.object_file_name = DIVAReadHelpers::read_null_terminated_string(p_spb->get_u32(), queue);
-			set.texture_file_name = DIVAReadHelpers::read_null_terminated_string(p_spb->get_u32(), queue);
-			set.archive_file_name = DIVAReadHelpers::read_null_terminated_string(p_spb->get_u32(), queue);
+			set.name = p_reader.read_string_offset();
+			set.id = p_reader.get_u32();
+			set.object_file_name = p_reader.read_string_offset();
+			set.texture_file_name = p_reader.read_string_offset();
+			set.archive_file_name = p_reader.read_string_offset();
 			// ???
-			p_spb->seek(p_spb->get_position() + 0x10);
+			p_reader.skip(0x10);
 			object_set_id_map.insert(set.id, i);
 		}
-		queue.position_pop();
+		p_reader.position_pop();
 
-		queue.position_push(objects_offset);
+		p_reader.position_push(objects_offset);
 		for (uint32_t i = 0; i < object_count; i++) {
-			uint32_t id = p_spb->get_u16();
-			uint32_t set_id = p_spb->get_u16();
-			uint32_t name_offset = p_spb->get_u32();
+			uint32_t id = p_reader.get_u16();
+			uint32_t set_id = p_reader.get_u16();
+			uint32_t name_offset = p_reader.get_u32();
 			DIVAObject object = {
 				.id = id,
-				.name = DIVAReadHelpers::read_null_terminated_string(name_offset, queue)
+				.name = p_reader.read_null_terminated_string(name_offset)
 			};
 			HashMap<uint32_t, int>::Iterator it = object_set_id_map.find(set_id);
 			if (it == object_set_id_map.end()) {
@@ -70,7 +73,7 @@ public:
 			}
 			object_sets[it->value].objects.push_back(object);
 		}
-		queue.position_pop();
+		p_reader.position_pop();
 	}
 
 	void dump_json(const String &p_path) {
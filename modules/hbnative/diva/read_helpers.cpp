@@ -0,0 +1,80 @@
+#include "read_helpers.h"
+
+#include "core/config/project_settings.h"
+#include "core/io/file_access.h"
+
+#ifdef UNIX_ENABLED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DIVAReadHelpers {
+
+void SpanReader::_unmap() {
+#ifdef UNIX_ENABLED
+	if (mapping) {
+		munmap(mapping, mapping_size);
+	}
+#endif
+	mapping = nullptr;
+	mapping_size = 0;
+}
+
+Error SpanReader::open_file(const String &p_path) {
+	_unmap();
+	buffer.clear();
+	set_span(nullptr, 0);
+
+#ifdef UNIX_ENABLED
+	// res:// may point inside a pack, only files that are guaranteed to be on disk get mapped
+	if (!p_path.begins_with("res://")) {
+		String global_path = ProjectSettings::get_singleton()->globalize_path(p_path);
+		int fd = ::open(global_path.utf8().get_data(), O_RDONLY | O_CLOEXEC);
+		if (fd != -1) {
+			struct stat st;
+			void *mapped = MAP_FAILED;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+			::close(fd);
+			if (mapped != MAP_FAILED) {
+				madvise(mapped, st.st_size, MADV_WILLNEED);
+				mapping = mapped;
+				mapping_size = st.st_size;
+				set_span((const uint8_t *)mapping, mapping_size);
+				return OK;
+			}
+		}
+	}
+#endif
+
+	Error err;
+	Vector<uint8_t> file_buffer = FileAccess::get_file_as_bytes(p_path, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, vformat("Can't open DIVA file \"%s\".", p_path));
+	set_buffer(file_buffer);
+	return OK;
+}
+
+void SpanReader::set_stream_peer_buffer(const Ref<StreamPeerBuffer> &p_spb) {
+	ERR_FAIL_COND(p_spb.is_null());
+	set_buffer(p_spb->get_data_array(), p_spb->get_position());
+	big_endian = p_spb->is_big_endian_enabled();
+}
+
+void SpanReader::set_buffer(const Vector<uint8_t> &p_buffer, uint64_t p_position) {
+	_unmap();
+	buffer = p_buffer;
+	set_span(buffer.ptr(), buffer.size(), p_position);
+}
+
+void SpanReader::set_span(const uint8_t *p_data, uint64_t p_size, uint64_t p_position) {
+	data = p_data;
+	size = p_size;
+	position = p_position;
+	overflowed = false;
+	position_stack.clear();
+}
+
+} //namespace DIVAReadHelpers
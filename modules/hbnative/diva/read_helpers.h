@@ -2,38 +2,226 @@
 #define READ_HELPERS_H
 
 #include "core/io/stream_peer.h"
-#include <stack>
+#include "core/templates/local_vector.h"
+
+#include <cstring>
 
 namespace DIVAReadHelpers {
-struct OffsetQueue {
-	Ref<StreamPeerBuffer> spb;
-	std::stack<int> position_queue;
-	void position_push(int p_pos) {
-		position_queue.push(spb->get_position());
-		spb->seek(p_pos);
+// Reads straight out of a memory span instead of going through StreamPeer's per field virtual calls,
+// the span is either the StreamPeerBuffer's own array (no copy), a memory mapped file or a FileAccess
+// loaded buffer. Reads past the end fail, return zeros and latch the error so parsers can bail out once.
+class SpanReader {
+	const uint8_t *data = nullptr;
+	uint64_t size = 0;
+	uint64_t position = 0;
+	bool big_endian = false;
+	bool overflowed = false;
+
+	Vector<uint8_t> buffer;
+	void *mapping = nullptr;
+	uint64_t mapping_size = 0;
+
+	LocalVector<uint64_t> position_stack;
+
+	void _unmap();
+
+	_FORCE_INLINE_ bool _check_read(uint64_t p_bytes) {
+		if (unlikely(p_bytes > size - MIN(position, size))) {
+			// Only report the first overrun, everything read after it is garbage anyway
+			if (!overflowed) {
+				overflowed = true;
+				ERR_FAIL_V_MSG(false, vformat("Tried to read %d bytes at %d, but the buffer is only %d bytes long.", p_bytes, position, size));
+			}
+			return false;
+		}
+		return true;
 	}
+
+	template <typename T>
+	static _FORCE_INLINE_ T _swap(T p_value) {
+		if constexpr (sizeof(T) == 2) {
+			uint16_t bits;
+			memcpy(&bits, &p_value, 2);
+			bits = BSWAP16(bits);
+			memcpy(&p_value, &bits, 2);
+		} else if constexpr (sizeof(T) == 4) {
+			uint32_t bits;
+			memcpy(&bits, &p_value, 4);
+			bits = BSWAP32(bits);
+			memcpy(&p_value, &bits, 4);
+		} else if constexpr (sizeof(T) == 8) {
+			uint64_t bits;
+			memcpy(&bits, &p_value, 8);
+			bits = BSWAP64(bits);
+			memcpy(&p_value, &bits, 8);
+		}
+		return p_value;
+	}
+
+	template <typename T>
+	_FORCE_INLINE_ T _decode(const uint8_t *p_src) const {
+		T value;
+		memcpy(&value, p_src, sizeof(T));
+		return big_endian ? _swap(value) : value;
+	}
+
+public:
+	SpanReader() {}
+	SpanReader(const SpanReader &) = delete;
+	SpanReader &operator=(const SpanReader &) = delete;
+	~SpanReader() { _unmap(); }
+
+	// Maps the file when it lives on the real filesystem, otherwise (packs, res:// in exports) loads it through FileAccess
+	Error open_file(const String &p_path);
+	// Shares the array with the StreamPeerBuffer and starts at its current position
+	void set_stream_peer_buffer(const Ref<StreamPeerBuffer> &p_spb);
+	void set_buffer(const Vector<uint8_t> &p_buffer, uint64_t p_position = 0);
+	// The caller keeps p_data alive for as long as the reader is used
+	void set_span(const uint8_t *p_data, uint64_t p_size, uint64_t p_position = 0);
+
+	// Reads the same span as p_source without owning it, for parsing independent parts on other threads.
+	// p_source has to outlive this reader.
+	void set_view(const SpanReader &p_source, uint64_t p_position = 0) {
+		set_span(p_source.data, p_source.size, p_position);
+		big_endian = p_source.big_endian;
+	}
+
+	void set_big_endian(bool p_big_endian) { big_endian = p_big_endian; }
+	bool is_big_endian() const { return big_endian; }
+	bool has_overflowed() const { return overflowed; }
+	void set_overflowed() { overflowed = true; }
+	bool is_memory_mapped() const { return mapping != nullptr; }
+
+	_FORCE_INLINE_ uint64_t get_position() const { return position; }
+	_FORCE_INLINE_ uint64_t get_size() const { return size; }
+	_FORCE_INLINE_ uint64_t get_available_bytes() const { return size - MIN(position, size); }
+	_FORCE_INLINE_ void seek(uint64_t p_position) { position = p_position; }
+	_FORCE_INLINE_ void skip(uint64_t p_bytes) { position += p_bytes; }
+
+	void align(uint64_t p_alignment) {
+		uint64_t remainder = position % p_alignment;
+		if (remainder != 0) {
+			position += p_alignment - remainder;
+		}
+	}
+
+	void position_push(uint64_t p_position) {
+		position_stack.push_back(position);
+		position = p_position;
+	}
+
 	void position_pop() {
-		int pos = position_queue.top();
-		position_queue.pop();
-		spb->seek(pos);
+		ERR_FAIL_COND(position_stack.is_empty());
+		position = position_stack[position_stack.size() - 1];
+		position_stack.remove_at(position_stack.size() - 1);
 	}
-};
 
-static String read_null_terminated_string(int p_string_pos, OffsetQueue &p_queue) {
-	int length = 0;
-	uint8_t chr;
+	uint32_t get_position_depth() const { return position_stack.size(); }
 
-	p_queue.position_push(p_string_pos);
-	while (p_queue.spb->get_available_bytes() > 0 && (chr = p_queue.spb->get_u8()) != 0) {
-		length++;
+	// Unwinds every push made after get_position_depth() returned p_depth, for parsers bailing out mid way
+	void position_restore(uint32_t p_depth) {
+		ERR_FAIL_COND(p_depth > position_stack.size());
+		if (p_depth < position_stack.size()) {
+			position = position_stack[p_depth];
+			position_stack.resize(p_depth);
+		}
 	}
-	p_queue.position_pop();
 
-	p_queue.position_push(p_string_pos);
-	String out = p_queue.spb->get_string(length);
-	p_queue.position_pop();
-	return out;
-}
+	template <typename T>
+	_FORCE_INLINE_ T read() {
+		if (!_check_read(sizeof(T))) {
+			return T();
+		}
+		T value = _decode<T>(data + position);
+		position += sizeof(T);
+		return value;
+	}
+
+	_FORCE_INLINE_ uint8_t get_u8() { return read<uint8_t>(); }
+	_FORCE_INLINE_ uint16_t get_u16() { return read<uint16_t>(); }
+	_FORCE_INLINE_ uint32_t get_u32() { return read<uint32_t>(); }
+	_FORCE_INLINE_ int32_t get_32() { return read<int32_t>(); }
+	_FORCE_INLINE_ float get_float() { return read<float>(); }
+
+	// Returns a pointer into the span and advances past it, no copy is made
+	const uint8_t *read_span(uint64_t p_bytes) {
+		if (!_check_read(p_bytes)) {
+			return nullptr;
+		}
+		const uint8_t *span = data + position;
+		position += p_bytes;
+		return span;
+	}
+
+	void get_data(uint8_t *r_dst, uint64_t p_bytes) {
+		const uint8_t *src = read_span(p_bytes);
+		if (!src) {
+			memset(r_dst, 0, p_bytes);
+			return;
+		}
+		memcpy(r_dst, src, p_bytes);
+	}
+
+	// Bulk copy of p_count values, byte swapped in place when the data is big endian
+	template <typename T>
+	void read_array(T *r_dst, uint64_t p_count) {
+		get_data((uint8_t *)r_dst, p_count * sizeof(T));
+		if (big_endian && sizeof(T) > 1) {
+			for (uint64_t i = 0; i < p_count; i++) {
+				r_dst[i] = _swap(r_dst[i]);
+			}
+		}
+	}
+
+	// Decodes p_count values of type TSrc into a wider destination type
+	template <typename TSrc, typename TDst>
+	void read_array_as(TDst *r_dst, uint64_t p_count) {
+		const uint8_t *src = read_span(p_count * sizeof(TSrc));
+		if (!src) {
+			memset((void *)r_dst, 0, p_count * sizeof(TDst));
+			return;
+		}
+		for (uint64_t i = 0; i < p_count; i++) {
+			r_dst[i] = (TDst)_decode<TSrc>(src + i * sizeof(TSrc));
+		}
+	}
+
+	void read_vector2_array(Vector2 *r_dst, uint64_t p_count) {
+#ifdef REAL_T_IS_DOUBLE
+		read_array_as<float>((real_t *)r_dst, p_count * 2);
+#else
+		read_array((float *)r_dst, p_count * 2);
+#endif
+	}
+
+	void read_vector3_array(Vector3 *r_dst, uint64_t p_count) {
+#ifdef REAL_T_IS_DOUBLE
+		read_array_as<float>((real_t *)r_dst, p_count * 3);
+#else
+		read_array((float *)r_dst, p_count * 3);
+#endif
+	}
+
+	void read_color_array(Color *r_dst, uint64_t p_count) {
+		read_array((float *)r_dst, p_count * 4);
+	}
+
+	// Latin-1 string at an absolute offset, doesn't move the read position
+	String read_null_terminated_string(uint64_t p_string_pos) const {
+		if (p_string_pos >= size) {
+			return String();
+		}
+		const char *str = (const char *)data + p_string_pos;
+		const void *terminator = memchr(str, 0, size - p_string_pos);
+		int length = terminator ? (const char *)terminator - str : size - p_string_pos;
+		return String(str, length);
+	}
+
+	// Reads a string offset at the current position and returns the string it points to
+	String read_string_offset() {
+		return read_null_terminated_string(get_u32());
+	}
+};
 }; //namespace DIVAReadHelpers
 
 #endif // READ_HELPERS_H
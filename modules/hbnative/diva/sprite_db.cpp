@@ -1,46 +1,49 @@
 #include "sprite_db.h"
 
 void DIVASpriteDB::read_classic(Ref<StreamPeerBuffer> p_stream) {
-	uint32_t sprite_sets_count = p_stream->get_u32();
-	uint32_t sprite_sets_offset = p_stream->get_u32();
-	uint32_t sprites_count = p_stream->get_u32();
-	uint32_t sprites_offset = p_stream->get_u32();
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_stream_peer_buffer(p_stream);
+	read_classic_span(reader);
+	p_stream->seek(MIN(reader.get_position(), reader.get_size()));
+}
 
-	sprite_sets.resize(sprite_sets_count);
+void DIVASpriteDB::read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
+	uint32_t sprite_sets_count = p_reader.get_u32();
+	uint32_t sprite_sets_offset = p_reader.get_u32();
+	uint32_t sprites_count = p_reader.get_u32();
+	uint32_t sprites_offset = p_reader.get_u32();
 
-	DIVAReadHelpers::OffsetQueue queue{
-		.spb = p_stream
-	};
+	sprite_sets.resize(sprite_sets_count);
 
-	queue.position_push(sprite_sets_offset);
+	p_reader.position_push(sprite_sets_offset);
 	for (uint32_t i = 0; i < sprite_sets_count; i++) {
 		SpriteSetInfo *spr_set = &sprite_sets[i];
-		spr_set->id = p_stream->get_u32();
-		spr_set->name = DIVAReadHelpers::read_null_terminated_string(p_stream->get_u32(), queue);
-		spr_set->file_name = DIVAReadHelpers::read_null_terminated_string(p_stream->get_u32(), queue);
-		spr_set->index = p_stream->get_u32();
+		spr_set->id = p_reader.get_u32();
+		spr_set->name = p_reader.read_string_offset();
+		spr_set->file_name = p_reader.read_string_offset();
+		spr_set->index = p_reader.get_u32();
 	}
-	queue.position_pop();
+	p_reader.position_pop();
 
-	queue.position_push(sprites_offset);
+	p_reader.position_push(sprites_offset);
 	for (uint32_t i = 0; i < sprites_count; i++) {
 		SpriteInfo sprite_info{
-			.id = p_stream->get_u32(),
+			.id = p_reader.get_u32(),
 		};
 
-		uint32_t name_offset = p_stream->get_u32();
-		uint32_t info_bitfield = p_stream->get_u32();
+		uint32_t name_offset = p_reader.get_u32();
+		uint32_t info_bitfield = p_reader.get_u32();
 
 		uint16_t index = (uint16_t)(info_bitfield & 0xFFFF);
 		uint16_t set_index = (uint16_t)((info_bitfield >> 16) & 0x0FFF);
 		sprite_info.texture = !!((info_bitfield >> 16) & 0x1000);
 
 		SpriteSetInfo *spr_set = &sprite_sets[set_index];
-		sprite_info.name = StringName(DIVAReadHelpers::read_null_terminated_string(name_offset, queue));
+		sprite_info.name = StringName(p_reader.read_null_terminated_string(name_offset));
 		sprite_info.index = index;
 		spr_set->sprites.insert(sprite_info.name, sprite_info);
 	}
-	queue.position_pop();
+	p_reader.position_pop();
 }
 
 void DIVASpriteDB::dump_json(const String &p_path) {
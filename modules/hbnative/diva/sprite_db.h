@@ -26,6 +26,7 @@ class DIVASpriteDB : public RefCounted {
 
 public:
 	void read_classic(Ref<StreamPeerBuffer> p_stream);
+	void read_classic_span(DIVAReadHelpers::SpanReader &p_reader);
 	void dump_json(const String &p_path);
 	int get_sprite_set_idx_by_name(const StringName &p_name) const;
 	int get_sprite_idx_by_name(int p_set_idx, const StringName &p_name) const;
@@ -3,7 +3,9 @@
 
 #include "core/error/error_macros.h"
 #include "core/io/json.h"
+#include "core/io/resource.h"
 #include "core/io/stream_peer.h"
+#include "core/object/worker_thread_pool.h"
 #include "read_helpers.h"
 #include "scene/resources/image_texture.h"
 #include "scene/resources/texture.h"
@@ -78,7 +80,8 @@ class DivaTXP : public RefCounted {
 		Size2i size;
 		DIVATextureFormat format;
 		uint32_t id;
-		LocalVector<uint8_t> data;
+		uint32_t data_offset = 0;
+		Vector<uint8_t> data;
 	};
 	struct DIVATexture {
 		bool cube_map;
@@ -88,6 +91,86 @@ class DivaTXP : public RefCounted {
 	};
 	LocalVector<DIVATexture> textures;
 
+	struct TextureReadJobs {
+		const DIVAReadHelpers::SpanReader *reader = nullptr;
+		uint32_t first_texture = 0;
+	};
+
+	// Headers are parsed first, then the mipmap bytes of every texture are copied out on the WorkerThreadPool.
+	// This is only a copy, no decoding happens here: the data is handed to Image in its stored format
+	void _read_texture_task(uint32_t p_index, const TextureReadJobs *p_jobs) {
+		DIVAReadHelpers::SpanReader reader;
+		reader.set_view(*p_jobs->reader);
+		for (DIVAMipmap &mipmap : textures[p_jobs->first_texture + p_index].mipmaps) {
+			reader.seek(mipmap.data_offset);
+			reader.get_data(mipmap.data.ptrw(), mipmap.data.size());
+		}
+	}
+
+	// Appends the headers of every texture to textures, the mipmap data is sized but left unfilled
+	Error _read_texture_headers(DIVAReadHelpers::SpanReader &p_reader, uint32_t p_set_start, uint32_t p_texture_count) {
+		for (uint32_t i = 0; i < p_texture_count; i++) {
+			uint32_t texture_start = p_set_start + p_reader.get_u32();
+			p_reader.position_push(texture_start);
+
+			uint32_t txp_signature = p_reader.get_u32();
+			if (txp_signature != 0x04505854 && txp_signature != 0x05505854) {
+				p_reader.position_pop();
+				continue;
+			}
+
+			uint32_t subtex_count = p_reader.get_u32();
+			uint32_t tex_info = p_reader.get_u32();
+
+			DIVATexture tex = {
+				.cube_map = txp_signature == 0x05505854,
+				.array_size = (tex_info >> 8) & 0xFF,
+				.mipmap_count = tex_info & 0xFF
+			};
+
+			if (tex.array_size == 1 && tex.mipmap_count != subtex_count) {
+				tex.mipmap_count = subtex_count & 0xFF;
+			}
+
+			tex.mipmaps.resize(tex.array_size * tex.mipmap_count);
+
+			for (uint32_t arr_i = 0; arr_i < tex.array_size; arr_i++) {
+				for (uint32_t mipmap_i = 0; mipmap_i < tex.mipmap_count; mipmap_i++) {
+					uint32_t mipmap_offset = p_reader.get_u32();
+					p_reader.position_push(texture_start + mipmap_offset);
+
+					uint32_t subtex_signature = p_reader.get_u32(); // Mipmap signature
+
+					ERR_FAIL_COND_V_MSG(subtex_signature != 0x02505854, ERR_FILE_CORRUPT, "Subtexture signature was incorrect");
+
+					DIVAMipmap &mipmap = tex.mipmaps[arr_i * tex.mipmap_count + mipmap_i];
+					mipmap.size.x = p_reader.get_u32();
+					mipmap.size.y = p_reader.get_u32();
+					mipmap.format = (DIVATextureFormat)p_reader.get_u32();
+					mipmap.id = p_reader.get_u32();
+
+					uint32_t data_size = p_reader.get_u32();
+					mipmap.data_offset = p_reader.get_position();
+
+					if (p_reader.get_available_bytes() < data_size) {
+						p_reader.set_overflowed();
+						ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Texture data is out of bounds.");
+					}
+
+					mipmap.data.resize(data_size);
+
+					p_reader.position_pop();
+				}
+			}
+
+			textures.push_back(tex);
+
+			p_reader.position_pop();
+		}
+
+		return p_reader.has_overflowed() ? ERR_FILE_CORRUPT : OK;
+	}
+
 public:
 	static Image::Format diva_to_godot_format(DIVATextureFormat p_tex_format) {
 		switch (p_tex_format) {
@@ -189,6 +272,10 @@ public:
 		return 0;
 	}*/
 
+	int get_texture_count() const {
+		return textures.size();
+	}
+
 	Vector<Ref<Image>> get_texture_mipmaps(int p_idx) const {
 		ERR_FAIL_INDEX_V(p_idx, textures.size(), Vector<Ref<Image>>());
 		Vector<Ref<Image>> mipmaps;
@@ -203,76 +290,45 @@ public:
 	}
 
 	void read_classic(Ref<StreamPeerBuffer> p_spb) {
-		uint32_t set_start = p_spb->get_position();
-		uint32_t signature = p_spb->get_u32();
-		ERR_FAIL_COND_MSG(signature != 0x03505854, "Texture set signature was wrong");
+		DIVAReadHelpers::SpanReader reader;
+		reader.set_stream_peer_buffer(p_spb);
+		read_classic_span(reader);
+		p_spb->seek(MIN(reader.get_position(), reader.get_size()));
+	}
 
-		DIVAReadHelpers::OffsetQueue queue{
-			.spb = p_spb
-		};
+	Error read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
+		uint32_t set_start = p_reader.get_position();
+		uint32_t signature = p_reader.get_u32();
+		ERR_FAIL_COND_V_MSG(signature != 0x03505854, ERR_FILE_UNRECOGNIZED, "Texture set signature was wrong");
 
-		uint32_t texture_count = p_spb->get_u32();
+		uint32_t texture_count = p_reader.get_u32();
 
 		textures.reserve(texture_count);
 
 		// Not sure why but we have to skip 4 bytes here
 		// Both MML and ReDIVA skip it, MML calls it "texture count with rubbish"
-		p_spb->get_u32();
-		for (uint32_t i = 0; i < texture_count; i++) {
-			uint32_t texture_start = set_start + p_spb->get_u32();
-			queue.position_push(texture_start);
-
-			uint32_t txp_signature = p_spb->get_u32();
-			if (txp_signature != 0x04505854 && txp_signature != 0x05505854) {
-				continue;
-			}
-
-			uint32_t subtex_count = p_spb->get_u32();
-			uint32_t tex_info = p_spb->get_u32();
+		p_reader.get_u32();
+
+		const uint32_t first_texture = textures.size();
+		const uint32_t position_depth = p_reader.get_position_depth();
+		Error err = _read_texture_headers(p_reader, set_start, texture_count);
+		if (err != OK) {
+			// No data has been copied yet, drop the textures whose pixels were never filled in
+			textures.resize(first_texture);
+			p_reader.position_restore(position_depth);
+			return err;
+		}
 
-			DIVATexture tex = {
-				.cube_map = signature == 0x05505854,
-				.array_size = (tex_info >> 8) & 0xFF,
-				.mipmap_count = tex_info & 0xFF
+		if (textures.size() > first_texture) {
+			TextureReadJobs jobs = {
+				.reader = &p_reader,
+				.first_texture = first_texture,
 			};
-
-			if (tex.array_size == 1 && tex.mipmap_count != subtex_count) {
-				tex.mipmap_count = subtex_count & 0xFF;
-			}
-
-			tex.mipmaps.resize(tex.array_size * tex.mipmap_count);
-
-			for (uint32_t arr_i = 0; arr_i < tex.array_size; arr_i++) {
-				for (uint32_t mipmap_i = 0; mipmap_i < tex.mipmap_count; mipmap_i++) {
-					uint32_t mipmap_offset = p_spb->get_u32();
-					queue.position_push(texture_start + mipmap_offset);
-
-					uint32_t subtex_signature = p_spb->get_u32(); // Mipmap signature
-
-					ERR_FAIL_COND_MSG(subtex_signature != 0x02505854, "Subtexture signature was incorrect");
-
-					DIVAMipmap mipmap = {
-						.size = Size2i(p_spb->get_u32(), p_spb->get_u32()),
-						.format = (DIVATextureFormat)p_spb->get_u32(),
-						.id = p_spb->get_u32()
-					};
-
-					uint32_t data_size = p_spb->get_u32();
-
-					mipmap.data.resize(data_size);
-
-					p_spb->get_data(mipmap.data.ptr(), mipmap.data.size());
-
-					tex.mipmaps[arr_i * tex.mipmap_count + mipmap_i] = mipmap;
-
-					queue.position_pop();
-				}
-			}
-
-			textures.push_back(tex);
-
-			queue.position_pop();
+			WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &DivaTXP::_read_texture_task, (const TextureReadJobs *)&jobs, textures.size() - first_texture, -1, true, SNAME("DivaTXPReadTextures"));
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
 		}
+
+		return OK;
 	}
 
 	void dump_json(String p_path) {
@@ -303,8 +359,8 @@ public:
 	}
 };
 
-class DIVASpriteSet : public RefCounted {
-	GDCLASS(DIVASpriteSet, RefCounted);
+class DIVASpriteSet : public Resource {
+	GDCLASS(DIVASpriteSet, Resource);
 	struct SpriteInfo {
 		uint32_t texture_id;
 		int32_t rotate;
@@ -324,50 +380,76 @@ class DIVASpriteSet : public RefCounted {
 	SpriteSetData set_data;
 	Ref<StreamPeerBuffer> spb;
 
+protected:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("read_classic", "spb"), &DIVASpriteSet::read_classic);
+		ClassDB::bind_method(D_METHOD("read_classic_file", "path"), &DIVASpriteSet::read_classic_file);
+	}
+
 public:
 	void read_classic(Ref<StreamPeerBuffer> p_spb) {
 		spb = p_spb;
 
-		DIVAReadHelpers::OffsetQueue queue{
-			.spb = p_spb
-		};
+		DIVAReadHelpers::SpanReader reader;
+		reader.set_stream_peer_buffer(p_spb);
+		read_classic_span(reader);
+		p_spb->seek(MIN(reader.get_position(), reader.get_size()));
+	}
+
+	Error read_classic_file(const String &p_path) {
+		DIVAReadHelpers::SpanReader reader;
+		Error err = reader.open_file(p_path);
+		if (err != OK) {
+			return err;
+		}
+		return read_classic_span(reader);
+	}
 
-		set_data.flags = p_spb->get_u32();
-		uint32_t textures_offset = p_spb->get_u32();
-		uint32_t texture_count = p_spb->get_u32();
-		uint32_t sprite_count = p_spb->get_u32();
-		uint32_t sprite_info_offset = p_spb->get_u32();
-		uint32_t texture_name_offset = p_spb->get_u32();
-		uint32_t sprite_name_offset = p_spb->get_u32();
-		uint32_t sprite_data_offset = p_spb->get_u32();
+	Error read_classic_span(DIVAReadHelpers::SpanReader &p_reader) {
+		set_data.flags = p_reader.get_u32();
+		uint32_t textures_offset = p_reader.get_u32();
+		uint32_t texture_count = p_reader.get_u32();
+		uint32_t sprite_count = p_reader.get_u32();
+		uint32_t sprite_info_offset = p_reader.get_u32();
+		uint32_t texture_name_offset = p_reader.get_u32();
+		uint32_t sprite_name_offset = p_reader.get_u32();
+		uint32_t sprite_data_offset = p_reader.get_u32();
 
 		set_data.sprite_infos.resize(sprite_count);
 
-		p_spb->seek(sprite_info_offset);
+		p_reader.seek(sprite_info_offset);
 		for (uint32_t i = 0; i < sprite_count; i++) {
 			SpriteInfo *spr_info = &set_data.sprite_infos[i];
-			spr_info->texture_id = p_spb->get_u32();
-			spr_info->rotate = p_spb->get_32();
-			spr_info->rect = Rect2(Vector2(p_spb->get_float(), p_spb->get_float()), Vector2(p_spb->get_float(), p_spb->get_float()));
-			spr_info->pos = Vector2(Vector2(p_spb->get_float(), p_spb->get_float()));
-			spr_info->size = Vector2(Vector2(p_spb->get_float(), p_spb->get_float()));
+			spr_info->texture_id = p_reader.get_u32();
+			spr_info->rotate = p_reader.get_32();
+			// rect, pos and size are 8 consecutive floats
+			float values[8];
+			p_reader.read_array(values, 8);
+			spr_info->rect = Rect2(values[0], values[1], values[2], values[3]);
+			spr_info->pos = Vector2(values[4], values[5]);
+			spr_info->size = Vector2(values[6], values[7]);
 		}
 
-		p_spb->seek(sprite_name_offset);
+		p_reader.seek(sprite_name_offset);
 		for (uint32_t i = 0; i < sprite_count; i++) {
-			set_data.sprite_infos[i].name = DIVAReadHelpers::read_null_terminated_string(p_spb->get_u32(), queue);
+			set_data.sprite_infos[i].name = p_reader.read_string_offset();
 		}
-		p_spb->seek(sprite_data_offset);
+		p_reader.seek(sprite_data_offset);
 		for (uint32_t i = 0; i < sprite_count; i++) {
-			set_data.sprite_infos[i].attributes = p_spb->get_u32();
-			set_data.sprite_infos[i].resolution_mode = p_spb->get_u32();
+			set_data.sprite_infos[i].attributes = p_reader.get_u32();
+			set_data.sprite_infos[i].resolution_mode = p_reader.get_u32();
 		}
 
-		p_spb->seek(textures_offset);
+		p_reader.seek(textures_offset);
 		for (uint32_t i = 0; i < texture_count; i++) {
 			set_data.texture_set.instantiate();
-			set_data.texture_set->read_classic(p_spb);
+			Error err = set_data.texture_set->read_classic_span(p_reader);
+			if (err != OK) {
+				return err;
+			}
 		}
+
+		return p_reader.has_overflowed() ? ERR_FILE_CORRUPT : OK;
 	}
 
 	Ref<DivaTXP> get_texture_set() const {
@@ -1,33 +1,327 @@
 #include "interval_tree.h"
 
+#include "core/templates/hashfuncs.h"
+
+void HBIntervalTreeQueryResult::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_query_count"), &HBIntervalTreeQueryResult::get_query_count);
+	ClassDB::bind_method(D_METHOD("get_result_count", "query"), &HBIntervalTreeQueryResult::get_result_count);
+	ClassDB::bind_method(D_METHOD("get_results", "query"), &HBIntervalTreeQueryResult::get_results);
+	ClassDB::bind_method(D_METHOD("get_ids"), &HBIntervalTreeQueryResult::get_ids);
+	ClassDB::bind_method(D_METHOD("get_offsets"), &HBIntervalTreeQueryResult::get_offsets);
+}
+
+int HBIntervalTreeQueryResult::get_query_count() const {
+	return offsets.is_empty() ? 0 : offsets.size() - 1;
+}
+
+int HBIntervalTreeQueryResult::get_result_count(int p_query) const {
+	ERR_FAIL_INDEX_V(p_query, get_query_count(), 0);
+	return offsets[p_query + 1] - offsets[p_query];
+}
+
+PackedInt64Array HBIntervalTreeQueryResult::get_results(int p_query) const {
+	ERR_FAIL_INDEX_V(p_query, get_query_count(), PackedInt64Array());
+	PackedInt64Array out;
+	out.resize(offsets[p_query + 1] - offsets[p_query]);
+	if (out.size() > 0) {
+		memcpy(out.ptrw(), ids.ptr() + offsets[p_query], out.size() * sizeof(int64_t));
+	}
+	return out;
+}
+
+PackedInt64Array HBIntervalTreeQueryResult::get_ids() const {
+	PackedInt64Array out;
+	out.resize(ids.size());
+	if (out.size() > 0) {
+		memcpy(out.ptrw(), ids.ptr(), out.size() * sizeof(int64_t));
+	}
+	return out;
+}
+
+PackedInt32Array HBIntervalTreeQueryResult::get_offsets() const {
+	PackedInt32Array out;
+	out.resize(offsets.size());
+	if (out.size() > 0) {
+		memcpy(out.ptrw(), offsets.ptr(), out.size() * sizeof(int32_t));
+	}
+	return out;
+}
+
 void HBIntervalTree::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("insert", "low", "high", "value"), &HBIntervalTree::insert);
 	ClassDB::bind_method(D_METHOD("erase", "low", "high", "value"), &HBIntervalTree::erase);
+	ClassDB::bind_method(D_METHOD("build_from", "lows", "highs", "values"), &HBIntervalTree::build_from);
 	ClassDB::bind_method(D_METHOD("query_point", "query_point"), &HBIntervalTree::query_point);
+	ClassDB::bind_method(D_METHOD("query_range", "low", "high"), &HBIntervalTree::query_range);
+	ClassDB::bind_method(D_METHOD("query_points", "points"), &HBIntervalTree::query_points);
+	ClassDB::bind_method(D_METHOD("query_points_into", "points", "result"), &HBIntervalTree::query_points_into);
+	ClassDB::bind_method(D_METHOD("query_ranges_into", "lows", "highs", "result"), &HBIntervalTree::query_ranges_into);
+	ClassDB::bind_method(D_METHOD("size"), &HBIntervalTree::size);
 	ClassDB::bind_method(D_METHOD("clear"), &HBIntervalTree::clear);
 }
 
+int32_t HBIntervalTree::_create_node(const Interval &p_interval) {
+	int32_t index;
+	if (!free_nodes.is_empty()) {
+		index = free_nodes[free_nodes.size() - 1];
+		free_nodes.resize(free_nodes.size() - 1);
+	} else {
+		index = nodes.size();
+		nodes.push_back(Node());
+	}
+	Node &node = nodes[index];
+	node.interval = p_interval;
+	node.max_high = p_interval.high;
+	// Hashing a counter gives well spread priorities without keeping a random generator around
+	node.priority = hash_murmur3_one_32(next_priority++);
+	node.left = -1;
+	node.right = -1;
+	return index;
+}
+
+void HBIntervalTree::_update_node(int32_t p_node) {
+	Node &node = nodes[p_node];
+	node.max_high = node.interval.high;
+	if (node.left != -1) {
+		node.max_high = MAX(node.max_high, nodes[node.left].max_high);
+	}
+	if (node.right != -1) {
+		node.max_high = MAX(node.max_high, nodes[node.right].max_high);
+	}
+}
+
+void HBIntervalTree::_update_subtree(int32_t p_node) {
+	if (p_node == -1) {
+		return;
+	}
+	_update_subtree(nodes[p_node].left);
+	_update_subtree(nodes[p_node].right);
+	_update_node(p_node);
+}
+
+void HBIntervalTree::_split(int32_t p_node, const Interval &p_interval, int32_t &r_left, int32_t &r_right) {
+	// Intervals ordered before p_interval go left, the rest right
+	if (p_node == -1) {
+		r_left = -1;
+		r_right = -1;
+		return;
+	}
+	Node &node = nodes[p_node];
+	if (node.interval < p_interval) {
+		_split(node.right, p_interval, nodes[p_node].right, r_right);
+		r_left = p_node;
+	} else {
+		_split(node.left, p_interval, r_left, nodes[p_node].left);
+		r_right = p_node;
+	}
+	_update_node(p_node);
+}
+
+int32_t HBIntervalTree::_merge(int32_t p_left, int32_t p_right) {
+	// Every interval in p_left is ordered before the ones in p_right
+	if (p_left == -1) {
+		return p_right;
+	}
+	if (p_right == -1) {
+		return p_left;
+	}
+	if (nodes[p_left].priority > nodes[p_right].priority) {
+		int32_t right = _merge(nodes[p_left].right, p_right);
+		nodes[p_left].right = right;
+		_update_node(p_left);
+		return p_left;
+	}
+	int32_t left = _merge(p_left, nodes[p_right].left);
+	nodes[p_right].left = left;
+	_update_node(p_right);
+	return p_right;
+}
+
+int32_t HBIntervalTree::_erase_node(int32_t p_node, const Interval &p_interval, bool &r_erased) {
+	if (p_node == -1) {
+		return -1;
+	}
+	Node &node = nodes[p_node];
+	if (node.interval == p_interval) {
+		r_erased = true;
+		free_nodes.push_back(p_node);
+		return _merge(node.left, node.right);
+	}
+	if (p_interval < node.interval) {
+		int32_t left = _erase_node(node.left, p_interval, r_erased);
+		nodes[p_node].left = left;
+	} else {
+		int32_t right = _erase_node(node.right, p_interval, r_erased);
+		nodes[p_node].right = right;
+	}
+	_update_node(p_node);
+	return p_node;
+}
+
+bool HBIntervalTree::_has(const Interval &p_interval) const {
+	int32_t node = root;
+	while (node != -1) {
+		const Interval &interval = nodes[node].interval;
+		if (interval == p_interval) {
+			return true;
+		}
+		node = p_interval < interval ? nodes[node].left : nodes[node].right;
+	}
+	return false;
+}
+
+template <typename F>
+void HBIntervalTree::_query_node(int32_t p_node, int64_t p_low, int64_t p_high, F &p_callback) const {
+	// Skip subtrees that end before the range
+	if (p_node == -1 || nodes[p_node].max_high < p_low) {
+		return;
+	}
+	const Node &node = nodes[p_node];
+	_query_node(node.left, p_low, p_high, p_callback);
+	// Everything from here on starts after the range
+	if (node.interval.low > p_high) {
+		return;
+	}
+	if (node.interval.high >= p_low) {
+		p_callback(node.interval);
+	}
+	_query_node(node.right, p_low, p_high, p_callback);
+}
+
+template <typename F>
+void HBIntervalTree::_query(int64_t p_low, int64_t p_high, F p_callback) const {
+	_query_node(root, p_low, p_high, p_callback);
+}
+
 void HBIntervalTree::insert(int64_t p_low, int64_t p_high, ObjectID p_value) {
-	IntervalTree::Interval interval{ p_low, p_high, p_value };
-	ERR_FAIL_COND(!tree.insert(interval));
+	Interval interval{ MIN(p_low, p_high), MAX(p_low, p_high), p_value };
+	ERR_FAIL_COND(_has(interval));
+	int32_t left;
+	int32_t right;
+	_split(root, interval, left, right);
+	root = _merge(_merge(left, _create_node(interval)), right);
+	count++;
 }
 
 void HBIntervalTree::erase(int64_t p_low, int64_t p_high, ObjectID p_value) {
-	IntervalTree::Interval interval{ p_low, p_high, p_value };
-	ERR_FAIL_COND(!tree.remove(interval));
+	Interval interval{ MIN(p_low, p_high), MAX(p_low, p_high), p_value };
+	bool erased = false;
+	root = _erase_node(root, interval, erased);
+	ERR_FAIL_COND(!erased);
+	count--;
+}
+
+void HBIntervalTree::build_from(const PackedInt64Array &p_lows, const PackedInt64Array &p_highs, const PackedInt64Array &p_values) {
+	ERR_FAIL_COND_MSG(p_lows.size() != p_highs.size() || p_lows.size() != p_values.size(), "Lows, highs and values must have the same size.");
+
+	const int64_t *lows = p_lows.ptr();
+	const int64_t *highs = p_highs.ptr();
+	const int64_t *values = p_values.ptr();
+
+	LocalVector<Interval> intervals;
+	intervals.resize(p_lows.size());
+	for (int i = 0; i < p_lows.size(); i++) {
+		intervals[i] = Interval{ MIN(lows[i], highs[i]), MAX(lows[i], highs[i]), ObjectID(values[i]) };
+	}
+	intervals.sort();
+
+	// The intervals are sorted already, so the treap is built in one pass: every node becomes
+	// the right child of the last node with a higher priority and adopts the ones it outranks
+	clear();
+	nodes.reserve(intervals.size());
+	LocalVector<int32_t> stack;
+	for (uint32_t i = 0; i < intervals.size(); i++) {
+		// Same intervals can't be inserted twice
+		if (i > 0 && intervals[i - 1] == intervals[i]) {
+			continue;
+		}
+		int32_t node = _create_node(intervals[i]);
+		int32_t last = -1;
+		while (!stack.is_empty() && nodes[stack[stack.size() - 1]].priority < nodes[node].priority) {
+			last = stack[stack.size() - 1];
+			stack.resize(stack.size() - 1);
+		}
+		nodes[node].left = last;
+		if (!stack.is_empty()) {
+			nodes[stack[stack.size() - 1]].right = node;
+		}
+		stack.push_back(node);
+		count++;
+	}
+	root = stack.is_empty() ? -1 : stack[0];
+	_update_subtree(root);
 }
 
 TypedArray<Object> HBIntervalTree::query_point(int64_t p_point) const {
-	IntervalTree::Intervals intervals = tree.findIntervalsContainPoint(p_point);
 	TypedArray<Object> intervals_out;
-	intervals_out.resize(intervals.size());
+	_query(p_point, p_point, [&](const Interval &p_interval) {
+		intervals_out.push_back(ObjectDB::get_instance(p_interval.value));
+	});
+	return intervals_out;
+}
+
+PackedInt64Array HBIntervalTree::query_range(int64_t p_low, int64_t p_high) const {
+	LocalVector<int64_t> ids;
+	_query(MIN(p_low, p_high), MAX(p_low, p_high), [&](const Interval &p_interval) {
+		ids.push_back(int64_t(p_interval.value));
+	});
 
-	for (int i = 0; i < (int)intervals.size(); i++) {
-		intervals_out[i] = ObjectDB::get_instance(intervals[i].value);
+	PackedInt64Array out;
+	out.resize(ids.size());
+	if (out.size() > 0) {
+		memcpy(out.ptrw(), ids.ptr(), out.size() * sizeof(int64_t));
 	}
-	return intervals_out;
+	return out;
+}
+
+PackedInt64Array HBIntervalTree::query_points(const PackedInt64Array &p_points) const {
+	// Results of every point one after the other, use query_points_into to tell them apart
+	LocalVector<int64_t> ids;
+	for (int i = 0; i < p_points.size(); i++) {
+		_query(p_points[i], p_points[i], [&](const Interval &p_interval) {
+			ids.push_back(int64_t(p_interval.value));
+		});
+	}
+
+	PackedInt64Array out;
+	out.resize(ids.size());
+	if (out.size() > 0) {
+		memcpy(out.ptrw(), ids.ptr(), out.size() * sizeof(int64_t));
+	}
+	return out;
+}
+
+void HBIntervalTree::query_points_into(const PackedInt64Array &p_points, const Ref<HBIntervalTreeQueryResult> &p_result) const {
+	query_ranges_into(p_points, p_points, p_result);
+}
+
+void HBIntervalTree::query_ranges_into(const PackedInt64Array &p_lows, const PackedInt64Array &p_highs, const Ref<HBIntervalTreeQueryResult> &p_result) const {
+	ERR_FAIL_COND(p_result.is_null());
+	ERR_FAIL_COND_MSG(p_lows.size() != p_highs.size(), "Lows and highs must have the same size.");
+
+	LocalVector<int64_t> &ids = p_result->ids;
+	LocalVector<int32_t> &offsets = p_result->offsets;
+	ids.clear();
+	offsets.resize(p_lows.size() + 1);
+	offsets[0] = 0;
+
+	const int64_t *lows = p_lows.ptr();
+	const int64_t *highs = p_highs.ptr();
+	for (int i = 0; i < p_lows.size(); i++) {
+		_query(MIN(lows[i], highs[i]), MAX(lows[i], highs[i]), [&](const Interval &p_interval) {
+			ids.push_back(int64_t(p_interval.value));
+		});
+		offsets[i + 1] = ids.size();
+	}
+}
+
+int HBIntervalTree::size() const {
+	return count;
 }
 
 void HBIntervalTree::clear() {
-	tree.clear();
+	nodes.clear();
+	free_nodes.clear();
+	root = -1;
+	count = 0;
 }
@@ -2,14 +2,84 @@
 #define INTERVAL_TREE_GD_H
 
 #include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/typed_array.h"
-#include "thirdparty/intervaltree.h"
+
+// Reusable output of the batched queries, the ObjectIDs of every query are stored back to
+// back in ids and query i owns ids [offsets[i], offsets[i + 1])
+class HBIntervalTreeQueryResult : public RefCounted {
+	GDCLASS(HBIntervalTreeQueryResult, RefCounted);
+
+	// Never shrunk, so a result that is reused every frame stops allocating
+	LocalVector<int64_t> ids;
+	LocalVector<int32_t> offsets;
+
+	friend class HBIntervalTree;
+
+protected:
+	static void _bind_methods();
+
+public:
+	int get_query_count() const;
+	int get_result_count(int p_query) const;
+	PackedInt64Array get_results(int p_query) const;
+	PackedInt64Array get_ids() const;
+	PackedInt32Array get_offsets() const;
+};
 
 class HBIntervalTree : public RefCounted {
 	GDCLASS(HBIntervalTree, RefCounted);
 
-	typedef Intervals::IntervalTree<int64_t, ObjectID> IntervalTree;
-	IntervalTree tree;
+	struct Interval {
+		int64_t low;
+		int64_t high;
+		ObjectID value;
+
+		bool operator==(const Interval &p_other) const {
+			return low == p_other.low && high == p_other.high && value == p_other.value;
+		}
+		bool operator<(const Interval &p_other) const {
+			if (low != p_other.low) {
+				return low < p_other.low;
+			}
+			if (high != p_other.high) {
+				return high < p_other.high;
+			}
+			return uint64_t(value) < uint64_t(p_other.value);
+		}
+	};
+
+	// Treap ordered by the intervals, every node also keeps the highest end found in its
+	// subtree so queries can skip whole subtrees. insert and erase only touch the path to
+	// the changed node, O(log n) expected, and queries only read so they can run at the same
+	// time. Nodes live in one array and freed ones are reused.
+	struct Node {
+		Interval interval;
+		int64_t max_high;
+		uint32_t priority;
+		int32_t left = -1;
+		int32_t right = -1;
+	};
+
+	LocalVector<Node> nodes;
+	LocalVector<int32_t> free_nodes;
+	int32_t root = -1;
+	uint32_t count = 0;
+	uint32_t next_priority = 0;
+
+	int32_t _create_node(const Interval &p_interval);
+	void _update_node(int32_t p_node);
+	void _split(int32_t p_node, const Interval &p_interval, int32_t &r_left, int32_t &r_right);
+	int32_t _merge(int32_t p_left, int32_t p_right);
+	int32_t _erase_node(int32_t p_node, const Interval &p_interval, bool &r_erased);
+	bool _has(const Interval &p_interval) const;
+	void _update_subtree(int32_t p_node);
+
+	// Calls p_callback with every interval overlapping [p_low, p_high]
+	template <typename F>
+	void _query(int64_t p_low, int64_t p_high, F p_callback) const;
+	template <typename F>
+	void _query_node(int32_t p_node, int64_t p_low, int64_t p_high, F &p_callback) const;
 
 protected:
 	static void _bind_methods();
@@ -17,7 +87,13 @@ protected:
 public:
 	void insert(int64_t p_low, int64_t p_high, ObjectID p_value);
 	void erase(int64_t p_low, int64_t p_high, ObjectID p_value);
+	void build_from(const PackedInt64Array &p_lows, const PackedInt64Array &p_highs, const PackedInt64Array &p_values);
 	TypedArray<Object> query_point(int64_t p_point) const;
+	PackedInt64Array query_range(int64_t p_low, int64_t p_high) const;
+	PackedInt64Array query_points(const PackedInt64Array &p_points) const;
+	void query_points_into(const PackedInt64Array &p_points, const Ref<HBIntervalTreeQueryResult> &p_result) const;
+	void query_ranges_into(const PackedInt64Array &p_lows, const PackedInt64Array &p_highs, const Ref<HBIntervalTreeQueryResult> &p_result) const;
+	int size() const;
 	void clear();
 };
 
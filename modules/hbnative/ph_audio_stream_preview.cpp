@@ -32,113 +32,152 @@
 
 /////////////////////
 
-float PHAudioStreamPreview::get_length() const {
-	return length;
+void PHAudioStreamPreview::create_levels(float p_length, int p_bin_count) {
+	RWLockWrite write_lock(lock);
+	length = p_length;
+	levels.clear();
+	if (p_bin_count <= 0) {
+		return;
+	}
+	int size = p_bin_count;
+	do {
+		levels.push_back(LocalVector<Bin>());
+		levels[levels.size() - 1].resize(size);
+		size = (size + 1) / 2;
+	} while (levels[levels.size() - 1].size() > 1);
 }
-float PHAudioStreamPreview::get_max(float p_time, float p_time_next) const {
-	if (length == 0)
-		return 0;
 
-	int max = preview.size() / 2;
-	int time_from = p_time / length * max;
-	int time_to = p_time_next / length * max;
-	time_from = CLAMP(time_from, 0, max - 1);
-	time_to = CLAMP(time_to, 0, max - 1);
+uint32_t PHAudioStreamPreview::_get_bin_frames(int p_level, int p_index) const {
+	// Number of level 0 bins a bin covers, the last bin of a level may be partial
+	uint32_t start = uint32_t(p_index) << p_level;
+	return MIN(uint32_t(1) << p_level, levels[0].size() - start);
+}
 
-	if (time_to <= time_from) {
-		time_to = time_from + 1;
+void PHAudioStreamPreview::store_bins(int p_from, const LocalVector<Bin> &p_bins) {
+	RWLockWrite write_lock(lock);
+
+	if (p_bins.is_empty() || levels.is_empty()) {
+		return;
 	}
 
-	uint8_t vmax = 0;
+	int from = p_from;
+	int to = MIN(p_from + (int)p_bins.size(), (int)levels[0].size());
+	for (int i = from; i < to; i++) {
+		levels[0][i] = p_bins[i - from];
+	}
 
-	for (int i = time_from; i < time_to; i++) {
-		uint8_t v = preview[i * 2 + 1];
-		if (i == 0 || v > vmax) {
-			vmax = v;
+	for (uint32_t level = 1; level < levels.size(); level++) {
+		const LocalVector<Bin> &children = levels[level - 1];
+		LocalVector<Bin> &parents = levels[level];
+		from >>= 1;
+		to = (to + 1) >> 1;
+		for (int i = from; i < to; i++) {
+			const Bin &a = children[i * 2];
+			Bin &parent = parents[i];
+			if ((uint32_t)i * 2 + 1 >= children.size()) {
+				parent = a;
+				continue;
+			}
+			const Bin &b = children[i * 2 + 1];
+			const float wa = _get_bin_frames(level - 1, i * 2);
+			const float wb = _get_bin_frames(level - 1, i * 2 + 1);
+			parent.min = MIN(a.min, b.min);
+			parent.max = MAX(a.max, b.max);
+			parent.avg = Math::round((a.avg * wa + b.avg * wb) / (wa + wb));
+			parent.rms = Math::round(Math::sqrt((a.rms * a.rms * wa + b.rms * b.rms * wb) / (wa + wb)));
 		}
 	}
-
-	return (vmax / 255.0) * 2.0 - 1.0;
 }
 
-float PHAudioStreamPreview::get_avg(float p_time, float p_time_next) const {
-	if (length == 0)
-		return 0;
+bool PHAudioStreamPreview::_query(float p_time, float p_time_next, QueryResult &r_result) const {
+	if (length == 0) {
+		return false;
+	}
+
+	RWLockRead read_lock(lock);
+
+	if (levels.is_empty() || levels[0].is_empty()) {
+		return false;
+	}
 
-	int max = preview.size() / 2;
+	int max = levels[0].size();
 	int time_from = p_time / length * max;
 	int time_to = p_time_next / length * max;
 	time_from = CLAMP(time_from, 0, max - 1);
-	time_to = CLAMP(time_to, 0, max - 1);
+	time_to = CLAMP(time_to, 0, max);
 
 	if (time_to <= time_from) {
 		time_to = time_from + 1;
 	}
 
-	int64_t total = 0;
-	int64_t count = 0;
-	for (int i = time_from; i < time_to; i++) {
-		uint8_t v = preview[i * 2 + 1];
-		total += v;
-		count++;
+	// Bottom up segment tree walk, whenever a side of the range isn't aligned to the
+	// parent level the bin on that edge is taken as is and the range shrinks inwards
+	auto accumulate = [&](int p_level, int p_index) {
+		const Bin &bin = levels[p_level][p_index];
+		const uint32_t weight = _get_bin_frames(p_level, p_index);
+		r_result.min = MIN(r_result.min, bin.min);
+		r_result.max = MAX(r_result.max, bin.max);
+		r_result.avg_sum += bin.avg * (float)weight;
+		r_result.rms_sq_sum += bin.rms * bin.rms * (float)weight;
+		r_result.count += weight;
+	};
+
+	int level = 0;
+	while (time_from < time_to) {
+		if (time_from & 1) {
+			accumulate(level, time_from++);
+		}
+		if (time_to & 1) {
+			accumulate(level, --time_to);
+		}
+		time_from >>= 1;
+		time_to >>= 1;
+		level++;
 	}
 
-	float avg = total / count;
+	return r_result.count > 0;
+}
 
-	return (avg / 255.0) * 2.0 - 1.0;
+float PHAudioStreamPreview::get_length() const {
+	return length;
 }
 
-float PHAudioStreamPreview::get_rms(float p_time, float p_time_next) const {
-	if (length == 0)
+float PHAudioStreamPreview::get_max(float p_time, float p_time_next) const {
+	QueryResult result;
+	if (!_query(p_time, p_time_next, result)) {
 		return 0;
-
-	int max = preview.size() / 2;
-	int time_from = p_time / length * max;
-	int time_to = p_time_next / length * max;
-	time_from = CLAMP(time_from, 0, max - 1);
-	time_to = CLAMP(time_to, 0, max - 1);
-
-	if (time_to <= time_from) {
-		time_to = time_from + 1;
 	}
 
-	float total = 0;
-	int64_t count = 0;
-	for (int i = time_from; i < time_to; i++) {
-		uint8_t v = preview[i * 2 + 1];
-		total += v * v;
-		count++;
+	return (result.max / 255.0) * 2.0 - 1.0;
+}
+
+float PHAudioStreamPreview::get_avg(float p_time, float p_time_next) const {
+	QueryResult result;
+	if (!_query(p_time, p_time_next, result)) {
+		return 0;
 	}
 
-	float mean = total / count;
+	float avg = result.avg_sum / result.count;
 
-	return (Math::sqrt(mean) / 255.0) * 2.0 - 1.0;
+	return (avg / 255.0) * 2.0 - 1.0;
 }
 
-float PHAudioStreamPreview::get_min(float p_time, float p_time_next) const {
-	if (length == 0)
+float PHAudioStreamPreview::get_rms(float p_time, float p_time_next) const {
+	QueryResult result;
+	if (!_query(p_time, p_time_next, result)) {
 		return 0;
-
-	int max = preview.size() / 2;
-	int time_from = p_time / length * max;
-	int time_to = p_time_next / length * max;
-	time_from = CLAMP(time_from, 0, max - 1);
-	time_to = CLAMP(time_to, 0, max - 1);
-
-	if (time_to <= time_from) {
-		time_to = time_from + 1;
 	}
 
-	uint8_t vmin = 255;
+	return Math::sqrt(result.rms_sq_sum / result.count) / 255.0;
+}
 
-	for (int i = time_from; i < time_to; i++) {
-		uint8_t v = preview[i * 2];
-		if (i == 0 || v < vmin) {
-			vmin = v;
-		}
+float PHAudioStreamPreview::get_min(float p_time, float p_time_next) const {
+	QueryResult result;
+	if (!_query(p_time, p_time_next, result)) {
+		return 0;
 	}
 
-	return (vmin / 255.0) * 2.0 - 1.0;
+	return (result.min / 255.0) * 2.0 - 1.0;
 }
 
 PHAudioStreamPreview::PHAudioStreamPreview() {
@@ -159,62 +198,91 @@ void PHAudioStreamPreviewGenerator::_update_emit(ObjectID p_id) {
 	emit_signal("preview_updated", p_id);
 }
 
-void PHAudioStreamPreviewGenerator::_preview_thread(void *p_preview) {
-	Preview *preview = (Preview *)p_preview;
+void PHAudioStreamPreviewGenerator::_generate_chunk(uint32_t p_chunk, Preview *p_preview) {
+	Ref<AudioStreamPlayback> playback = p_preview->chunk_playbacks[p_chunk];
+	const float mix_rate = AudioServer::get_singleton()->get_mix_rate();
+
+	auto bin_frame = [p_preview](int p_bin) {
+		return int64_t(uint64_t(p_bin) * uint64_t(p_preview->frames_total) / uint64_t(p_preview->bin_count));
+	};
+
+	const int bin_from = p_chunk * p_preview->chunk_bins;
+	const int bin_to = MIN(bin_from + p_preview->chunk_bins, p_preview->bin_count);
+	const int64_t frame_to = bin_frame(bin_to);
+	int64_t frame = bin_frame(bin_from);
 
 	float muxbuff_chunk_s = 0.25;
 
-	int mixbuff_chunk_frames = AudioServer::get_singleton()->get_mix_rate() * muxbuff_chunk_s;
+	int mixbuff_chunk_frames = mix_rate * muxbuff_chunk_s;
 
 	Vector<AudioFrame> mix_chunk;
 	mix_chunk.resize(mixbuff_chunk_frames);
-
-	int frames_total = AudioServer::get_singleton()->get_mix_rate() * preview->preview->length;
-	int frames_todo = frames_total;
-
-	preview->playback->start();
-
-	while (frames_todo) {
-		int ofs_write = uint64_t(frames_total - frames_todo) * uint64_t(preview->preview->preview.size() / 2) / uint64_t(frames_total);
-		int to_read = MIN(frames_todo, mixbuff_chunk_frames);
-		int to_write = uint64_t(to_read) * uint64_t(preview->preview->preview.size() / 2) / uint64_t(frames_total);
-		to_write = MIN(to_write, (preview->preview->preview.size() / 2) - ofs_write);
-
-		preview->playback->mix(mix_chunk.ptrw(), 1.0, to_read);
-
-		for (int i = 0; i < to_write; i++) {
-			float max = -1000;
-			float min = 1000;
-			int from = uint64_t(i) * to_read / to_write;
-			int to = (uint64_t(i) + 1) * to_read / to_write;
-			to = MIN(to, to_read);
-			from = MIN(from, to_read - 1);
-			if (to == from) {
-				to = from + 1;
+	int buffered = 0;
+	int buffer_pos = 0;
+
+	// Bins are published every time a mix chunk worth of them is ready so the editor
+	// can draw the waveform while the rest of it is still decoding
+	const int publish_bins = MAX(1, mixbuff_chunk_frames / FRAMES_PER_BIN);
+	LocalVector<PHAudioStreamPreview::Bin> pending;
+	pending.reserve(publish_bins);
+	int pending_from = bin_from;
+
+	playback->start(frame / mix_rate);
+
+	for (int bin = bin_from; bin < bin_to; bin++) {
+		const int64_t bin_end = bin_frame(bin + 1);
+		float max = -1000;
+		float min = 1000;
+		float rms = 0;
+		float sum_sq = 0;
+		int count = 0;
+
+		while (frame < bin_end) {
+			if (buffer_pos == buffered) {
+				buffered = MIN(int64_t(mixbuff_chunk_frames), frame_to - frame);
+				buffer_pos = 0;
+				playback->mix(mix_chunk.ptrw(), 1.0, buffered);
 			}
 
-			for (int j = from; j < to; j++) {
-				max = MAX(max, mix_chunk[j].l);
-				max = MAX(max, mix_chunk[j].r);
+			const AudioFrame *src = mix_chunk.ptr() + buffer_pos;
+			int to_read = MIN(int64_t(buffered - buffer_pos), bin_end - frame);
+			for (int j = 0; j < to_read; j++) {
+				max = MAX(max, src[j].l);
+				max = MAX(max, src[j].r);
 
-				min = MIN(min, mix_chunk[j].l);
-				min = MIN(min, mix_chunk[j].r);
-			}
+				min = MIN(min, src[j].l);
+				min = MIN(min, src[j].r);
 
-			uint8_t pfrom = CLAMP((min * 0.5 + 0.5) * 255, 0, 255);
-			uint8_t pto = CLAMP((max * 0.5 + 0.5) * 255, 0, 255);
+				sum_sq += src[j].l * src[j].l + src[j].r * src[j].r;
+			}
+			count += to_read;
+			buffer_pos += to_read;
+			frame += to_read;
+		}
 
-			preview->preview->preview.write[(ofs_write + i) * 2 + 0] = pfrom;
-			preview->preview->preview.write[(ofs_write + i) * 2 + 1] = pto;
+		if (count == 0) {
+			max = 0;
+			min = 0;
+		} else {
+			rms = Math::sqrt(sum_sq / (count * 2));
 		}
 
-		frames_todo -= to_read;
-		singleton->call_deferred(SNAME("_update_emit"), preview->id);
+		PHAudioStreamPreview::Bin out;
+		out.min = CLAMP((min * 0.5 + 0.5) * 255, 0, 255);
+		out.max = CLAMP((max * 0.5 + 0.5) * 255, 0, 255);
+		out.avg = out.max;
+		out.rms = CLAMP(rms * 255, 0, 255);
+		pending.push_back(out);
+
+		if ((int)pending.size() >= publish_bins || bin + 1 == bin_to) {
+			p_preview->preview->store_bins(pending_from, pending);
+			pending_from += pending.size();
+			pending.clear();
+			singleton->call_deferred(SNAME("_update_emit"), p_preview->id);
+		}
 	}
 
-	preview->playback->stop();
-
-	preview->generating.clear();
+	playback->stop();
 }
 
 Ref<PHAudioStreamPreview> PHAudioStreamPreviewGenerator::generate_preview(const Ref<AudioStream> &p_stream) {
@@ -230,34 +298,43 @@ Ref<PHAudioStreamPreview> PHAudioStreamPreviewGenerator::generate_preview(const
 
 	Preview *preview = &previews[p_stream->get_instance_id()];
 	preview->base_stream = p_stream;
-	preview->playback = preview->base_stream->instantiate_playback();
-	preview->generating.set();
 	preview->id = p_stream->get_instance_id();
 
 	float len_s = preview->base_stream->get_length();
+	bool seekable = len_s != 0;
 	if (len_s == 0) {
 		len_s = 60 * 5; //five minutes
 	}
 
-	int frames = AudioServer::get_singleton()->get_mix_rate() * len_s;
+	float mix_rate = AudioServer::get_singleton()->get_mix_rate();
+	int frames = mix_rate * len_s;
+	int pw = frames / FRAMES_PER_BIN;
 
-	Vector<uint8_t> maxmin;
-	int pw = frames / 20;
-	maxmin.resize(pw * 2);
-	{
-		uint8_t *ptr = maxmin.ptrw();
-		for (int i = 0; i < pw * 2; i++) {
-			ptr[i] = 127;
-		}
-	}
+	preview->frames_total = frames;
+	preview->bin_count = pw;
+	preview->chunk_bins = seekable ? MAX(1, int(mix_rate * CHUNK_LENGTH_SEC) / FRAMES_PER_BIN) : pw;
 
 	preview->preview.instantiate();
-	preview->preview->preview = maxmin;
-	preview->preview->length = len_s;
+	preview->preview->create_levels(len_s, pw);
+
+	if (pw == 0) {
+		return preview->preview;
+	}
 
-	if (preview->playback.is_valid()) {
-		preview->thread = memnew(Thread);
-		preview->thread->start(_preview_thread, preview);
+	// Every chunk decodes through its own playback, they are created here rather than on
+	// the worker threads since streams don't guarantee instantiate_playback is thread safe
+	int chunk_count = (pw + preview->chunk_bins - 1) / preview->chunk_bins;
+	for (int i = 0; i < chunk_count; i++) {
+		Ref<AudioStreamPlayback> playback = preview->base_stream->instantiate_playback();
+		if (playback.is_null()) {
+			preview->chunk_playbacks.clear();
+			break;
+		}
+		preview->chunk_playbacks.push_back(playback);
+	}
+
+	if (!preview->chunk_playbacks.is_empty()) {
+		preview->group_id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &PHAudioStreamPreviewGenerator::_generate_chunk, preview, chunk_count, -1, false, SNAME("PHAudioStreamPreview"));
 	}
 
 	return preview->preview;
@@ -276,15 +353,16 @@ void PHAudioStreamPreviewGenerator::_notification(int p_what) {
 	if (p_what == NOTIFICATION_PROCESS) {
 		List<ObjectID> to_erase;
 		for (KeyValue<ObjectID, Preview> &E : previews) {
-			if (!E.value.generating.is_set()) {
-				if (E.value.thread) {
-					E.value.thread->wait_to_finish();
-					memdelete(E.value.thread);
-					E.value.thread = NULL;
-				}
-				if (!ObjectDB::get_instance(E.key)) { //no longer in use, get rid of preview
-					to_erase.push_back(E.key);
+			if (E.value.group_id != -1) {
+				if (!WorkerThreadPool::get_singleton()->is_group_task_completed(E.value.group_id)) {
+					continue;
 				}
+				WorkerThreadPool::get_singleton()->wait_for_group_task_completion(E.value.group_id);
+				E.value.group_id = -1;
+				E.value.chunk_playbacks.clear();
+			}
+			if (!ObjectDB::get_instance(E.key)) { //no longer in use, get rid of preview
+				to_erase.push_back(E.key);
 			}
 		}
 
@@ -299,3 +377,15 @@ PHAudioStreamPreviewGenerator::PHAudioStreamPreviewGenerator() {
 	singleton = this;
 	set_process(true);
 }
+
+PHAudioStreamPreviewGenerator::~PHAudioStreamPreviewGenerator() {
+	// Tasks still hold pointers into the preview map
+	for (KeyValue<ObjectID, Preview> &E : previews) {
+		if (E.value.group_id != -1) {
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(E.value.group_id);
+		}
+	}
+	if (singleton == this) {
+		singleton = NULL;
+	}
+}
@@ -32,15 +32,43 @@
 #define PH_AUDIO_STREAM_PREVIEW_H
 
 #include "core/object/ref_counted.h"
-#include "core/os/thread.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/rw_lock.h"
+#include "core/templates/local_vector.h"
 #include "scene/main/node.h"
 #include "servers/audio/audio_stream.h"
 
 class PHAudioStreamPreview : public RefCounted {
 	GDCLASS(PHAudioStreamPreview, RefCounted);
 	friend class AudioStream;
-	Vector<uint8_t> preview;
+
+public:
+	// Values are quantized to a byte, min and max map [-1, 1] to [0, 255], avg is the
+	// mean of max and rms is the RMS amplitude mapped [0, 1] to [0, 255]
+	struct Bin {
+		uint8_t min = 127;
+		uint8_t max = 127;
+		uint8_t avg = 127;
+		uint8_t rms = 0;
+	};
+
+private:
+	// levels[0] holds the bins as generated, every level above covers twice as many
+	// frames so range queries only have to touch O(log n) bins
+	LocalVector<LocalVector<Bin>> levels;
 	float length;
+	mutable RWLock lock;
+
+	struct QueryResult {
+		uint8_t min = 255;
+		uint8_t max = 0;
+		float avg_sum = 0.0f;
+		float rms_sq_sum = 0.0f;
+		uint32_t count = 0;
+	};
+
+	uint32_t _get_bin_frames(int p_level, int p_index) const;
+	bool _query(float p_time, float p_time_next, QueryResult &r_result) const;
 
 	friend class PHAudioStreamPreviewGenerator;
 
@@ -48,6 +76,11 @@ protected:
 	static void _bind_methods();
 
 public:
+	// Sizes the pyramid for p_bin_count bins spread over p_length seconds, bins are then
+	// filled in any order with store_bins, which also updates the levels above them
+	void create_levels(float p_length, int p_bin_count);
+	void store_bins(int p_from, const LocalVector<Bin> &p_bins);
+
 	float get_length() const;
 	float get_max(float p_time, float p_time_next) const;
 	float get_min(float p_time, float p_time_next) const;
@@ -62,39 +95,25 @@ class PHAudioStreamPreviewGenerator : public Node {
 
 	static PHAudioStreamPreviewGenerator *singleton;
 
+	// Length of the stream each worker task decodes, streams with an unknown length
+	// can't be seeked so they are decoded as a single chunk
+	static constexpr float CHUNK_LENGTH_SEC = 10.0f;
+	static constexpr int FRAMES_PER_BIN = 20;
+
 	struct Preview {
 		Ref<PHAudioStreamPreview> preview;
 		Ref<AudioStream> base_stream;
-		Ref<AudioStreamPlayback> playback;
-		SafeFlag generating;
+		Vector<Ref<AudioStreamPlayback>> chunk_playbacks;
 		ObjectID id;
-		Thread *thread;
-
-		// Needed for the bookkeeping of the Map
-		Preview &operator=(const Preview &p_rhs) {
-			preview = p_rhs.preview;
-			base_stream = p_rhs.base_stream;
-			playback = p_rhs.playback;
-			generating.set_to(generating.is_set());
-			id = p_rhs.id;
-			thread = p_rhs.thread;
-			return *this;
-		}
-		Preview(const Preview &p_rhs) {
-			preview = p_rhs.preview;
-			base_stream = p_rhs.base_stream;
-			playback = p_rhs.playback;
-			generating.set_to(generating.is_set());
-			id = p_rhs.id;
-			thread = p_rhs.thread;
-		}
-		Preview() {
-		}
+		int64_t frames_total = 0;
+		int bin_count = 0;
+		int chunk_bins = 0;
+		WorkerThreadPool::GroupID group_id = -1;
 	};
 
 	RBMap<ObjectID, Preview> previews;
 
-	static void _preview_thread(void *p_preview);
+	void _generate_chunk(uint32_t p_chunk, Preview *p_preview);
 
 	void _update_emit(ObjectID p_id);
 
@@ -108,6 +127,7 @@ public:
 	Ref<PHAudioStreamPreview> generate_preview(const Ref<AudioStream> &p_stream);
 
 	PHAudioStreamPreviewGenerator();
+	~PHAudioStreamPreviewGenerator();
 };
 
 #endif // AUDIO_STREAM_PREVIEW_H
@@ -39,23 +39,29 @@ void Process::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_available_stderr_lines"), &Process::get_available_stderr_lines);
 	ClassDB::bind_method(D_METHOD("get_stderr_line"), &Process::get_stderr_line);
 
+	ClassDB::bind_method(D_METHOD("get_available_bytes", "stream"), &Process::get_available_bytes);
+	ClassDB::bind_method(D_METHOD("read_available", "stream", "max_bytes"), &Process::_read_available, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("is_output_closed", "stream"), &Process::is_output_closed);
+	ClassDB::bind_method(D_METHOD("set_line_callback", "stream", "callback"), &Process::set_line_callback);
+	ClassDB::bind_method(D_METHOD("get_line_callback", "stream"), &Process::get_line_callback);
+	ClassDB::bind_method(D_METHOD("dispatch_lines"), &Process::dispatch_lines);
+
 	ClassDB::bind_method(D_METHOD("get_exit_status"), &Process::get_exit_status);
 	ClassDB::bind_method(D_METHOD("kill", "force"), &Process::kill, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("get_id"), &Process::get_id);
 	ClassDB::bind_method(D_METHOD("write", "input"), &Process::write);
 	ClassDB::bind_method(D_METHOD("close_stdin"), &Process::close_stdin);
+
+	BIND_ENUM_CONSTANT(OUTPUT_STDOUT);
+	BIND_ENUM_CONSTANT(OUTPUT_STDERR);
 }
 
-void Process::_push_stdout_line(const String &p_stdout_line) {
-	mutex.lock();
-	stdout_lines.push_back(p_stdout_line);
-	mutex.unlock();
+void Process::_push_output(OutputStream p_stream, const char *p_bytes, size_t p_size) {
+	outputs[p_stream].write((const uint8_t *)p_bytes, p_size);
 }
 
-void Process::_push_stderr_line(const String &p_stderr_line) {
-	mutex.lock();
-	stderr_lines.push_back(p_stderr_line);
-	mutex.unlock();
+void Process::_close_output(OutputStream p_stream) {
+	outputs[p_stream].close();
 }
 
 Ref<Process> Process::create(const String &p_path, const Vector<String> &p_arguments, const String &p_working_dir, bool p_open_stdin) {
@@ -77,37 +83,81 @@ Ref<Process> Process::create(const String &p_path, const Vector<String> &p_argum
 }
 
 int Process::get_available_stdout_lines() const {
-	mutex.lock();
-	int available_lines = stdout_lines.size();
-	mutex.unlock();
-	return available_lines;
+	return outputs[OUTPUT_STDOUT].get_available_lines();
 }
 
 int Process::get_available_stderr_lines() const {
-	mutex.lock();
-	int available_lines = stderr_lines.size();
-	mutex.unlock();
-	return available_lines;
+	return outputs[OUTPUT_STDERR].get_available_lines();
 }
 
 String Process::get_stdout_line() {
-	String line = "";
-	mutex.lock();
-	if (stdout_lines.size() > 0) {
-		line = stdout_lines[0];
-		stdout_lines.remove_at(0);
-	}
-	mutex.unlock();
+	String line;
+	outputs[OUTPUT_STDOUT].pop_line(line);
 	return line;
 }
 
 String Process::get_stderr_line() {
-	String line = "";
-	mutex.lock();
-	if (stderr_lines.size() > 0) {
-		line = stderr_lines[0];
-		stderr_lines.remove_at(0);
-	}
-	mutex.unlock();
+	String line;
+	outputs[OUTPUT_STDERR].pop_line(line);
 	return line;
 }
+
+int64_t Process::get_available_bytes(OutputStream p_stream) const {
+	ERR_FAIL_INDEX_V(p_stream, OUTPUT_MAX, 0);
+	return outputs[p_stream].get_available_bytes();
+}
+
+int64_t Process::read_available_into(uint8_t *r_dst, int64_t p_max_bytes, OutputStream p_stream) {
+	ERR_FAIL_INDEX_V(p_stream, OUTPUT_MAX, 0);
+	ERR_FAIL_COND_V(p_max_bytes < 0, 0);
+	return outputs[p_stream].read(r_dst, p_max_bytes);
+}
+
+int64_t Process::read_available_into(PackedByteArray &r_buffer, OutputStream p_stream, int64_t p_max_bytes) {
+	ERR_FAIL_INDEX_V(p_stream, OUTPUT_MAX, 0);
+	return outputs[p_stream].read_available_into(r_buffer, p_max_bytes);
+}
+
+PackedByteArray Process::_read_available(OutputStream p_stream, int64_t p_max_bytes) {
+	PackedByteArray buffer;
+	read_available_into(buffer, p_stream, p_max_bytes);
+	return buffer;
+}
+
+bool Process::is_output_closed(OutputStream p_stream) const {
+	ERR_FAIL_INDEX_V(p_stream, OUTPUT_MAX, true);
+	return outputs[p_stream].is_closed();
+}
+
+void Process::set_line_callback(OutputStream p_stream, const Callable &p_callback) {
+	ERR_FAIL_INDEX(p_stream, OUTPUT_MAX);
+	line_callbacks[p_stream] = p_callback;
+}
+
+Callable Process::get_line_callback(OutputStream p_stream) const {
+	ERR_FAIL_INDEX_V(p_stream, OUTPUT_MAX, Callable());
+	return line_callbacks[p_stream];
+}
+
+int Process::dispatch_lines() {
+	int dispatched = 0;
+	for (int i = 0; i < OUTPUT_MAX; i++) {
+		// Copied so the callback can replace itself
+		const Callable callback = line_callbacks[i];
+		if (!callback.is_valid()) {
+			continue;
+		}
+		String line;
+		while (outputs[i].pop_line(line)) {
+			callback.call(line);
+			dispatched++;
+		}
+	}
+	return dispatched;
+}
+
+Process::Process() {
+	// Converters can write tens of MB to stdout, stderr is usually just logging
+	outputs[OUTPUT_STDOUT].set_capacity(1 << 20);
+	outputs[OUTPUT_STDERR].set_capacity(1 << 16);
+}
@@ -32,22 +32,33 @@
 #define PROCESS_H
 
 #include "core/object/ref_counted.h"
-#include "core/os/mutex.h"
+#include "core/variant/callable.h"
+#include "process_output_buffer.h"
 
 class Process : public RefCounted {
 	GDCLASS(Process, RefCounted);
 
+public:
+	enum OutputStream {
+		OUTPUT_STDOUT,
+		OUTPUT_STDERR,
+		OUTPUT_MAX,
+	};
+
 private:
-	Mutex mutex;
-	Vector<String> stdout_lines;
-	Vector<String> stderr_lines;
+	// Filled by the platform's reader thread, drained by whoever polls the process
+	mutable ProcessOutputBuffer outputs[OUTPUT_MAX];
+	Callable line_callbacks[OUTPUT_MAX];
+
+	PackedByteArray _read_available(OutputStream p_stream, int64_t p_max_bytes);
 
 protected:
 	static Ref<Process> (*_create)(const String &p_path, const Vector<String> &p_arguments, const String &p_working_dir, bool p_open_stdin);
 	static void _bind_methods();
 
-	void _push_stdout_line(const String &p_stdout_line);
-	void _push_stderr_line(const String &p_stderr_line);
+	// Called from the reader thread, never blocks on the consumer
+	void _push_output(OutputStream p_stream, const char *p_bytes, size_t p_size);
+	void _close_output(OutputStream p_stream);
 
 public:
 	static Ref<Process> create(const String &p_path, const Vector<String> &p_arguments = Vector<String>(), const String &p_working_dir = "", bool p_open_stdin = false);
@@ -55,13 +66,30 @@ public:
 	int get_available_stderr_lines() const;
 	String get_stdout_line();
 	String get_stderr_line();
+
+	// Raw output, for binary data like media piped out of a converter. A stream is read either as lines or raw.
+	int64_t get_available_bytes(OutputStream p_stream) const;
+	int64_t read_available_into(uint8_t *r_dst, int64_t p_max_bytes, OutputStream p_stream = OUTPUT_STDOUT);
+	// Resizes r_buffer to what was read and copies straight out of the output buffer
+	int64_t read_available_into(PackedByteArray &r_buffer, OutputStream p_stream = OUTPUT_STDOUT, int64_t p_max_bytes = -1);
+	bool is_output_closed(OutputStream p_stream) const;
+
+	// The callback gets each line as a String, lines are only split and dispatched by dispatch_lines(),
+	// on the thread that calls it
+	void set_line_callback(OutputStream p_stream, const Callable &p_callback);
+	Callable get_line_callback(OutputStream p_stream) const;
+	int dispatch_lines();
+
 	virtual int get_exit_status() const { return -1; };
 	virtual int get_id() const { return -1; };
 	virtual void kill(bool m_force = false){};
 	virtual bool write(const String &p_input) { return false; };
 	virtual void close_stdin(){};
 
+	Process();
 	virtual ~Process(){};
 };
 
+VARIANT_ENUM_CAST(Process::OutputStream);
+
 #endif // PROCESS_H
@@ -0,0 +1,200 @@
+#include "process_output_buffer.h"
+
+#include <cstring>
+
+ProcessOutputBuffer::ProcessOutputBuffer() {
+	set_capacity(1 << 16);
+}
+
+void ProcessOutputBuffer::set_capacity(uint32_t p_capacity) {
+	ERR_FAIL_COND_MSG(write_position.load(std::memory_order_relaxed) != 0, "Can't resize a process output buffer that was already written to.");
+	ring.resize(next_power_of_2(MAX(p_capacity, 1u)));
+	ring_mask = ring.size() - 1;
+}
+
+void ProcessOutputBuffer::write(const uint8_t *p_data, uint64_t p_size) {
+	// Once something spilled everything goes to the spill buffer until the consumer catches up, to keep the order
+	if (!spilled.load(std::memory_order_acquire)) {
+		const uint64_t write_pos = write_position.load(std::memory_order_relaxed);
+		const uint64_t read_pos = read_position.load(std::memory_order_acquire);
+		const uint64_t to_ring = MIN(p_size, ring.size() - (write_pos - read_pos));
+		const uint64_t offset = write_pos & ring_mask;
+		const uint64_t first = MIN(to_ring, ring.size() - offset);
+		memcpy(ring.ptr() + offset, p_data, first);
+		memcpy(ring.ptr(), p_data + first, to_ring - first);
+		write_position.store(write_pos + to_ring, std::memory_order_release);
+
+		p_data += to_ring;
+		p_size -= to_ring;
+		if (p_size == 0) {
+			return;
+		}
+	}
+
+	MutexLock lock(spill_mutex);
+	const uint32_t spill_size = spill.size();
+	spill.resize(spill_size + p_size);
+	memcpy(spill.ptr() + spill_size, p_data, p_size);
+	spilled.store(true, std::memory_order_release);
+}
+
+uint64_t ProcessOutputBuffer::_read_ring(uint8_t *r_dst, uint64_t p_max_bytes) {
+	const uint64_t write_pos = write_position.load(std::memory_order_acquire);
+	const uint64_t read_pos = read_position.load(std::memory_order_relaxed);
+	const uint64_t to_read = MIN(p_max_bytes, write_pos - read_pos);
+	const uint64_t offset = read_pos & ring_mask;
+	const uint64_t first = MIN(to_read, ring.size() - offset);
+	memcpy(r_dst, ring.ptr() + offset, first);
+	memcpy(r_dst + first, ring.ptr(), to_read - first);
+	read_position.store(read_pos + to_read, std::memory_order_release);
+	return to_read;
+}
+
+uint64_t ProcessOutputBuffer::_read(uint8_t *r_dst, uint64_t p_max_bytes) {
+	uint64_t total = _read_ring(r_dst, p_max_bytes);
+	if (total == p_max_bytes || !spilled.load(std::memory_order_acquire)) {
+		return total;
+	}
+
+	MutexLock lock(spill_mutex);
+	// The producer may have filled the ring again before it spilled, that data comes first
+	total += _read_ring(r_dst + total, p_max_bytes - total);
+	const uint64_t from_spill = MIN(p_max_bytes - total, uint64_t(spill.size() - spill_read_position));
+	memcpy(r_dst + total, spill.ptr() + spill_read_position, from_spill);
+	spill_read_position += from_spill;
+	total += from_spill;
+	if (spill_read_position == spill.size()) {
+		spill.reset();
+		spill_read_position = 0;
+		spilled.store(false, std::memory_order_release);
+	}
+	return total;
+}
+
+uint64_t ProcessOutputBuffer::_get_available_bytes() {
+	uint64_t available = write_position.load(std::memory_order_acquire) - read_position.load(std::memory_order_relaxed);
+	if (spilled.load(std::memory_order_acquire)) {
+		MutexLock lock(spill_mutex);
+		// Re-read under the lock, the ring can't grow while the spill buffer is in use
+		available = write_position.load(std::memory_order_acquire) - read_position.load(std::memory_order_relaxed);
+		available += spill.size() - spill_read_position;
+	}
+	return available;
+}
+
+uint64_t ProcessOutputBuffer::get_available_bytes() {
+	MutexLock lock(consumer_mutex);
+	return line_bytes.size() + _get_available_bytes();
+}
+
+uint64_t ProcessOutputBuffer::read(uint8_t *r_dst, uint64_t p_max_bytes) {
+	MutexLock lock(consumer_mutex);
+	// Bytes of an unfinished line are still unread as far as raw readers are concerned
+	const uint64_t pending = MIN(p_max_bytes, uint64_t(line_bytes.size()));
+	if (pending > 0) {
+		memcpy(r_dst, line_bytes.ptr(), pending);
+		memmove(line_bytes.ptr(), line_bytes.ptr() + pending, line_bytes.size() - pending);
+		line_bytes.resize(line_bytes.size() - pending);
+		line_scan_position = 0;
+	}
+	return pending + _read(r_dst + pending, p_max_bytes - pending);
+}
+
+int64_t ProcessOutputBuffer::read_available_into(Vector<uint8_t> &r_buffer, int64_t p_max_bytes) {
+	MutexLock lock(consumer_mutex);
+	uint64_t available = line_bytes.size() + _get_available_bytes();
+	if (p_max_bytes >= 0) {
+		available = MIN(available, uint64_t(p_max_bytes));
+	}
+	r_buffer.resize(available);
+	if (available == 0) {
+		return 0;
+	}
+
+	uint8_t *dst = r_buffer.ptrw();
+	const uint64_t pending = MIN(available, uint64_t(line_bytes.size()));
+	if (pending > 0) {
+		memcpy(dst, line_bytes.ptr(), pending);
+		memmove(line_bytes.ptr(), line_bytes.ptr() + pending, line_bytes.size() - pending);
+		line_bytes.resize(line_bytes.size() - pending);
+		line_scan_position = 0;
+	}
+	// Only this consumer takes bytes out, so everything counted above is still there
+	return pending + _read(dst + pending, available - pending);
+}
+
+void ProcessOutputBuffer::_split_lines() {
+	// Checked before draining, so a trailing line is only flushed once the producer is really done
+	const bool was_closed = is_closed();
+
+	const uint64_t available = _get_available_bytes();
+	if (available > 0) {
+		const uint32_t old_size = line_bytes.size();
+		line_bytes.resize(old_size + available);
+		line_bytes.resize(old_size + _read(line_bytes.ptr() + old_size, available));
+	}
+
+	if (lines_head > 0 && lines_head * 2 >= lines.size()) {
+		for (uint32_t i = lines_head; i < lines.size(); i++) {
+			lines[i - lines_head] = lines[i];
+		}
+		lines.resize(lines.size() - lines_head);
+		lines_head = 0;
+	}
+
+	const uint8_t *bytes = line_bytes.ptr();
+	uint32_t line_start = 0;
+	uint32_t position = line_scan_position;
+	while (position < line_bytes.size()) {
+		const uint8_t *newline = (const uint8_t *)memchr(bytes + position, '\n', line_bytes.size() - position);
+		if (!newline) {
+			break;
+		}
+		uint32_t line_end = newline - bytes;
+		position = line_end + 1;
+		if (line_end > line_start && bytes[line_end - 1] == '\r') {
+			line_end--;
+		}
+		String line;
+		line.parse_utf8((const char *)bytes + line_start, line_end - line_start);
+		lines.push_back(line);
+		line_start = position;
+	}
+
+	if (was_closed && line_start < line_bytes.size()) {
+		String line;
+		line.parse_utf8((const char *)bytes + line_start, line_bytes.size() - line_start);
+		lines.push_back(line);
+		line_start = line_bytes.size();
+	}
+
+	if (line_start > 0) {
+		memmove(line_bytes.ptr(), line_bytes.ptr() + line_start, line_bytes.size() - line_start);
+		line_bytes.resize(line_bytes.size() - line_start);
+	}
+	line_scan_position = line_bytes.size();
+}
+
+int ProcessOutputBuffer::get_available_lines() {
+	MutexLock lock(consumer_mutex);
+	_split_lines();
+	return lines.size() - lines_head;
+}
+
+bool ProcessOutputBuffer::pop_line(String &r_line) {
+	MutexLock lock(consumer_mutex);
+	if (lines_head == lines.size()) {
+		_split_lines();
+		if (lines_head == lines.size()) {
+			return false;
+		}
+	}
+	r_line = lines[lines_head];
+	lines[lines_head] = String();
+	lines_head++;
+	if (lines_head == lines.size()) {
+		lines.clear();
+		lines_head = 0;
+	}
+	return true;
+}
@@ -0,0 +1,64 @@
+#ifndef PROCESS_OUTPUT_BUFFER_H
+#define PROCESS_OUTPUT_BUFFER_H
+
+#include "core/os/mutex.h"
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+
+#include <atomic>
+
+// Buffers one output stream of a child process. The thread reading the pipe (the producer) writes into
+// a lock-free single producer/single consumer ring, so it never waits on the game and the child never
+// stalls on a full pipe. When the ring is full the bytes spill into a locked overflow buffer instead of
+// blocking, and stay ordered after the ring contents.
+// Consumers either read raw bytes or split the stream into lines, a stream should only be read one way.
+class ProcessOutputBuffer {
+	// Producer/consumer state
+	LocalVector<uint8_t> ring;
+	uint64_t ring_mask = 0;
+	std::atomic<uint64_t> write_position = 0;
+	std::atomic<uint64_t> read_position = 0;
+	std::atomic<bool> spilled = false;
+	std::atomic<bool> closed = false;
+
+	Mutex spill_mutex;
+	LocalVector<uint8_t> spill;
+	uint32_t spill_read_position = 0;
+
+	// Consumer only state, serializes consumers with each other but never with the producer
+	Mutex consumer_mutex;
+	LocalVector<uint8_t> line_bytes;
+	uint32_t line_scan_position = 0;
+	LocalVector<String> lines;
+	uint32_t lines_head = 0;
+
+	uint64_t _read_ring(uint8_t *r_dst, uint64_t p_max_bytes);
+	uint64_t _read(uint8_t *r_dst, uint64_t p_max_bytes);
+	uint64_t _get_available_bytes();
+	void _split_lines();
+
+public:
+	// Capacity is rounded up to a power of two, must be called before any data is written
+	void set_capacity(uint32_t p_capacity);
+	uint32_t get_capacity() const { return ring.size(); }
+
+	// Producer side, only ever called from a single thread
+	void write(const uint8_t *p_data, uint64_t p_size);
+	// Called by the producer after the last write, lets a trailing line without a newline through
+	void close() { closed.store(true, std::memory_order_release); }
+	bool is_closed() const { return closed.load(std::memory_order_acquire); }
+
+	// Raw consumer side, bytes already split into lines are not returned again
+	uint64_t get_available_bytes();
+	uint64_t read(uint8_t *r_dst, uint64_t p_max_bytes);
+	// Resizes r_buffer to the bytes read and copies straight from the ring into it, returns the bytes read
+	int64_t read_available_into(Vector<uint8_t> &r_buffer, int64_t p_max_bytes = -1);
+
+	// Line consumer side, lines don't include the line terminator
+	int get_available_lines();
+	bool pop_line(String &r_line);
+
+	ProcessOutputBuffer();
+};
+
+#endif // PROCESS_OUTPUT_BUFFER_H
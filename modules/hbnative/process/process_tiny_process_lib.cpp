@@ -36,15 +36,11 @@ void ProcessTinyProcessLibrary::make_default() {
 }
 
 void ProcessTinyProcessLibrary::_on_stdout(const char *bytes, size_t size) {
-	String line;
-	line.parse_utf8(bytes, size);
-	_push_stdout_line(line);
+	_push_output(OUTPUT_STDOUT, bytes, size);
 }
 
 void ProcessTinyProcessLibrary::_on_stderr(const char *bytes, size_t size) {
-	String line;
-	line.parse_utf8(bytes, size);
-	_push_stderr_line(line);
+	_push_output(OUTPUT_STDERR, bytes, size);
 }
 
 Ref<Process> ProcessTinyProcessLibrary::create_tpl(const String &p_path, const Vector<String> &p_arguments, const String &p_working_dir, bool p_open_stdin) {
@@ -102,11 +98,15 @@ ProcessTinyProcessLibrary::ProcessTinyProcessLibrary(const String &m_path, const
 
 	TinyProcessLib::Process::string_type working_dir = godot_to_std_string(p_working_dir);
 
+	TinyProcessLib::Config config;
+	config.on_stdout_close = [this]() { _close_output(OUTPUT_STDOUT); };
+	config.on_stderr_close = [this]() { _close_output(OUTPUT_STDERR); };
+
 	process = memnew(TinyProcessLib::Process(
 			args, working_dir,
 			std::bind(&ProcessTinyProcessLibrary::_on_stdout, this, std::placeholders::_1, std::placeholders::_2),
 			std::bind(&ProcessTinyProcessLibrary::_on_stderr, this, std::placeholders::_1, std::placeholders::_2),
-			p_open_stdin));
+			p_open_stdin, config));
 }
 
 ProcessTinyProcessLibrary::~ProcessTinyProcessLibrary() {
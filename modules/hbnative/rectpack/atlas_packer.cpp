@@ -0,0 +1,458 @@
+#include "atlas_packer.h"
+
+#include "core/object/class_db.h"
+#include "core/templates/sort_array.h"
+
+void HBAtlasPacker::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_size", "size"), &HBAtlasPacker::set_size);
+	ClassDB::bind_method(D_METHOD("get_size"), &HBAtlasPacker::get_size);
+	ClassDB::bind_method(D_METHOD("set_heuristic", "heuristic"), &HBAtlasPacker::set_heuristic);
+	ClassDB::bind_method(D_METHOD("get_heuristic"), &HBAtlasPacker::get_heuristic);
+	ClassDB::bind_method(D_METHOD("set_fit", "fit"), &HBAtlasPacker::set_fit);
+	ClassDB::bind_method(D_METHOD("get_fit"), &HBAtlasPacker::get_fit);
+	ClassDB::bind_method(D_METHOD("set_padding", "padding"), &HBAtlasPacker::set_padding);
+	ClassDB::bind_method(D_METHOD("get_padding"), &HBAtlasPacker::get_padding);
+
+	ClassDB::bind_method(D_METHOD("insert", "size"), &HBAtlasPacker::insert);
+	ClassDB::bind_method(D_METHOD("insert_batch", "sizes"), &HBAtlasPacker::insert_batch);
+	ClassDB::bind_method(D_METHOD("remove", "id"), &HBAtlasPacker::remove);
+	ClassDB::bind_method(D_METHOD("grow", "size"), &HBAtlasPacker::grow);
+	ClassDB::bind_method(D_METHOD("clear"), &HBAtlasPacker::clear);
+
+	ClassDB::bind_method(D_METHOD("has_rect", "id"), &HBAtlasPacker::has_rect);
+	ClassDB::bind_method(D_METHOD("get_rect", "id"), &HBAtlasPacker::get_rect);
+	ClassDB::bind_method(D_METHOD("get_rect_count"), &HBAtlasPacker::get_rect_count);
+	ClassDB::bind_method(D_METHOD("can_fit", "size"), &HBAtlasPacker::can_fit);
+	ClassDB::bind_method(D_METHOD("get_occupancy"), &HBAtlasPacker::get_occupancy);
+	ClassDB::bind_method(D_METHOD("get_used_area"), &HBAtlasPacker::get_used_area);
+	ClassDB::bind_method(D_METHOD("get_free_rect_count"), &HBAtlasPacker::get_free_rect_count);
+
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2I, "size"), "set_size", "get_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "heuristic", PROPERTY_HINT_ENUM, "MaxRects,Guillotine"), "set_heuristic", "get_heuristic");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "fit", PROPERTY_HINT_ENUM, "Best Short Side,Best Long Side,Best Area,Bottom Left,Contact Point"), "set_fit", "get_fit");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "padding"), "set_padding", "get_padding");
+
+	BIND_ENUM_CONSTANT(HEURISTIC_MAXRECTS);
+	BIND_ENUM_CONSTANT(HEURISTIC_GUILLOTINE);
+
+	BIND_ENUM_CONSTANT(FIT_BEST_SHORT_SIDE);
+	BIND_ENUM_CONSTANT(FIT_BEST_LONG_SIDE);
+	BIND_ENUM_CONSTANT(FIT_BEST_AREA);
+	BIND_ENUM_CONSTANT(FIT_BOTTOM_LEFT);
+	BIND_ENUM_CONSTANT(FIT_CONTACT_POINT);
+}
+
+void HBAtlasPacker::_reset() {
+	rects.clear();
+	free_ids.clear();
+	free_rects.clear();
+	free_rects.push_back(Rect2i(Point2i(), size));
+	used_area = 0;
+	rect_count = 0;
+	free_rects_dirty = false;
+}
+
+void HBAtlasPacker::_rebuild_free_rects() {
+	free_rects.clear();
+	free_rects.push_back(Rect2i(Point2i(), size));
+	for (const PackedRect &rect : rects) {
+		if (rect.used) {
+			_place_maxrects(rect.rect);
+		}
+	}
+	free_rects_dirty = false;
+}
+
+int HBAtlasPacker::_contact_point_score(const Rect2i &p_rect) const {
+	int score = 0;
+	if (p_rect.position.x == 0 || p_rect.get_end().x == size.x) {
+		score += p_rect.size.y;
+	}
+	if (p_rect.position.y == 0 || p_rect.get_end().y == size.y) {
+		score += p_rect.size.x;
+	}
+	for (const PackedRect &other : rects) {
+		if (!other.used) {
+			continue;
+		}
+		const Rect2i &r = other.rect;
+		if (r.position.x == p_rect.get_end().x || r.get_end().x == p_rect.position.x) {
+			score += MAX(0, MIN(r.get_end().y, p_rect.get_end().y) - MAX(r.position.y, p_rect.position.y));
+		}
+		if (r.position.y == p_rect.get_end().y || r.get_end().y == p_rect.position.y) {
+			score += MAX(0, MIN(r.get_end().x, p_rect.get_end().x) - MAX(r.position.x, p_rect.position.x));
+		}
+	}
+	return score;
+}
+
+int HBAtlasPacker::_find_free_rect(const Size2i &p_size, Rect2i &r_rect) const {
+	int best = -1;
+	int64_t best_primary = INT64_MAX;
+	int64_t best_secondary = INT64_MAX;
+
+	Fit effective_fit = fit;
+	if (effective_fit == FIT_CONTACT_POINT && heuristic != HEURISTIC_MAXRECTS) {
+		effective_fit = FIT_BEST_AREA;
+	}
+
+	for (uint32_t i = 0; i < free_rects.size(); i++) {
+		const Rect2i &free_rect = free_rects[i];
+		if (free_rect.size.x < p_size.x || free_rect.size.y < p_size.y) {
+			continue;
+		}
+		const int64_t leftover_x = free_rect.size.x - p_size.x;
+		const int64_t leftover_y = free_rect.size.y - p_size.y;
+		int64_t primary = 0;
+		int64_t secondary = 0;
+		switch (effective_fit) {
+			case FIT_BEST_SHORT_SIDE: {
+				primary = MIN(leftover_x, leftover_y);
+				secondary = MAX(leftover_x, leftover_y);
+			} break;
+			case FIT_BEST_LONG_SIDE: {
+				primary = MAX(leftover_x, leftover_y);
+				secondary = MIN(leftover_x, leftover_y);
+			} break;
+			case FIT_BEST_AREA: {
+				primary = (int64_t)free_rect.size.x * free_rect.size.y - (int64_t)p_size.x * p_size.y;
+				secondary = MIN(leftover_x, leftover_y);
+			} break;
+			case FIT_BOTTOM_LEFT: {
+				primary = free_rect.position.y + p_size.y;
+				secondary = free_rect.position.x;
+			} break;
+			case FIT_CONTACT_POINT: {
+				// Higher contact is better
+				primary = -_contact_point_score(Rect2i(free_rect.position, p_size));
+				secondary = MIN(leftover_x, leftover_y);
+			} break;
+		}
+		if (primary < best_primary || (primary == best_primary && secondary < best_secondary)) {
+			best = i;
+			best_primary = primary;
+			best_secondary = secondary;
+		}
+	}
+
+	if (best != -1) {
+		r_rect = Rect2i(free_rects[best].position, p_size);
+	}
+	return best;
+}
+
+void HBAtlasPacker::_place_maxrects(const Rect2i &p_rect) {
+	// Split every free rect the new rect overlaps into the (up to 4) maximal rects around it
+	LocalVector<Rect2i> new_rects;
+	for (uint32_t i = 0; i < free_rects.size();) {
+		const Rect2i free_rect = free_rects[i];
+		if (!free_rect.intersects(p_rect)) {
+			i++;
+			continue;
+		}
+		if (p_rect.position.x > free_rect.position.x) {
+			new_rects.push_back(Rect2i(free_rect.position.x, free_rect.position.y, p_rect.position.x - free_rect.position.x, free_rect.size.y));
+		}
+		if (p_rect.get_end().x < free_rect.get_end().x) {
+			new_rects.push_back(Rect2i(p_rect.get_end().x, free_rect.position.y, free_rect.get_end().x - p_rect.get_end().x, free_rect.size.y));
+		}
+		if (p_rect.position.y > free_rect.position.y) {
+			new_rects.push_back(Rect2i(free_rect.position.x, free_rect.position.y, free_rect.size.x, p_rect.position.y - free_rect.position.y));
+		}
+		if (p_rect.get_end().y < free_rect.get_end().y) {
+			new_rects.push_back(Rect2i(free_rect.position.x, p_rect.get_end().y, free_rect.size.x, free_rect.get_end().y - p_rect.get_end().y));
+		}
+		free_rects.remove_at_unordered(i);
+	}
+
+	// The untouched free rects don't contain each other already, so only the new ones need pruning
+	const uint32_t old_count = free_rects.size();
+	for (uint32_t i = 0; i < new_rects.size(); i++) {
+		bool contained = false;
+		for (uint32_t j = 0; j < new_rects.size() && !contained; j++) {
+			if (i != j && new_rects[j].encloses(new_rects[i]) && (new_rects[j] != new_rects[i] || j < i)) {
+				contained = true;
+			}
+		}
+		for (uint32_t j = 0; j < old_count && !contained; j++) {
+			contained = free_rects[j].encloses(new_rects[i]);
+		}
+		if (!contained) {
+			free_rects.push_back(new_rects[i]);
+		}
+	}
+}
+
+void HBAtlasPacker::_place_guillotine(int p_free_rect, const Rect2i &p_rect) {
+	const Rect2i free_rect = free_rects[p_free_rect];
+	free_rects.remove_at_unordered(p_free_rect);
+
+	const int leftover_x = free_rect.size.x - p_rect.size.x;
+	const int leftover_y = free_rect.size.y - p_rect.size.y;
+
+	// Shorter leftover axis split, the bigger leftover gets the whole side of the free rect
+	Rect2i right;
+	Rect2i bottom;
+	if (leftover_x <= leftover_y) {
+		right = Rect2i(free_rect.position.x + p_rect.size.x, free_rect.position.y, leftover_x, p_rect.size.y);
+		bottom = Rect2i(free_rect.position.x, free_rect.position.y + p_rect.size.y, free_rect.size.x, leftover_y);
+	} else {
+		right = Rect2i(free_rect.position.x + p_rect.size.x, free_rect.position.y, leftover_x, free_rect.size.y);
+		bottom = Rect2i(free_rect.position.x, free_rect.position.y + p_rect.size.y, p_rect.size.x, leftover_y);
+	}
+	if (right.has_area()) {
+		free_rects.push_back(right);
+	}
+	if (bottom.has_area()) {
+		free_rects.push_back(bottom);
+	}
+}
+
+void HBAtlasPacker::_free_guillotine(const Rect2i &p_rect) {
+	free_rects.push_back(p_rect);
+
+	// Merge free rects that share a whole edge until nothing changes
+	bool merged = true;
+	while (merged) {
+		merged = false;
+		for (uint32_t i = 0; i < free_rects.size() && !merged; i++) {
+			for (uint32_t j = i + 1; j < free_rects.size() && !merged; j++) {
+				Rect2i &a = free_rects[i];
+				const Rect2i &b = free_rects[j];
+				if (a.position.x == b.position.x && a.size.x == b.size.x) {
+					if (a.get_end().y == b.position.y) {
+						a.size.y += b.size.y;
+						merged = true;
+					} else if (b.get_end().y == a.position.y) {
+						a.position.y = b.position.y;
+						a.size.y += b.size.y;
+						merged = true;
+					}
+				} else if (a.position.y == b.position.y && a.size.y == b.size.y) {
+					if (a.get_end().x == b.position.x) {
+						a.size.x += b.size.x;
+						merged = true;
+					} else if (b.get_end().x == a.position.x) {
+						a.position.x = b.position.x;
+						a.size.x += b.size.x;
+						merged = true;
+					}
+				}
+				if (merged) {
+					free_rects.remove_at_unordered(j);
+				}
+			}
+		}
+	}
+}
+
+int HBAtlasPacker::_insert(const Size2i &p_size) {
+	ERR_FAIL_COND_V_MSG(p_size.x <= 0 || p_size.y <= 0, -1, "Rect size must be positive.");
+
+	if (free_rects_dirty) {
+		_rebuild_free_rects();
+	}
+
+	Rect2i placed;
+	int free_rect = _find_free_rect(p_size + Size2i(padding, padding), placed);
+	if (free_rect == -1) {
+		return -1;
+	}
+
+	if (heuristic == HEURISTIC_MAXRECTS) {
+		_place_maxrects(placed);
+	} else {
+		_place_guillotine(free_rect, placed);
+	}
+
+	int id;
+	if (!free_ids.is_empty()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.remove_at(free_ids.size() - 1);
+	} else {
+		id = rects.size();
+		rects.push_back(PackedRect());
+	}
+	rects[id].rect = placed;
+	rects[id].used = true;
+	used_area += (int64_t)p_size.x * p_size.y;
+	rect_count++;
+	return id;
+}
+
+HBAtlasPacker::HBAtlasPacker() {
+	_reset();
+}
+
+void HBAtlasPacker::set_size(const Size2i &p_size) {
+	ERR_FAIL_COND(p_size.x <= 0 || p_size.y <= 0);
+	MutexLock lock(mutex);
+	size = p_size;
+	_reset();
+}
+
+Size2i HBAtlasPacker::get_size() const {
+	MutexLock lock(mutex);
+	return size;
+}
+
+void HBAtlasPacker::set_heuristic(Heuristic p_heuristic) {
+	MutexLock lock(mutex);
+	heuristic = p_heuristic;
+	_reset();
+}
+
+HBAtlasPacker::Heuristic HBAtlasPacker::get_heuristic() const {
+	MutexLock lock(mutex);
+	return heuristic;
+}
+
+void HBAtlasPacker::set_fit(Fit p_fit) {
+	MutexLock lock(mutex);
+	fit = p_fit;
+}
+
+HBAtlasPacker::Fit HBAtlasPacker::get_fit() const {
+	MutexLock lock(mutex);
+	return fit;
+}
+
+void HBAtlasPacker::set_padding(int p_padding) {
+	ERR_FAIL_COND(p_padding < 0);
+	MutexLock lock(mutex);
+	padding = p_padding;
+	_reset();
+}
+
+int HBAtlasPacker::get_padding() const {
+	MutexLock lock(mutex);
+	return padding;
+}
+
+int HBAtlasPacker::insert(const Size2i &p_size) {
+	MutexLock lock(mutex);
+	return _insert(p_size);
+}
+
+PackedInt32Array HBAtlasPacker::insert_batch(const PackedVector2Array &p_sizes) {
+	struct SizeSort {
+		const Vector2 *sizes;
+		bool operator()(int p_a, int p_b) const {
+			const Vector2 &a = sizes[p_a];
+			const Vector2 &b = sizes[p_b];
+			real_t a_max = MAX(a.x, a.y);
+			real_t b_max = MAX(b.x, b.y);
+			if (a_max != b_max) {
+				return a_max > b_max;
+			}
+			return a.x * a.y > b.x * b.y;
+		}
+	};
+
+	LocalVector<int> order;
+	order.resize(p_sizes.size());
+	for (int i = 0; i < p_sizes.size(); i++) {
+		order[i] = i;
+	}
+	SortArray<int, SizeSort> sorter;
+	sorter.compare.sizes = p_sizes.ptr();
+	sorter.sort(order.ptr(), order.size());
+
+	PackedInt32Array ids;
+	ids.resize(p_sizes.size());
+	int32_t *ids_ptr = ids.ptrw();
+
+	MutexLock lock(mutex);
+	for (int index : order) {
+		ids_ptr[index] = _insert(Size2i(p_sizes[index]));
+	}
+	return ids;
+}
+
+bool HBAtlasPacker::remove(int p_id) {
+	MutexLock lock(mutex);
+	ERR_FAIL_INDEX_V(p_id, (int)rects.size(), false);
+	ERR_FAIL_COND_V(!rects[p_id].used, false);
+
+	PackedRect &rect = rects[p_id];
+	rect.used = false;
+	free_ids.push_back(p_id);
+	const Size2i rect_size = rect.rect.size - Size2i(padding, padding);
+	used_area -= (int64_t)rect_size.x * rect_size.y;
+	rect_count--;
+
+	if (heuristic == HEURISTIC_MAXRECTS) {
+		free_rects_dirty = true;
+	} else {
+		_free_guillotine(rect.rect);
+	}
+	return true;
+}
+
+void HBAtlasPacker::grow(const Size2i &p_size) {
+	MutexLock lock(mutex);
+	ERR_FAIL_COND_MSG(p_size.x < size.x || p_size.y < size.y, "The atlas can only grow.");
+	const Size2i old_size = size;
+	size = p_size;
+	if (heuristic == HEURISTIC_MAXRECTS) {
+		free_rects_dirty = true;
+		return;
+	}
+	// The bottom strip spans the full new width so wide rects fit after growing in both directions
+	if (size.x > old_size.x) {
+		_free_guillotine(Rect2i(old_size.x, 0, size.x - old_size.x, old_size.y));
+	}
+	if (size.y > old_size.y) {
+		_free_guillotine(Rect2i(0, old_size.y, size.x, size.y - old_size.y));
+	}
+}
+
+void HBAtlasPacker::clear() {
+	MutexLock lock(mutex);
+	_reset();
+}
+
+bool HBAtlasPacker::has_rect(int p_id) const {
+	MutexLock lock(mutex);
+	return p_id >= 0 && p_id < (int)rects.size() && rects[p_id].used;
+}
+
+Rect2i HBAtlasPacker::get_rect(int p_id) const {
+	MutexLock lock(mutex);
+	ERR_FAIL_INDEX_V(p_id, (int)rects.size(), Rect2i());
+	ERR_FAIL_COND_V(!rects[p_id].used, Rect2i());
+	const Rect2i &rect = rects[p_id].rect;
+	return Rect2i(rect.position, rect.size - Size2i(padding, padding));
+}
+
+int HBAtlasPacker::get_rect_count() const {
+	MutexLock lock(mutex);
+	return rect_count;
+}
+
+bool HBAtlasPacker::can_fit(const Size2i &p_size) {
+	MutexLock lock(mutex);
+	if (free_rects_dirty) {
+		_rebuild_free_rects();
+	}
+	Rect2i rect;
+	return _find_free_rect(p_size + Size2i(padding, padding), rect) != -1;
+}
+
+float HBAtlasPacker::get_occupancy() const {
+	MutexLock lock(mutex);
+	return used_area / (double)((int64_t)size.x * size.y);
+}
+
+int64_t HBAtlasPacker::get_used_area() const {
+	MutexLock lock(mutex);
+	return used_area;
+}
+
+int HBAtlasPacker::get_free_rect_count() {
+	MutexLock lock(mutex);
+	if (free_rects_dirty) {
+		_rebuild_free_rects();
+	}
+	return free_rects.size();
+}
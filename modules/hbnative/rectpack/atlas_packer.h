@@ -0,0 +1,101 @@
+#ifndef ATLAS_PACKER_H
+#define ATLAS_PACKER_H
+
+#include "core/math/rect2i.h"
+#include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+
+// Incremental atlas packer, unlike HBRectPack it keeps its state around so rects can be added and
+// removed one at a time without repacking the whole atlas. Every instance has its own state behind
+// a mutex, so separate atlases can be packed on separate threads.
+class HBAtlasPacker : public RefCounted {
+	GDCLASS(HBAtlasPacker, RefCounted);
+
+public:
+	enum Heuristic {
+		// Keeps every maximal free rectangle, packs tighter but inserts are slower
+		HEURISTIC_MAXRECTS,
+		// Free space is a set of disjoint rectangles split on every insert, fast but fragments more
+		HEURISTIC_GUILLOTINE,
+	};
+
+	enum Fit {
+		FIT_BEST_SHORT_SIDE,
+		FIT_BEST_LONG_SIDE,
+		FIT_BEST_AREA,
+		FIT_BOTTOM_LEFT,
+		// MaxRects only, touches as many edges of other rects as possible, falls back to best area otherwise
+		FIT_CONTACT_POINT,
+	};
+
+private:
+	struct PackedRect {
+		Rect2i rect; // Includes padding
+		bool used = false;
+	};
+
+	mutable Mutex mutex;
+
+	Size2i size = Size2i(1024, 1024);
+	Heuristic heuristic = HEURISTIC_MAXRECTS;
+	Fit fit = FIT_BEST_SHORT_SIDE;
+	int padding = 0;
+
+	LocalVector<PackedRect> rects;
+	LocalVector<int> free_ids;
+	LocalVector<Rect2i> free_rects;
+	int64_t used_area = 0;
+	int rect_count = 0;
+	// MaxRects free space is rebuilt from the used rects on the next insert after a removal
+	bool free_rects_dirty = false;
+
+	void _reset();
+	void _rebuild_free_rects();
+	int _contact_point_score(const Rect2i &p_rect) const;
+	int _find_free_rect(const Size2i &p_size, Rect2i &r_rect) const;
+	void _place_maxrects(const Rect2i &p_rect);
+	void _place_guillotine(int p_free_rect, const Rect2i &p_rect);
+	void _free_guillotine(const Rect2i &p_rect);
+	int _insert(const Size2i &p_size);
+
+protected:
+	static void _bind_methods();
+
+public:
+	HBAtlasPacker();
+
+	// Changing the size, heuristic or padding clears the packer
+	void set_size(const Size2i &p_size);
+	Size2i get_size() const;
+	void set_heuristic(Heuristic p_heuristic);
+	Heuristic get_heuristic() const;
+	void set_fit(Fit p_fit);
+	Fit get_fit() const;
+	void set_padding(int p_padding);
+	int get_padding() const;
+
+	// Returns the id of the new rect or -1 if it doesn't fit
+	int insert(const Size2i &p_size);
+	// Packs biggest first for a better fit, ids are returned in the original order
+	PackedInt32Array insert_batch(const PackedVector2Array &p_sizes);
+	bool remove(int p_id);
+	// Makes the atlas bigger without moving the rects already packed
+	void grow(const Size2i &p_size);
+	void clear();
+
+	bool has_rect(int p_id) const;
+	Rect2i get_rect(int p_id) const;
+	int get_rect_count() const;
+	bool can_fit(const Size2i &p_size);
+
+	// Fraction of the atlas covered by rects (without padding), used to decide when to start a new page
+	float get_occupancy() const;
+	int64_t get_used_area() const;
+	int get_free_rect_count();
+};
+
+VARIANT_ENUM_CAST(HBAtlasPacker::Heuristic);
+VARIANT_ENUM_CAST(HBAtlasPacker::Fit);
+
+#endif // ATLAS_PACKER_H
@@ -6,8 +6,6 @@
 #include "core/variant/dictionary.h"
 #include "core/variant/typed_array.h"
 
-stbrp_node HBRectPack::packer_temp_storage[MAX_RECT_SIZE] = {};
-
 void HBRectPack::_bind_methods() {
 	ClassDB::bind_static_method("HBRectPack", D_METHOD("pack_rects", "rects", "starting_pack_size"), &HBRectPack::pack_rects);
 }
@@ -29,12 +27,15 @@ Dictionary HBRectPack::pack_rects(PackedVector2Array p_rects, Vector2i p_startin
 	bool packed = false;
 
 	stbrp_context context;
+	// Per call so packing is reentrant, see HBAtlasPacker for incremental packing
+	LocalVector<stbrp_node> nodes;
+	nodes.resize(MAX_RECT_SIZE);
 
 	while (!packed && pack_size != Vector2i(MAX_RECT_SIZE, MAX_RECT_SIZE)) {
 		int min_axis = pack_size.min_axis_index();
 		pack_size.coord[min_axis] <<= 1;
 
-		stbrp_init_target(&context, pack_size.x, pack_size.y, packer_temp_storage, MAX_RECT_SIZE);
+		stbrp_init_target(&context, pack_size.x, pack_size.y, nodes.ptr(), nodes.size());
 		int result = stbrp_pack_rects(&context, rects.ptr(), rects.size());
 		if (result == 1) {
 			packed = true;
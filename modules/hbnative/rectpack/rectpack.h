@@ -10,7 +10,6 @@
 class HBRectPack : public Object {
 	GDCLASS(HBRectPack, Object);
 	static constexpr int MAX_RECT_SIZE = 8192;
-	static stbrp_node packer_temp_storage[MAX_RECT_SIZE];
 
 protected:
 	static void _bind_methods();
@@ -6,6 +6,8 @@
 #include "core/object/class_db.h"
 #include "diva/bone_db.h"
 #include "diva/diva_object.h"
+#include "diva/diva_resource_loader.h"
+#include "diva/sprite_set.h"
 #include "interval_tree.h"
 #include "modules/hbnative/ph_blur_controls.h"
 #include "multi_spin_box.h"
@@ -23,11 +25,13 @@
 #include "process/process_windows.h"
 #endif
 
+#include "rectpack/atlas_packer.h"
 #include "rectpack/rectpack.h"
 #include "threen.h"
 
 static PHAudioStreamPreviewGenerator *preview_generator_ptr = NULL;
 static PHNative *ph_ptr = NULL;
+static Ref<ResourceFormatLoaderDIVA> resource_loader_diva;
 
 const char *blur_shader_code =
 		"shader_type canvas_item;"
@@ -77,12 +81,18 @@ void initialize_hbnative_module(ModuleInitializationLevel p_level) {
 	GDREGISTER_ABSTRACT_CLASS(PHNative);
 	GDREGISTER_CLASS(MultiSpinBox);
 	GDREGISTER_CLASS(HBIntervalTree);
+	GDREGISTER_CLASS(HBIntervalTreeQueryResult);
 	GDREGISTER_CLASS(DIVABoneDB);
 	GDREGISTER_CLASS(DIVASkeleton);
 	GDREGISTER_CLASS(DIVAObjectSet);
+	GDREGISTER_CLASS(DIVASpriteSet);
 	GDREGISTER_ABSTRACT_CLASS(HBRectPack);
+	GDREGISTER_CLASS(HBAtlasPacker);
 	Engine::get_singleton()->add_singleton(Engine::Singleton("PHAudioStreamPreviewGenerator", PHAudioStreamPreviewGenerator::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("PHNative", PHNative::get_singleton()));
+
+	resource_loader_diva.instantiate();
+	ResourceLoader::add_resource_format_loader(resource_loader_diva);
 }
 
 void uninitialize_hbnative_module(ModuleInitializationLevel p_level) {
@@ -91,5 +101,7 @@ void uninitialize_hbnative_module(ModuleInitializationLevel p_level) {
 	}
 	memdelete(preview_generator_ptr);
 	memdelete(ph_ptr);
+	ResourceLoader::remove_resource_format_loader(resource_loader_diva);
+	resource_loader_diva.unref();
 	HBStyleboxBlurDrawer::blur_material.unref();
 }
@@ -0,0 +1,146 @@
+#ifndef TEST_ATLAS_PACKER_H
+#define TEST_ATLAS_PACKER_H
+
+#include "../rectpack/atlas_packer.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+namespace TestAtlasPacker {
+
+static bool rects_are_valid(const Ref<HBAtlasPacker> &p_packer, const LocalVector<int> &p_ids) {
+	const Rect2i bounds = Rect2i(Point2i(), p_packer->get_size());
+	for (uint32_t i = 0; i < p_ids.size(); i++) {
+		Rect2i rect = p_packer->get_rect(p_ids[i]);
+		if (!bounds.encloses(rect)) {
+			return false;
+		}
+		for (uint32_t j = i + 1; j < p_ids.size(); j++) {
+			if (rect.intersects(p_packer->get_rect(p_ids[j]))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void test_heuristic(HBAtlasPacker::Heuristic p_heuristic) {
+	Ref<HBAtlasPacker> packer;
+	packer.instantiate();
+	packer->set_heuristic(p_heuristic);
+	packer->set_size(Size2i(512, 512));
+	packer->set_padding(1);
+
+	RandomPCG rng(1234);
+	LocalVector<int> ids;
+	LocalVector<Size2i> sizes;
+	for (int i = 0; i < 300; i++) {
+		Size2i size = Size2i(4 + rng.rand() % 40, 4 + rng.rand() % 40);
+		int id = packer->insert(size);
+		if (id != -1) {
+			CHECK(packer->get_rect(id).size == size);
+			ids.push_back(id);
+			sizes.push_back(size);
+		}
+	}
+	CHECK(ids.size() > 0);
+	CHECK(packer->get_rect_count() == (int)ids.size());
+	CHECK_MESSAGE(rects_are_valid(packer, ids), "Rects overlap or are out of bounds.");
+
+	int64_t area = 0;
+	for (const Size2i &size : sizes) {
+		area += size.x * size.y;
+	}
+	CHECK(packer->get_used_area() == area);
+	CHECK(packer->get_occupancy() == doctest::Approx(area / double(512 * 512)));
+
+	// Freed space is reused for a rect of the same size
+	Rect2i removed = packer->get_rect(ids[0]);
+	CHECK(packer->remove(ids[0]));
+	CHECK_FALSE(packer->has_rect(ids[0]));
+	ERR_PRINT_OFF;
+	CHECK_FALSE(packer->remove(ids[0]));
+	ERR_PRINT_ON;
+	ids.remove_at_unordered(0);
+	CHECK(packer->can_fit(removed.size));
+	int reinserted = packer->insert(removed.size);
+	REQUIRE(reinserted != -1);
+	ids.push_back(reinserted);
+	CHECK_MESSAGE(rects_are_valid(packer, ids), "Rects overlap after reinserting.");
+
+	// Growing keeps the packed rects in place and makes room for one that didn't fit
+	Rect2i first = packer->get_rect(ids[0]);
+	CHECK(packer->insert(Size2i(600, 100)) == -1);
+	packer->grow(Size2i(1024, 1024));
+	CHECK(packer->get_rect(ids[0]) == first);
+	int big = packer->insert(Size2i(600, 100));
+	REQUIRE(big != -1);
+	ids.push_back(big);
+	CHECK_MESSAGE(rects_are_valid(packer, ids), "Rects overlap after growing.");
+
+	packer->clear();
+	CHECK(packer->get_rect_count() == 0);
+	CHECK(packer->get_used_area() == 0);
+}
+
+TEST_CASE("[HBAtlasPacker] MaxRects packing") {
+	test_heuristic(HBAtlasPacker::HEURISTIC_MAXRECTS);
+}
+
+TEST_CASE("[HBAtlasPacker] Guillotine packing") {
+	test_heuristic(HBAtlasPacker::HEURISTIC_GUILLOTINE);
+}
+
+TEST_CASE("[HBAtlasPacker] Batch insert") {
+	Ref<HBAtlasPacker> packer;
+	packer.instantiate();
+	packer->set_size(Size2i(256, 256));
+
+	PackedVector2Array sizes;
+	sizes.push_back(Vector2(16, 16));
+	sizes.push_back(Vector2(128, 128));
+	sizes.push_back(Vector2(300, 10));
+	sizes.push_back(Vector2(64, 32));
+
+	PackedInt32Array ids = packer->insert_batch(sizes);
+	REQUIRE(ids.size() == sizes.size());
+	CHECK(ids[2] == -1);
+	LocalVector<int> packed;
+	for (int i = 0; i < ids.size(); i++) {
+		if (i != 2) {
+			REQUIRE(ids[i] != -1);
+			CHECK(Vector2(packer->get_rect(ids[i]).size) == sizes[i]);
+			packed.push_back(ids[i]);
+		}
+	}
+	CHECK(rects_are_valid(packer, packed));
+}
+
+TEST_CASE("[HBAtlasPacker] Benchmark incremental inserts") {
+	Ref<HBAtlasPacker> packer;
+	packer.instantiate();
+	packer->set_size(Size2i(4096, 4096));
+
+	RandomPCG rng(4321);
+	LocalVector<int> ids;
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < 2000; i++) {
+		int id = packer->insert(Size2i(8 + rng.rand() % 56, 8 + rng.rand() % 56));
+		if (id != -1) {
+			ids.push_back(id);
+		}
+		// Churn like a glyph cache evicting old entries
+		if (i % 4 == 3 && ids.size() > 0) {
+			uint32_t index = rng.rand() % ids.size();
+			packer->remove(ids[index]);
+			ids.remove_at_unordered(index);
+		}
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+	MESSAGE(vformat("2000 inserts with churn: %d usec, occupancy %.3f, %d free rects", elapsed, packer->get_occupancy(), packer->get_free_rect_count()));
+	CHECK(rects_are_valid(packer, ids));
+}
+
+} // namespace TestAtlasPacker
+
+#endif // TEST_ATLAS_PACKER_H
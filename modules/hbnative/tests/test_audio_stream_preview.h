@@ -0,0 +1,140 @@
+#ifndef TEST_AUDIO_STREAM_PREVIEW_H
+#define TEST_AUDIO_STREAM_PREVIEW_H
+
+#include "../ph_audio_stream_preview.h"
+#include "core/math/random_pcg.h"
+#include "tests/test_macros.h"
+
+namespace TestAudioStreamPreview {
+
+struct BruteForceResult {
+	float min = 0.0f;
+	float max = 0.0f;
+	float avg = 0.0f;
+	float rms = 0.0f;
+};
+
+// Scans every bin in the range, the range is mapped to bins the same way the preview does it
+static BruteForceResult brute_force_query(const LocalVector<PHAudioStreamPreview::Bin> &p_bins, float p_length, float p_time, float p_time_next) {
+	const int bin_count = p_bins.size();
+	int from = CLAMP(int(p_time / p_length * bin_count), 0, bin_count - 1);
+	int to = CLAMP(int(p_time_next / p_length * bin_count), 0, bin_count);
+	if (to <= from) {
+		to = from + 1;
+	}
+
+	uint8_t min = 255;
+	uint8_t max = 0;
+	double avg_sum = 0.0;
+	double rms_sq_sum = 0.0;
+	for (int i = from; i < to; i++) {
+		min = MIN(min, p_bins[i].min);
+		max = MAX(max, p_bins[i].max);
+		avg_sum += p_bins[i].avg;
+		rms_sq_sum += p_bins[i].rms * p_bins[i].rms;
+	}
+
+	BruteForceResult result;
+	result.min = (min / 255.0) * 2.0 - 1.0;
+	result.max = (max / 255.0) * 2.0 - 1.0;
+	result.avg = (avg_sum / (to - from) / 255.0) * 2.0 - 1.0;
+	result.rms = Math::sqrt(rms_sq_sum / (to - from)) / 255.0;
+	return result;
+}
+
+static LocalVector<PHAudioStreamPreview::Bin> make_bins(RandomPCG &p_rng, int p_bin_count) {
+	LocalVector<PHAudioStreamPreview::Bin> bins;
+	bins.resize(p_bin_count);
+	for (PHAudioStreamPreview::Bin &bin : bins) {
+		const uint8_t a = p_rng.rand() % 256;
+		const uint8_t b = p_rng.rand() % 256;
+		bin.min = MIN(a, b);
+		bin.max = MAX(a, b);
+		bin.avg = bin.max;
+		bin.rms = p_rng.rand() % 256;
+	}
+	return bins;
+}
+
+// Stores the bins in uneven pieces like the generator's chunks do, so partial level updates are covered
+static Ref<PHAudioStreamPreview> make_preview(RandomPCG &p_rng, const LocalVector<PHAudioStreamPreview::Bin> &p_bins, float p_length) {
+	Ref<PHAudioStreamPreview> preview;
+	preview.instantiate();
+	preview->create_levels(p_length, p_bins.size());
+
+	uint32_t from = 0;
+	while (from < p_bins.size()) {
+		const uint32_t count = MIN(1 + p_rng.rand() % 97, p_bins.size() - from);
+		LocalVector<PHAudioStreamPreview::Bin> piece;
+		for (uint32_t i = 0; i < count; i++) {
+			piece.push_back(p_bins[from + i]);
+		}
+		preview->store_bins(from, piece);
+		from += count;
+	}
+	return preview;
+}
+
+static void check_query(const Ref<PHAudioStreamPreview> &p_preview, const LocalVector<PHAudioStreamPreview::Bin> &p_bins, float p_time, float p_time_next) {
+	const BruteForceResult expected = brute_force_query(p_bins, p_preview->get_length(), p_time, p_time_next);
+	const String range = vformat("%d bins, range %f to %f", p_bins.size(), p_time, p_time_next);
+	CHECK_MESSAGE(p_preview->get_min(p_time, p_time_next) == expected.min, range);
+	CHECK_MESSAGE(p_preview->get_max(p_time, p_time_next) == expected.max, range);
+	// Levels above the first one store rounded averages, every level can be off by half a step
+	CHECK_MESSAGE(Math::abs(p_preview->get_avg(p_time, p_time_next) - expected.avg) < 0.05f, range);
+	CHECK_MESSAGE(Math::abs(p_preview->get_rms(p_time, p_time_next) - expected.rms) < 0.03f, range);
+}
+
+TEST_CASE("[HBWaveformPreview] Pyramid queries match a scan of every bin") {
+	RandomPCG rng(1234);
+	// Odd sizes leave a partial bin at the end of most levels
+	for (int bin_count : { 1, 2, 7, 37, 1000, 4097 }) {
+		const LocalVector<PHAudioStreamPreview::Bin> bins = make_bins(rng, bin_count);
+		// One second per bin so times map straight to bin indices
+		const float length = bin_count;
+		const Ref<PHAudioStreamPreview> preview = make_preview(rng, bins, length);
+
+		// Every zoom level from a single bin to the whole stream, sliding over the end of the stream
+		for (int width : { 1, 2, 3, 5, 16, 17, 64, 333, 1024, 5000 }) {
+			for (int from = 0; from < bin_count; from += MAX(1, width / 3)) {
+				check_query(preview, bins, from, from + width);
+			}
+			check_query(preview, bins, MAX(0, bin_count - width), bin_count);
+		}
+
+		// Ranges that don't start or end on a bin boundary
+		for (int i = 0; i < 200; i++) {
+			const float a = rng.random(0.0f, length);
+			const float b = rng.random(0.0f, length);
+			check_query(preview, bins, MIN(a, b), MAX(a, b));
+		}
+	}
+}
+
+TEST_CASE("[HBWaveformPreview] Restoring bins updates every level above them") {
+	RandomPCG rng(42);
+	const int bin_count = 777;
+	LocalVector<PHAudioStreamPreview::Bin> bins = make_bins(rng, bin_count);
+	const Ref<PHAudioStreamPreview> preview = make_preview(rng, bins, bin_count);
+
+	// A single loud bin near the end must show up at every zoom level that covers it
+	PHAudioStreamPreview::Bin loud;
+	loud.min = 0;
+	loud.max = 255;
+	loud.avg = 255;
+	loud.rms = 255;
+	bins[bin_count - 3] = loud;
+	LocalVector<PHAudioStreamPreview::Bin> piece;
+	piece.push_back(loud);
+	preview->store_bins(bin_count - 3, piece);
+
+	for (int width : { 1, 4, 100, bin_count }) {
+		check_query(preview, bins, bin_count - width, bin_count);
+		CHECK(preview->get_max(bin_count - width, bin_count) == 1.0f);
+		CHECK(preview->get_min(bin_count - width, bin_count) == -1.0f);
+	}
+}
+
+} // namespace TestAudioStreamPreview
+
+#endif // TEST_AUDIO_STREAM_PREVIEW_H
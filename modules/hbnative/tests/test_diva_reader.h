@@ -0,0 +1,398 @@
+#ifndef TEST_DIVA_READER_H
+#define TEST_DIVA_READER_H
+
+#include "../diva/diva_object.h"
+#include "../diva/read_helpers.h"
+#include "../diva/sprite_set.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+#include "tests/test_utils.h"
+
+namespace TestDIVAReader {
+
+static const uint32_t OBJECT_COUNT = 200;
+static const uint32_t VERTEX_COUNT = 2000;
+static const uint32_t INDEX_COUNT = 6000;
+
+struct Writer {
+	LocalVector<uint8_t> data;
+
+	uint32_t tell() const { return data.size(); }
+
+	void put_u16(uint16_t p_value) {
+		data.push_back(p_value & 0xFF);
+		data.push_back(p_value >> 8);
+	}
+	void put_u32(uint32_t p_value) {
+		put_u16(p_value & 0xFFFF);
+		put_u16(p_value >> 16);
+	}
+	void put_float(float p_value) {
+		uint32_t bits;
+		memcpy(&bits, &p_value, 4);
+		put_u32(bits);
+	}
+	void put_zeros(uint32_t p_count) {
+		for (uint32_t i = 0; i < p_count; i++) {
+			data.push_back(0);
+		}
+	}
+	void put_string(const char *p_str) {
+		for (const char *c = p_str; *c; c++) {
+			data.push_back(*c);
+		}
+		data.push_back(0);
+	}
+	void patch_u32(uint32_t p_position, uint32_t p_value) {
+		for (int i = 0; i < 4; i++) {
+			data[p_position + i] = (p_value >> (i * 8)) & 0xFF;
+		}
+	}
+
+	Vector<uint8_t> to_vector() const {
+		Vector<uint8_t> out;
+		out.resize(data.size());
+		memcpy(out.ptrw(), data.ptr(), data.size());
+		return out;
+	}
+};
+
+static Vector3 expected_position(uint32_t p_object, uint32_t p_vertex) {
+	return Vector3(p_vertex, p_object, p_vertex * 0.5f);
+}
+
+// Object set with a single mesh per object, positions, normals, texcoords and a triangle strip index buffer
+static Vector<uint8_t> build_object_set() {
+	Writer w;
+	w.put_u32(0x05062500);
+	w.put_u32(OBJECT_COUNT);
+	w.put_u32(OBJECT_COUNT - 1); // last_obj_id
+	const uint32_t obj_datas_offset_pos = w.tell();
+	w.put_u32(0);
+	w.put_u32(0); // skins
+	const uint32_t obj_names_offset_pos = w.tell();
+	w.put_u32(0);
+	w.put_zeros(4 * 3); // ids, texture ids, texture id count
+	w.put_zeros(8);
+
+	const uint32_t obj_datas_offset = w.tell();
+	w.patch_u32(obj_datas_offset_pos, obj_datas_offset);
+	w.put_zeros(OBJECT_COUNT * 4);
+	const uint32_t obj_names_offset = w.tell();
+	w.patch_u32(obj_names_offset_pos, obj_names_offset);
+	w.put_zeros(OBJECT_COUNT * 4);
+
+	for (uint32_t i = 0; i < OBJECT_COUNT; i++) {
+		w.patch_u32(obj_names_offset + i * 4, w.tell());
+		w.put_string(vformat("object_%d", i).utf8().get_data());
+	}
+
+	const uint32_t vertex_format = 0x01 | 0x02 | 0x10; // Position, normal, texcoord0
+	for (uint32_t i = 0; i < OBJECT_COUNT; i++) {
+		w.put_zeros((4 - w.tell() % 4) % 4);
+		const uint32_t base = w.tell();
+		w.patch_u32(obj_datas_offset + i * 4, base);
+
+		// Model
+		w.put_u32(0x10000);
+		w.put_u32(0);
+		w.put_zeros(4 * 4); // Bounding sphere
+		w.put_u32(1); // Mesh count
+		w.put_u32(0x50); // Meshes offset, right after the model
+		w.put_u32(0);
+		w.put_u32(0);
+		w.put_zeros(4 * 10);
+
+		// Mesh
+		w.put_u32(0);
+		w.put_zeros(4 * 4);
+		w.put_u32(1); // Submesh count
+		const uint32_t submesh_offset_pos = w.tell();
+		w.put_u32(0);
+		w.put_u32(vertex_format);
+		w.put_u32(32);
+		w.put_u32(VERTEX_COUNT);
+		const uint32_t vertex_offsets_pos = w.tell();
+		w.put_zeros(4 * 20);
+		w.put_zeros(4 * 8);
+		w.put_zeros(64); // Name
+
+		// Submesh
+		w.patch_u32(submesh_offset_pos, w.tell() - base);
+		w.put_u32(0);
+		w.put_zeros(4 * 4);
+		w.put_u32(0); // Material
+		w.put_zeros(8); // UV indices
+		w.put_u32(0);
+		w.put_u32(0);
+		w.put_u32(0); // Bones per vertex
+		w.put_u32(5); // Triangle strip
+		w.put_u32(1); // U16 indices
+		w.put_u32(INDEX_COUNT);
+		const uint32_t indices_offset_pos = w.tell();
+		w.put_u32(0);
+		w.put_u32(0);
+		w.put_zeros(0x1C);
+
+		w.patch_u32(vertex_offsets_pos + 0 * 4, w.tell() - base);
+		for (uint32_t j = 0; j < VERTEX_COUNT; j++) {
+			Vector3 pos = expected_position(i, j);
+			w.put_float(pos.x);
+			w.put_float(pos.y);
+			w.put_float(pos.z);
+		}
+		w.patch_u32(vertex_offsets_pos + 1 * 4, w.tell() - base);
+		for (uint32_t j = 0; j < VERTEX_COUNT; j++) {
+			w.put_float(0.0f);
+			w.put_float(1.0f);
+			w.put_float(0.0f);
+		}
+		w.patch_u32(vertex_offsets_pos + 4 * 4, w.tell() - base);
+		for (uint32_t j = 0; j < VERTEX_COUNT; j++) {
+			w.put_float(j / (float)VERTEX_COUNT);
+			w.put_float(1.0f);
+		}
+		w.patch_u32(indices_offset_pos, w.tell() - base);
+		for (uint32_t j = 0; j < INDEX_COUNT; j++) {
+			// Every 100th index is a strip restart
+			w.put_u16(j % 100 == 99 ? 0xFFFF : j % VERTEX_COUNT);
+		}
+	}
+	return w.to_vector();
+}
+
+struct ErrorCounter {
+	ErrorHandlerList handler;
+	int count = 0;
+
+	static void _count_error(void *p_self, const char *p_func, const char *p_file, int p_line, const char *p_error, const char *p_errorexp, bool p_editor_notify, ErrorHandlerType p_type) {
+		((ErrorCounter *)p_self)->count++;
+	}
+
+	ErrorCounter() {
+		handler.errfunc = _count_error;
+		handler.userdata = this;
+		add_error_handler(&handler);
+	}
+
+	~ErrorCounter() {
+		remove_error_handler(&handler);
+	}
+};
+
+TEST_CASE("[DIVAReader] Span reader decoding") {
+	const uint8_t bytes[] = { 0x12, 0x34, 0x56, 0x78, 0x00, 0x01, 'h', 'i', 0, 'x' };
+
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_span(bytes, sizeof(bytes));
+	CHECK(reader.get_u32() == 0x78563412);
+	CHECK(reader.get_u16() == 0x0100);
+	CHECK(reader.read_null_terminated_string(6) == "hi");
+	// Unterminated strings stop at the end of the buffer
+	CHECK(reader.read_null_terminated_string(9) == "x");
+
+	reader.set_span(bytes, sizeof(bytes));
+	reader.set_big_endian(true);
+	uint16_t values[3];
+	reader.read_array(values, 3);
+	CHECK(values[0] == 0x1234);
+	CHECK(values[1] == 0x5678);
+	CHECK(values[2] == 0x0001);
+
+	ErrorCounter errors;
+	ERR_PRINT_OFF;
+	reader.seek(8);
+	CHECK(reader.get_u32() == 0);
+	CHECK(reader.get_u32() == 0);
+	CHECK(reader.get_u16() == 0);
+	ERR_PRINT_ON;
+	CHECK(reader.has_overflowed());
+	// Only the first overrun is reported
+	CHECK(errors.count == 1);
+}
+
+TEST_CASE("[DIVAReader] Object set import reports bad and truncated files") {
+	Vector<uint8_t> data = build_object_set();
+
+	Vector<uint8_t> bad_version = data;
+	bad_version.write[0] ^= 0xFF;
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_span(bad_version.ptr(), bad_version.size());
+	Ref<DIVAObjectSet> object_set;
+	object_set.instantiate();
+	ERR_PRINT_OFF;
+	CHECK(object_set->read_classic_span(reader) == ERR_FILE_UNRECOGNIZED);
+	ERR_PRINT_ON;
+
+	reader.set_span(data.ptr(), data.size() / 2);
+	object_set.instantiate();
+	ERR_PRINT_OFF;
+	CHECK(object_set->read_classic_span(reader) == ERR_FILE_CORRUPT);
+	ERR_PRINT_ON;
+
+	reader.set_span(data.ptr(), data.size());
+	object_set.instantiate();
+	CHECK(object_set->read_classic_span(reader) == OK);
+}
+
+TEST_CASE("[DIVAReader] Object set import matches the source data") {
+	Vector<uint8_t> data = build_object_set();
+	Ref<StreamPeerBuffer> spb;
+	spb.instantiate();
+	spb->set_data_array(data);
+
+	Ref<DIVAObjectSet> object_set;
+	object_set.instantiate();
+	object_set->read_classic(spb);
+
+	bool matches = true;
+	for (uint32_t i = 0; i < OBJECT_COUNT; i += 17) {
+		const auto *object = object_set->get_object(StringName(vformat("object_%d", i)));
+		REQUIRE(object != nullptr);
+		REQUIRE(object->meshes.size() == 1);
+		const auto &mesh = object->meshes[0];
+		REQUIRE(mesh.godot_vertex_data.positions.size() == VERTEX_COUNT);
+		REQUIRE(mesh.submeshes.size() == 1);
+		REQUIRE(mesh.submeshes[0].index_array.size() == INDEX_COUNT);
+		for (uint32_t j = 0; j < VERTEX_COUNT; j += 101) {
+			matches = matches && mesh.godot_vertex_data.positions[j] == expected_position(i, j);
+			matches = matches && mesh.godot_vertex_data.normals[j] == Vector3(0, 1, 0);
+			matches = matches && mesh.godot_vertex_data.texcoord0[j] == Vector2(j / (float)VERTEX_COUNT, 1.0f);
+		}
+		matches = matches && mesh.submeshes[0].index_array[98] == 98;
+		matches = matches && mesh.submeshes[0].index_array[99] == -1;
+	}
+	CHECK_MESSAGE(matches, "Decoded object set doesn't match the source data.");
+}
+
+// A texture set of p_texture_count single mipmap 4x4 RGBA8 textures, pixel bytes are the texture index
+static Vector<uint8_t> build_texture_set(uint32_t p_texture_count, uint32_t p_broken_texture = UINT32_MAX) {
+	Writer w;
+	w.put_u32(0x03505854);
+	w.put_u32(p_texture_count);
+	w.put_u32(p_texture_count);
+	const uint32_t offsets = w.tell();
+	w.put_zeros(4 * p_texture_count);
+
+	for (uint32_t i = 0; i < p_texture_count; i++) {
+		const uint32_t texture_start = w.tell();
+		w.patch_u32(offsets + i * 4, texture_start);
+		w.put_u32(0x04505854);
+		w.put_u32(1);
+		w.put_u32((1 << 8) | 1);
+		w.put_u32(w.tell() + 4 - texture_start);
+
+		w.put_u32(i == p_broken_texture ? 0xDEADBEEF : 0x02505854);
+		w.put_u32(4);
+		w.put_u32(4);
+		w.put_u32(2); // RGBA8
+		w.put_u32(i);
+		w.put_u32(4 * 4 * 4);
+		for (uint32_t j = 0; j < 4 * 4 * 4; j++) {
+			w.data.push_back(i);
+		}
+	}
+	return w.to_vector();
+}
+
+TEST_CASE("[DIVAReader] Texture sets copy their data and drop partial textures on failure") {
+	Vector<uint8_t> data = build_texture_set(3);
+	DIVAReadHelpers::SpanReader reader;
+	reader.set_span(data.ptr(), data.size());
+	Ref<DivaTXP> txp;
+	txp.instantiate();
+	REQUIRE(txp->read_classic_span(reader) == OK);
+	REQUIRE(txp->get_texture_count() == 3);
+	for (int i = 0; i < 3; i++) {
+		Vector<Ref<Image>> mipmaps = txp->get_texture_mipmaps(i);
+		REQUIRE(mipmaps.size() == 1);
+		CHECK(mipmaps[0]->get_data()[4 * 4 * 4 - 1] == i);
+	}
+
+	// The last texture is broken after the first two were already sized
+	data = build_texture_set(3, 2);
+	reader.set_span(data.ptr(), data.size());
+	reader.position_push(0);
+	txp.instantiate();
+	ERR_PRINT_OFF;
+	CHECK(txp->read_classic_span(reader) == ERR_FILE_CORRUPT);
+	ERR_PRINT_ON;
+	CHECK(txp->get_texture_count() == 0);
+	CHECK(reader.get_position_depth() == 1);
+
+	// Truncated texture data
+	data = build_texture_set(3);
+	reader.set_span(data.ptr(), data.size() - 1);
+	txp.instantiate();
+	ERR_PRINT_OFF;
+	CHECK(txp->read_classic_span(reader) == ERR_FILE_CORRUPT);
+	ERR_PRINT_ON;
+	CHECK(txp->get_texture_count() == 0);
+	CHECK(reader.get_position_depth() == 0);
+}
+
+TEST_CASE("[DIVAReader][SceneTree] Object sets load in the background") {
+	const String path = TestUtils::get_temp_path("diva_loader_test_obj.bin");
+	{
+		Ref<FileAccess> f = FileAccess::open(path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(build_object_set());
+	}
+
+	CHECK(ResourceLoader::get_resource_type(path) == "DIVAObjectSet");
+	REQUIRE(ResourceLoader::load_threaded_request(path) == OK);
+	Ref<DIVAObjectSet> object_set = ResourceLoader::load_threaded_get(path);
+	REQUIRE(object_set.is_valid());
+
+	Vector<Ref<Mesh>> meshes = object_set->get_object_meshes(StringName("object_10"));
+	REQUIRE(meshes.size() == 1);
+	CHECK(meshes[0]->get_surface_count() == 1);
+	// Already built by the loader
+	CHECK(object_set->get_object_meshes(StringName("object_10"))[0] == meshes[0]);
+
+	DirAccess::remove_absolute(path);
+}
+
+TEST_CASE("[DIVAReader] Object set import benchmark") {
+	Vector<uint8_t> data = build_object_set();
+	Ref<StreamPeerBuffer> spb;
+	spb.instantiate();
+	spb->set_data_array(data);
+
+	const String path = TestUtils::get_temp_path("diva_reader_benchmark_obj.bin");
+	{
+		Ref<FileAccess> f = FileAccess::open(path, FileAccess::WRITE);
+		REQUIRE(f.is_valid());
+		f->store_buffer(data);
+	}
+
+	const int iterations = 5;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		Ref<DIVAObjectSet> object_set;
+		object_set.instantiate();
+		spb->seek(0);
+		object_set->read_classic(spb);
+	}
+	uint64_t buffer_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		Ref<DIVAObjectSet> object_set;
+		object_set.instantiate();
+		CHECK(object_set->read_classic_file(path) == OK);
+	}
+	uint64_t file_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	MESSAGE(vformat("%d objects (%d KiB), from StreamPeerBuffer: %.2f ms, from file: %.2f ms", OBJECT_COUNT, data.size() / 1024, buffer_usec / (1000.0 * iterations), file_usec / (1000.0 * iterations)));
+
+	DirAccess::remove_absolute(path);
+}
+
+} // namespace TestDIVAReader
+
+#endif // TEST_DIVA_READER_H
@@ -0,0 +1,188 @@
+#ifndef TEST_INTERVAL_TREE_H
+#define TEST_INTERVAL_TREE_H
+
+#include "../interval_tree.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+namespace TestIntervalTree {
+
+static PackedInt64Array brute_force_query(const PackedInt64Array &p_lows, const PackedInt64Array &p_highs, const PackedInt64Array &p_values, int64_t p_low, int64_t p_high) {
+	PackedInt64Array out;
+	for (int i = 0; i < p_lows.size(); i++) {
+		if (p_lows[i] <= p_high && p_highs[i] >= p_low) {
+			out.push_back(p_values[i]);
+		}
+	}
+	out.sort();
+	return out;
+}
+
+static PackedInt64Array sorted(PackedInt64Array p_array) {
+	p_array.sort();
+	return p_array;
+}
+
+TEST_CASE("[HBIntervalTree] Bulk built and incremental trees match a brute force search") {
+	RandomPCG rng(1234);
+	PackedInt64Array lows;
+	PackedInt64Array highs;
+	PackedInt64Array values;
+	for (int i = 0; i < 2000; i++) {
+		int64_t low = rng.rand() % 100000;
+		lows.push_back(low);
+		highs.push_back(low + rng.rand() % 2000);
+		values.push_back(i + 1);
+	}
+
+	Ref<HBIntervalTree> bulk;
+	bulk.instantiate();
+	bulk->build_from(lows, highs, values);
+
+	Ref<HBIntervalTree> incremental;
+	incremental.instantiate();
+	for (int i = 0; i < lows.size(); i++) {
+		incremental->insert(lows[i], highs[i], ObjectID(uint64_t(values[i])));
+	}
+
+	CHECK(bulk->size() == lows.size());
+	CHECK(incremental->size() == lows.size());
+
+	PackedInt64Array points;
+	PackedInt64Array range_lows;
+	PackedInt64Array range_highs;
+	for (int i = 0; i < 200; i++) {
+		int64_t point = rng.rand() % 102000;
+		points.push_back(point);
+		range_lows.push_back(point);
+		range_highs.push_back(point + rng.rand() % 500);
+	}
+
+	Ref<HBIntervalTreeQueryResult> result;
+	result.instantiate();
+
+	bool matches = true;
+	bulk->query_points_into(points, result);
+	for (int i = 0; i < points.size(); i++) {
+		PackedInt64Array expected = brute_force_query(lows, highs, values, points[i], points[i]);
+		matches = matches && sorted(result->get_results(i)) == expected;
+		matches = matches && sorted(incremental->query_range(points[i], points[i])) == expected;
+	}
+	CHECK_MESSAGE(matches, "Point queries don't match.");
+
+	matches = true;
+	bulk->query_ranges_into(range_lows, range_highs, result);
+	CHECK(result->get_query_count() == range_lows.size());
+	for (int i = 0; i < range_lows.size(); i++) {
+		PackedInt64Array expected = brute_force_query(lows, highs, values, range_lows[i], range_highs[i]);
+		matches = matches && sorted(result->get_results(i)) == expected;
+		matches = matches && sorted(bulk->query_range(range_lows[i], range_highs[i])) == expected;
+	}
+	CHECK_MESSAGE(matches, "Range queries don't match.");
+
+	// Erasing keeps the index in sync
+	for (int i = 0; i < lows.size(); i += 2) {
+		bulk->erase(lows[i], highs[i], ObjectID(uint64_t(values[i])));
+	}
+	CHECK(bulk->size() == lows.size() / 2);
+	matches = true;
+	for (int i = 0; i < lows.size(); i++) {
+		PackedInt64Array found = bulk->query_range(lows[i], lows[i]);
+		matches = matches && (found.find(values[i]) != -1) == (i % 2 == 1);
+	}
+	CHECK_MESSAGE(matches, "Erased intervals are still found.");
+
+	// Rebuilding with fewer intervals drops the old ones from the index
+	bulk->build_from(lows.slice(0, 3), highs.slice(0, 3), values.slice(0, 3));
+	CHECK(bulk->size() == 3);
+	matches = true;
+	for (int i = 0; i < range_lows.size(); i++) {
+		PackedInt64Array expected = brute_force_query(lows.slice(0, 3), highs.slice(0, 3), values.slice(0, 3), range_lows[i], range_highs[i]);
+		matches = matches && sorted(bulk->query_range(range_lows[i], range_highs[i])) == expected;
+	}
+	CHECK_MESSAGE(matches, "Intervals from before the rebuild are still found.");
+}
+
+TEST_CASE("[HBIntervalTree] Interleaved inserts and erases match a brute force search") {
+	RandomPCG rng(4321);
+	Ref<HBIntervalTree> tree;
+	tree.instantiate();
+
+	PackedInt64Array lows;
+	PackedInt64Array highs;
+	PackedInt64Array values;
+	int64_t next_value = 1;
+	bool matches = true;
+	for (int step = 0; step < 20000; step++) {
+		if (values.is_empty() || rng.rand() % 3 != 0) {
+			int64_t low = rng.rand() % 100000;
+			int64_t high = low + rng.rand() % 2000;
+			// Reversed ends are accepted too
+			if (step % 7 == 0) {
+				tree->insert(high, low, ObjectID(uint64_t(next_value)));
+			} else {
+				tree->insert(low, high, ObjectID(uint64_t(next_value)));
+			}
+			lows.push_back(low);
+			highs.push_back(high);
+			values.push_back(next_value++);
+		} else {
+			int index = rng.rand() % values.size();
+			tree->erase(lows[index], highs[index], ObjectID(uint64_t(values[index])));
+			lows.remove_at(index);
+			highs.remove_at(index);
+			values.remove_at(index);
+		}
+
+		if (step % 1000 == 0) {
+			matches = matches && tree->size() == values.size();
+			for (int i = 0; i < 20; i++) {
+				int64_t low = rng.rand() % 102000;
+				int64_t high = low + rng.rand() % 500;
+				matches = matches && sorted(tree->query_range(low, high)) == brute_force_query(lows, highs, values, low, high);
+			}
+		}
+	}
+	CHECK_MESSAGE(matches, "Queries after interleaved changes don't match.");
+
+	// Trees loaded with build_from keep taking single changes
+	tree->build_from(lows, highs, values);
+	tree->insert(5, 10, ObjectID(uint64_t(next_value)));
+	tree->erase(lows[0], highs[0], ObjectID(uint64_t(values[0])));
+	CHECK(tree->size() == values.size());
+	PackedInt64Array found = tree->query_range(7, 7);
+	CHECK(found.has(next_value));
+	CHECK(!tree->query_range(lows[0], highs[0]).has(values[0]));
+}
+
+TEST_CASE("[HBIntervalTree] Benchmark single edits on a large tree") {
+	RandomPCG rng(99);
+	PackedInt64Array lows;
+	PackedInt64Array highs;
+	PackedInt64Array values;
+	for (int i = 0; i < 100000; i++) {
+		int64_t low = rng.rand() % 10000000;
+		lows.push_back(low);
+		highs.push_back(low + rng.rand() % 5000);
+		values.push_back(i + 1);
+	}
+	Ref<HBIntervalTree> tree;
+	tree.instantiate();
+	tree->build_from(lows, highs, values);
+
+	// Moving a note in the editor timeline is an erase and an insert
+	const int edits = 10000;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < edits; i++) {
+		tree->erase(lows[i], highs[i], ObjectID(uint64_t(values[i])));
+		tree->insert(lows[i] + 1, highs[i] + 1, ObjectID(uint64_t(values[i])));
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	CHECK(tree->size() == lows.size());
+	MESSAGE(vformat("%d moves on %d intervals: %d usec, %.2f usec per move", edits, lows.size(), elapsed, elapsed / (double)edits));
+}
+
+} // namespace TestIntervalTree
+
+#endif // TEST_INTERVAL_TREE_H
@@ -0,0 +1,122 @@
+#ifndef TEST_PROCESS_OUTPUT_BUFFER_H
+#define TEST_PROCESS_OUTPUT_BUFFER_H
+
+#include "../process/process_output_buffer.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "tests/test_macros.h"
+
+namespace TestProcessOutputBuffer {
+
+static void write_string(ProcessOutputBuffer &p_buffer, const char *p_string) {
+	p_buffer.write((const uint8_t *)p_string, strlen(p_string));
+}
+
+TEST_CASE("[ProcessOutputBuffer] Lines are split across writes") {
+	ProcessOutputBuffer buffer;
+	write_string(buffer, "frame=  1 fps=0.0\r\nframe=");
+	CHECK(buffer.get_available_lines() == 1);
+	write_string(buffer, "  2 fps=30\n\nprogress=end");
+
+	String line;
+	CHECK(buffer.pop_line(line));
+	CHECK(line == "frame=  1 fps=0.0");
+	CHECK(buffer.pop_line(line));
+	CHECK(line == "frame=  2 fps=30");
+	CHECK(buffer.pop_line(line));
+	CHECK(line.is_empty());
+	// The last line has no terminator yet
+	CHECK_FALSE(buffer.pop_line(line));
+
+	buffer.close();
+	CHECK(buffer.pop_line(line));
+	CHECK(line == "progress=end");
+	CHECK(buffer.get_available_lines() == 0);
+}
+
+TEST_CASE("[ProcessOutputBuffer] Writes past the capacity spill without reordering") {
+	ProcessOutputBuffer buffer;
+	buffer.set_capacity(64);
+	CHECK(buffer.get_capacity() == 64);
+
+	uint8_t data[1000];
+	for (int i = 0; i < 1000; i++) {
+		data[i] = i % 251;
+	}
+	buffer.write(data, 40);
+	buffer.write(data + 40, 960);
+	CHECK(buffer.get_available_bytes() == 1000);
+
+	uint8_t out[1000] = {};
+	CHECK(buffer.read(out, 10) == 10);
+	// The ring has room again, but the spilled bytes have to come out first
+	buffer.write(data, 10);
+	CHECK(buffer.read(out + 10, 990) == 990);
+	CHECK(memcmp(data, out, 1000) == 0);
+
+	Vector<uint8_t> tail;
+	CHECK(buffer.read_available_into(tail) == 10);
+	CHECK(memcmp(tail.ptr(), data, 10) == 0);
+	CHECK(buffer.get_available_bytes() == 0);
+}
+
+struct ProducerData {
+	ProcessOutputBuffer *buffer = nullptr;
+	uint64_t size = 0;
+};
+
+static void produce(void *p_userdata) {
+	ProducerData *producer = (ProducerData *)p_userdata;
+	RandomPCG rng(42);
+	uint8_t chunk[4096];
+	uint64_t written = 0;
+	while (written < producer->size) {
+		uint64_t chunk_size = MIN(uint64_t(1 + rng.rand() % sizeof(chunk)), producer->size - written);
+		for (uint64_t i = 0; i < chunk_size; i++) {
+			chunk[i] = (written + i) % 251;
+		}
+		producer->buffer->write(chunk, chunk_size);
+		written += chunk_size;
+	}
+	producer->buffer->close();
+}
+
+TEST_CASE("[ProcessOutputBuffer] Concurrent producer and consumer") {
+	ProcessOutputBuffer buffer;
+	buffer.set_capacity(1 << 14);
+
+	ProducerData producer;
+	producer.buffer = &buffer;
+	producer.size = 32 * 1024 * 1024;
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	Thread thread;
+	thread.start(produce, &producer);
+
+	Vector<uint8_t> chunk;
+	uint64_t received = 0;
+	bool in_order = true;
+	while (true) {
+		bool was_closed = buffer.is_closed();
+		int64_t read = buffer.read_available_into(chunk, 1 << 16);
+		const uint8_t *ptr = chunk.ptr();
+		for (int64_t i = 0; i < read && in_order; i++) {
+			in_order = ptr[i] == (received + i) % 251;
+		}
+		received += read;
+		if (read == 0 && was_closed) {
+			break;
+		}
+	}
+	thread.wait_to_finish();
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+
+	CHECK(received == producer.size);
+	CHECK_MESSAGE(in_order, "Bytes arrived out of order.");
+	MESSAGE(vformat("Moved %d MiB through a %d KiB ring in %d usec", producer.size / (1024 * 1024), buffer.get_capacity() / 1024, elapsed));
+}
+
+} // namespace TestProcessOutputBuffer
+
+#endif // TEST_PROCESS_OUTPUT_BUFFER_H
@@ -0,0 +1,214 @@
+#ifndef TEST_THREEN_H
+#define TEST_THREEN_H
+
+#include "../threen.h"
+#include "core/os/os.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/window.h"
+#include "tests/test_macros.h"
+
+namespace TestThreen {
+
+static const int TIMELINE_TWEENS = 10000;
+static const int TIMELINE_NODES = 100;
+
+// Note approach style timeline, every tween is short and they are spread over a few minutes
+static void build_timeline(Threen *p_threen, LocalVector<Node2D *> &r_nodes) {
+	for (int i = 0; i < TIMELINE_NODES; i++) {
+		r_nodes.push_back(memnew(Node2D));
+	}
+	for (int i = 0; i < TIMELINE_TWEENS; i++) {
+		Node2D *node = r_nodes[i % TIMELINE_NODES];
+		real_t delay = i * 0.02;
+		p_threen->interpolate_property(node, NodePath("position"), Vector2(0, 0), Vector2(100, i), 0.5, Threen::TRANS_LINEAR, Threen::EASE_IN_OUT, delay);
+	}
+}
+
+static void free_timeline(Threen *p_threen, LocalVector<Node2D *> &r_nodes) {
+	memdelete(p_threen);
+	for (Node2D *node : r_nodes) {
+		memdelete(node);
+	}
+	r_nodes.clear();
+}
+
+// Value a full seek would leave behind, the last added tween that started wins
+static Vector2 get_expected_position(int p_node, real_t p_time) {
+	Vector2 expected;
+	for (int i = p_node; i < TIMELINE_TWEENS; i += TIMELINE_NODES) {
+		real_t delay = i * 0.02;
+		if (p_time < delay) {
+			break;
+		}
+		real_t t = MIN(p_time - delay, (real_t)0.5) / 0.5;
+		expected = Vector2(100, i) * t;
+	}
+	return expected;
+}
+
+TEST_CASE("[Threen] Seek matches a full evaluation of the timeline") {
+	Threen *threen = memnew(Threen);
+	LocalVector<Node2D *> nodes;
+	build_timeline(threen, nodes);
+
+	CHECK(threen->get_runtime() == doctest::Approx(TIMELINE_TWEENS * 0.02 - 0.02 + 0.5));
+
+	// Forwards, then backwards past tweens that were already applied
+	const real_t times[] = { 50.0, 100.1, 30.3, 30.35, 0.0 };
+	for (real_t time : times) {
+		threen->seek(time);
+		CHECK(threen->tell() == doctest::Approx(time));
+
+		bool matches = true;
+		for (int n = 0; n < TIMELINE_NODES; n++) {
+			if (time < n * 0.02) {
+				continue;
+			}
+			matches = matches && nodes[n]->get_position().is_equal_approx(get_expected_position(n, time));
+		}
+		CHECK_MESSAGE(matches, vformat("Positions don't match after seeking to %f", time));
+	}
+
+	free_timeline(threen, nodes);
+}
+
+TEST_CASE("[Threen] Timeline scrubbing benchmark") {
+	Threen *threen = memnew(Threen);
+	LocalVector<Node2D *> nodes;
+	build_timeline(threen, nodes);
+
+	const real_t runtime = threen->get_runtime();
+	threen->seek(0.0);
+
+	// Small steps back and forth like dragging the playhead in the chart editor
+	const int steps = 2000;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < steps; i++) {
+		real_t t = Math::fmod(i * 0.37, (double)runtime);
+		threen->seek(t);
+		threen->tell();
+	}
+	uint64_t scrub_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	// Jumps across the whole timeline, like practice mode rewinding to a section
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < steps; i++) {
+		real_t t = (i % 2) ? runtime * 0.9 : runtime * 0.1;
+		threen->seek(t);
+	}
+	uint64_t jump_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	MESSAGE(vformat("%d tweens, scrub: %.2f usec/seek, jump: %.2f usec/seek", TIMELINE_TWEENS, scrub_usec / (double)steps, jump_usec / (double)steps));
+
+	free_timeline(threen, nodes);
+}
+
+static LocalVector<String> signal_log;
+
+static void log_tween_step(Object *p_object, const NodePath &p_key, real_t p_elapsed, const Variant &p_value) {
+	signal_log.push_back(vformat("step %s %s", p_key, p_value));
+}
+
+static void log_tween_completed(Object *p_object, const NodePath &p_key) {
+	signal_log.push_back(vformat("completed %s", p_key));
+}
+
+TEST_CASE("[SceneTree][Threen] Typed and generic tweens emit their signals in order") {
+	Threen *threen = memnew(Threen);
+	Node2D *node = memnew(Node2D);
+	SceneTree::get_singleton()->get_root()->add_child(threen);
+	threen->add_child(node);
+	threen->connect("tween_step", callable_mp_static(&log_tween_step));
+	threen->connect("tween_completed", callable_mp_static(&log_tween_completed));
+	signal_log.clear();
+
+	// The position takes the typed path, the z index goes through the generic one
+	threen->interpolate_property(node, NodePath("position"), Vector2(0, 0), Vector2(100, 0), 0.5);
+	threen->interpolate_property(node, NodePath("z_index"), 0, 10, 0.5);
+	threen->start();
+
+	SceneTree::get_singleton()->process(0.25);
+	SceneTree::get_singleton()->process(0.5);
+
+	const String expected[] = {
+		"step position (50, 0)",
+		"step z_index 5",
+		"step position (100, 0)",
+		"completed position",
+		"step z_index 10",
+		"completed z_index",
+	};
+	REQUIRE(signal_log.size() == std::size(expected));
+	for (uint32_t i = 0; i < signal_log.size(); i++) {
+		CHECK(signal_log[i] == expected[i]);
+	}
+	CHECK(node->get_position() == Vector2(100, 0));
+	CHECK(node->get_z_index() == 10);
+
+	signal_log.clear();
+	memdelete(threen);
+}
+
+static Threen *handler_threen = nullptr;
+static Node2D *handler_node = nullptr;
+static bool handler_seek = false;
+static bool handler_ran = false;
+
+// Seeks or stops the other tween from inside the signal of the first one, once
+static void change_tweens_on_step(Object *p_object, const NodePath &p_key, real_t p_elapsed, const Variant &p_value) {
+	signal_log.push_back(vformat("step %s %s", Object::cast_to<Node>(p_object)->get_name(), p_value));
+	if (handler_ran) {
+		return;
+	}
+	handler_ran = true;
+	if (handler_seek) {
+		handler_threen->seek(0.1);
+	} else {
+		handler_threen->stop(handler_node, StringName());
+	}
+}
+
+TEST_CASE("[SceneTree][Threen] Tweens changed by a signal handler don't apply stale steps") {
+	for (bool seek : { true, false }) {
+		Threen *threen = memnew(Threen);
+		Node2D *first = memnew(Node2D);
+		Node2D *second = memnew(Node2D);
+		first->set_name("first");
+		second->set_name("second");
+		SceneTree::get_singleton()->get_root()->add_child(threen);
+		threen->add_child(first);
+		threen->add_child(second);
+		threen->connect("tween_step", callable_mp_static(&change_tweens_on_step));
+		handler_threen = threen;
+		handler_node = second;
+		handler_seek = seek;
+		handler_ran = false;
+		signal_log.clear();
+
+		// Both positions take the typed path, so they are blended together before any signal goes out
+		threen->interpolate_property(first, NodePath("position"), Vector2(0, 0), Vector2(100, 0), 1.0);
+		threen->interpolate_property(second, NodePath("position"), Vector2(0, 0), Vector2(100, 0), 1.0);
+		threen->start();
+		SceneTree::get_singleton()->process(0.5);
+
+		// The handler ran on the first step, the second tween must not write its step from before it
+		REQUIRE(signal_log.size() == 1);
+		CHECK(signal_log[0] == "step first (50, 0)");
+		if (seek) {
+			CHECK(first->get_position().is_equal_approx(Vector2(10, 0)));
+			CHECK(second->get_position().is_equal_approx(Vector2(10, 0)));
+		} else {
+			CHECK(first->get_position() == Vector2(50, 0));
+			CHECK(second->get_position() == Vector2(0, 0));
+		}
+
+		signal_log.clear();
+		memdelete(threen);
+	}
+	handler_threen = nullptr;
+	handler_node = nullptr;
+}
+
+} // namespace TestThreen
+
+#endif // TEST_THREEN_H
@@ -234,6 +234,13 @@ void Process::async_read() noexcept {
 			pollfds.back().fd = fcntl(*stderr_fd, F_SETFL, fcntl(*stderr_fd, F_GETFL) | O_NONBLOCK) == 0 ? *stderr_fd : -1;
 			pollfds.back().events = POLLIN;
 		}
+		auto notify_close = [this, &fd_is_stdout](size_t i) {
+			if (fd_is_stdout[i]) {
+				if (config.on_stdout_close)
+					config.on_stdout_close();
+			} else if (config.on_stderr_close)
+				config.on_stderr_close();
+		};
 		auto buffer = std::unique_ptr<char[]>(new char[config.buffer_size]);
 		bool any_open = !pollfds.empty();
 		while (any_open && (poll(pollfds.data(), static_cast<nfds_t>(pollfds.size()), -1) > 0 || errno == EINTR)) {
@@ -249,11 +256,13 @@ void Process::async_read() noexcept {
 								read_stderr(buffer.get(), static_cast<size_t>(n));
 						} else if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
 							pollfds[i].fd = -1;
+							notify_close(i);
 							continue;
 						}
 					}
 					if (pollfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
 						pollfds[i].fd = -1;
+						notify_close(i);
 						continue;
 					}
 					any_open = true;
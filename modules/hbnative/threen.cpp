@@ -33,6 +33,8 @@
 #include "easing_equations.h"
 
 #include "core/object/class_db.h"
+#include "scene/2d/node_2d.h"
+#include "scene/gui/control.h"
 
 using namespace godot;
 
@@ -724,6 +726,193 @@ bool Threen::_apply_tween_value(InterpolateData &p_data, Variant &value) {
 	return true;
 }
 
+bool Threen::_assign_typed_slot(Object *p_object, InterpolateData &p_data) {
+	// Only whole properties can be typed, subproperties like position:x still go through set_indexed
+	if (p_data.type != INTER_PROPERTY || p_data.key.size() != 1) {
+		return false;
+	}
+
+	const Variant::Type type = p_data.initial_val.get_type();
+	const StringName &property = p_data.key[0];
+
+	// Figure out which setter matches the target object and property
+	TypedSetter setter;
+	if (Object::cast_to<Node2D>(p_object) && type == Variant::VECTOR2 && property == SNAME("position")) {
+		setter = TYPED_SETTER_NODE_2D_POSITION;
+	} else if (Object::cast_to<Node2D>(p_object) && type == Variant::FLOAT && property == SNAME("rotation")) {
+		setter = TYPED_SETTER_NODE_2D_ROTATION;
+	} else if (Object::cast_to<Node2D>(p_object) && type == Variant::VECTOR2 && property == SNAME("scale")) {
+		setter = TYPED_SETTER_NODE_2D_SCALE;
+	} else if (Object::cast_to<Node2D>(p_object) && type == Variant::FLOAT && property == SNAME("skew")) {
+		setter = TYPED_SETTER_NODE_2D_SKEW;
+	} else if (Object::cast_to<Control>(p_object) && type == Variant::VECTOR2 && property == SNAME("position")) {
+		setter = TYPED_SETTER_CONTROL_POSITION;
+	} else if (Object::cast_to<Control>(p_object) && type == Variant::VECTOR2 && property == SNAME("size")) {
+		setter = TYPED_SETTER_CONTROL_SIZE;
+	} else if (Object::cast_to<Control>(p_object) && type == Variant::VECTOR2 && property == SNAME("scale")) {
+		setter = TYPED_SETTER_CONTROL_SCALE;
+	} else if (Object::cast_to<Control>(p_object) && type == Variant::FLOAT && property == SNAME("rotation")) {
+		setter = TYPED_SETTER_CONTROL_ROTATION;
+	} else if (Object::cast_to<Control>(p_object) && type == Variant::VECTOR2 && property == SNAME("pivot_offset")) {
+		setter = TYPED_SETTER_CONTROL_PIVOT_OFFSET;
+	} else if (Object::cast_to<CanvasItem>(p_object) && type == Variant::COLOR && property == SNAME("modulate")) {
+		setter = TYPED_SETTER_CANVAS_ITEM_MODULATE;
+	} else if (Object::cast_to<CanvasItem>(p_object) && type == Variant::COLOR && property == SNAME("self_modulate")) {
+		setter = TYPED_SETTER_CANVAS_ITEM_SELF_MODULATE;
+	} else {
+		return false;
+	}
+
+	// Reuse a free slot if there is one
+	uint32_t slot;
+	if (!typed.free_slots.is_empty()) {
+		slot = typed.free_slots[typed.free_slots.size() - 1];
+		typed.free_slots.resize(typed.free_slots.size() - 1);
+		typed.setter[slot] = setter;
+	} else {
+		slot = typed.setter.size();
+		typed.setter.push_back(setter);
+		typed.initial.resize(typed.initial.size() + TYPED_LANES);
+		typed.delta.resize(typed.delta.size() + TYPED_LANES);
+	}
+
+	// Unpack the values into the lanes
+	real_t *initial = typed.initial.ptr() + slot * TYPED_LANES;
+	real_t *delta = typed.delta.ptr() + slot * TYPED_LANES;
+	for (int i = 0; i < TYPED_LANES; i++) {
+		initial[i] = 0;
+		delta[i] = 0;
+	}
+
+	switch (type) {
+		case Variant::FLOAT: {
+			initial[0] = p_data.initial_val;
+			delta[0] = p_data.delta_val;
+		} break;
+		case Variant::VECTOR2: {
+			Vector2 i = p_data.initial_val;
+			Vector2 d = p_data.delta_val;
+			initial[0] = i.x;
+			initial[1] = i.y;
+			delta[0] = d.x;
+			delta[1] = d.y;
+		} break;
+		case Variant::COLOR: {
+			Color i = p_data.initial_val;
+			Color d = p_data.delta_val;
+			initial[0] = i.r;
+			initial[1] = i.g;
+			initial[2] = i.b;
+			initial[3] = i.a;
+			delta[0] = d.r;
+			delta[1] = d.g;
+			delta[2] = d.b;
+			delta[3] = d.a;
+		} break;
+		default:
+			break;
+	}
+
+	p_data.typed_slot = slot;
+	return true;
+}
+
+void Threen::_release_typed_slot(InterpolateData &p_data) {
+	if (p_data.typed_slot == -1) {
+		return;
+	}
+	typed.free_slots.push_back(p_data.typed_slot);
+	p_data.typed_slot = -1;
+}
+
+uint32_t Threen::_queue_typed_step(TypedBatch &p_batch, InterpolateData &p_data) {
+	// All the equations scale linearly with the delta, so the eased weight of a tween is the
+	// same for every lane and only has to be computed once
+	real_t weight = 1.0;
+	if (p_data.duration > 0) {
+		weight = run_equation(p_data.trans_type, p_data.ease_type, p_data.elapsed - p_data.delay, 0.0, 1.0, p_data.duration);
+	}
+	p_batch.tweens.push_back(&p_data);
+	p_batch.weights.push_back(weight);
+	return p_batch.tweens.size() - 1;
+}
+
+void Threen::_blend_typed_steps(TypedBatch &p_batch) {
+	// Blend every lane of every queued tween, this loop has no branches so it can be vectorized
+	const uint32_t count = p_batch.tweens.size();
+	p_batch.values.resize(count * TYPED_LANES);
+	real_t *values = p_batch.values.ptr();
+	const real_t *weights = p_batch.weights.ptr();
+	const real_t *initial = typed.initial.ptr();
+	const real_t *delta = typed.delta.ptr();
+	for (uint32_t i = 0; i < count; i++) {
+		const uint32_t slot = p_batch.tweens[i]->typed_slot * TYPED_LANES;
+		const real_t weight = weights[i];
+		for (int j = 0; j < TYPED_LANES; j++) {
+			values[i * TYPED_LANES + j] = initial[slot + j] + delta[slot + j] * weight;
+		}
+	}
+}
+
+void Threen::_write_typed_step(const TypedBatch &p_batch, uint32_t p_index, Object *p_object) {
+	// Write the value back through the setter of the target type
+	const InterpolateData &interp_data = *p_batch.tweens[p_index];
+	const real_t *v = p_batch.values.ptr() + p_index * TYPED_LANES;
+	switch (typed.setter[interp_data.typed_slot]) {
+		case TYPED_SETTER_NODE_2D_POSITION: {
+			static_cast<Node2D *>(p_object)->set_position(Vector2(v[0], v[1]));
+		} break;
+		case TYPED_SETTER_NODE_2D_ROTATION: {
+			static_cast<Node2D *>(p_object)->set_rotation(v[0]);
+		} break;
+		case TYPED_SETTER_NODE_2D_SCALE: {
+			static_cast<Node2D *>(p_object)->set_scale(Vector2(v[0], v[1]));
+		} break;
+		case TYPED_SETTER_NODE_2D_SKEW: {
+			static_cast<Node2D *>(p_object)->set_skew(v[0]);
+		} break;
+		case TYPED_SETTER_CONTROL_POSITION: {
+			static_cast<Control *>(p_object)->set_position(Vector2(v[0], v[1]));
+		} break;
+		case TYPED_SETTER_CONTROL_SIZE: {
+			static_cast<Control *>(p_object)->set_size(Vector2(v[0], v[1]));
+		} break;
+		case TYPED_SETTER_CONTROL_SCALE: {
+			static_cast<Control *>(p_object)->set_scale(Vector2(v[0], v[1]));
+		} break;
+		case TYPED_SETTER_CONTROL_ROTATION: {
+			static_cast<Control *>(p_object)->set_rotation(v[0]);
+		} break;
+		case TYPED_SETTER_CONTROL_PIVOT_OFFSET: {
+			static_cast<Control *>(p_object)->set_pivot_offset(Vector2(v[0], v[1]));
+		} break;
+		case TYPED_SETTER_CANVAS_ITEM_MODULATE: {
+			static_cast<CanvasItem *>(p_object)->set_modulate(Color(v[0], v[1], v[2], v[3]));
+		} break;
+		case TYPED_SETTER_CANVAS_ITEM_SELF_MODULATE: {
+			static_cast<CanvasItem *>(p_object)->set_self_modulate(Color(v[0], v[1], v[2], v[3]));
+		} break;
+	}
+}
+
+Variant Threen::_get_typed_step_value(const TypedBatch &p_batch, uint32_t p_index) const {
+	// Only built for the tween_step signal, the setters take the lanes directly
+	const real_t *v = p_batch.values.ptr() + p_index * TYPED_LANES;
+	switch (p_batch.tweens[p_index]->initial_val.get_type()) {
+		case Variant::FLOAT:
+			return v[0];
+		case Variant::VECTOR2:
+			return Vector2(v[0], v[1]);
+		default:
+			return Color(v[0], v[1], v[2], v[3]);
+	}
+}
+
+void Threen::_clear_typed_steps(TypedBatch &p_batch) {
+	p_batch.tweens.clear();
+	p_batch.weights.clear();
+}
+
 void Threen::_tween_process(float p_delta) {
 	// Process all of the pending commands
 	_process_pending_commands();
@@ -762,22 +951,32 @@ void Threen::_tween_process(float p_delta) {
 	// Are all of the tweens complete?
 	bool all_finished = true;
 
-	// For each tween we wish to interpolate...
+	// Advance every tween first. The typed tweens are blended together before any signal is
+	// emitted, so the signals of every tween can still go out in order afterwards.
+	processed_tweens.clear();
 	for (List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
 		// Get the data from it
 		InterpolateData &interp_data = E->get();
 
+		// Catch up with the last seek if needed
+		_sync_timeline_elapsed(interp_data);
+
 		// Track if we hit one that isn't finished yet
 		all_finished = all_finished && interp_data.finish;
 
 		// Is the data not active or already finished? No need to go any further
 		if (!interp_data.active || interp_data.finish) {
+			// Inactive tweens fall behind the timeline
+			if (!interp_data.finish) {
+				_mark_timeline_dirty(interp_data);
+			}
 			continue;
 		}
 
 		// Get the target object for this interpolation
 		Object *object = ObjectDB::get_instance(interp_data.id);
 		if (object == nullptr) {
+			_mark_timeline_dirty(interp_data);
 			continue;
 		}
 
@@ -786,10 +985,6 @@ void Threen::_tween_process(float p_delta) {
 		interp_data.elapsed += p_delta;
 		if (interp_data.elapsed < interp_data.delay) {
 			continue;
-		} else if (prev_delaying) {
-			// We can apply the tween's value to the data and emit that the tween has started
-			_apply_tween_value(interp_data, interp_data.initial_val);
-			emit_signal("tween_started", object, nodepath_from_subnames(interp_data.key));
 		}
 
 		// Are we at the end of the tween?
@@ -799,6 +994,50 @@ void Threen::_tween_process(float p_delta) {
 			interp_data.finish = true;
 		}
 
+		ProcessedTween processed;
+		processed.data = &interp_data;
+		processed.started = prev_delaying;
+		processed.elapsed = interp_data.elapsed;
+		processed.finish = interp_data.finish;
+		if (interp_data.type != INTER_CALLBACK && interp_data.typed_slot != -1 && !interp_data.finish) {
+			processed.typed_index = _queue_typed_step(typed.step_batch, interp_data);
+		}
+		processed_tweens.push_back(processed);
+
+		// Check whether all tweens are finished
+		if (!repeat) {
+			all_finished = all_finished && interp_data.finish;
+		}
+	}
+	// Every tween that follows the timeline moved along with it
+	timeline_position += p_delta;
+
+	TypedBatch &step_batch = typed.step_batch;
+	_blend_typed_steps(step_batch);
+
+	// Apply the values and emit the signals of every tween that advanced
+	const uint64_t batch_state_serial = tween_state_serial;
+	for (const ProcessedTween &processed : processed_tweens) {
+		InterpolateData &interp_data = *processed.data;
+
+		// The target may have been freed by a signal emitted for an earlier tween
+		Object *object = ObjectDB::get_instance(interp_data.id);
+		if (object == nullptr) {
+			continue;
+		}
+
+		// A handler of an earlier signal may have seeked, reset or stopped this tween. The step
+		// computed for it is stale then, and the handler already applied the value it wanted.
+		if (tween_state_serial != batch_state_serial && (!interp_data.active || interp_data.elapsed != processed.elapsed || interp_data.finish != processed.finish)) {
+			continue;
+		}
+
+		if (processed.started) {
+			// We can apply the tween's value to the data and emit that the tween has started
+			_apply_tween_value(interp_data, interp_data.initial_val);
+			emit_signal("tween_started", object, interp_data.key_path);
+		}
+
 		// Are we interpolating a callback?
 		if (interp_data.type == INTER_CALLBACK) {
 			// Is the tween completed?
@@ -870,13 +1109,22 @@ void Threen::_tween_process(float p_delta) {
 					}
 				}
 			}
+		} else if (processed.typed_index != -1) {
+			// Apply the blended value
+			_write_typed_step(step_batch, processed.typed_index, object);
+			emit_signal("tween_step", object, interp_data.key_path, interp_data.elapsed, _get_typed_step_value(step_batch, processed.typed_index));
+		} else if (interp_data.typed_slot != -1) {
+			// A finished typed tween isn't blended, its last step lands on the final value
+			Variant final_val = _get_final_val(interp_data);
+			_apply_tween_value(interp_data, final_val);
+			emit_signal("tween_step", object, interp_data.key_path, interp_data.elapsed, final_val);
 		} else {
 			// We can apply the value directly
 			Variant result = _run_equation(interp_data);
 			_apply_tween_value(interp_data, result);
 
 			// Emit that the tween has taken a step
-			emit_signal("tween_step", object, nodepath_from_subnames(interp_data.key), interp_data.elapsed, result);
+			emit_signal("tween_step", object, interp_data.key_path, interp_data.elapsed, result);
 		}
 
 		// Is the tween now finished?
@@ -886,17 +1134,16 @@ void Threen::_tween_process(float p_delta) {
 			_apply_tween_value(interp_data, final_val);
 
 			// Emit the signal
-			emit_signal("tween_completed", object, nodepath_from_subnames(interp_data.key));
+			emit_signal("tween_completed", object, interp_data.key_path);
 
 			// If we are not repeating the tween, remove it
 			if (!repeat) {
 				call_deferred("_remove_by_uid", interp_data.uid);
 			}
-		} else if (!repeat) {
-			// Check whether all tweens are finished
-			all_finished = all_finished && interp_data.finish;
 		}
 	}
+	_clear_typed_steps(step_batch);
+
 	// One less update left to go
 	pending_update--;
 
@@ -984,6 +1231,7 @@ bool Threen::start() {
 bool Threen::reset(Object *p_object, StringName p_key) {
 	// Find all interpolations that use the same object and target string
 	pending_update++;
+	tween_state_serial++;
 	for (List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
 		// Get the target object
 		InterpolateData &interp_data = E->get();
@@ -994,7 +1242,8 @@ bool Threen::reset(Object *p_object, StringName p_key) {
 
 		// Do we have the correct object and key?
 		if (object == p_object && (interp_data.concatenated_key == p_key || p_key == StringName())) {
-			// Reset the tween to the initial state
+			// Reset the tween to the initial state, it no longer follows the timeline
+			_mark_timeline_dirty(interp_data);
 			interp_data.elapsed = 0;
 			interp_data.finish = false;
 
@@ -1009,6 +1258,12 @@ bool Threen::reset(Object *p_object, StringName p_key) {
 }
 
 bool Threen::reset_all() {
+	// Everything goes back to the start of the timeline
+	tween_state_serial++;
+	timeline_position = 0;
+	timeline_serial++;
+	timeline_dirty.clear();
+
 	// Go through all interpolations
 	pending_update++;
 	for (List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
@@ -1016,6 +1271,8 @@ bool Threen::reset_all() {
 		InterpolateData &interp_data = E->get();
 		interp_data.elapsed = 0;
 		interp_data.finish = false;
+		interp_data.timeline_dirty = false;
+		interp_data.timeline_serial = timeline_serial;
 
 		// If there isn't a delay, apply the value to the object
 		if (interp_data.delay == 0) {
@@ -1029,6 +1286,7 @@ bool Threen::reset_all() {
 bool Threen::stop(Object *p_object, StringName p_key) {
 	// Find the tween that has the given target object and string key
 	pending_update++;
+	tween_state_serial++;
 	for (List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
 		// Get the object the tween is targeting
 		InterpolateData &interp_data = E->get();
@@ -1039,7 +1297,8 @@ bool Threen::stop(Object *p_object, StringName p_key) {
 
 		// Is this the correct object and does it have the given key?
 		if (object == p_object && (interp_data.concatenated_key == p_key || p_key == StringName())) {
-			// Disable the tween
+			// Disable the tween, it stops following the timeline
+			_mark_timeline_dirty(interp_data);
 			interp_data.active = false;
 		}
 	}
@@ -1048,6 +1307,7 @@ bool Threen::stop(Object *p_object, StringName p_key) {
 }
 
 bool Threen::stop_all() {
+	tween_state_serial++;
 	// We no longer need to be active since all tweens have been stopped
 	set_active(false);
 	was_stopped = true;
@@ -1129,6 +1389,8 @@ bool Threen::remove(Object *p_object, StringName p_key) {
 	// For each interpolation we wish to remove...
 	for (List<List<InterpolateData>::Element *>::Element *E = for_removal.front(); E; E = E->next()) {
 		// Erase it
+		_release_typed_slot(E->get()->get());
+		_forget_timeline_data(E->get()->get());
 		interpolates.erase(E->get());
 	}
 	return true;
@@ -1145,6 +1407,8 @@ void Threen::_remove_by_uid(int p_uid) {
 	for (List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
 		if (p_uid == E->get().uid) {
 			// It matches, erase it and stop looking
+			_release_typed_slot(E->get());
+			_forget_timeline_data(E->get());
 			E->erase();
 			break;
 		}
@@ -1154,9 +1418,18 @@ void Threen::_remove_by_uid(int p_uid) {
 void Threen::_push_interpolate_data(InterpolateData &p_data) {
 	pending_update++;
 
-	// Add the new interpolation
+	// Add the new interpolation, the key is cached as a NodePath for the signals
 	p_data.uid = ++uid;
-	interpolates.push_back(p_data);
+	p_data.key_path = nodepath_from_subnames(p_data.key);
+	p_data.timeline_serial = timeline_serial;
+	p_data.timeline_dirty = false;
+	List<InterpolateData>::Element *E = interpolates.push_back(p_data);
+	timeline_index.valid = false;
+
+	// New tweens start from 0, so they only follow the timeline if it's there too
+	if (timeline_position != 0) {
+		_mark_timeline_dirty(E->get());
+	}
 
 	pending_update--;
 }
@@ -1174,58 +1447,309 @@ bool Threen::remove_all() {
 	interpolates.clear();
 	uid = 0;
 
+	// Drop the typed buffers as well, every slot is free now
+	typed.initial.clear();
+	typed.delta.clear();
+	typed.setter.clear();
+	typed.free_slots.clear();
+
+	// And the timeline
+	timeline_position = 0;
+	timeline_dirty.clear();
+	timeline_index.valid = false;
+
+	return true;
+}
+
+real_t Threen::_get_timeline_elapsed(const InterpolateData &p_data) const {
+	// Tweens that still follow the timeline are wherever the timeline puts them
+	if (p_data.timeline_dirty || p_data.timeline_serial == timeline_serial) {
+		return p_data.elapsed;
+	}
+	return MIN(timeline_position, p_data.delay + p_data.duration);
+}
+
+void Threen::_sync_timeline_elapsed(InterpolateData &p_data) {
+	p_data.elapsed = _get_timeline_elapsed(p_data);
+	p_data.timeline_serial = timeline_serial;
+}
+
+void Threen::_mark_timeline_dirty(InterpolateData &p_data) {
+	_sync_timeline_elapsed(p_data);
+	if (!p_data.timeline_dirty) {
+		p_data.timeline_dirty = true;
+		timeline_dirty.push_back(&p_data);
+	}
+}
+
+void Threen::_forget_timeline_data(InterpolateData &p_data) {
+	// Called right before the data is erased, so nothing can keep pointing to it
+	if (p_data.timeline_dirty) {
+		timeline_dirty.erase(&p_data);
+	}
+	timeline_index.valid = false;
+}
+
+void Threen::_update_timeline_index() const {
+	if (timeline_index.valid) {
+		return;
+	}
+
+	TimelineIndex &index = timeline_index;
+	index.items.clear();
+	index.dynamic.clear();
+	index.targets.clear();
+	index.max_end = 0;
+
+	for (const List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
+		InterpolateData *interp_data = const_cast<InterpolateData *>(&E->get());
+		index.max_end = MAX(index.max_end, interp_data->delay + interp_data->duration);
+		index.items.push_back(interp_data);
+		switch (interp_data->type) {
+			case FOLLOW_PROPERTY:
+			case FOLLOW_METHOD:
+			case TARGETING_PROPERTY:
+			case TARGETING_METHOD:
+				index.dynamic.push_back(interp_data);
+				break;
+			default:
+				break;
+		}
+	}
+
+	struct DelayComparator {
+		_FORCE_INLINE_ bool operator()(const InterpolateData *p_a, const InterpolateData *p_b) const {
+			return p_a->delay < p_b->delay;
+		}
+	};
+	index.items.sort_custom<DelayComparator>();
+
+	const uint32_t count = index.items.size();
+	index.starts.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		InterpolateData *interp_data = index.items[i];
+		index.starts[i] = interp_data->delay;
+
+		// Group the tweens by what they write to, keeping the delay order
+		if (interp_data->type == INTER_CALLBACK) {
+			continue;
+		}
+		TimelineTarget target = { interp_data->id, interp_data->concatenated_key };
+		TimelineTargetTweens *tweens = index.targets.getptr(target);
+		if (tweens == nullptr) {
+			tweens = &index.targets.insert(target, TimelineTargetTweens())->value;
+		}
+		InterpolateData *winner = interp_data;
+		if (!tweens->winners.is_empty() && tweens->winners[tweens->winners.size() - 1]->uid > interp_data->uid) {
+			winner = tweens->winners[tweens->winners.size() - 1];
+		}
+		tweens->starts.push_back(interp_data->delay);
+		tweens->winners.push_back(winner);
+	}
+
+	// Bottom up max tree over the end times, the leaves follow the delay order
+	index.tree_size = 1;
+	while (index.tree_size < count) {
+		index.tree_size <<= 1;
+	}
+	index.max_end_tree.resize(index.tree_size * 2);
+	for (uint32_t i = 0; i < index.tree_size; i++) {
+		index.max_end_tree[index.tree_size + i] = i < count ? index.items[i]->delay + index.items[i]->duration : -INFINITY;
+	}
+	for (uint32_t i = index.tree_size - 1; i > 0; i--) {
+		index.max_end_tree[i] = MAX(index.max_end_tree[i * 2], index.max_end_tree[i * 2 + 1]);
+	}
+
+	index.valid = true;
+}
+
+void Threen::_collect_timeline_range(uint32_t p_node, uint32_t p_node_from, uint32_t p_node_to, uint32_t p_count, real_t p_from, LocalVector<InterpolateData *> &r_items) const {
+	// Skip subtrees that start after the range or that end before it
+	if (p_node_from >= p_count || timeline_index.max_end_tree[p_node] < p_from) {
+		return;
+	}
+	if (p_node_to - p_node_from == 1) {
+		r_items.push_back(timeline_index.items[p_node_from]);
+		return;
+	}
+	uint32_t mid = (p_node_from + p_node_to) / 2;
+	_collect_timeline_range(p_node * 2, p_node_from, mid, p_count, p_from, r_items);
+	_collect_timeline_range(p_node * 2 + 1, mid, p_node_to, p_count, p_from, r_items);
+}
+
+Threen::InterpolateData *Threen::_get_timeline_winner(const TimelineTarget &p_target, real_t p_time) const {
+	const TimelineTargetTweens *tweens = timeline_index.targets.getptr(p_target);
+	if (tweens == nullptr) {
+		return nullptr;
+	}
+
+	// Number of tweens that have started by p_time
+	uint32_t count = 0;
+	uint32_t high = tweens->starts.size();
+	while (count < high) {
+		uint32_t mid = (count + high) / 2;
+		if (tweens->starts[mid] <= p_time) {
+			count = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return count > 0 ? tweens->winners[count - 1] : nullptr;
+}
+
+bool Threen::_seek_interpolation(InterpolateData &p_data, real_t p_time) {
+	// Update the elapsed data to be set to the target time
+	p_data.elapsed = p_time;
+
+	// Are we at the end?
+	if (p_data.elapsed < p_data.delay) {
+		// There is still time left to go
+		p_data.finish = false;
+		return false;
+	} else if (p_data.elapsed >= (p_data.delay + p_data.duration)) {
+		// We are past the end of it, set the elapsed time to the end and mark as finished
+		p_data.elapsed = (p_data.delay + p_data.duration);
+		p_data.finish = true;
+	} else {
+		// We are not finished with this interpolation yet
+		p_data.finish = false;
+	}
+
+	// If we are a callback, do nothing special
+	if (p_data.type == INTER_CALLBACK) {
+		return false;
+	}
+
+	// Typed tweens are applied together once the seek is done
+	if (p_data.typed_slot != -1) {
+		_queue_typed_step(typed.seek_batch, p_data);
+		return true;
+	}
+
+	// Run the equation on the data and apply the value
+	Variant result = _run_equation(p_data);
+	_apply_tween_value(p_data, result);
 	return true;
 }
 
 bool Threen::seek(real_t p_time) {
-	// Go through each interpolation...
 	pending_update++;
-	for (List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
-		// Get the target data
-		InterpolateData &interp_data = E->get();
+	tween_state_serial++;
+	_update_timeline_index();
+
+	// Tweens whose interval doesn't overlap the range between the current and the new
+	// position are either finished or not started at both, so their state doesn't change
+	const real_t from = MIN(timeline_position, p_time);
+	const real_t to = MAX(timeline_position, p_time);
+
+	seek_scratch.clear();
+	if (!timeline_index.items.is_empty()) {
+		// Only the tweens that start before the end of the range can overlap it
+		uint32_t count = 0;
+		uint32_t high = timeline_index.starts.size();
+		while (count < high) {
+			uint32_t mid = (count + high) / 2;
+			if (timeline_index.starts[mid] <= to) {
+				count = mid + 1;
+			} else {
+				high = mid;
+			}
+		}
+		_collect_timeline_range(1, 0, timeline_index.tree_size, count, from, seek_scratch);
+	}
+	for (InterpolateData *interp_data : timeline_index.dynamic) {
+		seek_scratch.push_back(interp_data);
+	}
+	for (InterpolateData *interp_data : timeline_dirty) {
+		seek_scratch.push_back(interp_data);
+	}
+
+	// Apply them in the order they were added, same as a full seek would
+	struct UIDComparator {
+		_FORCE_INLINE_ bool operator()(const InterpolateData *p_a, const InterpolateData *p_b) const {
+			return p_a->uid < p_b->uid;
+		}
+	};
+	seek_scratch.sort_custom<UIDComparator>();
 
-		// Update the elapsed data to be set to the target time
-		interp_data.elapsed = p_time;
+	// Everything that isn't touched below now follows the new position
+	timeline_position = p_time;
+	timeline_serial++;
+	timeline_dirty.clear();
 
-		// Are we at the end?
-		if (interp_data.elapsed < interp_data.delay) {
-			// There is still time left to go
-			interp_data.finish = false;
+	// Go through each interpolation, skipping the duplicates
+	seek_targets.clear();
+	for (uint32_t i = 0; i < seek_scratch.size(); i++) {
+		if (i > 0 && seek_scratch[i] == seek_scratch[i - 1]) {
 			continue;
-		} else if (interp_data.elapsed >= (interp_data.delay + interp_data.duration)) {
-			// We are past the end of it, set the elapsed time to the end and mark as finished
-			interp_data.elapsed = (interp_data.delay + interp_data.duration);
-			interp_data.finish = true;
-		} else {
-			// We are not finished with this interpolation yet
-			interp_data.finish = false;
 		}
 
-		// If we are a callback, do nothing special
-		if (interp_data.type == INTER_CALLBACK) {
+		InterpolateData &interp_data = *seek_scratch[i];
+		interp_data.timeline_dirty = false;
+		interp_data.timeline_serial = timeline_serial;
+		bool applied = _seek_interpolation(interp_data, p_time);
+
+		// Remember the last value written to each property
+		if (interp_data.type != INTER_CALLBACK) {
+			TimelineTarget target = { interp_data.id, interp_data.concatenated_key };
+			InterpolateData **last = seek_targets.getptr(target);
+			if (last == nullptr) {
+				seek_targets.insert(target, applied ? &interp_data : nullptr);
+			} else if (applied) {
+				*last = &interp_data;
+			}
+		}
+	}
+
+	// The most recently added tween that has started owns the property, when it wasn't
+	// touched above (like when seeking back before a later tween) it has to be reapplied
+	for (const KeyValue<TimelineTarget, InterpolateData *> &E : seek_targets) {
+		InterpolateData *winner = _get_timeline_winner(E.key, p_time);
+		if (winner == nullptr || winner == E.value) {
 			continue;
 		}
+		_sync_timeline_elapsed(*winner);
+		_seek_interpolation(*winner, p_time);
+	}
 
-		// Run the equation on the data and apply the value
-		Variant result = _run_equation(interp_data);
-		_apply_tween_value(interp_data, result);
+	// Apply all the typed tweens moved by the seek
+	TypedBatch &seek_batch = typed.seek_batch;
+	_blend_typed_steps(seek_batch);
+	for (uint32_t i = 0; i < seek_batch.tweens.size(); i++) {
+		Object *object = ObjectDB::get_instance(seek_batch.tweens[i]->id);
+		if (object != nullptr) {
+			_write_typed_step(seek_batch, i, object);
+		}
 	}
+	_clear_typed_steps(seek_batch);
+
 	pending_update--;
 	return true;
 }
 
 real_t Threen::tell() const {
 	// We want to grab the position of the furthest along tween
+	if (interpolates.is_empty()) {
+		return 0;
+	}
+
+	// When every tween follows the timeline the furthest one is either at the timeline
+	// position or at the end of the longest tween
+	if (timeline_dirty.is_empty()) {
+		_update_timeline_index();
+		return MAX(0, MIN(timeline_position, timeline_index.max_end));
+	}
+
 	pending_update++;
 	real_t pos = 0;
 
 	// For each interpolation...
 	for (const List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
 		// Get the data and figure out if it's position is further along than the previous ones
-		const InterpolateData &interp_data = E->get();
-		if (interp_data.elapsed > pos) {
+		real_t elapsed = _get_timeline_elapsed(E->get());
+		if (elapsed > pos) {
 			// Save it if so
-			pos = interp_data.elapsed;
+			pos = elapsed;
 		}
 	}
 	pending_update--;
@@ -1238,20 +1762,9 @@ real_t Threen::get_runtime() const {
 		return INFINITY;
 	}
 
-	pending_update++;
-
-	// For each interpolation...
-	real_t runtime = 0;
-	for (const List<InterpolateData>::Element *E = interpolates.front(); E; E = E->next()) {
-		// Get the tween data and see if it's runtime is greater than the previous tweens
-		const InterpolateData &interp_data = E->get();
-		real_t t = interp_data.delay + interp_data.duration;
-		if (t > runtime) {
-			// This is the longest running tween
-			runtime = t;
-		}
-	}
-	pending_update--;
+	// The index keeps track of the longest running tween
+	_update_timeline_index();
+	real_t runtime = timeline_index.max_end;
 
 	// Adjust the runtime for the current speed scale
 	return runtime / speed_scale;
@@ -1460,6 +1973,9 @@ bool Threen::_build_interpolation(InterpolateType p_interpolation_type, Object *
 		return false;
 	}
 
+	// Use the typed path if we know how to set this property directly
+	_assign_typed_slot(p_object, interp_data);
+
 	// Add this interpolation to the total
 	_push_interpolate_data(interp_data);
 	return true;
@@ -32,6 +32,8 @@
 #define THREEN_H
 
 #include "core/object/object.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/vector.h"
 #include "core/variant/variant.h"
 #include "scene/main/node.h"
@@ -86,6 +88,21 @@ private:
 		INTER_CALLBACK,
 	};
 
+	// Properties the typed fast path knows how to write without going through set_indexed
+	enum TypedSetter {
+		TYPED_SETTER_NODE_2D_POSITION,
+		TYPED_SETTER_NODE_2D_ROTATION,
+		TYPED_SETTER_NODE_2D_SCALE,
+		TYPED_SETTER_NODE_2D_SKEW,
+		TYPED_SETTER_CONTROL_POSITION,
+		TYPED_SETTER_CONTROL_SIZE,
+		TYPED_SETTER_CONTROL_SCALE,
+		TYPED_SETTER_CONTROL_ROTATION,
+		TYPED_SETTER_CONTROL_PIVOT_OFFSET,
+		TYPED_SETTER_CANVAS_ITEM_MODULATE,
+		TYPED_SETTER_CANVAS_ITEM_SELF_MODULATE,
+	};
+
 	struct InterpolateData {
 		bool active;
 		InterpolateType type;
@@ -95,6 +112,7 @@ private:
 		ObjectID id;
 		Vector<StringName> key;
 		StringName concatenated_key;
+		NodePath key_path;
 		Variant initial_val;
 		Variant delta_val;
 		Variant final_val;
@@ -107,11 +125,17 @@ private:
 		int args;
 		Variant arg[VARIANT_ARG_MAX];
 		int uid;
+		int typed_slot;
+		uint32_t timeline_serial;
+		bool timeline_dirty;
 		InterpolateData() {
 			active = false;
 			finish = false;
 			call_deferred = false;
 			uid = 0;
+			typed_slot = -1;
+			timeline_serial = 0;
+			timeline_dirty = false;
 		}
 	};
 
@@ -131,6 +155,103 @@ private:
 	};
 	List<PendingCommand> pending_commands;
 
+	// Float, Vector2 and Color property tweens on known node types keep their values here
+	// as structure of arrays, every slot has TYPED_LANES lanes and unused lanes stay at 0.
+	// Every easing equation is initial + delta * ease(t / duration), so the easing is
+	// evaluated once per tween and the lanes are blended in bulk.
+	static constexpr int TYPED_LANES = 4;
+	struct TypedBatch {
+		LocalVector<InterpolateData *> tweens;
+		LocalVector<real_t> weights;
+		LocalVector<real_t> values;
+	};
+	struct TypedTweens {
+		LocalVector<real_t> initial;
+		LocalVector<real_t> delta;
+		LocalVector<TypedSetter> setter;
+		LocalVector<uint32_t> free_slots;
+
+		// Tweens stepped this frame and by the current seek, kept apart since a signal
+		// handler can seek while the frame's steps are still being applied
+		TypedBatch step_batch;
+		TypedBatch seek_batch;
+	} typed;
+
+	// Tweens advanced this frame, in list order, along with the state they were advanced to
+	struct ProcessedTween {
+		InterpolateData *data = nullptr;
+		bool started = false;
+		int typed_index = -1;
+		real_t elapsed = 0;
+		bool finish = false;
+	};
+	LocalVector<ProcessedTween> processed_tweens;
+
+	// Bumped every time tweens are seeked, reset or stopped. Signal handlers can do that while
+	// the processed tweens are being applied, which leaves the rest of the frame's steps stale.
+	uint64_t tween_state_serial = 0;
+
+	// Seeking only touches the tweens whose [delay, delay + duration] interval overlaps the
+	// old and new positions. Every other tween follows the timeline, so its elapsed time is
+	// only written back lazily once timeline_serial moves past the tween's own serial.
+	// Tweens that stop following the timeline (reset, stopped, added mid way) are dirty and
+	// always get updated by the next seek.
+	real_t timeline_position = 0;
+	uint32_t timeline_serial = 0;
+	LocalVector<InterpolateData *> timeline_dirty;
+
+	// Tweens writing to the same property of the same object, the value that sticks after
+	// a seek comes from the most recently added one that has started
+	struct TimelineTarget {
+		ObjectID id;
+		StringName key;
+
+		bool operator==(const TimelineTarget &p_other) const {
+			return id == p_other.id && key == p_other.key;
+		}
+		static uint32_t hash(const TimelineTarget &p_target) {
+			return hash_murmur3_one_64(uint64_t(p_target.id), p_target.key.hash());
+		}
+	};
+	struct TimelineTargetTweens {
+		LocalVector<real_t> starts;
+		// Most recently added tween among the ones that start up to the same index
+		LocalVector<InterpolateData *> winners;
+	};
+
+	// Tweens sorted by delay with a max tree over their end times, rebuilt lazily
+	struct TimelineIndex {
+		bool valid = false;
+		real_t max_end = 0;
+		uint32_t tree_size = 0;
+		LocalVector<real_t> starts;
+		LocalVector<InterpolateData *> items;
+		LocalVector<real_t> max_end_tree;
+		// Follow and targeting tweens depend on other objects, so they are always updated
+		LocalVector<InterpolateData *> dynamic;
+		HashMap<TimelineTarget, TimelineTargetTweens, TimelineTarget> targets;
+	};
+	mutable TimelineIndex timeline_index;
+	LocalVector<InterpolateData *> seek_scratch;
+	HashMap<TimelineTarget, InterpolateData *, TimelineTarget> seek_targets;
+
+	real_t _get_timeline_elapsed(const InterpolateData &p_data) const;
+	void _sync_timeline_elapsed(InterpolateData &p_data);
+	void _mark_timeline_dirty(InterpolateData &p_data);
+	void _forget_timeline_data(InterpolateData &p_data);
+	void _update_timeline_index() const;
+	InterpolateData *_get_timeline_winner(const TimelineTarget &p_target, real_t p_time) const;
+	bool _seek_interpolation(InterpolateData &p_data, real_t p_time);
+	void _collect_timeline_range(uint32_t p_node, uint32_t p_node_from, uint32_t p_node_to, uint32_t p_count, real_t p_from, LocalVector<InterpolateData *> &r_items) const;
+
+	bool _assign_typed_slot(Object *p_object, InterpolateData &p_data);
+	void _release_typed_slot(InterpolateData &p_data);
+	uint32_t _queue_typed_step(TypedBatch &p_batch, InterpolateData &p_data);
+	void _blend_typed_steps(TypedBatch &p_batch);
+	void _write_typed_step(const TypedBatch &p_batch, uint32_t p_index, Object *p_object);
+	Variant _get_typed_step_value(const TypedBatch &p_batch, uint32_t p_index) const;
+	void _clear_typed_steps(TypedBatch &p_batch);
+
 	void _add_pending_command(StringName p_key, const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), const Variant &p_arg3 = Variant(), const Variant &p_arg4 = Variant(), const Variant &p_arg5 = Variant(), const Variant &p_arg6 = Variant(), const Variant &p_arg7 = Variant(), const Variant &p_arg8 = Variant(), const Variant &p_arg9 = Variant(), const Variant &p_arg10 = Variant());
 	void _process_pending_commands();
 
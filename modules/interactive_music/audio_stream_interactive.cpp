@@ -539,6 +539,11 @@ void AudioStreamInteractive::_bind_methods() {
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 AudioStreamPlaybackInteractive::AudioStreamPlaybackInteractive() {
+	for (uint64_t i = 0; i < SWITCH_QUEUE_SIZE; i++) {
+		switch_queue[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	// Avoids allocating on the mix thread unless switches are scheduled far ahead.
+	pending_switches.reserve(SWITCH_QUEUE_SIZE);
 }
 
 AudioStreamPlaybackInteractive::~AudioStreamPlaybackInteractive() {
@@ -847,30 +852,122 @@ void AudioStreamPlaybackInteractive::seek(double p_time) {
 	// Seek not supported
 }
 
+bool AudioStreamPlaybackInteractive::_push_switch(int p_clip, uint64_t p_frame) {
+	switches_requested.increment();
+
+	// Bounded multi-producer queue, each slot's sequence tells whether it is free for the given write position.
+	uint64_t position = switch_queue_write.load(std::memory_order_relaxed);
+	SwitchSlot *slot = nullptr;
+	while (true) {
+		slot = &switch_queue[position & (SWITCH_QUEUE_SIZE - 1)];
+		const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const int64_t diff = int64_t(sequence - position);
+		if (diff == 0) {
+			if (switch_queue_write.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			switches_dropped.increment();
+			ERR_FAIL_V_MSG(false, "Too many clip switches queued, the switch was dropped.");
+		} else {
+			position = switch_queue_write.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->command.clip = p_clip;
+	slot->command.frame = p_frame;
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool AudioStreamPlaybackInteractive::_pop_switch(SwitchCommand &r_command) {
+	SwitchSlot &slot = switch_queue[switch_queue_read & (SWITCH_QUEUE_SIZE - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != switch_queue_read + 1) {
+		return false; // Empty, or the producer hasn't finished writing it yet.
+	}
+	r_command = slot.command;
+	slot.sequence.store(switch_queue_read + SWITCH_QUEUE_SIZE, std::memory_order_release);
+	switch_queue_read++;
+	return true;
+}
+
+void AudioStreamPlaybackInteractive::_fetch_switches() {
+	SwitchCommand command;
+	while (_pop_switch(command)) {
+		if (command.clip == -1) {
+			pending_switches.clear();
+			continue;
+		}
+		// Insertion keeps switches stamped with the same frame in request order.
+		uint32_t index = pending_switches.size();
+		pending_switches.push_back(command);
+		while (index > 0 && pending_switches[index - 1].frame > command.frame) {
+			pending_switches[index] = pending_switches[index - 1];
+			index--;
+		}
+		pending_switches[index] = command;
+	}
+}
+
+void AudioStreamPlaybackInteractive::_apply_switches(uint64_t p_frame) {
+	uint32_t applied = 0;
+	while (applied < pending_switches.size() && pending_switches[applied].frame <= p_frame) {
+		const SwitchCommand &command = pending_switches[applied];
+		if (command.frame != SWITCH_AS_SOON_AS_POSSIBLE && command.frame < p_frame) {
+			switches_late.increment();
+		}
+		_queue(command.clip, false);
+		switches_applied.increment();
+		applied++;
+	}
+	if (applied == 0) {
+		return;
+	}
+
+	int last_clip = pending_switches[applied - 1].clip;
+	for (uint32_t i = applied; i < pending_switches.size(); i++) {
+		pending_switches[i - applied] = pending_switches[i];
+	}
+	pending_switches.resize(pending_switches.size() - applied);
+	if (pending_switches.is_empty()) {
+		// Only clears it if no newer request came in meanwhile.
+		switch_request.compare_exchange_strong(last_clip, -1);
+	}
+}
+
 int AudioStreamPlaybackInteractive::mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
 	if (active && version != stream->version) {
 		stop();
 	}
 
-	if (switch_request != -1) {
-		_queue(switch_request, false);
-		switch_request = -1;
-	}
+	_fetch_switches();
+
+	uint64_t frame = mix_frame.load(std::memory_order_relaxed);
 
 	if (!active) {
+		_apply_switches(frame);
 		return 0;
 	}
 
 	int todo = p_frames;
 
 	while (todo) {
+		_apply_switches(frame);
+
 		int to_mix = MIN(todo, BUFFER_SIZE);
+		if (!pending_switches.is_empty()) {
+			// Split the buffer so the next switch starts on its frame.
+			to_mix = MIN(uint64_t(to_mix), pending_switches[0].frame - frame);
+		}
+
 		_mix_internal(to_mix);
 		for (int i = 0; i < to_mix; i++) {
 			p_buffer[i] = mix_buffer[i];
 		}
 		p_buffer += to_mix;
 		todo -= to_mix;
+		frame += to_mix;
+		mix_frame.store(frame, std::memory_order_release);
 	}
 
 	return p_frames;
@@ -890,6 +987,29 @@ void AudioStreamPlaybackInteractive::_mix_internal(int p_frames) {
 	}
 }
 
+// Gain loops without any state carried between frames, so the compiler can vectorize them.
+static _FORCE_INLINE_ void _mix_with_gain(AudioFrame *r_dst, const AudioFrame *p_src, int p_frames, float p_gain) {
+	if (p_gain == 0.0f) {
+		return;
+	}
+	float *dst = (float *)r_dst;
+	const float *src = (const float *)p_src;
+	for (int i = 0; i < p_frames * 2; i++) {
+		dst[i] += src[i] * p_gain;
+	}
+}
+
+// Frame i is mixed at p_from + p_step * (i + 1), the same as stepping the volume before each frame.
+static _FORCE_INLINE_ void _mix_with_gain_ramp(AudioFrame *r_dst, const AudioFrame *p_src, int p_frames, float p_from, float p_step) {
+	float *dst = (float *)r_dst;
+	const float *src = (const float *)p_src;
+	for (int i = 0; i < p_frames; i++) {
+		const float gain = CLAMP(p_from + p_step * float(i + 1), 0.0f, 1.0f);
+		dst[i * 2 + 0] += src[i * 2 + 0] * gain;
+		dst[i * 2 + 1] += src[i * 2 + 1] * gain;
+	}
+}
+
 void AudioStreamPlaybackInteractive::_mix_internal_state(int p_state_idx, int p_frames) {
 	State &state = states[p_state_idx];
 	double mix_rate = double(AudioServer::get_singleton()->get_mix_rate());
@@ -918,37 +1038,56 @@ void AudioStreamPlaybackInteractive::_mix_internal_state(int p_state_idx, int p_
 	state.previous_position = state.playback->get_playback_position();
 	state.playback->mix(temp_buffer + from_frame, 1.0, p_frames - from_frame);
 
+	// The mix is split in runs of constant volume and linear ramps, so each run is a single vectorizable loop.
+	int frame = from_frame;
+
+	if (state.fade_wait > 0 && frame < p_frames) {
+		// This is for fade out of existing stream, it keeps its volume until the fade kicks in.
+		const double wait_frames = Math::ceil(state.fade_wait * mix_rate);
+		const int run = (int)MIN(double(p_frames - frame), wait_frames);
+		_mix_with_gain(mix_buffer + frame, temp_buffer + frame, run, state.fade_volume);
+		state.fade_wait = run == wait_frames ? 0.0 : MAX(0.0, state.fade_wait - run * frame_inc);
+		frame += run;
+	}
+
 	double frame_fade_inc = state.fade_speed * frame_inc;
 
-	for (int i = from_frame; i < p_frames; i++) {
-		if (state.fade_wait) {
-			// This is for fade out of existing stream;
-			state.fade_wait -= frame_inc;
-			if (state.fade_wait < 0.0) {
-				state.fade_wait = 0.0;
-			}
-		} else if (frame_fade_inc > 0) {
-			state.fade_volume += frame_fade_inc;
-			if (state.fade_volume >= 1.0) {
-				state.fade_speed = 0.0;
-				frame_fade_inc = 0.0;
-				state.fade_volume = 1.0;
-			}
-		} else if (frame_fade_inc < 0.0) {
-			state.fade_volume += frame_fade_inc;
-			if (state.fade_volume <= 0.0) {
-				state.fade_speed = 0.0;
-				frame_fade_inc = 0.0;
-				state.fade_volume = 0.0;
-				state.playback->stop(); // Stop playback and break, no point to continue mixing
-				break;
+	if (frame_fade_inc != 0.0 && frame < p_frames && state.fade_wait == 0.0) {
+		const double target_volume = frame_fade_inc > 0.0 ? 1.0 : 0.0;
+		// Frames until the volume reaches the target, the frame that reaches it included.
+		const double ramp_frames = MAX(1.0, Math::ceil((target_volume - state.fade_volume) / frame_fade_inc));
+		const int run = (int)MIN(double(p_frames - frame), ramp_frames);
+		const bool finished = run == ramp_frames;
+
+		if (frame_fade_inc > 0.0) {
+			_mix_with_gain_ramp(mix_buffer + frame, temp_buffer + frame, run, state.fade_volume, frame_fade_inc);
+			frame += run;
+		} else {
+			// The frame that reaches silence isn't mixed.
+			const int mixed = finished ? run - 1 : run;
+			_mix_with_gain_ramp(mix_buffer + frame, temp_buffer + frame, mixed, state.fade_volume, frame_fade_inc);
+			frame += mixed;
+		}
+
+		if (finished) {
+			state.fade_speed = 0.0;
+			state.fade_volume = target_volume;
+			if (target_volume == 0.0) {
+				state.playback->stop(); // Stop playback, no point to continue mixing
+				p_frames = frame;
 			}
+		} else {
+			state.fade_volume += frame_fade_inc * run;
 		}
+	}
 
-		mix_buffer[i] += temp_buffer[i] * state.fade_volume;
-		state.previous_position += frame_inc;
+	if (frame < p_frames) {
+		_mix_with_gain(mix_buffer + frame, temp_buffer + frame, p_frames - frame, state.fade_volume);
+		frame = p_frames;
 	}
 
+	state.previous_position += (frame - from_frame) * frame_inc;
+
 	if (!state.playback->is_playing()) {
 		// It finished because it either reached end or faded out, so deactivate and continue.
 		state.active = false;
@@ -969,7 +1108,8 @@ void AudioStreamPlaybackInteractive::tag_used_streams() {
 
 void AudioStreamPlaybackInteractive::switch_to_clip_by_name(const StringName &p_name) {
 	if (p_name == StringName()) {
-		switch_request = -1;
+		switch_request.store(-1);
+		_push_switch(-1, SWITCH_AS_SOON_AS_POSSIBLE);
 		return;
 	}
 
@@ -977,7 +1117,7 @@ void AudioStreamPlaybackInteractive::switch_to_clip_by_name(const StringName &p_
 
 	for (int i = 0; i < stream->get_clip_count(); i++) {
 		if (stream->get_clip_name(i) == p_name) {
-			switch_request = i;
+			switch_to_clip(i);
 			return;
 		}
 	}
@@ -992,9 +1132,10 @@ void AudioStreamPlaybackInteractive::set_parameter(const StringName &p_name, con
 
 Variant AudioStreamPlaybackInteractive::get_parameter(const StringName &p_name) const {
 	if (p_name == SNAME("switch_to_clip")) {
+		const int requested_clip = switch_request.load();
 		for (int i = 0; i < stream->get_clip_count(); i++) {
-			if (switch_request != -1) {
-				if (switch_request == i) {
+			if (requested_clip != -1) {
+				if (requested_clip == i) {
 					return String(stream->get_clip_name(i));
 				}
 			} else if (playback_current == i) {
@@ -1008,7 +1149,28 @@ Variant AudioStreamPlaybackInteractive::get_parameter(const StringName &p_name)
 }
 
 void AudioStreamPlaybackInteractive::switch_to_clip(int p_index) {
-	switch_request = p_index;
+	switch_to_clip_at_frame(p_index, SWITCH_AS_SOON_AS_POSSIBLE);
+}
+
+void AudioStreamPlaybackInteractive::switch_to_clip_at_frame(int p_index, uint64_t p_frame) {
+	ERR_FAIL_COND_MSG(stream.is_null(), "Attempted to switch while not playing back any stream.");
+	ERR_FAIL_INDEX(p_index, stream->get_clip_count());
+	if (_push_switch(p_index, p_frame)) {
+		switch_request.store(p_index);
+	}
+}
+
+uint64_t AudioStreamPlaybackInteractive::get_mix_frame() const {
+	return mix_frame.load(std::memory_order_acquire);
+}
+
+AudioStreamPlaybackInteractive::SwitchStats AudioStreamPlaybackInteractive::get_switch_stats() const {
+	SwitchStats stats;
+	stats.requested = switches_requested.get();
+	stats.applied = switches_applied.get();
+	stats.dropped = switches_dropped.get();
+	stats.late = switches_late.get();
+	return stats;
 }
 
 int AudioStreamPlaybackInteractive::get_loop_count() const {
@@ -1026,4 +1188,6 @@ bool AudioStreamPlaybackInteractive::is_playing() const {
 void AudioStreamPlaybackInteractive::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("switch_to_clip_by_name", "clip_name"), &AudioStreamPlaybackInteractive::switch_to_clip_by_name);
 	ClassDB::bind_method(D_METHOD("switch_to_clip", "clip_index"), &AudioStreamPlaybackInteractive::switch_to_clip);
+	ClassDB::bind_method(D_METHOD("switch_to_clip_at_frame", "clip_index", "frame"), &AudioStreamPlaybackInteractive::switch_to_clip_at_frame);
+	ClassDB::bind_method(D_METHOD("get_mix_frame"), &AudioStreamPlaybackInteractive::get_mix_frame);
 }
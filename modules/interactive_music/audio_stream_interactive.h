@@ -31,8 +31,12 @@
 #ifndef AUDIO_STREAM_INTERACTIVE_H
 #define AUDIO_STREAM_INTERACTIVE_H
 
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
 #include "servers/audio/audio_stream.h"
 
+#include <atomic>
+
 class AudioStreamPlaybackInteractive;
 
 class AudioStreamInteractive : public AudioStream {
@@ -241,7 +245,40 @@ private:
 
 	void _queue(int p_to_clip_index, bool p_is_auto_advance);
 
-	int switch_request = -1;
+	// Switch requests are pushed by any thread into a bounded lock-free queue and applied by mix(), which
+	// splits its buffer so each switch lands on the exact frame it was stamped with.
+	enum {
+		SWITCH_QUEUE_SIZE = 256, // Power of two.
+		SWITCH_AS_SOON_AS_POSSIBLE = 0,
+	};
+
+	struct SwitchCommand {
+		int clip = -1; // -1 cancels the switches that are still pending.
+		uint64_t frame = SWITCH_AS_SOON_AS_POSSIBLE;
+	};
+
+	struct SwitchSlot {
+		std::atomic<uint64_t> sequence;
+		SwitchCommand command;
+	};
+
+	SwitchSlot switch_queue[SWITCH_QUEUE_SIZE];
+	std::atomic<uint64_t> switch_queue_write = 0;
+	uint64_t switch_queue_read = 0; // Mix thread only.
+	LocalVector<SwitchCommand> pending_switches; // Mix thread only, sorted by frame.
+
+	std::atomic<uint64_t> mix_frame = 0;
+	std::atomic<int> switch_request = -1; // Last requested clip, for get_parameter().
+
+	SafeNumeric<uint64_t> switches_requested;
+	SafeNumeric<uint64_t> switches_applied;
+	SafeNumeric<uint64_t> switches_dropped;
+	SafeNumeric<uint64_t> switches_late;
+
+	bool _push_switch(int p_clip, uint64_t p_frame);
+	bool _pop_switch(SwitchCommand &r_command);
+	void _fetch_switches();
+	void _apply_switches(uint64_t p_frame);
 
 protected:
 	static void _bind_methods();
@@ -259,6 +296,18 @@ public:
 
 	void switch_to_clip_by_name(const StringName &p_name);
 	void switch_to_clip(int p_index);
+	// Switches exactly at p_frame of this playback's output, see get_mix_frame(). Frames already mixed switch right away.
+	void switch_to_clip_at_frame(int p_index, uint64_t p_frame);
+	// Frames mixed since the playback was created.
+	uint64_t get_mix_frame() const;
+
+	struct SwitchStats {
+		uint64_t requested = 0;
+		uint64_t applied = 0;
+		uint64_t dropped = 0; // The queue was full.
+		uint64_t late = 0; // Applied after the frame they were scheduled for.
+	};
+	SwitchStats get_switch_stats() const;
 
 	virtual void set_parameter(const StringName &p_name, const Variant &p_value) override;
 	virtual Variant get_parameter(const StringName &p_name) const override;
@@ -0,0 +1,207 @@
+/**************************************************************************/
+/*  test_audio_stream_interactive.h                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_AUDIO_STREAM_INTERACTIVE_H
+#define TEST_AUDIO_STREAM_INTERACTIVE_H
+
+#include "../audio_stream_interactive.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "scene/resources/audio_stream_wav.h"
+#include "servers/audio_server.h"
+
+#include "tests/test_macros.h"
+
+namespace TestAudioStreamInteractive {
+
+// Looping clip that outputs a constant level, at the server's rate so playback doesn't interpolate.
+static Ref<AudioStreamWAV> make_constant_clip(float p_level) {
+	const int mix_rate = AudioServer::get_singleton()->get_mix_rate();
+	const int16_t sample = int16_t(p_level * 32768.0f);
+
+	Vector<uint8_t> data;
+	data.resize(mix_rate * 4);
+	uint8_t *ptr = data.ptrw();
+	for (int i = 0; i < mix_rate * 2; i++) {
+		ptr[i * 2 + 0] = sample & 0xFF;
+		ptr[i * 2 + 1] = (sample >> 8) & 0xFF;
+	}
+
+	Ref<AudioStreamWAV> clip;
+	clip.instantiate();
+	clip->set_format(AudioStreamWAV::FORMAT_16_BITS);
+	clip->set_stereo(true);
+	clip->set_mix_rate(mix_rate);
+	clip->set_data(data);
+	clip->set_loop_mode(AudioStreamWAV::LOOP_FORWARD);
+	clip->set_loop_begin(0);
+	clip->set_loop_end(mix_rate);
+	return clip;
+}
+
+static Ref<AudioStreamInteractive> make_interactive_stream(AudioStreamInteractive::FadeMode p_fade_mode) {
+	const float levels[3] = { 0.25f, 0.5f, 0.125f };
+
+	Ref<AudioStreamInteractive> stream;
+	stream.instantiate();
+	stream->set_clip_count(3);
+	for (int i = 0; i < 3; i++) {
+		stream->set_clip_stream(i, make_constant_clip(levels[i]));
+	}
+	stream->set_initial_clip(0);
+	stream->add_transition(AudioStreamInteractive::CLIP_ANY, AudioStreamInteractive::CLIP_ANY, AudioStreamInteractive::TRANSITION_FROM_TIME_IMMEDIATE, AudioStreamInteractive::TRANSITION_TO_TIME_START, p_fade_mode, 1);
+	return stream;
+}
+
+TEST_CASE("[AudioStreamInteractive] Scheduled switches land on their frame") {
+	const double mix_rate = AudioServer::get_singleton()->get_mix_rate();
+	Ref<AudioStreamInteractive> stream = make_interactive_stream(AudioStreamInteractive::FADE_DISABLED);
+	Ref<AudioStreamPlaybackInteractive> playback = stream->instantiate_playback();
+	REQUIRE(playback.is_valid());
+	playback->start();
+
+	playback->switch_to_clip_at_frame(1, 1000);
+
+	Vector<AudioFrame> buffer;
+	buffer.resize(4096);
+	CHECK(playback->mix(buffer.ptrw(), 1.0, 4096) == 4096);
+	CHECK(playback->get_mix_frame() == 4096);
+
+	CHECK(buffer[999].left == doctest::Approx(0.25));
+	// The new clip starts on the frame, the previous one fades out at 1000 per second on top to avoid clicks.
+	CHECK(buffer[1000].left == doctest::Approx(0.5 + 0.25 * (1.0 - 1000.0 / mix_rate)).epsilon(0.001));
+	CHECK(buffer[1200].left == doctest::Approx(0.5));
+
+	AudioStreamPlaybackInteractive::SwitchStats stats = playback->get_switch_stats();
+	CHECK(stats.applied == 1);
+	CHECK(stats.late == 0);
+}
+
+TEST_CASE("[AudioStreamInteractive] Crossfades follow a linear ramp") {
+	const double mix_rate = AudioServer::get_singleton()->get_mix_rate();
+	Ref<AudioStreamInteractive> stream = make_interactive_stream(AudioStreamInteractive::FADE_CROSS);
+	Ref<AudioStreamPlaybackInteractive> playback = stream->instantiate_playback();
+	REQUIRE(playback.is_valid());
+	playback->start();
+	playback->switch_to_clip(1);
+
+	// Without BPM a fade lasts fade_beats seconds.
+	const int frames = mix_rate * 1.5;
+	Vector<AudioFrame> buffer;
+	buffer.resize(frames);
+	for (int mixed = 0; mixed < frames; mixed += 512) {
+		playback->mix(buffer.ptrw() + mixed, 1.0, MIN(512, frames - mixed));
+	}
+
+	bool matches = true;
+	for (int i = 0; i < frames; i += 97) {
+		const double gain = MIN(1.0, (i + 1) / mix_rate);
+		const double expected = 0.25 * (1.0 - gain) + 0.5 * gain;
+		matches = matches && Math::is_equal_approx(buffer[i].left, (float)expected, 0.001f) && Math::is_equal_approx(buffer[i].right, (float)expected, 0.001f);
+	}
+	CHECK_MESSAGE(matches, "The crossfade doesn't match a linear ramp.");
+}
+
+struct SwitchDriver {
+	Ref<AudioStreamPlaybackInteractive> playback;
+	LocalVector<uint64_t> frames;
+	LocalVector<int> clips;
+	uint64_t window = 0;
+	// Every switch scheduled before this frame is queued.
+	std::atomic<uint64_t> queued_until = 0;
+};
+
+static void drive_switches(void *p_userdata) {
+	SwitchDriver *driver = (SwitchDriver *)p_userdata;
+	for (uint32_t i = 0; i < driver->frames.size(); i++) {
+		// Stays a bit ahead of the mixer, like a game reacting to its own state.
+		while (driver->frames[i] > driver->playback->get_mix_frame() + driver->window) {
+			OS::get_singleton()->delay_usec(10);
+		}
+		driver->playback->switch_to_clip_at_frame(driver->clips[i], driver->frames[i]);
+		driver->queued_until.store(i + 1 < driver->frames.size() ? driver->frames[i + 1] : UINT64_MAX, std::memory_order_release);
+	}
+}
+
+TEST_CASE("[AudioStreamInteractive] Stress scheduling switches from another thread") {
+	const int mix_rate = AudioServer::get_singleton()->get_mix_rate();
+	const int seconds = 10;
+	const int switches_per_second = 300;
+	const int block_size = 512;
+
+	Ref<AudioStreamInteractive> stream = make_interactive_stream(AudioStreamInteractive::FADE_DISABLED);
+
+	SwitchDriver driver;
+	driver.playback = stream->instantiate_playback();
+	REQUIRE(driver.playback.is_valid());
+	driver.playback->start();
+	driver.window = mix_rate / 4;
+
+	RandomPCG rng(1337);
+	uint64_t frame = 0;
+	int clip = 0;
+	for (int i = 0; i < seconds * switches_per_second; i++) {
+		frame += 1 + rng.rand() % (2 * mix_rate / switches_per_second);
+		clip = (clip + 1 + rng.rand() % 2) % 3;
+		driver.frames.push_back(frame);
+		driver.clips.push_back(clip);
+	}
+	const uint64_t total_frames = frame + block_size;
+
+	Vector<AudioFrame> buffer;
+	buffer.resize(block_size);
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	Thread thread;
+	thread.start(drive_switches, &driver);
+
+	for (uint64_t mixed = 0; mixed < total_frames; mixed += block_size) {
+		while (driver.queued_until.load(std::memory_order_acquire) < mixed + block_size) {
+			OS::get_singleton()->delay_usec(10);
+		}
+		driver.playback->mix(buffer.ptrw(), 1.0, block_size);
+	}
+
+	thread.wait_to_finish();
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+
+	AudioStreamPlaybackInteractive::SwitchStats stats = driver.playback->get_switch_stats();
+	CHECK(stats.requested == driver.frames.size());
+	CHECK(stats.applied == driver.frames.size());
+	CHECK(stats.dropped == 0);
+	CHECK(stats.late == 0);
+	MESSAGE(vformat("%d switches over %d seconds of audio mixed in %d usec", stats.applied, seconds, elapsed));
+}
+
+} // namespace TestAudioStreamInteractive
+
+#endif // TEST_AUDIO_STREAM_INTERACTIVE_H
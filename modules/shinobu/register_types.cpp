@@ -6,6 +6,7 @@
 #include "shinobu.h"
 #include "shinobu_effects.h"
 #include "shinobu_sound_player.h"
+#include "shinobu_voice_pool.h"
 
 static Shinobu *shinobu_ptr = NULL;
 
@@ -16,6 +17,8 @@ void initialize_shinobu_module(ModuleInitializationLevel p_level) {
 	GDREGISTER_ABSTRACT_CLASS(ShinobuSoundPlayer);
 	GDREGISTER_ABSTRACT_CLASS(ShinobuSoundSource);
 	GDREGISTER_ABSTRACT_CLASS(ShinobuSoundSourceMemory);
+	GDREGISTER_ABSTRACT_CLASS(ShinobuSoundSourceFile);
+	GDREGISTER_ABSTRACT_CLASS(ShinobuVoicePool);
 	GDREGISTER_ABSTRACT_CLASS(ShinobuGroup);
 	GDREGISTER_ABSTRACT_CLASS(ShinobuEffect);
 	GDREGISTER_ABSTRACT_CLASS(ShinobuChannelRemapEffect);
@@ -5,6 +5,7 @@
 
 #define MA_NO_VORBIS /* Disable the built-in Vorbis decoder to ensure the libvorbis decoder is picked. */
 #define MA_NO_OPUS /* Disable the (not yet implemented) built-in Opus decoder to ensure the libopus decoder is picked. */
+#define MA_RESOURCE_MANAGER_PAGE_SIZE_IN_MILLISECONDS SHINOBU_STREAM_PAGE_SIZE_MSEC
 #define MINIAUDIO_IMPLEMENTATION
 #define MA_DEBUG_OUTPUT
 
@@ -15,7 +16,9 @@
 #include "shinobu_spectrum_analyzer.h"
 /* clang-format on */
 
+#include "core/io/file_access.h"
 #include "core/os/os.h"
+#include "main/performance.h"
 #include "miniaudio/extras/miniaudio_libvorbis.h"
 #include "shinobu_macros.h"
 
@@ -25,8 +28,25 @@ SafeNumeric<uint64_t> Shinobu::sound_source_uid;
 void Shinobu::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("create_group", "group_name", "parent_group"), &Shinobu::create_group);
 	ClassDB::bind_method(D_METHOD("initialize"), &Shinobu::godot_initialize);
+	ClassDB::bind_method(D_METHOD("initialize_offline", "sample_rate"), &Shinobu::initialize_offline, DEFVAL(48000));
+	ClassDB::bind_method(D_METHOD("render_offline", "length_msec", "output_path", "analysis_callback"), &Shinobu::render_offline, DEFVAL(Callable()));
+	ClassDB::bind_method(D_METHOD("cancel_offline_render"), &Shinobu::cancel_offline_render);
+	ClassDB::bind_method(D_METHOD("is_offline_rendering"), &Shinobu::is_offline_rendering);
+	ClassDB::bind_method(D_METHOD("is_offline"), &Shinobu::is_offline);
+	ADD_SIGNAL(MethodInfo("offline_render_finished", PropertyInfo(Variant::INT, "error")));
 	ClassDB::bind_method(D_METHOD("get_initialization_error"), &Shinobu::get_initialization_error);
 	ClassDB::bind_method(D_METHOD("register_sound_from_memory", "name_hint", "data"), &Shinobu::register_sound_from_memory);
+	ClassDB::bind_method(D_METHOD("register_sound_from_file", "path"), &Shinobu::register_sound_from_file);
+	ClassDB::bind_method(D_METHOD("get_streaming_page_memory"), &Shinobu::get_streaming_page_memory);
+	ClassDB::bind_method(D_METHOD("analyze_loudness_async", "sources"), &Shinobu::analyze_loudness_async);
+	ClassDB::bind_method(D_METHOD("wait_for_loudness_batch", "batch_id"), &Shinobu::wait_for_loudness_batch);
+	ClassDB::bind_method(D_METHOD("save_loudness_cache"), &Shinobu::save_loudness_cache);
+	ClassDB::bind_method(D_METHOD("clear_loudness_cache"), &Shinobu::clear_loudness_cache);
+	ClassDB::bind_method(D_METHOD("set_loudness_cache_path", "path"), &Shinobu::set_loudness_cache_path);
+	ClassDB::bind_method(D_METHOD("get_loudness_cache_path"), &Shinobu::get_loudness_cache_path);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "loudness_cache_path"), "set_loudness_cache_path", "get_loudness_cache_path");
+	ADD_SIGNAL(MethodInfo("loudness_analyzed", PropertyInfo(Variant::OBJECT, "source", PROPERTY_HINT_RESOURCE_TYPE, "ShinobuSoundSource"), PropertyInfo(Variant::FLOAT, "loudness")));
+	ADD_SIGNAL(MethodInfo("loudness_batch_finished", PropertyInfo(Variant::INT, "batch_id"), PropertyInfo(Variant::PACKED_FLOAT32_ARRAY, "loudness")));
 	ClassDB::bind_method(D_METHOD("instantiate_spectrum_analyzer_effect"), &Shinobu::instantiate_spectrum_analyzer_effect);
 	ClassDB::bind_method(D_METHOD("instantiate_pitch_shift"), &Shinobu::instantiate_pitch_shift);
 	ClassDB::bind_method(D_METHOD("instantiate_channel_remap", "channel_count_in", "channel_count_out"), &Shinobu::instantiate_channel_remap);
@@ -38,6 +58,18 @@ void Shinobu::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "master_volume"), "set_master_volume", "get_master_volume");
 	ClassDB::bind_method(D_METHOD("set_dsp_time", "new_time"), &Shinobu::set_dsp_time);
 	ClassDB::bind_method(D_METHOD("get_dsp_time"), &Shinobu::get_dsp_time);
+	ClassDB::bind_method(D_METHOD("set_filtered_clock_enabled", "enabled"), &Shinobu::set_filtered_clock_enabled);
+	ClassDB::bind_method(D_METHOD("is_filtered_clock_enabled"), &Shinobu::is_filtered_clock_enabled);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "filtered_clock_enabled"), "set_filtered_clock_enabled", "is_filtered_clock_enabled");
+	ClassDB::bind_method(D_METHOD("set_clock_filter_bandwidth", "bandwidth_hz"), &Shinobu::set_clock_filter_bandwidth);
+	ClassDB::bind_method(D_METHOD("get_clock_filter_bandwidth"), &Shinobu::get_clock_filter_bandwidth);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "clock_filter_bandwidth"), "set_clock_filter_bandwidth", "get_clock_filter_bandwidth");
+	ClassDB::bind_method(D_METHOD("get_clock_statistics"), &Shinobu::get_clock_statistics);
+	ClassDB::bind_method(D_METHOD("get_performance_stats"), &Shinobu::get_performance_stats);
+	ClassDB::bind_method(D_METHOD("reset_performance_stats"), &Shinobu::reset_performance_stats);
+	ClassDB::bind_method(D_METHOD("set_node_profiling_enabled", "enabled"), &Shinobu::set_node_profiling_enabled);
+	ClassDB::bind_method(D_METHOD("is_node_profiling_enabled"), &Shinobu::is_node_profiling_enabled);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "node_profiling_enabled"), "set_node_profiling_enabled", "is_node_profiling_enabled");
 	ClassDB::bind_method(D_METHOD("get_actual_buffer_size"), &Shinobu::get_actual_buffer_size);
 	ClassDB::bind_method(D_METHOD("get_current_backend_name"), &Shinobu::get_current_backend_name);
 }
@@ -168,6 +200,7 @@ Error Shinobu::initialize(ma_backend forced_backend) {
 #endif
 
 	bool shinobu_clock_mix_size_compensation = true;
+	bool shinobu_clock_filtered = clock->is_using_filtered_clock();
 
 	List<String>::Element *I = args.front();
 	while (I) {
@@ -179,13 +212,18 @@ Error Shinobu::initialize(ma_backend forced_backend) {
 			}
 		} else if (I->get() == "--shinobu-dev-disable-clock-msc") {
 			shinobu_clock_mix_size_compensation = false;
+		} else if (I->get() == "--shinobu-clock-filtered") {
+			shinobu_clock_filtered = true;
+		} else if (I->get() == "--shinobu-node-profiling") {
+			set_node_profiling_enabled(true);
 		}
 		I = N;
 	}
 
 	clock->set_use_mix_size_compensation(shinobu_clock_mix_size_compensation);
+	clock->set_use_filtered_clock(shinobu_clock_filtered);
 
-	clock->measure(0);
+	clock->measure(0, 0);
 
 	ma_result result;
 
@@ -231,6 +269,20 @@ Error Shinobu::initialize(ma_backend forced_backend) {
 		engine_config.periodSizeInMilliseconds = desired_buffer_size_msec;
 	}
 
+	Error err = initialize_engine(engine_config);
+	if (err != OK) {
+		return err;
+	}
+
+	initialized = true;
+	_add_performance_monitors();
+
+	return OK;
+}
+
+Error Shinobu::initialize_engine(ma_engine_config &p_engine_config) {
+	ma_result result;
+
 	// Setup libvorbis
 
 	ma_resource_manager_config resourceManagerConfig;
@@ -249,27 +301,200 @@ Error Shinobu::initialize(ma_backend forced_backend) {
 	resourceManagerConfig.pCustomDecodingBackendUserData = NULL;
 	resourceManagerConfig.decodedFormat = ma_format_f32;
 
+	// Route file access through Godot so streamed sources can live inside PCKs
+	result = shinobu_vfs_init(&vfs);
+	MA_ERR_RET(result, "VFS init failed!");
+	resourceManagerConfig.pVFS = &vfs;
+
 	result = ma_resource_manager_init(&resourceManagerConfig, &resource_manager);
 
 	MA_ERR_RET(result, "Resource manager init failed!");
 
-	engine_config.pResourceManager = &resource_manager;
+	p_engine_config.pResourceManager = &resource_manager;
 
-	result = ma_engine_init(&engine_config, &engine);
+	result = ma_engine_init(&p_engine_config, &engine);
 
 	MA_ERR_RET(result, "Audio engine init failed!");
 
+
+	return OK;
+}
+
+Error Shinobu::initialize_offline(uint32_t p_sample_rate) {
+	ERR_FAIL_COND_V_MSG(initialized, ERR_ALREADY_IN_USE, "Shinobu is already initialized.");
+
+	ma_engine_config engine_config = ma_engine_config_init();
+	engine_config.noDevice = MA_TRUE;
+	engine_config.channels = 2;
+	engine_config.sampleRate = p_sample_rate;
+
+	Error err = initialize_engine(engine_config);
+	if (err != OK) {
+		return err;
+	}
+
+	offline = true;
 	initialized = true;
 
 	return OK;
 }
 
+void Shinobu::_offline_render_thread(void *p_userdata) {
+	Shinobu *shinobu = (Shinobu *)p_userdata;
+	Error err = shinobu->_render_offline();
+	callable_mp(shinobu, &Shinobu::_offline_render_finished).call_deferred(err);
+}
+
+static ma_result ma_encoder_write_file_access(ma_encoder *pEncoder, const void *pBufferIn, size_t bytesToWrite, size_t *pBytesWritten) {
+	FileAccess *file = (FileAccess *)pEncoder->pUserData;
+	file->store_buffer((const uint8_t *)pBufferIn, bytesToWrite);
+	*pBytesWritten = bytesToWrite;
+	return file->get_error() == OK ? MA_SUCCESS : MA_IO_ERROR;
+}
+
+static ma_result ma_encoder_seek_file_access(ma_encoder *pEncoder, ma_int64 offset, ma_seek_origin origin) {
+	FileAccess *file = (FileAccess *)pEncoder->pUserData;
+	switch (origin) {
+		case ma_seek_origin_start: {
+			file->seek(offset);
+		} break;
+		case ma_seek_origin_current: {
+			file->seek(file->get_position() + offset);
+		} break;
+		case ma_seek_origin_end: {
+			file->seek_end(offset);
+		} break;
+	}
+	return MA_SUCCESS;
+}
+
+Error Shinobu::_render_offline() {
+	const uint32_t channel_count = ma_engine_get_channels(&engine);
+	const uint32_t sample_rate = ma_engine_get_sample_rate(&engine);
+	const uint64_t total_frames = (offline_render_length_msec * sample_rate) / 1000;
+
+	Ref<FileAccess> file;
+	ma_encoder encoder;
+	bool use_encoder = false;
+
+	if (!offline_render_path.is_empty()) {
+		Error err;
+		file = FileAccess::open(offline_render_path, FileAccess::WRITE, &err);
+		ERR_FAIL_COND_V_MSG(err != OK, err, vformat("Can't open offline render output file %s.", offline_render_path));
+		if (offline_render_path.get_extension().to_lower() == "wav") {
+			ma_encoder_config encoder_config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, channel_count, sample_rate);
+			ma_result result = ma_encoder_init(ma_encoder_write_file_access, ma_encoder_seek_file_access, file.ptr(), &encoder_config, &encoder);
+			ERR_FAIL_COND_V_MSG(result != MA_SUCCESS, FAILED, vformat("Error initializing WAV encoder (%s).", ma_result_description(result)));
+			use_encoder = true;
+		}
+	}
+
+	PackedFloat32Array chunk;
+	chunk.resize(OFFLINE_RENDER_CHUNK_FRAMES * channel_count);
+
+	uint64_t frames_rendered = 0;
+	Error err = OK;
+
+	while (frames_rendered < total_frames && !offline_render_cancel.is_set()) {
+		// Chunks are a fixed number of frames so engine time advances exactly like a device would
+		uint64_t frames_to_render = MIN((uint64_t)OFFLINE_RENDER_CHUNK_FRAMES, total_frames - frames_rendered);
+		float *chunk_ptr = chunk.ptrw();
+		ma_uint64 frames_read = 0;
+		ma_result result = ma_engine_read_pcm_frames(&engine, chunk_ptr, frames_to_render, &frames_read);
+		if (result != MA_SUCCESS) {
+			err = FAILED;
+			break;
+		}
+		if (frames_read == 0) {
+			break;
+		}
+
+		if (use_encoder) {
+			result = ma_encoder_write_pcm_frames(&encoder, chunk_ptr, frames_read, nullptr);
+			if (result != MA_SUCCESS) {
+				ERR_PRINT(vformat("Error writing offline render output (%s).", ma_result_description(result)));
+				err = ERR_FILE_CANT_WRITE;
+				break;
+			}
+		} else if (file.is_valid()) {
+			file->store_buffer((const uint8_t *)chunk_ptr, frames_read * channel_count * sizeof(float));
+			if (file->get_error() != OK) {
+				err = ERR_FILE_CANT_WRITE;
+				break;
+			}
+		}
+
+		// Analysis callbacks run on the render thread, not the main thread
+		if (offline_render_callback.is_valid()) {
+			if (frames_read < OFFLINE_RENDER_CHUNK_FRAMES) {
+				// A sized copy, the chunk itself keeps its size for the next read
+				offline_render_callback.call(chunk.slice(0, frames_read * channel_count), frames_rendered);
+			} else {
+				offline_render_callback.call(chunk, frames_rendered);
+			}
+		}
+
+		frames_rendered += frames_read;
+		if (frames_read < frames_to_render) {
+			// The engine ran dry, nothing more to render
+			break;
+		}
+	}
+
+	if (use_encoder) {
+		ma_encoder_uninit(&encoder);
+	}
+
+	return err;
+}
+
+void Shinobu::_offline_render_finished(Error p_error) {
+	if (offline_render_thread.is_started()) {
+		offline_render_thread.wait_to_finish();
+	}
+	emit_signal(SNAME("offline_render_finished"), p_error);
+}
+
+Error Shinobu::render_offline(uint64_t p_length_msec, String p_output_path, Callable p_analysis_callback) {
+	ERR_FAIL_COND_V_MSG(!initialized || !offline, ERR_UNCONFIGURED, "Offline rendering requires Shinobu to be initialized with initialize_offline().");
+	ERR_FAIL_COND_V_MSG(offline_render_thread.is_started(), ERR_BUSY, "An offline render is already in progress.");
+
+	offline_render_length_msec = p_length_msec;
+	offline_render_path = p_output_path;
+	offline_render_callback = p_analysis_callback;
+	offline_render_cancel.clear();
+	offline_render_thread.start(_offline_render_thread, this);
+
+	return OK;
+}
+
+void Shinobu::cancel_offline_render() {
+	offline_render_cancel.set();
+}
+
+bool Shinobu::is_offline_rendering() const {
+	return offline_render_thread.is_started();
+}
+
+bool Shinobu::is_offline() const {
+	return offline;
+}
+
 void Shinobu::ma_data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount) {
 	Shinobu *shinobu = (Shinobu *)pDevice->pUserData;
 	if (shinobu != NULL) {
+		uint64_t render_start = shinobu_get_monotonic_nsec();
 		ma_engine_read_pcm_frames(&shinobu->engine, pOutput, frameCount, NULL);
+		uint64_t render_nsec = shinobu_get_monotonic_nsec() - render_start;
 		uint32_t sample_size_nsec = (frameCount * 1e+9) / ma_engine_get_sample_rate(&shinobu->engine);
-		shinobu->clock->measure(sample_size_nsec);
+		int64_t engine_time_nsec = (ma_engine_get_time(&shinobu->engine) * 1e+9) / ma_engine_get_sample_rate(&shinobu->engine);
+		shinobu->clock->measure(sample_size_nsec, engine_time_nsec);
+
+		shinobu->callback_counters.record(render_nsec);
+		shinobu->period_budget_nsec.store(sample_size_nsec, std::memory_order_relaxed);
+		if (render_nsec > sample_size_nsec) {
+			shinobu->underrun_count.fetch_add(1, std::memory_order_relaxed);
+		}
 	}
 }
 
@@ -287,12 +512,183 @@ ma_engine *Shinobu::get_engine() {
 	return &engine;
 }
 
+ma_vfs *Shinobu::get_vfs() {
+	return &vfs;
+}
+
+ma_decoder_config Shinobu::get_decoder_config() const {
+	static ma_decoding_backend_vtable *custom_backend_vtables[] = {
+		&g_ma_decoding_backend_vtable_libvorbis
+	};
+	ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 0, 0);
+	config.ppCustomBackendVTables = custom_backend_vtables;
+	config.customBackendCount = sizeof(custom_backend_vtables) / sizeof(custom_backend_vtables[0]);
+	config.pCustomBackendUserData = NULL;
+	return config;
+}
+
 Ref<ShinobuSoundSourceMemory> Shinobu::register_sound_from_memory(String m_name_hint, PackedByteArray m_data) {
 	Ref<ShinobuSoundSourceMemory> source;
 	source.instantiate(m_name_hint, m_data);
 	return source;
 }
 
+Ref<ShinobuSoundSourceFile> Shinobu::register_sound_from_file(String m_path) {
+	Ref<ShinobuSoundSourceFile> source;
+	source.instantiate(m_path);
+	return source;
+}
+
+uint64_t Shinobu::get_streaming_page_memory() const {
+	return ShinobuSoundSourceFile::get_total_decoded_page_memory();
+}
+
+void Shinobu::_load_loudness_cache() {
+	// Must be called with loudness_cache_mutex held
+	if (loudness_cache_loaded) {
+		return;
+	}
+	loudness_cache_loaded = true;
+
+	if (!FileAccess::exists(loudness_cache_path)) {
+		return;
+	}
+
+	Ref<FileAccess> file = FileAccess::open(loudness_cache_path, FileAccess::READ);
+	ERR_FAIL_COND_MSG(file.is_null(), vformat("Can't open loudness cache %s.", loudness_cache_path));
+	Dictionary cache = file->get_var();
+	Array keys = cache.keys();
+	for (int i = 0; i < keys.size(); i++) {
+		loudness_cache.insert(keys[i], cache[keys[i]]);
+	}
+}
+
+bool Shinobu::get_cached_loudness(const String &p_content_hash, float &r_loudness) {
+	MutexLock lock(loudness_cache_mutex);
+	_load_loudness_cache();
+	HashMap<String, float>::Iterator E = loudness_cache.find(p_content_hash);
+	if (!E) {
+		return false;
+	}
+	r_loudness = E->value;
+	return true;
+}
+
+void Shinobu::store_cached_loudness(const String &p_content_hash, float p_loudness) {
+	MutexLock lock(loudness_cache_mutex);
+	_load_loudness_cache();
+	loudness_cache.insert(p_content_hash, p_loudness);
+	loudness_cache_dirty = true;
+}
+
+Error Shinobu::save_loudness_cache() {
+	MutexLock lock(loudness_cache_mutex);
+	if (!loudness_cache_dirty) {
+		return OK;
+	}
+
+	Dictionary cache;
+	for (const KeyValue<String, float> &E : loudness_cache) {
+		cache[E.key] = E.value;
+	}
+
+	Error err;
+	Ref<FileAccess> file = FileAccess::open(loudness_cache_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, vformat("Can't write loudness cache %s.", loudness_cache_path));
+	file->store_var(cache);
+	loudness_cache_dirty = false;
+	return OK;
+}
+
+void Shinobu::clear_loudness_cache() {
+	MutexLock lock(loudness_cache_mutex);
+	loudness_cache.clear();
+	loudness_cache_loaded = true;
+	loudness_cache_dirty = true;
+}
+
+void Shinobu::set_loudness_cache_path(const String &p_path) {
+	MutexLock lock(loudness_cache_mutex);
+	loudness_cache_path = p_path;
+	loudness_cache_loaded = false;
+	loudness_cache.clear();
+}
+
+String Shinobu::get_loudness_cache_path() const {
+	return loudness_cache_path;
+}
+
+void Shinobu::_loudness_batch_task(uint32_t p_index, LoudnessBatch *p_batch) {
+	Ref<ShinobuSoundSource> source = p_batch->sources[p_index];
+	float loudness = source->ebur128_get_loudness();
+	p_batch->results_ptr[p_index] = loudness;
+	call_deferred(SNAME("emit_signal"), SNAME("loudness_analyzed"), source, loudness);
+
+	if (p_batch->remaining.decrement() == 0) {
+		callable_mp(this, &Shinobu::_loudness_batch_finished).call_deferred(p_batch->id);
+	}
+}
+
+Shinobu::LoudnessBatch *Shinobu::_take_loudness_batch(int64_t p_batch_id) {
+	MutexLock lock(loudness_batches_mutex);
+	HashMap<int64_t, LoudnessBatch *>::Iterator E = loudness_batches.find(p_batch_id);
+	if (!E) {
+		return nullptr;
+	}
+	LoudnessBatch *batch = E->value;
+	loudness_batches.remove(E);
+	return batch;
+}
+
+void Shinobu::_loudness_batch_finished(int64_t p_batch_id) {
+	// The batch might have already been collected by wait_for_loudness_batch
+	LoudnessBatch *batch = _take_loudness_batch(p_batch_id);
+	if (!batch) {
+		return;
+	}
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(batch->group_id);
+	PackedFloat32Array results = batch->results;
+	memdelete(batch);
+
+	save_loudness_cache();
+	emit_signal(SNAME("loudness_batch_finished"), p_batch_id, results);
+}
+
+int64_t Shinobu::analyze_loudness_async(TypedArray<ShinobuSoundSource> p_sources) {
+	ERR_FAIL_COND_V(p_sources.is_empty(), -1);
+
+	LoudnessBatch *batch = memnew(LoudnessBatch);
+	for (int i = 0; i < p_sources.size(); i++) {
+		Ref<ShinobuSoundSource> source = p_sources[i];
+		ERR_CONTINUE(source.is_null());
+		batch->sources.push_back(source);
+	}
+	batch->results.resize(batch->sources.size());
+	batch->results_ptr = batch->results.ptrw();
+	batch->remaining.set(batch->sources.size());
+
+	{
+		MutexLock lock(loudness_batches_mutex);
+		batch->id = next_loudness_batch_id++;
+		loudness_batches.insert(batch->id, batch);
+	}
+
+	batch->group_id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &Shinobu::_loudness_batch_task, batch, batch->sources.size(), -1, false, SNAME("ShinobuLoudnessAnalysis"));
+	return batch->id;
+}
+
+PackedFloat32Array Shinobu::wait_for_loudness_batch(int64_t p_batch_id) {
+	LoudnessBatch *batch = _take_loudness_batch(p_batch_id);
+	ERR_FAIL_NULL_V_MSG(batch, PackedFloat32Array(), "Invalid or already finished loudness batch.");
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(batch->group_id);
+	PackedFloat32Array results = batch->results;
+	memdelete(batch);
+
+	save_loudness_cache();
+	emit_signal(SNAME("loudness_batch_finished"), p_batch_id, results);
+	return results;
+}
+
 Ref<ShinobuGroup> Shinobu::create_group(String m_group_name, Ref<ShinobuGroup> m_parent_group) {
 	Ref<ShinobuGroup> out_group = memnew(ShinobuGroup(m_group_name, m_parent_group));
 	groups.push_back(out_group);
@@ -340,18 +736,221 @@ Error Shinobu::set_dsp_time(uint64_t m_new_time_msec) {
 }
 
 String Shinobu::get_current_backend_name() const {
+	if (offline) {
+		return "Offline";
+	}
 	return ma_get_backend_name(context.backend);
 }
 
+void Shinobu::set_filtered_clock_enabled(bool m_enabled) {
+	clock->set_use_filtered_clock(m_enabled);
+}
+
+bool Shinobu::is_filtered_clock_enabled() const {
+	return clock->is_using_filtered_clock();
+}
+
+void Shinobu::set_clock_filter_bandwidth(float m_bandwidth_hz) {
+	ERR_FAIL_COND_MSG(m_bandwidth_hz <= 0.0f, "Clock filter bandwidth must be positive.");
+	clock->set_dll_bandwidth_hz(m_bandwidth_hz);
+}
+
+float Shinobu::get_clock_filter_bandwidth() const {
+	return clock->get_dll_bandwidth_hz();
+}
+
+Dictionary Shinobu::get_clock_statistics() const {
+	Dictionary out;
+	out["jitter_rms_usec"] = clock->get_jitter_rms_usec();
+	out["jitter_max_usec"] = clock->get_jitter_max_usec();
+	out["drift_ppm"] = clock->get_drift_ppm();
+	out["filtered_position_usec"] = clock->get_filtered_position_nsec() / 1000;
+	return out;
+}
+
+Dictionary Shinobu::get_performance_stats() {
+	Dictionary out;
+	const uint64_t budget_nsec = period_budget_nsec.load(std::memory_order_relaxed);
+	const uint64_t last_nsec = callback_counters.last_nsec.load(std::memory_order_relaxed);
+	out["callback_count"] = callback_counters.count.load(std::memory_order_relaxed);
+	out["callback_time_usec"] = last_nsec / 1000.0;
+	out["callback_time_avg_usec"] = callback_counters.get_average_usec();
+	out["callback_time_max_usec"] = callback_counters.max_nsec.load(std::memory_order_relaxed) / 1000.0;
+	out["period_budget_usec"] = budget_nsec / 1000.0;
+	out["load_percent"] = _get_load_percent();
+	out["underrun_count"] = underrun_count.load(std::memory_order_relaxed);
+
+	Dictionary nodes;
+	MutexLock lock(node_profilers_mutex);
+	for (const KeyValue<uint64_t, ShinobuNodeProfiler *> &E : node_profilers) {
+		nodes[_get_node_display_name(E.value->get_name(), E.key)] = E.value->get_stats();
+	}
+	out["nodes"] = nodes;
+	return out;
+}
+
+// Share of the last period's budget that was spent rendering it, in percent
+double Shinobu::_get_load_percent() const {
+	const uint64_t budget_nsec = period_budget_nsec.load(std::memory_order_relaxed);
+	const uint64_t last_nsec = callback_counters.last_nsec.load(std::memory_order_relaxed);
+	return budget_nsec > 0 ? last_nsec * 100.0 / budget_nsec : 0.0;
+}
+
+void Shinobu::set_node_profiling_enabled(bool p_enabled) {
+	ShinobuNodeProfiler::enabled.store(p_enabled, std::memory_order_relaxed);
+}
+
+bool Shinobu::is_node_profiling_enabled() const {
+	return ShinobuNodeProfiler::enabled.load(std::memory_order_relaxed);
+}
+
+void Shinobu::reset_performance_stats() {
+	callback_counters.reset();
+	underrun_count.store(0, std::memory_order_relaxed);
+	MutexLock lock(node_profilers_mutex);
+	for (const KeyValue<uint64_t, ShinobuNodeProfiler *> &E : node_profilers) {
+		E.value->counters.reset();
+	}
+}
+
+uint64_t Shinobu::register_node_profiler(ShinobuNodeProfiler *p_profiler) {
+	MutexLock lock(node_profilers_mutex);
+	uint64_t id = next_node_profiler_id++;
+	node_profilers.insert(id, p_profiler);
+	if (performance_monitors_added) {
+		String monitor_name = _get_node_monitor_name(p_profiler->get_name(), id);
+		Performance::get_singleton()->add_custom_monitor(monitor_name, callable_mp(this, &Shinobu::_get_node_performance_monitor), varray(id));
+	}
+	return id;
+}
+
+void Shinobu::unregister_node_profiler(ShinobuNodeProfiler *p_profiler) {
+	MutexLock lock(node_profilers_mutex);
+	node_profilers.erase(p_profiler->get_id());
+	if (performance_monitors_added && Performance::get_singleton()) {
+		String monitor_name = _get_node_monitor_name(p_profiler->get_name(), p_profiler->get_id());
+		if (Performance::get_singleton()->has_custom_monitor(monitor_name)) {
+			Performance::get_singleton()->remove_custom_monitor(monitor_name);
+		}
+	}
+}
+
+String Shinobu::_get_node_display_name(const String &p_name, uint64_t p_id) {
+	return vformat("%s #%d", p_name, p_id);
+}
+
+String Shinobu::_get_node_monitor_name(const String &p_name, uint64_t p_id) {
+	return "Shinobu/" + _get_node_display_name(p_name, p_id) + " (usec)";
+}
+
+static const char *SHINOBU_PERFORMANCE_MONITORS[][2] = {
+	{ "Shinobu/Callback Time (usec)", "callback_time_usec" },
+	{ "Shinobu/Callback Time Max (usec)", "callback_time_max_usec" },
+	{ "Shinobu/Period Budget (usec)", "period_budget_usec" },
+	{ "Shinobu/Load (%)", "load_percent" },
+	{ "Shinobu/Underruns", "underrun_count" },
+};
+
+void Shinobu::_add_performance_monitors() {
+	Performance *performance = Performance::get_singleton();
+	if (performance == nullptr || performance_monitors_added) {
+		return;
+	}
+
+	for (const auto &monitor : SHINOBU_PERFORMANCE_MONITORS) {
+		performance->add_custom_monitor(monitor[0], callable_mp(this, &Shinobu::_get_performance_monitor), varray(monitor[1]));
+	}
+
+	MutexLock lock(node_profilers_mutex);
+	performance_monitors_added = true;
+	for (const KeyValue<uint64_t, ShinobuNodeProfiler *> &E : node_profilers) {
+		performance->add_custom_monitor(_get_node_monitor_name(E.value->get_name(), E.key), callable_mp(this, &Shinobu::_get_node_performance_monitor), varray(E.key));
+	}
+}
+
+void Shinobu::_remove_performance_monitors() {
+	Performance *performance = Performance::get_singleton();
+	if (performance == nullptr || !performance_monitors_added) {
+		return;
+	}
+
+	for (const auto &monitor : SHINOBU_PERFORMANCE_MONITORS) {
+		performance->remove_custom_monitor(monitor[0]);
+	}
+
+	MutexLock lock(node_profilers_mutex);
+	performance_monitors_added = false;
+	for (const KeyValue<uint64_t, ShinobuNodeProfiler *> &E : node_profilers) {
+		String monitor_name = _get_node_monitor_name(E.value->get_name(), E.key);
+		if (performance->has_custom_monitor(monitor_name)) {
+			performance->remove_custom_monitor(monitor_name);
+		}
+	}
+}
+
+Variant Shinobu::_get_performance_monitor(const String &p_key) const {
+	const uint64_t budget_nsec = period_budget_nsec.load(std::memory_order_relaxed);
+	const uint64_t last_nsec = callback_counters.last_nsec.load(std::memory_order_relaxed);
+	if (p_key == "callback_time_usec") {
+		return last_nsec / 1000.0;
+	} else if (p_key == "callback_time_max_usec") {
+		return callback_counters.max_nsec.load(std::memory_order_relaxed) / 1000.0;
+	} else if (p_key == "period_budget_usec") {
+		return budget_nsec / 1000.0;
+	} else if (p_key == "load_percent") {
+		return _get_load_percent();
+	} else if (p_key == "underrun_count") {
+		return underrun_count.load(std::memory_order_relaxed);
+	}
+	return Variant();
+}
+
+Variant Shinobu::_get_node_performance_monitor(uint64_t p_profiler_id) {
+	MutexLock lock(node_profilers_mutex);
+	ShinobuNodeProfiler **profiler = node_profilers.getptr(p_profiler_id);
+	if (profiler == nullptr) {
+		return Variant();
+	}
+	return (*profiler)->counters.last_nsec.load(std::memory_order_relaxed) / 1000.0;
+}
+
 uint64_t Shinobu::get_actual_buffer_size() const {
+	if (offline) {
+		return OFFLINE_RENDER_CHUNK_FRAMES / (double)(ma_engine_get_sample_rate(&engine) / 1000.0);
+	}
 	return device.playback.internalPeriodSizeInFrames / (double)(device.playback.internalSampleRate / 1000.0);
 }
 
 Shinobu::~Shinobu() {
+	_remove_performance_monitors();
+
+	for (const KeyValue<int64_t, LoudnessBatch *> &E : loudness_batches) {
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(E.value->group_id);
+		memdelete(E.value);
+	}
+	loudness_batches.clear();
+	save_loudness_cache();
+
+	if (offline_render_thread.is_started()) {
+		offline_render_cancel.set();
+		offline_render_thread.wait_to_finish();
+	}
+
+	// Groups own node profilers that unregister themselves on destruction, drop them while the
+	// profiler map is still alive. Profilers kept alive by outside references see a null singleton.
+	groups.clear();
+	{
+		MutexLock lock(node_profilers_mutex);
+		node_profilers.clear();
+	}
+
 	if (initialized) {
 		ma_engine_uninit(&engine);
 		ma_resource_manager_uninit(&resource_manager);
-		ma_device_uninit(&device);
-		ma_context_uninit(&context);
+		if (!offline) {
+			ma_device_uninit(&device);
+			ma_context_uninit(&context);
+		}
 	}
+	singleton = nullptr;
 }
\ No newline at end of file
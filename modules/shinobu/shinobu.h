@@ -6,10 +6,17 @@
 
 #include "core/object/object.h"
 #include "core/object/ref_counted.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/templates/hash_map.h"
+#include "core/variant/typed_array.h"
 #include "core/string/ustring.h"
 #include "shinobu_clock.h"
 #include "shinobu_group.h"
+#include "shinobu_performance.h"
 #include "shinobu_sound_source.h"
+#include "shinobu_vfs.h"
 #include "miniaudio/miniaudio.h"
 
 class Shinobu : public Object {
@@ -28,6 +35,7 @@ private:
 	ma_device device;
 	ma_resource_manager resource_manager;
 	ma_context context;
+	ShinobuVFS vfs;
 	String error_message;
 	uint64_t desired_buffer_size_msec = 10;
 
@@ -37,6 +45,65 @@ private:
 
 	float master_volume = 1.0f;
 	bool initialized = false;
+	bool offline = false;
+
+	// Offline rendering drives the engine from its own thread instead of a device callback
+	static const uint32_t OFFLINE_RENDER_CHUNK_FRAMES = 1024;
+	Thread offline_render_thread;
+	SafeFlag offline_render_cancel;
+	uint64_t offline_render_length_msec = 0;
+	String offline_render_path;
+	Callable offline_render_callback;
+
+	// Loudness analysis results keyed by the source's content hash, persisted between runs
+	struct LoudnessBatch {
+		int64_t id = 0;
+		WorkerThreadPool::GroupID group_id = -1;
+		Vector<Ref<ShinobuSoundSource>> sources;
+		PackedFloat32Array results;
+		float *results_ptr = nullptr;
+		SafeNumeric<uint32_t> remaining;
+	};
+
+	HashMap<String, float> loudness_cache;
+	Mutex loudness_cache_mutex;
+	String loudness_cache_path = "user://shinobu_loudness_cache.bin";
+	bool loudness_cache_loaded = false;
+	bool loudness_cache_dirty = false;
+
+	HashMap<int64_t, LoudnessBatch *> loudness_batches;
+	Mutex loudness_batches_mutex;
+	int64_t next_loudness_batch_id = 1;
+
+	// Audio thread timing, the period budget is the real time length of the last callback.
+	// Callbacks that render for longer than their budget leave the device starved, those are
+	// counted as underruns.
+	ShinobuTimingCounters callback_counters;
+	std::atomic<uint64_t> period_budget_nsec = { 0 };
+	std::atomic<uint64_t> underrun_count = { 0 };
+	bool performance_monitors_added = false;
+
+	HashMap<uint64_t, ShinobuNodeProfiler *> node_profilers;
+	Mutex node_profilers_mutex;
+	uint64_t next_node_profiler_id = 1;
+
+	void _add_performance_monitors();
+	void _remove_performance_monitors();
+	double _get_load_percent() const;
+	Variant _get_performance_monitor(const String &p_key) const;
+	Variant _get_node_performance_monitor(uint64_t p_profiler_id);
+	static String _get_node_display_name(const String &p_name, uint64_t p_id);
+	static String _get_node_monitor_name(const String &p_name, uint64_t p_id);
+
+	void _load_loudness_cache();
+	void _loudness_batch_task(uint32_t p_index, LoudnessBatch *p_batch);
+	void _loudness_batch_finished(int64_t p_batch_id);
+	LoudnessBatch *_take_loudness_batch(int64_t p_batch_id);
+
+	Error initialize_engine(ma_engine_config &p_engine_config);
+	static void _offline_render_thread(void *p_userdata);
+	Error _render_offline();
+	void _offline_render_finished(Error p_error);
 
 protected:
 	static void _bind_methods();
@@ -48,11 +115,29 @@ public:
 
 	Ref<ShinobuClock> get_clock();
 	ma_engine *get_engine();
+	ma_vfs *get_vfs();
+	ma_decoder_config get_decoder_config() const;
 	Error initialize(ma_backend forced_backend);
 	Error godot_initialize();
+	Error initialize_offline(uint32_t p_sample_rate = 48000);
+	Error render_offline(uint64_t p_length_msec, String p_output_path, Callable p_analysis_callback = Callable());
+	void cancel_offline_render();
+	bool is_offline_rendering() const;
+	bool is_offline() const;
 	_FORCE_INLINE_ static uint64_t get_inc_sound_source_uid() { return sound_source_uid.postincrement(); };
 
 	Ref<ShinobuSoundSourceMemory> register_sound_from_memory(String m_name_hint, PackedByteArray m_data);
+	Ref<ShinobuSoundSourceFile> register_sound_from_file(String m_path);
+	uint64_t get_streaming_page_memory() const;
+	int64_t analyze_loudness_async(TypedArray<ShinobuSoundSource> p_sources);
+	PackedFloat32Array wait_for_loudness_batch(int64_t p_batch_id);
+	bool get_cached_loudness(const String &p_content_hash, float &r_loudness);
+	void store_cached_loudness(const String &p_content_hash, float p_loudness);
+	Error save_loudness_cache();
+	void clear_loudness_cache();
+	void set_loudness_cache_path(const String &p_path);
+	String get_loudness_cache_path() const;
+
 	Ref<ShinobuGroup> create_group(String m_group_name, Ref<ShinobuGroup> m_parent_group = nullptr);
 
 	Ref<ShinobuSpectrumAnalyzerEffect> instantiate_spectrum_analyzer_effect();
@@ -68,6 +153,19 @@ public:
 	uint64_t get_dsp_time() const;
 	Error set_dsp_time(uint64_t m_new_time_msec);
 
+	void set_filtered_clock_enabled(bool m_enabled);
+	bool is_filtered_clock_enabled() const;
+	void set_clock_filter_bandwidth(float m_bandwidth_hz);
+	float get_clock_filter_bandwidth() const;
+	Dictionary get_clock_statistics() const;
+
+	Dictionary get_performance_stats();
+	void reset_performance_stats();
+	void set_node_profiling_enabled(bool p_enabled);
+	bool is_node_profiling_enabled() const;
+	uint64_t register_node_profiler(ShinobuNodeProfiler *p_profiler);
+	void unregister_node_profiler(ShinobuNodeProfiler *p_profiler);
+
 	uint64_t get_actual_buffer_size() const;
 	String get_current_backend_name() const;
 
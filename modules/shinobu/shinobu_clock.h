@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cmath>
 
 #include "core/object/ref_counted.h"
 #include "core/templates/safe_refcount.h"
@@ -17,33 +18,231 @@ class ShinobuClockLocal : public RefCounted {
 class ShinobuClock : public RefCounted {
 	SafeNumeric<uint64_t> last_recorded_time;
 	SafeNumeric<uint64_t> last_mix_length_nsec;
-	bool use_mix_size_compensation = true;
+	std::atomic<bool> use_mix_size_compensation = { true };
+	std::atomic<bool> use_filtered_clock = { false };
+
+	// Delay-locked loop fitting engine time against monotonic time, based on
+	// "Using a DLL to filter time" by F. Adriaensen. Only touched by the audio thread.
+	struct DLLState {
+		bool locked = false;
+		double t0 = 0.0; // Filtered monotonic time of the last callback
+		double t1 = 0.0; // Predicted monotonic time of the next callback
+		double rate = 1.0; // Monotonic nsec per engine nsec
+		int64_t engine_time_nsec = 0; // Engine time once the last callback was mixed
+		double jitter_sq_avg = 0.0;
+		double jitter_max = 0.0;
+	} dll;
+
+	// Seqlock snapshot published by the audio thread, fields are atomics so torn reads are
+	// detected by the sequence counter rather than being undefined behaviour
+	std::atomic<uint32_t> snapshot_seq = { 0 };
+	std::atomic<int64_t> snapshot_t0 = { 0 };
+	std::atomic<double> snapshot_rate = { 1.0 };
+	std::atomic<int64_t> snapshot_engine_time_nsec = { 0 };
+	std::atomic<int64_t> snapshot_mix_length_nsec = { 0 };
+	std::atomic<double> snapshot_jitter_rms = { 0.0 };
+	std::atomic<double> snapshot_jitter_max = { 0.0 };
+
+	std::atomic<int64_t> last_position_nsec = { INT64_MIN };
+	std::atomic<double> dll_bandwidth_hz = { 1.0 };
+
+	// Errors larger than this mean the device stalled or restarted, relock instead of filtering
+	static constexpr double DLL_RELOCK_THRESHOLD_NSEC = 100'000'000.0;
+	// The worst jitter seen fades by this much every callback, a single late callback
+	// shows up in the statistics for a few seconds instead of forever
+	static constexpr double DLL_JITTER_MAX_DECAY = 0.999;
+
+	struct Snapshot {
+		uint32_t seq;
+		int64_t t0;
+		double rate;
+		int64_t engine_time_nsec;
+		int64_t mix_length_nsec;
+		double jitter_rms;
+		double jitter_max;
+	};
+
+	static int64_t get_monotonic_nsec() {
+		return std::chrono::duration_cast<nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void read_snapshot(Snapshot &r_snapshot) const {
+		uint32_t seq_end;
+		do {
+			r_snapshot.seq = snapshot_seq.load(std::memory_order_acquire);
+			r_snapshot.t0 = snapshot_t0.load(std::memory_order_relaxed);
+			r_snapshot.rate = snapshot_rate.load(std::memory_order_relaxed);
+			r_snapshot.engine_time_nsec = snapshot_engine_time_nsec.load(std::memory_order_relaxed);
+			r_snapshot.mix_length_nsec = snapshot_mix_length_nsec.load(std::memory_order_relaxed);
+			r_snapshot.jitter_rms = snapshot_jitter_rms.load(std::memory_order_relaxed);
+			r_snapshot.jitter_max = snapshot_jitter_max.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			seq_end = snapshot_seq.load(std::memory_order_relaxed);
+		} while ((r_snapshot.seq & 1) != 0 || r_snapshot.seq != seq_end);
+	}
+
+	void publish_snapshot(int64_t p_mix_length_nsec) {
+		uint32_t seq = snapshot_seq.load(std::memory_order_relaxed);
+		snapshot_seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		snapshot_t0.store(dll.t0, std::memory_order_relaxed);
+		snapshot_rate.store(dll.rate, std::memory_order_relaxed);
+		snapshot_engine_time_nsec.store(dll.engine_time_nsec, std::memory_order_relaxed);
+		snapshot_mix_length_nsec.store(p_mix_length_nsec, std::memory_order_relaxed);
+		snapshot_jitter_rms.store(std::sqrt(dll.jitter_sq_avg), std::memory_order_relaxed);
+		snapshot_jitter_max.store(dll.jitter_max, std::memory_order_relaxed);
+		snapshot_seq.store(seq + 2, std::memory_order_release);
+	}
+
+	void update_dll(int64_t p_now, uint64_t p_mix_length_nsec, int64_t p_engine_time_nsec) {
+		if (p_mix_length_nsec == 0) {
+			dll.locked = false;
+			return;
+		}
+
+		const double period = p_mix_length_nsec;
+		double error = p_now - dll.t1;
+		dll.engine_time_nsec = p_engine_time_nsec;
+
+		if (!dll.locked || std::abs(error) > DLL_RELOCK_THRESHOLD_NSEC) {
+			dll.locked = true;
+			dll.t0 = p_now;
+			dll.t1 = p_now + period * dll.rate;
+			publish_snapshot(p_mix_length_nsec);
+			return;
+		}
+
+		// Second order loop, the period is allowed to vary between callbacks so the
+		// loop tracks the rate rather than the period length itself
+		const double omega = Math_TAU * dll_bandwidth_hz.load(std::memory_order_relaxed) * (period / 1e9);
+		const double b = Math_SQRT2 * omega;
+		const double c = omega * omega;
+
+		dll.t0 = dll.t1;
+		dll.t1 += b * error + dll.rate * period;
+		dll.rate += c * error / period;
+
+		dll.jitter_sq_avg += (error * error - dll.jitter_sq_avg) * 0.01;
+		dll.jitter_max = MAX(dll.jitter_max * DLL_JITTER_MAX_DECAY, std::abs(error));
+
+		publish_snapshot(p_mix_length_nsec);
+	}
 
 public:
+	// Filtered playback position on the engine timeline, together with the engine time of
+	// the callback it was extrapolated from. Both come from the same snapshot, sequence
+	// changes whenever a new callback is published.
+	struct FilteredPosition {
+		int64_t position_nsec = 0;
+		int64_t engine_time_nsec = 0;
+		uint32_t sequence = 0;
+	};
+
 	ShinobuClock() {
 		last_recorded_time.set(0);
 		last_mix_length_nsec.set(0);
 	}
 
 	int64_t get_current_offset_nsec() {
-		std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
-		std::chrono::high_resolution_clock::time_point lrt(nanoseconds(last_recorded_time.get()));
-		auto diff = std::chrono::duration_cast<nanoseconds>(now - lrt);
-		if (use_mix_size_compensation) {
-			return diff.count() - nanoseconds(last_mix_length_nsec.get()).count();
+		if (use_filtered_clock.load(std::memory_order_relaxed)) {
+			FilteredPosition position = get_filtered_position();
+			return position.position_nsec - position.engine_time_nsec;
+		}
+		int64_t diff = get_monotonic_nsec() - int64_t(last_recorded_time.get());
+		if (use_mix_size_compensation.load(std::memory_order_relaxed)) {
+			return diff - int64_t(last_mix_length_nsec.get());
 		}
-		return diff.count();
+		return diff;
 	}
 
-	void measure(uint64_t p_mix_length_nsec) {
-		uint64_t ns_count = std::chrono::time_point_cast<nanoseconds>(std::chrono::high_resolution_clock::now()).time_since_epoch().count();
-		last_recorded_time.set(ns_count);
+	// Engine time extrapolated from the filtered line at p_now, never goes backwards
+	FilteredPosition get_filtered_position(int64_t p_now) {
+		Snapshot snapshot;
+		read_snapshot(snapshot);
+
+		FilteredPosition out;
+		out.engine_time_nsec = snapshot.engine_time_nsec;
+		out.sequence = snapshot.seq;
+
+		int64_t position = snapshot.engine_time_nsec + int64_t((p_now - snapshot.t0) / snapshot.rate);
+		if (use_mix_size_compensation.load(std::memory_order_relaxed)) {
+			position -= snapshot.mix_length_nsec;
+		}
+		int64_t last_position = last_position_nsec.load(std::memory_order_relaxed);
+		while (position > last_position) {
+			if (last_position_nsec.compare_exchange_weak(last_position, position, std::memory_order_relaxed)) {
+				last_position = position;
+				break;
+			}
+		}
+		out.position_nsec = MAX(position, last_position);
+		return out;
+	}
+
+	FilteredPosition get_filtered_position() {
+		return get_filtered_position(get_monotonic_nsec());
+	}
+
+	int64_t get_filtered_position_nsec() {
+		return get_filtered_position().position_nsec;
+	}
+
+	uint32_t get_snapshot_sequence() const {
+		return snapshot_seq.load(std::memory_order_acquire) & ~1u;
+	}
+
+	// Called by the audio thread once a period was mixed, p_engine_time_nsec is the engine
+	// time after mixing it
+	void measure_at(int64_t p_now, uint64_t p_mix_length_nsec, int64_t p_engine_time_nsec) {
+		last_recorded_time.set(p_now);
 		last_mix_length_nsec.set(p_mix_length_nsec);
+		update_dll(p_now, p_mix_length_nsec, p_engine_time_nsec);
+	}
+
+	void measure(uint64_t p_mix_length_nsec, int64_t p_engine_time_nsec) {
+		measure_at(get_monotonic_nsec(), p_mix_length_nsec, p_engine_time_nsec);
 	}
 
 	void set_use_mix_size_compensation(bool p_use_mix_size_compensation) {
 		print_line("Using mix size compensation:", p_use_mix_size_compensation);
-		use_mix_size_compensation = p_use_mix_size_compensation;
+		use_mix_size_compensation.store(p_use_mix_size_compensation, std::memory_order_relaxed);
+	}
+
+	void set_use_filtered_clock(bool p_use_filtered_clock) {
+		print_line("Using filtered clock:", p_use_filtered_clock);
+		use_filtered_clock.store(p_use_filtered_clock, std::memory_order_relaxed);
+	}
+
+	bool is_using_filtered_clock() const {
+		return use_filtered_clock.load(std::memory_order_relaxed);
+	}
+
+	void set_dll_bandwidth_hz(double p_bandwidth_hz) {
+		dll_bandwidth_hz.store(p_bandwidth_hz, std::memory_order_relaxed);
+	}
+
+	double get_dll_bandwidth_hz() const {
+		return dll_bandwidth_hz.load(std::memory_order_relaxed);
+	}
+
+	// RMS and worst case difference between the measured and predicted callback times
+	double get_jitter_rms_usec() const {
+		Snapshot snapshot;
+		read_snapshot(snapshot);
+		return snapshot.jitter_rms / 1000.0;
+	}
+
+	double get_jitter_max_usec() const {
+		Snapshot snapshot;
+		read_snapshot(snapshot);
+		return snapshot.jitter_max / 1000.0;
+	}
+
+	// How much faster (positive) or slower the device clock runs compared to the monotonic clock
+	double get_drift_ppm() const {
+		Snapshot snapshot;
+		read_snapshot(snapshot);
+		return (1.0 / snapshot.rate - 1.0) * 1e6;
 	}
 };
-#endif
\ No newline at end of file
+#endif
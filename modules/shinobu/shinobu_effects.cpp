@@ -3,6 +3,7 @@
 #include "shinobu_channel_remap.h"
 #include "shinobu_group.h"
 #include "shinobu_macros.h"
+#include "shinobu_performance.h"
 #include "shinobu_pitch_shift.h"
 #include "shinobu_spectrum_analyzer.h"
 
@@ -30,11 +31,25 @@ Error ShinobuEffect::connect_to_node(ma_node *m_node) {
 	return OK;
 }
 
+void ShinobuEffect::start_profiling() {
+	ERR_FAIL_COND(profiler != nullptr);
+	profiler = memnew(ShinobuNodeProfiler(get_node(), get_class()));
+}
+
+ShinobuEffect::~ShinobuEffect() {
+	if (profiler != nullptr) {
+		memdelete(profiler);
+	}
+}
+
 ShinobuChannelRemapEffect::ShinobuChannelRemapEffect(uint32_t in_channel_count, uint32_t out_channel_count) {
 	ma_engine *engine = Shinobu::get_singleton()->get_engine();
 	ma_channel_remap_node_config mapNodeConfig = ma_channel_remap_node_config_init(ma_engine_get_sample_rate(engine), in_channel_count, out_channel_count);
 	ma_result result = ma_channel_remap_node_init(ma_engine_get_node_graph(engine), &mapNodeConfig, NULL, &remap_node);
 	MA_ERR(result, "Error creating channel remap effect");
+	if (result == MA_SUCCESS) {
+		start_profiling();
+	}
 }
 
 void ShinobuChannelRemapEffect::_bind_methods() {
@@ -76,6 +91,9 @@ ShinobuPitchShiftEffect::ShinobuPitchShiftEffect(uint32_t channel_count) {
 	ma_pitch_shift_node_config pitch_shift_config = ma_pitch_shift_node_config_init(ma_engine_get_sample_rate(engine));
 	ma_result result = ma_pitch_shift_node_init(ma_engine_get_node_graph(engine), &pitch_shift_config, NULL, &pitch_shift_node);
 	MA_ERR(result, "Error creating pitch shift effect");
+	if (result == MA_SUCCESS) {
+		start_profiling();
+	}
 }
 
 ShinobuPitchShiftEffect::~ShinobuPitchShiftEffect() {
@@ -87,9 +105,20 @@ ShinobuSpectrumAnalyzerEffect::ShinobuSpectrumAnalyzerEffect(uint32_t m_channel_
 	ma_spectrum_analyzer_config spectrum_config = ma_spectrum_analyzer_config_init(ma_engine_get_sample_rate(engine));
 	ma_result result = ma_spectrum_analyzer_node_init(ma_engine_get_node_graph(engine), &spectrum_config, NULL, &analyzer_node);
 	MA_ERR(result, "Error creating spectrum analyzer effect");
+	if (result == MA_SUCCESS) {
+		start_profiling();
+	}
 }
 void ShinobuSpectrumAnalyzerEffect::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_magnitude_for_frequency_range", "begin", "end", "mode"), &ShinobuSpectrumAnalyzerEffect::get_magnitude_for_frequency_range, DEFVAL(MAGNITUDE_MAX));
+	ClassDB::bind_method(D_METHOD("get_band_magnitudes", "band_count", "min_frequency", "max_frequency", "mode"), &ShinobuSpectrumAnalyzerEffect::get_band_magnitudes, DEFVAL(20.0f), DEFVAL(20000.0f), DEFVAL(MAGNITUDE_MAX));
+	ClassDB::bind_method(D_METHOD("get_band_peaks"), &ShinobuSpectrumAnalyzerEffect::get_band_peaks);
+	ClassDB::bind_method(D_METHOD("set_band_release_time", "release_time"), &ShinobuSpectrumAnalyzerEffect::set_band_release_time);
+	ClassDB::bind_method(D_METHOD("get_band_release_time"), &ShinobuSpectrumAnalyzerEffect::get_band_release_time);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "band_release_time"), "set_band_release_time", "get_band_release_time");
+	ClassDB::bind_method(D_METHOD("set_peak_hold_time", "peak_hold_time"), &ShinobuSpectrumAnalyzerEffect::set_peak_hold_time);
+	ClassDB::bind_method(D_METHOD("get_peak_hold_time"), &ShinobuSpectrumAnalyzerEffect::get_peak_hold_time);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "peak_hold_time"), "set_peak_hold_time", "get_peak_hold_time");
 	BIND_ENUM_CONSTANT(MAGNITUDE_AVERAGE);
 	BIND_ENUM_CONSTANT(MAGNITUDE_MAX);
 }
@@ -102,6 +131,104 @@ Vector2 ShinobuSpectrumAnalyzerEffect::get_magnitude_for_frequency_range(float m
 	return Vector2(res.l, res.r);
 }
 
+void ShinobuSpectrumAnalyzerEffect::_update_band_layout(int p_band_count, float p_min_frequency, float p_max_frequency) {
+	if (band_layout.band_count == p_band_count && band_layout.min_frequency == p_min_frequency && band_layout.max_frequency == p_max_frequency) {
+		return;
+	}
+
+	band_layout.band_count = p_band_count;
+	band_layout.min_frequency = p_min_frequency;
+	band_layout.max_frequency = p_max_frequency;
+	band_layout.edges.resize(p_band_count + 1);
+
+	// Log spaced edges, every band covers at least one bin
+	int *edges = band_layout.edges.ptrw();
+	const float ratio = p_max_frequency / p_min_frequency;
+	for (int i = 0; i <= p_band_count; i++) {
+		float frequency = p_min_frequency * Math::pow(ratio, i / (float)p_band_count);
+		edges[i] = ma_spectrum_analyzer_frequency_to_bin(&analyzer_node, frequency);
+		if (i > 0) {
+			edges[i] = MAX(edges[i], edges[i - 1] + 1);
+		}
+	}
+
+	band_values.resize(p_band_count);
+	band_values.fill(0.0f);
+	band_peaks.resize(p_band_count);
+	band_peaks.fill(0.0f);
+	band_peak_age.resize(p_band_count);
+	band_peak_age.fill(0.0);
+}
+
+PackedFloat32Array ShinobuSpectrumAnalyzerEffect::get_band_magnitudes(int p_band_count, float p_min_frequency, float p_max_frequency, ma_spectrum_magnitude_mode p_mode) {
+	ERR_FAIL_COND_V(p_band_count <= 0, PackedFloat32Array());
+	ERR_FAIL_COND_V(p_min_frequency <= 0.0f || p_max_frequency <= p_min_frequency, PackedFloat32Array());
+
+	_update_band_layout(p_band_count, p_min_frequency, p_max_frequency);
+
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	double delta = last_band_query_usec == 0 ? 0.0 : (now - last_band_query_usec) / 1000000.0;
+	last_band_query_usec = now;
+
+	const float *spectrum = ma_spectrum_analyzer_acquire_spectrum(&analyzer_node);
+	if (spectrum == nullptr) {
+		return band_values;
+	}
+
+	const int fft_size = analyzer_node.fftSize;
+	const float release = band_release_time > 0.0f ? 1.0f - Math::exp(-delta / band_release_time) : 1.0f;
+	const int *edges = band_layout.edges.ptr();
+	float *values = band_values.ptrw();
+	float *peaks = band_peaks.ptrw();
+	double *peak_age = band_peak_age.ptrw();
+
+	for (int i = 0; i < p_band_count; i++) {
+		int begin_bin = MIN(edges[i], fft_size - 1);
+		int end_bin = MIN(edges[i + 1] - 1, fft_size - 1);
+		MagnitudeResult magnitude = ma_spectrum_analyzer_get_magnitude_for_bin_range(spectrum, fft_size, begin_bin, end_bin, p_mode);
+		float value = p_mode == MAGNITUDE_AVERAGE ? (magnitude.l + magnitude.r) * 0.5f : MAX(magnitude.l, magnitude.r);
+
+		// Rises are immediate, falls are smoothed by the release time
+		if (value >= values[i]) {
+			values[i] = value;
+		} else {
+			values[i] += (value - values[i]) * release;
+		}
+
+		if (values[i] >= peaks[i]) {
+			peaks[i] = values[i];
+			peak_age[i] = 0.0;
+		} else {
+			peak_age[i] += delta;
+			if (peak_age[i] > peak_hold_time) {
+				peaks[i] += (values[i] - peaks[i]) * release;
+			}
+		}
+	}
+
+	return band_values;
+}
+
+PackedFloat32Array ShinobuSpectrumAnalyzerEffect::get_band_peaks() const {
+	return band_peaks;
+}
+
+void ShinobuSpectrumAnalyzerEffect::set_band_release_time(float p_release_time) {
+	band_release_time = MAX(p_release_time, 0.0f);
+}
+
+float ShinobuSpectrumAnalyzerEffect::get_band_release_time() const {
+	return band_release_time;
+}
+
+void ShinobuSpectrumAnalyzerEffect::set_peak_hold_time(float p_peak_hold_time) {
+	peak_hold_time = MAX(p_peak_hold_time, 0.0f);
+}
+
+float ShinobuSpectrumAnalyzerEffect::get_peak_hold_time() const {
+	return peak_hold_time;
+}
+
 ShinobuSpectrumAnalyzerEffect::~ShinobuSpectrumAnalyzerEffect() {
 	ma_spectrum_analyzer_node_uninit(&analyzer_node, NULL);
 }
\ No newline at end of file
@@ -10,13 +10,17 @@
 #include <memory>
 
 class ShinobuGroup;
+class ShinobuNodeProfiler;
 
 class ShinobuEffect : public RefCounted {
 	GDCLASS(ShinobuEffect, RefCounted);
+	ShinobuNodeProfiler *profiler = nullptr;
 
 protected:
 	String error_message = "";
 	Error connect_to_node(ma_node *m_node);
+	// Called by subclasses once their node is initialized, the node has to be uninitialized before this class is destroyed
+	void start_profiling();
 	static void _bind_methods();
 
 public:
@@ -24,6 +28,8 @@ public:
 	Error connect_to_effect(Ref<ShinobuEffect> m_effect);
 	Error connect_to_group(Ref<ShinobuGroup> m_group);
 	Error connect_to_endpoint();
+
+	~ShinobuEffect();
 };
 
 class ShinobuChannelRemapEffect : public ShinobuEffect {
@@ -62,6 +68,23 @@ class ShinobuSpectrumAnalyzerEffect : public ShinobuEffect {
 	GDCLASS(ShinobuSpectrumAnalyzerEffect, ShinobuEffect);
 	ma_spectrum_analyzer_node analyzer_node;
 
+	// Band query state, only ever touched from the thread doing the queries
+	struct BandLayout {
+		int band_count = 0;
+		float min_frequency = 0.0f;
+		float max_frequency = 0.0f;
+		Vector<int> edges; // band_count + 1 bin indices
+	} band_layout;
+
+	PackedFloat32Array band_values;
+	PackedFloat32Array band_peaks;
+	Vector<double> band_peak_age;
+	uint64_t last_band_query_usec = 0;
+	float band_release_time = 0.0f;
+	float peak_hold_time = 0.0f;
+
+	void _update_band_layout(int p_band_count, float p_min_frequency, float p_max_frequency);
+
 protected:
 	static void _bind_methods();
 
@@ -70,6 +93,13 @@ public:
 	~ShinobuSpectrumAnalyzerEffect();
 
 	Vector2 get_magnitude_for_frequency_range(float pBegin, float pEnd, ma_spectrum_magnitude_mode mode = MAGNITUDE_MAX);
+	PackedFloat32Array get_band_magnitudes(int p_band_count, float p_min_frequency = 20.0f, float p_max_frequency = 20000.0f, ma_spectrum_magnitude_mode p_mode = MAGNITUDE_MAX);
+	PackedFloat32Array get_band_peaks() const;
+
+	void set_band_release_time(float p_release_time);
+	float get_band_release_time() const;
+	void set_peak_hold_time(float p_peak_hold_time);
+	float get_peak_hold_time() const;
 
 	virtual ma_node *get_node() override;
 };
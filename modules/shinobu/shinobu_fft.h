@@ -1,6 +1,19 @@
 #ifndef SHINOBU_FFT
 #define SHINOBU_FFT
 
+#include "miniaudio/miniaudio.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SHINOBU_FFT_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define SHINOBU_FFT_NEON
+#include <arm_neon.h>
+#endif
+
 /* Thirdparty code, so disable clang-format with Godot style */
 /* clang-format off */
 static void smbFft(float *fftBuffer, long fftFrameSize, long sign)
@@ -60,4 +73,175 @@ static void smbFft(float *fftBuffer, long fftFrameSize, long sign)
 }
 /* clang-format on */
 
-#endif
\ No newline at end of file
+/*
+	Precomputed radix-2 FFT, same interleaved layout and sign convention as smbFft but
+	the bit reversal permutation and twiddle factors are computed once at init time
+	instead of on every transform.
+
+	Twiddles are stored per butterfly stage so every stage reads them contiguously, the
+	stage with half length h starts at complex index h - 1. Each twiddle is duplicated
+	as {wr, wr} and {-wi, wi} so two butterflies can be done per SIMD register without
+	any shuffling of the table.
+*/
+typedef struct {
+	int size; // Number of complex points, must be a power of 2
+	int *bitReverse;
+	float *twiddlesRe; // {wr, wr} per stage twiddle, (size - 1) * 2 floats
+	float *twiddlesIm; // {-wi, wi} per stage twiddle for the forward transform, (size - 1) * 2 floats
+} ma_fft_plan;
+
+static ma_result ma_fft_plan_init(ma_fft_plan *pPlan, int size, const ma_allocation_callbacks *pAllocationCallbacks) {
+	memset(pPlan, 0, sizeof(*pPlan));
+	if (size < 2 || (size & (size - 1)) != 0) {
+		return MA_INVALID_ARGS;
+	}
+
+	pPlan->size = size;
+	pPlan->bitReverse = (int *)ma_malloc(sizeof(int) * size, pAllocationCallbacks);
+	pPlan->twiddlesRe = (float *)ma_malloc(sizeof(float) * (size - 1) * 2, pAllocationCallbacks);
+	pPlan->twiddlesIm = (float *)ma_malloc(sizeof(float) * (size - 1) * 2, pAllocationCallbacks);
+	if (pPlan->bitReverse == NULL || pPlan->twiddlesRe == NULL || pPlan->twiddlesIm == NULL) {
+		ma_free(pPlan->bitReverse, pAllocationCallbacks);
+		ma_free(pPlan->twiddlesRe, pAllocationCallbacks);
+		ma_free(pPlan->twiddlesIm, pAllocationCallbacks);
+		memset(pPlan, 0, sizeof(*pPlan));
+		return MA_OUT_OF_MEMORY;
+	}
+
+	int bits = 0;
+	while ((1 << bits) < size) {
+		bits++;
+	}
+
+	for (int i = 0; i < size; i++) {
+		int reversed = 0;
+		for (int b = 0; b < bits; b++) {
+			reversed |= ((i >> b) & 1) << (bits - 1 - b);
+		}
+		pPlan->bitReverse[i] = reversed;
+	}
+
+	for (int half = 1; half < size; half <<= 1) {
+		float *pRe = pPlan->twiddlesRe + (half - 1) * 2;
+		float *pIm = pPlan->twiddlesIm + (half - 1) * 2;
+		for (int k = 0; k < half; k++) {
+			double arg = Math_PI * (double)k / (double)half;
+			float wr = cos(arg);
+			float wi = -sin(arg);
+			pRe[k * 2] = wr;
+			pRe[k * 2 + 1] = wr;
+			pIm[k * 2] = -wi;
+			pIm[k * 2 + 1] = wi;
+		}
+	}
+
+	return MA_SUCCESS;
+}
+
+static void ma_fft_plan_uninit(ma_fft_plan *pPlan, const ma_allocation_callbacks *pAllocationCallbacks) {
+	ma_free(pPlan->bitReverse, pAllocationCallbacks);
+	ma_free(pPlan->twiddlesRe, pAllocationCallbacks);
+	ma_free(pPlan->twiddlesIm, pAllocationCallbacks);
+	memset(pPlan, 0, sizeof(*pPlan));
+}
+
+// Sign = -1 is FFT, 1 is iFFT (inverse, unscaled), pBuffer holds pPlan->size interleaved complex values
+static void ma_fft_plan_execute(const ma_fft_plan *pPlan, float *pBuffer, int sign) {
+	const int size = pPlan->size;
+
+	for (int i = 0; i < size; i++) {
+		int j = pPlan->bitReverse[i];
+		if (i < j) {
+			float tr = pBuffer[i * 2];
+			float ti = pBuffer[i * 2 + 1];
+			pBuffer[i * 2] = pBuffer[j * 2];
+			pBuffer[i * 2 + 1] = pBuffer[j * 2 + 1];
+			pBuffer[j * 2] = tr;
+			pBuffer[j * 2 + 1] = ti;
+		}
+	}
+
+	// First stage only has the trivial twiddle
+	for (int start = 0; start < size * 2; start += 4) {
+		const float tr = pBuffer[start + 2];
+		const float ti = pBuffer[start + 3];
+		pBuffer[start + 2] = pBuffer[start] - tr;
+		pBuffer[start + 3] = pBuffer[start + 1] - ti;
+		pBuffer[start] += tr;
+		pBuffer[start + 1] += ti;
+	}
+
+	// The inverse transform uses the conjugate twiddles, so the imaginary table flips sign
+	const float imSign = sign > 0 ? -1.0f : 1.0f;
+
+	for (int half = 2; half < size; half <<= 1) {
+		const float *pRe = pPlan->twiddlesRe + (half - 1) * 2;
+		const float *pIm = pPlan->twiddlesIm + (half - 1) * 2;
+		for (int start = 0; start < size; start += half * 2) {
+			float *p1 = pBuffer + start * 2;
+			float *p2 = p1 + half * 2;
+			int k = 0;
+#if defined(SHINOBU_FFT_SSE)
+			const __m128 vImSign = _mm_set1_ps(imSign);
+			for (; k < half; k += 2) {
+				__m128 a = _mm_loadu_ps(p1 + k * 2);
+				__m128 b = _mm_loadu_ps(p2 + k * 2);
+				__m128 wr = _mm_loadu_ps(pRe + k * 2);
+				__m128 wi = _mm_mul_ps(_mm_loadu_ps(pIm + k * 2), vImSign);
+				__m128 bSwapped = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+				__m128 t = _mm_add_ps(_mm_mul_ps(b, wr), _mm_mul_ps(bSwapped, wi));
+				_mm_storeu_ps(p2 + k * 2, _mm_sub_ps(a, t));
+				_mm_storeu_ps(p1 + k * 2, _mm_add_ps(a, t));
+			}
+#elif defined(SHINOBU_FFT_NEON)
+			const float32x4_t vImSign = vdupq_n_f32(imSign);
+			for (; k < half; k += 2) {
+				float32x4_t a = vld1q_f32(p1 + k * 2);
+				float32x4_t b = vld1q_f32(p2 + k * 2);
+				float32x4_t wr = vld1q_f32(pRe + k * 2);
+				float32x4_t wi = vmulq_f32(vld1q_f32(pIm + k * 2), vImSign);
+				float32x4_t t = vmlaq_f32(vmulq_f32(b, wr), vrev64q_f32(b), wi);
+				vst1q_f32(p2 + k * 2, vsubq_f32(a, t));
+				vst1q_f32(p1 + k * 2, vaddq_f32(a, t));
+			}
+#endif
+			for (; k < half; k++) {
+				const float wr = pRe[k * 2];
+				const float wi = pIm[k * 2 + 1] * imSign;
+				const float tr = p2[k * 2] * wr - p2[k * 2 + 1] * wi;
+				const float ti = p2[k * 2] * wi + p2[k * 2 + 1] * wr;
+				p2[k * 2] = p1[k * 2] - tr;
+				p2[k * 2 + 1] = p1[k * 2 + 1] - ti;
+				p1[k * 2] += tr;
+				p1[k * 2 + 1] += ti;
+			}
+		}
+	}
+}
+
+// pOut[i] = sqrt(pRe[i]^2 + pIm[i]^2) * scale
+static void ma_fft_magnitudes(const float *pRe, const float *pIm, float *pOut, int count, float scale) {
+	int i = 0;
+#if defined(SHINOBU_FFT_SSE)
+	const __m128 vScale = _mm_set1_ps(scale);
+	for (; i + 4 <= count; i += 4) {
+		__m128 re = _mm_loadu_ps(pRe + i);
+		__m128 im = _mm_loadu_ps(pIm + i);
+		__m128 sq = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+		_mm_storeu_ps(pOut + i, _mm_mul_ps(_mm_sqrt_ps(sq), vScale));
+	}
+#elif defined(SHINOBU_FFT_NEON)
+	const float32x4_t vScale = vdupq_n_f32(scale);
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t re = vld1q_f32(pRe + i);
+		float32x4_t im = vld1q_f32(pIm + i);
+		float32x4_t sq = vmlaq_f32(vmulq_f32(re, re), im, im);
+		vst1q_f32(pOut + i, vmulq_f32(vsqrtq_f32(sq), vScale));
+	}
+#endif
+	for (; i < count; i++) {
+		pOut[i] = sqrtf(pRe[i] * pRe[i] + pIm[i] * pIm[i]) * scale;
+	}
+}
+
+#endif
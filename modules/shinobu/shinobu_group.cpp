@@ -2,6 +2,7 @@
 #include "shinobu.h"
 #include "shinobu_effects.h"
 #include "shinobu_macros.h"
+#include "shinobu_performance.h"
 
 void ShinobuGroup::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("connect_to_effect", "effect"), &ShinobuGroup::connect_to_effect);
@@ -35,17 +36,29 @@ Error ShinobuGroup::connect_to_effect(Ref<ShinobuEffect> m_effect) {
 }
 
 ShinobuGroup::ShinobuGroup(String m_group_name, Ref<ShinobuGroup> m_parent_group) {
+	name = m_group_name;
 	ma_engine *engine = Shinobu::get_singleton()->get_engine();
 
-	ma_sound_group *parent_group = nullptr;
-
+	ma_node *output_node = ma_engine_get_endpoint(engine);
 	if (!m_parent_group.is_null() && m_parent_group.is_valid()) {
-		parent_group = m_parent_group->get_group();
+		output_node = m_parent_group->get_group();
 	}
 
-	MA_ERR(ma_sound_group_init(engine, 0, parent_group, &group), "Error creating group");
+	// The profiler swaps the node's vtable, which the audio thread reads as soon as the group is
+	// attached, so the group is only connected once the profiler is in place
+	ma_result result = ma_sound_group_init(engine, MA_SOUND_FLAG_NO_DEFAULT_ATTACHMENT, nullptr, &group);
+	MA_ERR(result, "Error creating group");
+	if (result != MA_SUCCESS) {
+		return;
+	}
+	profiler = memnew(ShinobuNodeProfiler(&group, "ShinobuGroup " + name));
+	result = ma_node_attach_output_bus(&group, 0, output_node, 0);
+	MA_ERR(result, "Error connecting group to its parent");
 }
 
 ShinobuGroup::~ShinobuGroup() {
 	ma_sound_group_uninit(&group);
+	if (profiler != nullptr) {
+		memdelete(profiler);
+	}
 }
\ No newline at end of file
@@ -7,12 +7,14 @@
 #include <memory>
 
 class ShinobuEffect;
+class ShinobuNodeProfiler;
 
 class ShinobuGroup : public RefCounted {
 	GDCLASS(ShinobuGroup, RefCounted);
 	String name;
 	String error_message;
 	ma_sound_group group;
+	ShinobuNodeProfiler *profiler = nullptr;
 
 protected:
 	static void _bind_methods();
@@ -0,0 +1,45 @@
+#include "shinobu_performance.h"
+#include "shinobu.h"
+
+std::atomic<bool> ShinobuNodeProfiler::enabled = { false };
+
+void ShinobuNodeProfiler::_process_pcm_frames(ma_node *pNode, const float **ppFramesIn, ma_uint32 *pFrameCountIn, float **ppFramesOut, ma_uint32 *pFrameCountOut) {
+	const ShinobuProfiledVTable *profiled_vtable = (const ShinobuProfiledVTable *)((ma_node_base *)pNode)->vtable;
+	if (!enabled.load(std::memory_order_relaxed)) {
+		profiled_vtable->original->onProcess(pNode, ppFramesIn, pFrameCountIn, ppFramesOut, pFrameCountOut);
+		return;
+	}
+	uint64_t start = shinobu_get_monotonic_nsec();
+	profiled_vtable->original->onProcess(pNode, ppFramesIn, pFrameCountIn, ppFramesOut, pFrameCountOut);
+	profiled_vtable->profiler->counters.record(shinobu_get_monotonic_nsec() - start);
+}
+
+Dictionary ShinobuNodeProfiler::get_stats() const {
+	Dictionary out;
+	out["process_count"] = counters.count.load(std::memory_order_relaxed);
+	out["process_time_usec"] = counters.last_nsec.load(std::memory_order_relaxed) / 1000.0;
+	out["process_time_avg_usec"] = counters.get_average_usec();
+	out["process_time_max_usec"] = counters.max_nsec.load(std::memory_order_relaxed) / 1000.0;
+	return out;
+}
+
+ShinobuNodeProfiler::ShinobuNodeProfiler(ma_node *p_node, const String &p_name) {
+	name = p_name;
+	ma_node_base *node_base = (ma_node_base *)p_node;
+
+	profiled_vtable.original = node_base->vtable;
+	profiled_vtable.profiler = this;
+	profiled_vtable.vtable = *node_base->vtable;
+	if (profiled_vtable.original->onProcess != nullptr) {
+		profiled_vtable.vtable.onProcess = _process_pcm_frames;
+	}
+	node_base->vtable = &profiled_vtable.vtable;
+
+	id = Shinobu::get_singleton()->register_node_profiler(this);
+}
+
+ShinobuNodeProfiler::~ShinobuNodeProfiler() {
+	if (Shinobu::get_singleton() != nullptr) {
+		Shinobu::get_singleton()->unregister_node_profiler(this);
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef SHINOBU_PERFORMANCE_H
+#define SHINOBU_PERFORMANCE_H
+
+#include <atomic>
+#include <chrono>
+
+#include "core/string/ustring.h"
+#include "core/variant/dictionary.h"
+#include "miniaudio/miniaudio.h"
+
+static inline uint64_t shinobu_get_monotonic_nsec() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Timing statistics written by the audio thread and read from anywhere without locking.
+// There is only ever one writer, so the maximum doesn't need a compare and swap loop.
+struct ShinobuTimingCounters {
+	std::atomic<uint64_t> count = { 0 };
+	std::atomic<uint64_t> total_nsec = { 0 };
+	std::atomic<uint64_t> last_nsec = { 0 };
+	std::atomic<uint64_t> max_nsec = { 0 };
+
+	void record(uint64_t p_nsec) {
+		count.fetch_add(1, std::memory_order_relaxed);
+		total_nsec.fetch_add(p_nsec, std::memory_order_relaxed);
+		last_nsec.store(p_nsec, std::memory_order_relaxed);
+		if (p_nsec > max_nsec.load(std::memory_order_relaxed)) {
+			max_nsec.store(p_nsec, std::memory_order_relaxed);
+		}
+	}
+
+	double get_average_usec() const {
+		uint64_t c = count.load(std::memory_order_relaxed);
+		return c > 0 ? total_nsec.load(std::memory_order_relaxed) / (double)c / 1000.0 : 0.0;
+	}
+
+	void reset() {
+		count.store(0, std::memory_order_relaxed);
+		total_nsec.store(0, std::memory_order_relaxed);
+		last_nsec.store(0, std::memory_order_relaxed);
+		max_nsec.store(0, std::memory_order_relaxed);
+	}
+};
+
+class ShinobuNodeProfiler;
+
+// Copy of a node's vtable with the process callback swapped for a timing shim. miniaudio hands the
+// vtable pointer back through the node, which is how the shim finds its profiler without a lookup.
+struct ShinobuProfiledVTable {
+	ma_node_vtable vtable;
+	const ma_node_vtable *original;
+	ShinobuNodeProfiler *profiler;
+};
+
+// Times the node's own processing, inputs are pulled by miniaudio before the callback runs so
+// upstream nodes are not included
+class ShinobuNodeProfiler {
+	ShinobuProfiledVTable profiled_vtable;
+	uint64_t id = 0;
+	String name;
+
+	static void _process_pcm_frames(ma_node *pNode, const float **ppFramesIn, ma_uint32 *pFrameCountIn, float **ppFramesOut, ma_uint32 *pFrameCountOut);
+
+public:
+	// Off by default, the shim then only forwards to the original callback without reading the clock
+	static std::atomic<bool> enabled;
+
+	ShinobuTimingCounters counters;
+
+	uint64_t get_id() const { return id; }
+	String get_name() const { return name; }
+	Dictionary get_stats() const;
+
+	// Must be called before the node is attached to anything, and the profiler must outlive the node
+	ShinobuNodeProfiler(ma_node *p_node, const String &p_name);
+	~ShinobuNodeProfiler();
+};
+
+#endif // SHINOBU_PERFORMANCE_H
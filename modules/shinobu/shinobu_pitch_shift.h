@@ -1,5 +1,7 @@
 #ifndef SHINOBU_PITCH_SHIFT_H
 #define SHINOBU_PITCH_SHIFT_H
+#include <stdint.h>
+
 #include "miniaudio/miniaudio.h"
 
 #define SPS_PI 3.14159265358979323846
@@ -8,10 +10,6 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-enum {
-	SMB_PS_MAX_FRAME_LENGTH = 8192
-};
-
 typedef enum {
 	FFT_SIZE_256,
 	FFT_SIZE_512,
@@ -21,19 +19,18 @@ typedef enum {
 	FFT_SIZE_MAX
 } ma_sps_fft_size;
 
+// Per channel STFT state, every buffer points into the node's pooled block and is sized
+// from the configured FFT size and oversampling
 typedef struct {
-	float gInFIFO[SMB_PS_MAX_FRAME_LENGTH];
-	float gOutFIFO[SMB_PS_MAX_FRAME_LENGTH];
-	float gFFTworksp[2 * SMB_PS_MAX_FRAME_LENGTH];
-	float gLastPhase[SMB_PS_MAX_FRAME_LENGTH / 2 + 1];
-	float gSumPhase[SMB_PS_MAX_FRAME_LENGTH / 2 + 1];
-	float gOutputAccum[2 * SMB_PS_MAX_FRAME_LENGTH];
-	float gAnaFreq[SMB_PS_MAX_FRAME_LENGTH];
-	float gAnaMagn[SMB_PS_MAX_FRAME_LENGTH];
-	float gSynFreq[SMB_PS_MAX_FRAME_LENGTH];
-	float gSynMagn[SMB_PS_MAX_FRAME_LENGTH];
-	int32_t gRover;
-	float lastPitchShift;
+	float *gInFIFO; // fftFrameSize
+	float *gOutFIFO; // stepSize
+	float *gOutputAccum; // fftFrameSize + stepSize
+	float *gLastPhase; // fftFrameSize / 2 + 1
+	float *gSumPhase; // fftFrameSize / 2 + 1
+	float *gAnaFreq; // fftFrameSize / 2 + 1
+	float *gAnaMagn; // fftFrameSize / 2 + 1
+	float *gSynFreq; // fftFrameSize / 2 + 1
+	float *gSynMagn; // fftFrameSize / 2 + 1
 } SMBPitchShift;
 
 typedef struct {
@@ -51,6 +48,12 @@ typedef struct {
 	SMBPitchShift shiftL;
 	SMBPitchShift shiftR;
 	float sampleRate;
+	int32_t rover; // Shared by both channels since they are fed in lockstep
+	float *window; // Hann window, fftFrameSize
+	float *fftWorksp; // Both channels packed as L + iR, fftFrameSize complex values
+	void *fftPlan;
+	void *pBlock; // Pooled allocation backing every buffer above
+	size_t blockSizeInBytes;
 } ma_pitch_shift_node;
 
 MA_API ma_result ma_pitch_shift_node_init(ma_node_graph *pNodeGraph, const ma_pitch_shift_node_config *pConfig, const ma_allocation_callbacks *pAllocationCallbacks, ma_pitch_shift_node *node);
@@ -58,6 +61,8 @@ MA_API ma_pitch_shift_node_config ma_pitch_shift_node_config_init(ma_uint32 samp
 MA_API void ma_pitch_shift_node_set_pitch_scale(ma_pitch_shift_node *node, float pitchScale);
 MA_API float ma_pitch_shift_node_get_pitch_scale(ma_pitch_shift_node *node);
 MA_API void ma_pitch_shift_node_uninit(ma_pitch_shift_node *pPitchShiftNode, const ma_allocation_callbacks *pAllocationCallbacks);
+// Bytes of buffer memory a node with the given configuration uses, excluding the FFT plan
+MA_API size_t ma_pitch_shift_node_get_block_size(int fftFrameSize, int oversampling);
 #ifdef __cplusplus
 }
 #endif
@@ -67,17 +72,112 @@ MA_API void ma_pitch_shift_node_uninit(ma_pitch_shift_node *pPitchShiftNode, con
 
 #include "shinobu_fft.h"
 
-static void ma_smb_pitch_shift_init(SMBPitchShift *pitch_shift) {
-	pitch_shift->gRover = 0;
-	memset(pitch_shift->gInFIFO, 0, SMB_PS_MAX_FRAME_LENGTH * sizeof(float));
-	memset(pitch_shift->gOutFIFO, 0, SMB_PS_MAX_FRAME_LENGTH * sizeof(float));
-	memset(pitch_shift->gFFTworksp, 0, 2 * SMB_PS_MAX_FRAME_LENGTH * sizeof(double));
-	memset(pitch_shift->gLastPhase, 0, (SMB_PS_MAX_FRAME_LENGTH / 2 + 1) * sizeof(double));
-	memset(pitch_shift->gSumPhase, 0, (SMB_PS_MAX_FRAME_LENGTH / 2 + 1) * sizeof(double));
-	memset(pitch_shift->gOutputAccum, 0, 2 * SMB_PS_MAX_FRAME_LENGTH * sizeof(double));
-	memset(pitch_shift->gAnaFreq, 0, SMB_PS_MAX_FRAME_LENGTH * sizeof(double));
-	memset(pitch_shift->gAnaMagn, 0, SMB_PS_MAX_FRAME_LENGTH * sizeof(double));
-	pitch_shift->lastPitchShift = 1.0;
+/*
+	Buffer pool shared by every pitch shift node. Practice mode recreates the effect whenever
+	the speed changes, so freed blocks are kept and handed to the next node asking for the same
+	size instead of going through the allocator again. Pooled blocks always use the default
+	allocator since they can outlive the callbacks of the node that released them.
+*/
+#define MA_PITCH_SHIFT_POOL_MAX_BLOCKS 4
+
+// Keeps the float buffers following the header 64 byte aligned
+#define MA_PITCH_SHIFT_POOL_HEADER_SIZE 64
+
+typedef struct ma_pitch_shift_pool_block {
+	struct ma_pitch_shift_pool_block *pNext;
+	size_t sizeInBytes;
+} ma_pitch_shift_pool_block;
+
+static ma_spinlock g_ma_pitch_shift_pool_lock = 0;
+static ma_pitch_shift_pool_block *g_ma_pitch_shift_pool_head = NULL;
+static ma_uint32 g_ma_pitch_shift_pool_count = 0;
+
+static void *ma_pitch_shift_pool_acquire(size_t sizeInBytes) {
+	ma_pitch_shift_pool_block *pBlock = NULL;
+
+	ma_spinlock_lock(&g_ma_pitch_shift_pool_lock);
+	ma_pitch_shift_pool_block **ppLink = &g_ma_pitch_shift_pool_head;
+	while (*ppLink != NULL) {
+		if ((*ppLink)->sizeInBytes == sizeInBytes) {
+			pBlock = *ppLink;
+			*ppLink = pBlock->pNext;
+			g_ma_pitch_shift_pool_count--;
+			break;
+		}
+		ppLink = &(*ppLink)->pNext;
+	}
+	ma_spinlock_unlock(&g_ma_pitch_shift_pool_lock);
+
+	if (pBlock == NULL) {
+		pBlock = (ma_pitch_shift_pool_block *)ma_aligned_malloc(MA_PITCH_SHIFT_POOL_HEADER_SIZE + sizeInBytes, MA_PITCH_SHIFT_POOL_HEADER_SIZE, NULL);
+		if (pBlock == NULL) {
+			return NULL;
+		}
+		pBlock->sizeInBytes = sizeInBytes;
+	}
+
+	void *pData = (ma_uint8 *)pBlock + MA_PITCH_SHIFT_POOL_HEADER_SIZE;
+	MA_ZERO_MEMORY(pData, sizeInBytes);
+	return pData;
+}
+
+static void ma_pitch_shift_pool_release(void *pData) {
+	if (pData == NULL) {
+		return;
+	}
+
+	ma_pitch_shift_pool_block *pBlock = (ma_pitch_shift_pool_block *)((ma_uint8 *)pData - MA_PITCH_SHIFT_POOL_HEADER_SIZE);
+
+	ma_spinlock_lock(&g_ma_pitch_shift_pool_lock);
+	if (g_ma_pitch_shift_pool_count < MA_PITCH_SHIFT_POOL_MAX_BLOCKS) {
+		pBlock->pNext = g_ma_pitch_shift_pool_head;
+		g_ma_pitch_shift_pool_head = pBlock;
+		g_ma_pitch_shift_pool_count++;
+		pBlock = NULL;
+	}
+	ma_spinlock_unlock(&g_ma_pitch_shift_pool_lock);
+
+	if (pBlock != NULL) {
+		ma_aligned_free(pBlock, NULL);
+	}
+}
+
+static size_t ma_smb_pitch_shift_get_channel_size(int fftFrameSize, int oversampling) {
+	const size_t stepSize = fftFrameSize / oversampling;
+	const size_t binCount = fftFrameSize / 2 + 1;
+	return sizeof(float) * (fftFrameSize * 2 + stepSize * 2 + binCount * 6);
+}
+
+MA_API size_t ma_pitch_shift_node_get_block_size(int fftFrameSize, int oversampling) {
+	// Both channels, the shared window and the complex work buffer
+	return ma_smb_pitch_shift_get_channel_size(fftFrameSize, oversampling) * 2 + sizeof(float) * fftFrameSize * 3;
+}
+
+// Carves the channel's buffers out of pMemory, returns the first float past them
+static float *ma_smb_pitch_shift_init(SMBPitchShift *pitch_shift, float *pMemory, int fftFrameSize, int oversampling) {
+	const int stepSize = fftFrameSize / oversampling;
+	const int binCount = fftFrameSize / 2 + 1;
+
+	pitch_shift->gInFIFO = pMemory;
+	pMemory += fftFrameSize;
+	pitch_shift->gOutFIFO = pMemory;
+	pMemory += stepSize;
+	pitch_shift->gOutputAccum = pMemory;
+	pMemory += fftFrameSize + stepSize;
+	pitch_shift->gLastPhase = pMemory;
+	pMemory += binCount;
+	pitch_shift->gSumPhase = pMemory;
+	pMemory += binCount;
+	pitch_shift->gAnaFreq = pMemory;
+	pMemory += binCount;
+	pitch_shift->gAnaMagn = pMemory;
+	pMemory += binCount;
+	pitch_shift->gSynFreq = pMemory;
+	pMemory += binCount;
+	pitch_shift->gSynMagn = pMemory;
+	pMemory += binCount;
+
+	return pMemory;
 }
 
 /* clang-format off */
@@ -119,164 +219,175 @@ static void ma_smb_pitch_shift_init(SMBPitchShift *pitch_shift) {
 *
 *****************************************************************************/
 
-static void PitchShift(SMBPitchShift *smbPitchShift, float pitchShift, long numSampsToProcess, long fftFrameSize, long osamp, float sampleRate, const float *indata, float *outdata,int stride) {
-
-
-	/*
-		Routine smbPitchShift(). See top of file for explanation
-		Purpose: doing pitch shifting while maintaining duration using the Short
-		Time Fourier Transform.
-		Author: (c)1999-2015 Stephan M. Bernsee <s.bernsee [AT] zynaptiq [DOT] com>
-	*/
-
-	double magn, phase, tmp, window, real, imag;
-	double freqPerBin, expct;
-	long i,k, qpd, index, inFifoLatency, stepSize, fftFrameSize2;
-	unsigned long fftFrameBufferSize;
-
-	/* set up some handy variables */
-	fftFrameBufferSize = (unsigned long)fftFrameSize*sizeof(float);
-	fftFrameSize2 = fftFrameSize/2;
-	stepSize = fftFrameSize/osamp;
-	freqPerBin = sampleRate/(double)fftFrameSize;
-	expct = 2.*Math_PI*(double)stepSize/(double)fftFrameSize;
-	inFifoLatency = fftFrameSize-stepSize;
-	if (smbPitchShift->gRover == 0) { smbPitchShift->gRover = inFifoLatency;
+/*
+	The routine has been split per step so both channels can share one transform,
+	see ma_pitch_shift_node_process_frame.
+*/
+
+/* analysis step for bin k of one channel */
+static inline void smbAnalyzeBin(SMBPitchShift *smbPitchShift, long k, double real, double imag, double expct, double freqPerBin, long osamp) {
+	double magn, phase, tmp;
+	long qpd;
+
+	/* compute magnitude and phase */
+	magn = 2.*sqrt(real*real + imag*imag);
+	phase = atan2(imag,real);
+
+	/* compute phase difference */
+	tmp = phase - smbPitchShift->gLastPhase[k];
+	smbPitchShift->gLastPhase[k] = phase;
+
+	/* subtract expected phase difference */
+	tmp -= (double)k*expct;
+
+	/* map delta phase into +/- Pi interval */
+	qpd = tmp/Math_PI;
+	if (qpd >= 0) { qpd += qpd&1;
+	} else { qpd -= qpd&1;
 }
+	tmp -= Math_PI*(double)qpd;
 
-	/* initialize our static arrays */
+	/* get deviation from bin frequency from the +/- Pi interval */
+	tmp = osamp*tmp/(2.*Math_PI);
 
-	/* main processing loop */
-	for (i = 0; i < numSampsToProcess; i++){
-		/* As long as we have not yet collected enough data just read in */
-		smbPitchShift->gInFIFO[smbPitchShift->gRover] = indata[i*stride];
-		outdata[i*stride] = smbPitchShift->gOutFIFO[smbPitchShift->gRover-inFifoLatency];
-		smbPitchShift->gRover++;
+	/* compute the k-th partials' true frequency */
+	tmp = (double)k*freqPerBin + tmp*freqPerBin;
 
-		/* now we have enough data for processing */
-		if (smbPitchShift->gRover >= fftFrameSize) {
-			smbPitchShift->gRover = inFifoLatency;
+	/* store magnitude and true frequency in analysis arrays */
+	smbPitchShift->gAnaMagn[k] = magn;
+	smbPitchShift->gAnaFreq[k] = tmp;
+}
 
-			/* do windowing and re,im interleave */
-			for (k = 0; k < fftFrameSize;k++) {
-				window = -.5*cos(2.*Math_PI*(double)k/(double)fftFrameSize)+.5;
-				smbPitchShift->gFFTworksp[2*k] = smbPitchShift->gInFIFO[k] * window;
-				smbPitchShift->gFFTworksp[2*k+1] = 0.;
-			}
+/* this does the actual pitch shifting */
+static inline void smbShiftBins(SMBPitchShift *smbPitchShift, float pitchShift, long fftFrameSize2) {
+	long k, index;
+
+	memset(smbPitchShift->gSynMagn, 0, (fftFrameSize2+1)*sizeof(float));
+	memset(smbPitchShift->gSynFreq, 0, (fftFrameSize2+1)*sizeof(float));
+	for (k = 0; k <= fftFrameSize2; k++) {
+		index = k*pitchShift;
+		if (index <= fftFrameSize2) {
+			smbPitchShift->gSynMagn[index] += smbPitchShift->gAnaMagn[k];
+			smbPitchShift->gSynFreq[index] = smbPitchShift->gAnaFreq[k] * pitchShift;
+		}
+	}
+}
 
+/* synthesis step for bin k of one channel */
+static inline void smbSynthesizeBin(SMBPitchShift *smbPitchShift, long k, double expct, double freqPerBin, long osamp, float *real, float *imag) {
+	double magn, phase, tmp;
 
-			/* ***************** ANALYSIS ******************* */
-			/* do transform */
-			smbFft(smbPitchShift->gFFTworksp, fftFrameSize, -1);
+	/* get magnitude and true frequency from synthesis arrays */
+	magn = smbPitchShift->gSynMagn[k];
+	tmp = smbPitchShift->gSynFreq[k];
 
-			/* this is the analysis step */
-			for (k = 0; k <= fftFrameSize2; k++) {
-				/* de-interlace FFT buffer */
-				real = smbPitchShift->gFFTworksp[2*k];
-				imag = smbPitchShift->gFFTworksp[2*k+1];
+	/* subtract bin mid frequency */
+	tmp -= (double)k*freqPerBin;
 
-				/* compute magnitude and phase */
-				magn = 2.*sqrt(real*real + imag*imag);
-				phase = atan2(imag,real);
+	/* get bin deviation from freq deviation */
+	tmp /= freqPerBin;
 
-				/* compute phase difference */
-				tmp = phase - smbPitchShift->gLastPhase[k];
-				smbPitchShift->gLastPhase[k] = phase;
+	/* take osamp into account */
+	tmp = 2.*Math_PI*tmp/osamp;
 
-				/* subtract expected phase difference */
-				tmp -= (double)k*expct;
+	/* add the overlap phase advance back in */
+	tmp += (double)k*expct;
 
-				/* map delta phase into +/- Pi interval */
-				qpd = tmp/Math_PI;
-				if (qpd >= 0) { qpd += qpd&1;
-				} else { qpd -= qpd&1;
-}
-				tmp -= Math_PI*(double)qpd;
-
-				/* get deviation from bin frequency from the +/- Pi interval */
-				tmp = osamp*tmp/(2.*Math_PI);
-
-				/* compute the k-th partials' true frequency */
-				tmp = (double)k*freqPerBin + tmp*freqPerBin;
-
-				/* store magnitude and true frequency in analysis arrays */
-				smbPitchShift->gAnaMagn[k] = magn;
-				smbPitchShift->gAnaFreq[k] = tmp;
-
-			}
-
-			/* ***************** PROCESSING ******************* */
-			/* this does the actual pitch shifting */
-			memset(smbPitchShift->gSynMagn, 0, fftFrameBufferSize);
-			memset(smbPitchShift->gSynFreq, 0, fftFrameBufferSize);
-			for (k = 0; k <= fftFrameSize2; k++) {
-				index = k*pitchShift;
-				if (index <= fftFrameSize2) {
-					smbPitchShift->gSynMagn[index] += smbPitchShift->gAnaMagn[k];
-					smbPitchShift->gSynFreq[index] = smbPitchShift->gAnaFreq[k] * pitchShift;
-				}
-			}
-
-			/* ***************** SYNTHESIS ******************* */
-			/* this is the synthesis step */
-			for (k = 0; k <= fftFrameSize2; k++) {
-				/* get magnitude and true frequency from synthesis arrays */
-				magn = smbPitchShift->gSynMagn[k];
-				tmp = smbPitchShift->gSynFreq[k];
-
-				/* subtract bin mid frequency */
-				tmp -= (double)k*freqPerBin;
-
-				/* get bin deviation from freq deviation */
-				tmp /= freqPerBin;
-
-				/* take osamp into account */
-				tmp = 2.*Math_PI*tmp/osamp;
-
-				/* add the overlap phase advance back in */
-				tmp += (double)k*expct;
-
-				/* accumulate delta phase to get bin phase */
-				smbPitchShift->gSumPhase[k] += tmp;
-				phase = smbPitchShift->gSumPhase[k];
-
-				/* get real and imag part and re-interleave */
-				smbPitchShift->gFFTworksp[2*k] = magn*cos(phase);
-				smbPitchShift->gFFTworksp[2*k+1] = magn*sin(phase);
-			}
-
-			/* zero negative frequencies */
-			for (k = fftFrameSize+2; k < 2*fftFrameSize; k++) { smbPitchShift->gFFTworksp[k] = 0.;
+	/* accumulate delta phase to get bin phase */
+	smbPitchShift->gSumPhase[k] += tmp;
+	phase = smbPitchShift->gSumPhase[k];
+
+	/* get real and imag part */
+	*real = magn*cos(phase);
+	*imag = magn*sin(phase);
 }
 
-			/* do inverse transform */
-			smbFft(smbPitchShift->gFFTworksp, fftFrameSize, 1);
+/* Godot code again */
+/* clang-format on */
+
+/*
+	Runs one STFT frame for both channels. The input is real, so both channels are packed into a
+	single complex transform (L + iR) and separated again with conjugate symmetry. The synthesized
+	spectra are recombined the same way, so the inverse is a single transform as well.
+*/
+static void ma_pitch_shift_node_process_frame(ma_pitch_shift_node *pPitchShift, float pitchShift) {
+	const long fftFrameSize = pPitchShift->fft_size;
+	const long fftFrameSize2 = fftFrameSize / 2;
+	const long osamp = pPitchShift->oversampling;
+	const long stepSize = fftFrameSize / osamp;
+	const long inFifoLatency = fftFrameSize - stepSize;
+	const double freqPerBin = pPitchShift->sampleRate / (double)fftFrameSize;
+	const double expct = 2.0 * Math_PI * (double)stepSize / (double)fftFrameSize;
+
+	SMBPitchShift *shiftL = &pPitchShift->shiftL;
+	SMBPitchShift *shiftR = &pPitchShift->shiftR;
+	const float *window = pPitchShift->window;
+	float *z = pPitchShift->fftWorksp;
+
+	for (long k = 0; k < fftFrameSize; k++) {
+		z[k * 2] = shiftL->gInFIFO[k] * window[k];
+		z[k * 2 + 1] = shiftR->gInFIFO[k] * window[k];
+	}
 
-			/* do windowing and add to output accumulator */
-			for(k=0; k < fftFrameSize; k++) {
-				window = -.5*cos(2.*Math_PI*(double)k/(double)fftFrameSize)+.5;
-				smbPitchShift->gOutputAccum[k] += 2.*window*smbPitchShift->gFFTworksp[2*k]/(fftFrameSize2*osamp);
-			}
-			for (k = 0; k < stepSize; k++) { smbPitchShift->gOutFIFO[k] = smbPitchShift->gOutputAccum[k];
-}
+	ma_fft_plan_execute((ma_fft_plan *)pPitchShift->fftPlan, z, -1);
 
-			/* shift accumulator */
-			memmove(smbPitchShift->gOutputAccum, smbPitchShift->gOutputAccum+stepSize, fftFrameBufferSize);
+	for (long k = 0; k <= fftFrameSize2; k++) {
+		const long m = (fftFrameSize - k) & (fftFrameSize - 1);
+		const double leftReal = (z[k * 2] + z[m * 2]) * 0.5;
+		const double leftImag = (z[k * 2 + 1] - z[m * 2 + 1]) * 0.5;
+		const double rightReal = (z[k * 2 + 1] + z[m * 2 + 1]) * 0.5;
+		const double rightImag = (z[m * 2] - z[k * 2]) * 0.5;
+		smbAnalyzeBin(shiftL, k, leftReal, leftImag, expct, freqPerBin, osamp);
+		smbAnalyzeBin(shiftR, k, rightReal, rightImag, expct, freqPerBin, osamp);
+	}
 
-			/* move input FIFO */
-			for (k = 0; k < inFifoLatency; k++) { smbPitchShift->gInFIFO[k] = smbPitchShift->gInFIFO[k+stepSize];
-}
+	smbShiftBins(shiftL, pitchShift, fftFrameSize2);
+	smbShiftBins(shiftR, pitchShift, fftFrameSize2);
+
+	for (long k = 0; k <= fftFrameSize2; k++) {
+		float leftReal, leftImag, rightReal, rightImag;
+		smbSynthesizeBin(shiftL, k, expct, freqPerBin, osamp, &leftReal, &leftImag);
+		smbSynthesizeBin(shiftR, k, expct, freqPerBin, osamp, &rightReal, &rightImag);
+
+		if (k == 0 || k == fftFrameSize2) {
+			// The original routine zeroes the negative frequencies and keeps twice the real part
+			// of the inverse, for DC and Nyquist that equals a real bin of twice the value
+			z[k * 2] = 2.0f * leftReal;
+			z[k * 2 + 1] = 2.0f * rightReal;
+		} else {
+			const long m = fftFrameSize - k;
+			z[k * 2] = leftReal - rightImag;
+			z[k * 2 + 1] = leftImag + rightReal;
+			z[m * 2] = leftReal + rightImag;
+			z[m * 2 + 1] = rightReal - leftImag;
 		}
 	}
-}
 
-/* Godot code again */
-/* clang-format on */
+	ma_fft_plan_execute((ma_fft_plan *)pPitchShift->fftPlan, z, 1);
+
+	// The conjugate half already doubles every other bin, so there is no extra factor of 2
+	const float outputScale = 1.0f / (float)(fftFrameSize2 * osamp);
+	for (long k = 0; k < fftFrameSize; k++) {
+		const float w = window[k] * outputScale;
+		shiftL->gOutputAccum[k] += w * z[k * 2];
+		shiftR->gOutputAccum[k] += w * z[k * 2 + 1];
+	}
+
+	SMBPitchShift *channels[2] = { shiftL, shiftR };
+	for (int c = 0; c < 2; c++) {
+		SMBPitchShift *channel = channels[c];
+		memcpy(channel->gOutFIFO, channel->gOutputAccum, stepSize * sizeof(float));
+		// Nothing is accumulated past fftFrameSize, so the shift brings zeroes in
+		memmove(channel->gOutputAccum, channel->gOutputAccum + stepSize, fftFrameSize * sizeof(float));
+		memmove(channel->gInFIFO, channel->gInFIFO + stepSize, inFifoLatency * sizeof(float));
+	}
+}
 
 static void ma_pitch_shift_node_process_pcm_frames(ma_node *pNode, const float **ppFramesIn, ma_uint32 *pFrameCountIn, float **ppFramesOut, ma_uint32 *pFrameCountOut) {
 	ma_pitch_shift_node *pPitchShift = (ma_pitch_shift_node *)pNode;
 
-	float tolerance = 0.00001 * abs(pPitchShift->pitchScale);
+	const float pitchScale = c89atomic_load_f32(&pPitchShift->pitchScale);
+	float tolerance = 0.00001 * abs(pitchScale);
 	if (tolerance < 0.00001) {
 		tolerance = 0.00001;
 	}
@@ -284,35 +395,36 @@ static void ma_pitch_shift_node_process_pcm_frames(ma_node *pNode, const float *
 	pFrameCountOut[0] = pFrameCountIn[0];
 
 	// For pitch_scale 1.0 it's cheaper to just pass samples without processing them.
-	if (abs(pPitchShift->pitchScale - 1.0f) < tolerance) {
+	if (abs(pitchScale - 1.0f) < tolerance) {
 		ma_copy_pcm_frames(ppFramesOut[0], ppFramesIn[0], pFrameCountIn[0], ma_format_f32, ma_node_get_output_channels(pNode, 0));
 		return;
 	}
 
-	const float *in_l = ppFramesIn[0];
-	const float *in_r = in_l + 1;
-
-	float *out_l = ppFramesOut[0];
-	float *out_r = out_l + 1;
-
-	PitchShift(&pPitchShift->shiftL,
-			pPitchShift->pitchScale,
-			pFrameCountIn[0],
-			pPitchShift->fft_size,
-			pPitchShift->oversampling,
-			pPitchShift->sampleRate,
-			in_l,
-			out_l,
-			2);
-	PitchShift(&pPitchShift->shiftR,
-			pPitchShift->pitchScale,
-			pFrameCountIn[0],
-			pPitchShift->fft_size,
-			pPitchShift->oversampling,
-			pPitchShift->sampleRate,
-			in_r,
-			out_r,
-			2);
+	const float *pFramesIn = ppFramesIn[0];
+	float *pFramesOut = ppFramesOut[0];
+
+	const int32_t fftFrameSize = pPitchShift->fft_size;
+	const int32_t inFifoLatency = fftFrameSize - fftFrameSize / pPitchShift->oversampling;
+	if (pPitchShift->rover == 0) {
+		pPitchShift->rover = inFifoLatency;
+	}
+
+	SMBPitchShift *shiftL = &pPitchShift->shiftL;
+	SMBPitchShift *shiftR = &pPitchShift->shiftR;
+
+	for (ma_uint32 i = 0; i < pFrameCountIn[0]; i++) {
+		const int32_t rover = pPitchShift->rover;
+		shiftL->gInFIFO[rover] = pFramesIn[i * 2];
+		shiftR->gInFIFO[rover] = pFramesIn[i * 2 + 1];
+		pFramesOut[i * 2] = shiftL->gOutFIFO[rover - inFifoLatency];
+		pFramesOut[i * 2 + 1] = shiftR->gOutFIFO[rover - inFifoLatency];
+
+		pPitchShift->rover++;
+		if (pPitchShift->rover >= fftFrameSize) {
+			pPitchShift->rover = inFifoLatency;
+			ma_pitch_shift_node_process_frame(pPitchShift, pitchScale);
+		}
+	}
 }
 
 static ma_node_vtable g_ma_pitch_shift_node_vtable = {
@@ -336,14 +448,52 @@ MA_API ma_pitch_shift_node_config ma_pitch_shift_node_config_init(ma_uint32 samp
 }
 
 MA_API ma_result ma_pitch_shift_node_init(ma_node_graph *pNodeGraph, const ma_pitch_shift_node_config *pConfig, const ma_allocation_callbacks *pAllocationCallbacks, ma_pitch_shift_node *node) {
-	ma_smb_pitch_shift_init(&node->shiftL);
-	ma_smb_pitch_shift_init(&node->shiftR);
-	node->pitchScale = 1.0f;
+	if (node == NULL || pConfig == NULL || pConfig->fftSize < 0 || pConfig->fftSize >= FFT_SIZE_MAX) {
+		return MA_INVALID_ARGS;
+	}
+
+	MA_ZERO_OBJECT(node);
+
 	static const int fft_sizes[FFT_SIZE_MAX] = { 256, 512, 1024, 2048, 4096 };
-	node->fft_size = fft_sizes[pConfig->fftSize];
+	const int fftFrameSize = fft_sizes[pConfig->fftSize];
+	if (pConfig->oversampling < 1 || pConfig->oversampling > fftFrameSize || (pConfig->oversampling & (pConfig->oversampling - 1)) != 0) {
+		return MA_INVALID_ARGS;
+	}
+
+	node->pitchScale = 1.0f;
+	node->fft_size = fftFrameSize;
 	node->oversampling = pConfig->oversampling;
 	node->sampleRate = pConfig->sampleRate;
 
+	node->blockSizeInBytes = ma_pitch_shift_node_get_block_size(fftFrameSize, node->oversampling);
+	node->pBlock = ma_pitch_shift_pool_acquire(node->blockSizeInBytes);
+	node->fftPlan = ma_malloc(sizeof(ma_fft_plan), pAllocationCallbacks);
+	if (node->pBlock == NULL || node->fftPlan == NULL) {
+		ma_pitch_shift_pool_release(node->pBlock);
+		ma_free(node->fftPlan, pAllocationCallbacks);
+		MA_ZERO_OBJECT(node);
+		return MA_OUT_OF_MEMORY;
+	}
+
+	ma_result result = ma_fft_plan_init((ma_fft_plan *)node->fftPlan, fftFrameSize, pAllocationCallbacks);
+	if (result != MA_SUCCESS) {
+		ma_pitch_shift_pool_release(node->pBlock);
+		ma_free(node->fftPlan, pAllocationCallbacks);
+		MA_ZERO_OBJECT(node);
+		return result;
+	}
+
+	float *pMemory = (float *)node->pBlock;
+	pMemory = ma_smb_pitch_shift_init(&node->shiftL, pMemory, fftFrameSize, node->oversampling);
+	pMemory = ma_smb_pitch_shift_init(&node->shiftR, pMemory, fftFrameSize, node->oversampling);
+	node->window = pMemory;
+	pMemory += fftFrameSize;
+	node->fftWorksp = pMemory;
+
+	for (int k = 0; k < fftFrameSize; k++) {
+		node->window[k] = -.5 * cos(2. * Math_PI * (double)k / (double)fftFrameSize) + .5;
+	}
+
 	ma_node_config baseConfig;
 
 	baseConfig = pConfig->nodeConfig;
@@ -359,9 +509,13 @@ MA_API ma_result ma_pitch_shift_node_init(ma_node_graph *pNodeGraph, const ma_pi
 	baseConfig.pInputChannels = inputChannels;
 	baseConfig.pOutputChannels = outputChannels;
 
-	ma_result result = ma_node_init(pNodeGraph, &baseConfig, pAllocationCallbacks, &node->baseNode);
+	result = ma_node_init(pNodeGraph, &baseConfig, pAllocationCallbacks, &node->baseNode);
 
 	if (result != MA_SUCCESS) {
+		ma_fft_plan_uninit((ma_fft_plan *)node->fftPlan, pAllocationCallbacks);
+		ma_free(node->fftPlan, pAllocationCallbacks);
+		ma_pitch_shift_pool_release(node->pBlock);
+		MA_ZERO_OBJECT(node);
 		return result;
 	}
 
@@ -378,6 +532,13 @@ MA_API float ma_pitch_shift_node_get_pitch_scale(ma_pitch_shift_node *node) {
 
 MA_API void ma_pitch_shift_node_uninit(ma_pitch_shift_node *pPitchShiftNode, const ma_allocation_callbacks *pAllocationCallbacks) {
 	ma_node_uninit(pPitchShiftNode, pAllocationCallbacks);
+	if (pPitchShiftNode->fftPlan != NULL) {
+		ma_fft_plan_uninit((ma_fft_plan *)pPitchShiftNode->fftPlan, pAllocationCallbacks);
+		ma_free(pPitchShiftNode->fftPlan, pAllocationCallbacks);
+		pPitchShiftNode->fftPlan = NULL;
+	}
+	ma_pitch_shift_pool_release(pPitchShiftNode->pBlock);
+	pPitchShiftNode->pBlock = NULL;
 }
 
 #endif
@@ -59,16 +59,28 @@ int64_t ShinobuSoundPlayer::get_playback_position_nsec() {
 	Ref<ShinobuClock> clock = Shinobu::get_singleton()->get_clock();
 	ma_engine *engine = Shinobu::get_singleton()->get_engine();
 
-	ma_uint64 pos_frames = 0;
-	ma_result result = ma_sound_get_cursor_in_pcm_frames(&sound, &pos_frames);
+	// With the filtered clock the cursor and the filtered position have to come from the same
+	// callback, read the cursor again if the audio thread published a new one in between
+	const bool filtered = clock->is_using_filtered_clock();
+	ShinobuClock::FilteredPosition filtered_position;
 	int64_t out_pos = 0;
-	uint32_t sample_rate;
-	if (result == MA_SUCCESS) {
-		result = ma_sound_get_data_format(&sound, NULL, NULL, &sample_rate, NULL, 0);
+	uint32_t sequence;
+	do {
+		sequence = clock->get_snapshot_sequence();
+		out_pos = 0;
+		ma_uint64 pos_frames = 0;
+		ma_result result = ma_sound_get_cursor_in_pcm_frames(&sound, &pos_frames);
+		uint32_t sample_rate;
 		if (result == MA_SUCCESS) {
-			out_pos = (pos_frames * 1e+9) / sample_rate;
+			result = ma_sound_get_data_format(&sound, NULL, NULL, &sample_rate, NULL, 0);
+			if (result == MA_SUCCESS) {
+				out_pos = (pos_frames * 1e+9) / sample_rate;
+			}
 		}
-	}
+		if (filtered) {
+			filtered_position = clock->get_filtered_position();
+		}
+	} while (filtered && filtered_position.sequence != sequence);
 
 	// This allows the return of negative playback time
 	// seconds to nanoseconds = x * 1_000_000_000
@@ -81,7 +93,7 @@ int64_t ShinobuSoundPlayer::get_playback_position_nsec() {
 	}
 
 	if (is_playing()) {
-		int64_t engine_offset = clock->get_current_offset_nsec();
+		int64_t engine_offset = filtered ? filtered_position.position_nsec - filtered_position.engine_time_nsec : clock->get_current_offset_nsec();
 		engine_offset = ma_sound_get_pitch(&sound) * engine_offset;
 		out_pos += engine_offset;
 	}
@@ -187,5 +199,5 @@ ShinobuSoundPlayer::ShinobuSoundPlayer(Ref<ShinobuSoundSource> m_sound_source, R
 }
 
 ShinobuSoundPlayer::~ShinobuSoundPlayer() {
-	ma_sound_uninit(&sound);
+	sound_source->release_sound(&sound);
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include "shinobu_sound_source.h"
 #include "shinobu.h"
 #include "shinobu_macros.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/io/file_access.h"
 #include "thirdparty/ebur128/ebur128.h"
 
 void ShinobuSoundSource::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("instantiate", "group", "use_source_channel_count"), &ShinobuSoundSource::instantiate, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("instantiate_voice_pool", "group", "voice_count"), &ShinobuSoundSource::instantiate_voice_pool, DEFVAL(8));
 	ClassDB::bind_method(D_METHOD("get_channel_count"), &ShinobuSoundSource::get_channel_count);
 	ClassDB::bind_method(D_METHOD("ebur128_get_loudness"), &ShinobuSoundSource::ebur128_get_loudness);
 }
@@ -13,41 +17,70 @@ ShinobuSoundSource::ShinobuSoundSource(String m_name) {
 	name = m_name;
 };
 
-float ShinobuSoundSource::ebur128_get_loudness() {
-	uint64_t start = OS::get_singleton()->get_ticks_usec();
-	ma_sound sound;
+float ShinobuSoundSource::compute_ebur128_loudness(ma_decoder *p_decoder) {
 	ma_format format;
 	uint32_t channel_count;
 	uint32_t sample_rate;
-	ERR_FAIL_COND_V(instantiate_sound(Ref<ShinobuGroup>(), true, &sound) != OK, 0.0f);
-	ma_sound_get_data_format(&sound, &format, &channel_count, &sample_rate, nullptr, 0);
+	ma_decoder_get_data_format(p_decoder, &format, &channel_count, &sample_rate, nullptr, 0);
 	ebur128_state *state = ebur128_init(channel_count, sample_rate, EBUR128_MODE_I);
+	ERR_FAIL_NULL_V(state, 0.0f);
 
 	const uint64_t FRAMES_PER_CHUNK = 300000;
 	Vector<float> chunk_data;
 	chunk_data.resize(FRAMES_PER_CHUNK * channel_count);
 	float *chunk_data_ptr = chunk_data.ptrw();
-	ma_data_source *data_source = ma_sound_get_data_source(&sound);
-	int frame_count = 0;
-	uint64_t frames_read;
-	while (ma_data_source_read_pcm_frames(data_source, chunk_data_ptr, (ma_uint64)FRAMES_PER_CHUNK, (ma_uint64 *)&frames_read) != MA_AT_END) {
-		ebur128_add_frames_float(state, chunk_data_ptr, frames_read);
-		frame_count += frames_read;
+	while (true) {
+		ma_uint64 frames_read = 0;
+		ma_result read_result = ma_decoder_read_pcm_frames(p_decoder, chunk_data_ptr, (ma_uint64)FRAMES_PER_CHUNK, &frames_read);
+		if (frames_read > 0) {
+			ebur128_add_frames_float(state, chunk_data_ptr, frames_read);
+		}
+		if (read_result != MA_SUCCESS || frames_read == 0) {
+			break;
+		}
 	}
 
 	double loudness_global;
 	ebur128_loudness_global(state, &loudness_global);
 	ebur128_destroy(&state);
-	ma_sound_uninit(&sound);
-	print_line("Normalization done, took", (OS::get_singleton()->get_ticks_usec() - start) * 0.001, "milliseconds");
 	return loudness_global;
 }
 
+float ShinobuSoundSource::ebur128_get_loudness() {
+	Shinobu *shinobu = Shinobu::get_singleton();
+	String content_hash = get_content_hash();
+	float loudness;
+	if (!content_hash.is_empty() && shinobu->get_cached_loudness(content_hash, loudness)) {
+		return loudness;
+	}
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	// Decoding directly instead of going through an ma_sound keeps this safe to run from worker threads
+	ma_decoder decoder;
+	ERR_FAIL_COND_V(init_decoder(&decoder) != OK, 0.0f);
+	loudness = compute_ebur128_loudness(&decoder);
+	ma_decoder_uninit(&decoder);
+	print_line("Normalization done, took", (OS::get_singleton()->get_ticks_usec() - start) * 0.001, "milliseconds");
+
+	if (!content_hash.is_empty()) {
+		shinobu->store_cached_loudness(content_hash, loudness);
+	}
+	return loudness;
+}
+
+String ShinobuSoundSource::get_content_hash() const {
+	return String();
+}
+
+Error ShinobuSoundSource::init_decoder(ma_decoder *p_decoder) {
+	return ERR_UNAVAILABLE;
+}
+
 uint32_t ShinobuSoundSource::get_channel_count() const {
 	uint32_t channel_count;
 	// data sources cannot be reused, so this is the best we can do
 	ma_resource_manager_data_source source;
-	ma_resource_manager_data_source_init(ma_engine_get_resource_manager(Shinobu::get_singleton()->get_engine()), name.utf8(), 0, nullptr, &source);
+	ma_resource_manager_data_source_init(ma_engine_get_resource_manager(Shinobu::get_singleton()->get_engine()), name.utf8(), get_data_source_flags() & ~MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_ASYNC, nullptr, &source);
 	ma_resource_manager_data_source_get_data_format(&source, nullptr, &channel_count, nullptr, nullptr, 0);
 	ma_resource_manager_data_source_uninit(&source);
 	return channel_count;
@@ -69,13 +102,21 @@ ShinobuSoundPlayer *ShinobuSoundSource::instantiate(Ref<ShinobuGroup> m_group, b
 	return memnew(ShinobuSoundPlayer(this, m_group, m_use_source_channel_count));
 }
 
+Ref<ShinobuVoicePool> ShinobuSoundSource::instantiate_voice_pool(Ref<ShinobuGroup> m_group, int m_voice_count) {
+	return memnew(ShinobuVoicePool(this, m_group, m_voice_count));
+}
+
 ShinobuSoundSource::~ShinobuSoundSource(){};
 
-Error ShinobuSoundSourceMemory::instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound) {
+ma_uint32 ShinobuSoundSource::get_data_source_flags() const {
+	return 0;
+}
+
+Error ShinobuSoundSource::instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound) {
 	ma_sound_config config = ma_sound_config_init();
 	CharString string_data = name.utf8();
 	config.pFilePath = string_data.ptr();
-	config.flags = config.flags | MA_SOUND_FLAG_NO_SPATIALIZATION;
+	config.flags = config.flags | MA_SOUND_FLAG_NO_SPATIALIZATION | get_data_source_flags();
 	if (use_source_channel_count) {
 		config.flags = config.flags | MA_SOUND_FLAG_NO_DEFAULT_ATTACHMENT;
 		config.channelsOut = MA_SOUND_SOURCE_CHANNEL_COUNT;
@@ -89,6 +130,22 @@ Error ShinobuSoundSourceMemory::instantiate_sound(Ref<ShinobuGroup> m_group, boo
 	return OK;
 }
 
+void ShinobuSoundSource::release_sound(ma_sound *p_sound) {
+	ma_sound_uninit(p_sound);
+}
+
+String ShinobuSoundSourceMemory::get_content_hash() const {
+	unsigned char hash[32];
+	CryptoCore::sha256(data.ptr(), data.size(), hash);
+	return String::hex_encode_buffer(hash, 32);
+}
+
+Error ShinobuSoundSourceMemory::init_decoder(ma_decoder *p_decoder) {
+	ma_decoder_config config = Shinobu::get_singleton()->get_decoder_config();
+	MA_ERR_RET(ma_decoder_init_memory(data.ptr(), data.size(), &config, p_decoder), "Error initializing decoder");
+	return OK;
+}
+
 ShinobuSoundSourceMemory::ShinobuSoundSourceMemory(String m_name, PackedByteArray m_in_data) :
 		ShinobuSoundSource(m_name) {
 	data = m_in_data;
@@ -100,4 +157,72 @@ ShinobuSoundSourceMemory::ShinobuSoundSourceMemory(String m_name, PackedByteArra
 ShinobuSoundSourceMemory::~ShinobuSoundSourceMemory() {
 	ma_engine *engine = Shinobu::get_singleton()->get_engine();
 	ma_resource_manager_unregister_data(ma_engine_get_resource_manager(engine), name.utf8());
-}
\ No newline at end of file
+}
+
+SafeNumeric<uint64_t> ShinobuSoundSourceFile::total_decoded_page_memory;
+
+void ShinobuSoundSourceFile::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_decoded_page_memory"), &ShinobuSoundSourceFile::get_decoded_page_memory);
+}
+
+ma_uint32 ShinobuSoundSourceFile::get_data_source_flags() const {
+	// Only the page ring is kept in memory, decoding happens on the resource manager's job thread
+	return MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM | MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_ASYNC | MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_WAIT_INIT;
+}
+
+uint64_t ShinobuSoundSourceFile::get_page_memory_for_sound(ma_sound *p_sound) {
+	ma_format format;
+	ma_uint32 channel_count;
+	ma_uint32 sample_rate;
+	if (ma_sound_get_data_format(p_sound, &format, &channel_count, &sample_rate, nullptr, 0) != MA_SUCCESS) {
+		return 0;
+	}
+	// Mirrors ma_resource_manager_data_stream_get_page_size_in_frames, two pages are allocated per stream
+	uint64_t page_size_in_frames = SHINOBU_STREAM_PAGE_SIZE_MSEC * (sample_rate / 1000);
+	return page_size_in_frames * 2 * ma_get_bytes_per_frame(format, channel_count);
+}
+
+Error ShinobuSoundSourceFile::instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound) {
+	Error err = ShinobuSoundSource::instantiate_sound(m_group, use_source_channel_count, p_sound);
+	if (err == OK) {
+		uint64_t page_memory = get_page_memory_for_sound(p_sound);
+		decoded_page_memory.add(page_memory);
+		total_decoded_page_memory.add(page_memory);
+	}
+	return err;
+}
+
+void ShinobuSoundSourceFile::release_sound(ma_sound *p_sound) {
+	uint64_t page_memory = get_page_memory_for_sound(p_sound);
+	decoded_page_memory.sub(page_memory);
+	total_decoded_page_memory.sub(page_memory);
+	ShinobuSoundSource::release_sound(p_sound);
+}
+
+String ShinobuSoundSourceFile::get_content_hash() const {
+	return FileAccess::get_sha256(name);
+}
+
+Error ShinobuSoundSourceFile::init_decoder(ma_decoder *p_decoder) {
+	ma_decoder_config config = Shinobu::get_singleton()->get_decoder_config();
+	MA_ERR_RET(ma_decoder_init_vfs(Shinobu::get_singleton()->get_vfs(), name.utf8(), &config, p_decoder), "Error initializing decoder");
+	return OK;
+}
+
+uint64_t ShinobuSoundSourceFile::get_decoded_page_memory() const {
+	return decoded_page_memory.get();
+}
+
+uint64_t ShinobuSoundSourceFile::get_total_decoded_page_memory() {
+	return total_decoded_page_memory.get();
+}
+
+ShinobuSoundSourceFile::ShinobuSoundSourceFile(String p_path) :
+		ShinobuSoundSource(p_path) {
+	decoded_page_memory.set(0);
+	// Streams are opened through Shinobu's VFS on demand, so there's nothing to register here
+	result = MA_SUCCESS;
+}
+
+ShinobuSoundSourceFile::~ShinobuSoundSourceFile() {
+}
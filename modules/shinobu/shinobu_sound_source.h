@@ -11,6 +11,10 @@
 #include "core/string/ustring.h"
 #include "shinobu_group.h"
 #include "shinobu_sound_player.h"
+#include "shinobu_voice_pool.h"
+
+// Length of a single decoded page for streamed sources, miniaudio keeps two pages resident per stream
+#define SHINOBU_STREAM_PAGE_SIZE_MSEC 500
 
 class ShinobuSoundSource : public RefCounted {
 	GDCLASS(ShinobuSoundSource, RefCounted);
@@ -21,6 +25,7 @@ protected:
 	ma_result result;
 
 	static void _bind_methods();
+	virtual ma_uint32 get_data_source_flags() const;
 
 public:
 	virtual const String get_name() const;
@@ -29,12 +34,19 @@ public:
 
 	virtual uint64_t get_fixed_length() const;
 	ShinobuSoundPlayer *instantiate(Ref<ShinobuGroup> m_group, bool m_use_source_channel_count = false);
+	Ref<ShinobuVoicePool> instantiate_voice_pool(Ref<ShinobuGroup> m_group, int m_voice_count);
 
 	ShinobuSoundSource(String m_name);
 
+	static float compute_ebur128_loudness(ma_decoder *p_decoder);
 	float ebur128_get_loudness();
+	// Hash of the encoded data, used as the loudness cache key
+	virtual String get_content_hash() const;
+	// Standalone decoder that doesn't touch the engine, safe to use from any thread
+	virtual Error init_decoder(ma_decoder *p_decoder);
 	uint32_t get_channel_count() const;
-	virtual Error instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound) = 0;
+	virtual Error instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound);
+	virtual void release_sound(ma_sound *p_sound);
 
 	virtual ~ShinobuSoundSource();
 };
@@ -44,10 +56,35 @@ class ShinobuSoundSourceMemory : public ShinobuSoundSource {
 	PackedByteArray data;
 
 public:
-	virtual Error instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound) override;
+	virtual String get_content_hash() const override;
+	virtual Error init_decoder(ma_decoder *p_decoder) override;
 	ShinobuSoundSourceMemory(String p_name, PackedByteArray p_in_data);
 	~ShinobuSoundSourceMemory();
 	friend class ShinobuSoundPlayer;
 };
 
+class ShinobuSoundSourceFile : public ShinobuSoundSource {
+	GDCLASS(ShinobuSoundSourceFile, ShinobuSoundSource);
+	static SafeNumeric<uint64_t> total_decoded_page_memory;
+	SafeNumeric<uint64_t> decoded_page_memory;
+
+	static uint64_t get_page_memory_for_sound(ma_sound *p_sound);
+
+protected:
+	static void _bind_methods();
+	virtual ma_uint32 get_data_source_flags() const override;
+
+public:
+	virtual Error instantiate_sound(Ref<ShinobuGroup> m_group, bool use_source_channel_count, ma_sound *p_sound) override;
+	virtual void release_sound(ma_sound *p_sound) override;
+	virtual String get_content_hash() const override;
+	virtual Error init_decoder(ma_decoder *p_decoder) override;
+
+	uint64_t get_decoded_page_memory() const;
+	static uint64_t get_total_decoded_page_memory();
+
+	ShinobuSoundSourceFile(String p_path);
+	~ShinobuSoundSourceFile();
+};
+
 #endif // SHINOBU_SOUND_SOURCE_H
\ No newline at end of file
@@ -42,9 +42,20 @@ typedef struct
 {
 	ma_node_base baseNode;
 	ma_uint32 bufferLengthInMilliseconds;
-	int fftSize;
-	float *temporalFft;
-	float **fftHistory;
+	int fftSize; // Number of output bins per channel, transforms are 2 * fftSize samples long
+	float *window; // Precomputed Hann window, 2 * fftSize entries
+	float *temporalFft; // Windowed input packed as left + i * right, 2 * fftSize complex values
+	float *magnitudeScratch; // Split spectra of both channels, 4 * fftSize entries
+	float *fftHistory; // Ring of fftCount rows, each row is fftSize left bins followed by fftSize right bins
+	void *fftPlan;
+	// Triple buffered copy of the spectrum tapBackPos behind the latest FFT, written by the audio thread
+	// and read without locks by a single reader thread. publishState holds the index of the buffer
+	// last handed over by the writer plus a flag telling if the reader hasn't picked it up yet.
+	float *publishedSpectra;
+	ma_uint32 publishState;
+	int publishWriteIndex;
+	int publishReadIndex;
+	ma_bool32 hasPublishedSpectrum;
 	int temporalFftPos;
 	int fftCount;
 	int fftPos;
@@ -57,6 +68,13 @@ MA_API ma_result ma_spectrum_analyzer_node_init(ma_node_graph *pNodeGraph, const
 MA_API ma_spectrum_analyzer_config ma_spectrum_analyzer_config_init(ma_uint32 sampleRate);
 MA_API void ma_spectrum_analyzer_node_uninit(ma_spectrum_analyzer_node *pSpectrumNode, const ma_allocation_callbacks *pAllocationCallbacks);
 MagnitudeResult ma_spectrum_analyzer_get_magnitude_for_frequency_range(float pBegin, float pEnd, ma_spectrum_magnitude_mode pMagnitudeMode, ma_spectrum_analyzer_node *pSpectrumNode);
+// Hands a spectrum (fftSize left bins followed by fftSize right bins) over to the reader, called by the audio thread
+void ma_spectrum_analyzer_publish_spectrum(ma_spectrum_analyzer_node *pSpectrumNode, const float *pSpectrum);
+// Returns the most recently published spectrum (fftSize left bins followed by fftSize right bins) or NULL if there's none yet,
+// must only be called from one thread and the pointer is valid until the next call
+const float *ma_spectrum_analyzer_acquire_spectrum(ma_spectrum_analyzer_node *pSpectrumNode);
+int ma_spectrum_analyzer_frequency_to_bin(ma_spectrum_analyzer_node *pSpectrumNode, float pFrequency);
+MagnitudeResult ma_spectrum_analyzer_get_magnitude_for_bin_range(const float *pSpectrum, int pFftSize, int pBeginBin, int pEndBin, ma_spectrum_magnitude_mode pMagnitudeMode);
 
 #ifdef __cplusplus
 }
@@ -67,54 +85,92 @@ MagnitudeResult ma_spectrum_analyzer_get_magnitude_for_frequency_range(float pBe
 
 #include "shinobu_fft.h"
 
+static void ma_spectrum_analyzer_compute_spectrum(ma_spectrum_analyzer_node *pSpectrumNode, float *pOut) {
+	const int binCount = pSpectrumNode->fftSize;
+	const int transformSize = binCount * 2;
+	float *z = pSpectrumNode->temporalFft;
+
+	// Both channels are real, so they are transformed together as one complex signal
+	ma_fft_plan_execute((ma_fft_plan *)pSpectrumNode->fftPlan, z, -1);
+
+	// Split the packed spectrum, L[k] = (Z[k] + conj(Z[N - k])) / 2, R[k] = (Z[k] - conj(Z[N - k])) / 2i
+	float *leftRe = pSpectrumNode->magnitudeScratch;
+	float *leftIm = leftRe + binCount;
+	float *rightRe = leftIm + binCount;
+	float *rightIm = rightRe + binCount;
+	for (int k = 0; k < binCount; k++) {
+		const int mirror = (transformSize - k) & (transformSize - 1);
+		const float zr = z[k * 2];
+		const float zi = z[k * 2 + 1];
+		const float zmr = z[mirror * 2];
+		const float zmi = z[mirror * 2 + 1];
+		leftRe[k] = zr + zmr;
+		leftIm[k] = zi - zmi;
+		rightRe[k] = zi + zmi;
+		rightIm[k] = zmr - zr;
+	}
+
+	// The halving from the split is folded into the normalization
+	const float scale = 0.5f / (float)binCount;
+	ma_fft_magnitudes(leftRe, leftIm, pOut, binCount, scale);
+	ma_fft_magnitudes(rightRe, rightIm, pOut + binCount, binCount, scale);
+}
+
+#define MA_SPECTRUM_PUBLISH_DIRTY 0x4
+#define MA_SPECTRUM_PUBLISH_INDEX_MASK 0x3
+
+void ma_spectrum_analyzer_publish_spectrum(ma_spectrum_analyzer_node *pSpectrumNode, const float *pSpectrum) {
+	const int rowSize = pSpectrumNode->fftSize * 2;
+	float *dst = pSpectrumNode->publishedSpectra + pSpectrumNode->publishWriteIndex * rowSize;
+	MA_COPY_MEMORY(dst, pSpectrum, sizeof(float) * rowSize);
+
+	ma_uint32 previous = c89atomic_exchange_32(&pSpectrumNode->publishState, (ma_uint32)pSpectrumNode->publishWriteIndex | MA_SPECTRUM_PUBLISH_DIRTY);
+	pSpectrumNode->publishWriteIndex = previous & MA_SPECTRUM_PUBLISH_INDEX_MASK;
+}
+
+static void ma_spectrum_analyzer_publish(ma_spectrum_analyzer_node *pSpectrumNode) {
+	const int rowSize = pSpectrumNode->fftSize * 2;
+	const float fftTimeSize = float(pSpectrumNode->fftSize) / (double)pSpectrumNode->sampleRate;
+
+	int delayRows = ma_min((int)(pSpectrumNode->tapBackPos / fftTimeSize), pSpectrumNode->fftCount - 1);
+	int fftIndex = (pSpectrumNode->fftPos - delayRows + pSpectrumNode->fftCount) % pSpectrumNode->fftCount;
+	ma_spectrum_analyzer_publish_spectrum(pSpectrumNode, pSpectrumNode->fftHistory + fftIndex * rowSize);
+}
+
 static void ma_spectrum_analyzer_process_pcm_frames(ma_node *pNode, const float **ppFramesIn, ma_uint32 *pFrameCountIn, float **ppFramesOut, ma_uint32 *pFrameCountOut) {
 	ma_spectrum_analyzer_node *pSpectrumNode = (ma_spectrum_analyzer_node *)pNode;
 	ma_uint64 time_usec = (double)ma_node_get_time(pNode) / (double)pSpectrumNode->sampleRate * 1000000.0;
 
 	ma_uint32 frameCount = *pFrameCountIn;
-
-	int frameInPos = 0;
+	const int transformSize = pSpectrumNode->fftSize * 2;
+	const float *in = ppFramesIn[0];
 
 	while (frameCount > 0) {
-		int toFill = pSpectrumNode->fftSize * 2 - pSpectrumNode->temporalFftPos;
+		int toFill = transformSize - pSpectrumNode->temporalFftPos;
 		toFill = ma_min(toFill, frameCount);
 
-		float *fftw = pSpectrumNode->temporalFft;
+		float *fftw = pSpectrumNode->temporalFft + pSpectrumNode->temporalFftPos * 2;
+		const float *window = pSpectrumNode->window + pSpectrumNode->temporalFftPos;
 
+		// Interleaved stereo maps directly onto the packed complex layout
 		for (int i = 0; i < toFill; i++) {
-			float window = -0.5 * cos(2.0 * SSA_PI * (double)pSpectrumNode->temporalFftPos / (double)pSpectrumNode->fftSize) + 0.5;
-			fftw[pSpectrumNode->temporalFftPos * 2] = window * ppFramesIn[0][frameInPos]; // left channel
-			fftw[pSpectrumNode->temporalFftPos * 2 + 1] = 0;
-			fftw[(pSpectrumNode->temporalFftPos + pSpectrumNode->fftSize * 2) * 2] = window * ppFramesIn[0][frameInPos + 1]; // right channel
-			fftw[(pSpectrumNode->temporalFftPos + pSpectrumNode->fftSize * 2) * 2 + 1] = 0;
-			frameInPos += 2;
-			++pSpectrumNode->temporalFftPos;
+			fftw[i * 2] = window[i] * in[i * 2]; // left channel
+			fftw[i * 2 + 1] = window[i] * in[i * 2 + 1]; // right channel
 		}
 
+		in += toFill * 2;
+		pSpectrumNode->temporalFftPos += toFill;
 		frameCount -= toFill;
 
-		if (pSpectrumNode->temporalFftPos == pSpectrumNode->fftSize * 2) {
+		if (pSpectrumNode->temporalFftPos == transformSize) {
 			//time to do a FFT
-			smbFft(fftw, pSpectrumNode->fftSize * 2, -1);
-			smbFft(fftw + pSpectrumNode->fftSize * 4, pSpectrumNode->fftSize * 2, -1);
 			int next = (pSpectrumNode->fftPos + 1) % pSpectrumNode->fftCount;
-
-			float *hw = pSpectrumNode->fftHistory[next];
-			float x;
-			float y;
-
-			for (int i = 0; i < pSpectrumNode->fftSize; i++) {
-				x = fftw[i * 2];
-				y = fftw[i * 2 + 1];
-				hw[i] = sqrt(x * x + y * y) / (float)pSpectrumNode->fftSize;
-
-				x = fftw[pSpectrumNode->fftSize * 4 + i * 2];
-				y = fftw[pSpectrumNode->fftSize * 4 + i * 2 + 1];
-				hw[i + 1] = sqrt(x * x + y * y) / (float)pSpectrumNode->fftSize;
-			}
+			ma_spectrum_analyzer_compute_spectrum(pSpectrumNode, pSpectrumNode->fftHistory + next * transformSize);
 
 			pSpectrumNode->fftPos = next;
 			pSpectrumNode->temporalFftPos = 0;
+
+			ma_spectrum_analyzer_publish(pSpectrumNode);
 		}
 	}
 
@@ -136,6 +192,24 @@ MA_API ma_spectrum_analyzer_config ma_spectrum_analyzer_config_init(ma_uint32 sa
 	return config;
 }
 
+static void ma_spectrum_analyzer_node_free_buffers(ma_spectrum_analyzer_node *pSpectrumNode, const ma_allocation_callbacks *pAllocationCallbacks) {
+	if (pSpectrumNode->fftPlan != NULL) {
+		ma_fft_plan_uninit((ma_fft_plan *)pSpectrumNode->fftPlan, pAllocationCallbacks);
+		ma_free(pSpectrumNode->fftPlan, pAllocationCallbacks);
+	}
+	ma_free(pSpectrumNode->fftHistory, pAllocationCallbacks);
+	ma_free(pSpectrumNode->temporalFft, pAllocationCallbacks);
+	ma_free(pSpectrumNode->window, pAllocationCallbacks);
+	ma_free(pSpectrumNode->magnitudeScratch, pAllocationCallbacks);
+	ma_free(pSpectrumNode->publishedSpectra, pAllocationCallbacks);
+	pSpectrumNode->publishedSpectra = NULL;
+	pSpectrumNode->fftPlan = NULL;
+	pSpectrumNode->fftHistory = NULL;
+	pSpectrumNode->temporalFft = NULL;
+	pSpectrumNode->window = NULL;
+	pSpectrumNode->magnitudeScratch = NULL;
+}
+
 static ma_node_vtable g_ma_spectrum_node_vtable = {
 	ma_spectrum_analyzer_process_pcm_frames,
 	NULL,
@@ -164,19 +238,40 @@ MA_API ma_result ma_spectrum_analyzer_node_init(ma_node_graph *pNodeGraph, const
 	pSpectrumNode->fftCount = ((pConfig->bufferLengthInMilliseconds / 1000.0f) / (((float)pSpectrumNode->fftSize) / (float)pSpectrumNode->sampleRate)) + 1;
 	pSpectrumNode->fftPos = 0;
 	pSpectrumNode->lastFftTime = 0;
-	pSpectrumNode->fftHistory = (float **)ma_malloc(sizeof(float **) * pSpectrumNode->fftCount, pAllocationCallbacks); // Yes we are assuming stereo... bad idea
-	pSpectrumNode->temporalFft = (float *)ma_malloc(sizeof(float) * pSpectrumNode->fftSize * 8, pAllocationCallbacks); // x2 stereo, x2 amount of samples for freqs, x2 for input
 	pSpectrumNode->temporalFftPos = 0;
 	pSpectrumNode->tapBackPos = pConfig->tapBackPos;
 
-	for (int i = 0; i < pSpectrumNode->fftCount; i++) {
-		pSpectrumNode->fftHistory[i] = (float *)ma_malloc(sizeof(float) * pSpectrumNode->fftSize * 2, pAllocationCallbacks);
-		for (int j = 0; j < pSpectrumNode->fftSize * 2; j += 2) {
-			pSpectrumNode->fftHistory[i][j] = 0;
-			pSpectrumNode->fftHistory[i][j + 1] = 0;
-		}
+	const int transformSize = pSpectrumNode->fftSize * 2;
+
+	// Everything is allocated up front as single blocks, the audio thread never allocates
+	pSpectrumNode->fftHistory = (float *)ma_malloc(sizeof(float) * transformSize * pSpectrumNode->fftCount, pAllocationCallbacks);
+	pSpectrumNode->temporalFft = (float *)ma_malloc(sizeof(float) * transformSize * 2, pAllocationCallbacks);
+	pSpectrumNode->window = (float *)ma_malloc(sizeof(float) * transformSize, pAllocationCallbacks);
+	pSpectrumNode->magnitudeScratch = (float *)ma_malloc(sizeof(float) * transformSize * 2, pAllocationCallbacks);
+	pSpectrumNode->publishedSpectra = (float *)ma_malloc(sizeof(float) * transformSize * 3, pAllocationCallbacks);
+	pSpectrumNode->fftPlan = ma_malloc(sizeof(ma_fft_plan), pAllocationCallbacks);
+
+	if (pSpectrumNode->fftHistory == NULL || pSpectrumNode->temporalFft == NULL || pSpectrumNode->window == NULL || pSpectrumNode->magnitudeScratch == NULL || pSpectrumNode->publishedSpectra == NULL || pSpectrumNode->fftPlan == NULL) {
+		ma_spectrum_analyzer_node_free_buffers(pSpectrumNode, pAllocationCallbacks);
+		return MA_OUT_OF_MEMORY;
 	}
 
+	result = ma_fft_plan_init((ma_fft_plan *)pSpectrumNode->fftPlan, transformSize, pAllocationCallbacks);
+	if (result != MA_SUCCESS) {
+		ma_spectrum_analyzer_node_free_buffers(pSpectrumNode, pAllocationCallbacks);
+		return result;
+	}
+
+	for (int i = 0; i < transformSize; i++) {
+		pSpectrumNode->window[i] = -0.5 * cos(2.0 * SSA_PI * (double)i / (double)transformSize) + 0.5;
+	}
+	MA_ZERO_MEMORY(pSpectrumNode->fftHistory, sizeof(float) * transformSize * pSpectrumNode->fftCount);
+	MA_ZERO_MEMORY(pSpectrumNode->publishedSpectra, sizeof(float) * transformSize * 3);
+	pSpectrumNode->publishWriteIndex = 0;
+	pSpectrumNode->publishState = 1;
+	pSpectrumNode->publishReadIndex = 2;
+	pSpectrumNode->hasPublishedSpectrum = MA_FALSE;
+
 	baseConfig = pConfig->nodeConfig;
 	baseConfig.vtable = &g_ma_spectrum_node_vtable;
 	ma_uint32 inputChannels[1];
@@ -191,73 +286,81 @@ MA_API ma_result ma_spectrum_analyzer_node_init(ma_node_graph *pNodeGraph, const
 	result = ma_node_init(pNodeGraph, &baseConfig, pAllocationCallbacks, &pSpectrumNode->baseNode);
 
 	if (result != MA_SUCCESS) {
+		ma_spectrum_analyzer_node_free_buffers(pSpectrumNode, pAllocationCallbacks);
 		return result;
 	}
 
 	return MA_SUCCESS;
 }
 
-MagnitudeResult ma_spectrum_analyzer_get_magnitude_for_frequency_range(float pBegin, float pEnd, ma_spectrum_magnitude_mode pMagnitudeMode, ma_spectrum_analyzer_node *pSpectrumNode) {
-	MagnitudeResult out;
-	out.l = 0.0f;
-	out.r = 0.0f;
-	if (pSpectrumNode->lastFftTime == 0) {
-		return out;
+const float *ma_spectrum_analyzer_acquire_spectrum(ma_spectrum_analyzer_node *pSpectrumNode) {
+	if (c89atomic_load_32(&pSpectrumNode->publishState) & MA_SPECTRUM_PUBLISH_DIRTY) {
+		ma_uint32 previous = c89atomic_exchange_32(&pSpectrumNode->publishState, (ma_uint32)pSpectrumNode->publishReadIndex);
+		pSpectrumNode->publishReadIndex = previous & MA_SPECTRUM_PUBLISH_INDEX_MASK;
+		pSpectrumNode->hasPublishedSpectrum = MA_TRUE;
 	}
 
-	double time_useconds = ma_node_get_time(pSpectrumNode) / (double)(pSpectrumNode->sampleRate / 1000000.0);
-	float diff = double(time_useconds - pSpectrumNode->lastFftTime) / 1000000.0 + pSpectrumNode->tapBackPos;
-	float fftTimeSize = float(pSpectrumNode->fftSize) / (double)pSpectrumNode->sampleRate;
-
-	int fftIndex = pSpectrumNode->fftPos;
-
-	while (diff > fftTimeSize) {
-		diff -= fftTimeSize;
-		fftIndex -= 1;
-		if (fftIndex < 0) {
-			fftIndex = pSpectrumNode->fftCount - 1;
-		}
+	if (!pSpectrumNode->hasPublishedSpectrum) {
+		return NULL;
 	}
 
-	int beginPos = pBegin * pSpectrumNode->fftSize / ((double)pSpectrumNode->sampleRate * 0.5);
-	int endPos = pEnd * pSpectrumNode->fftSize / ((double)pSpectrumNode->sampleRate * 0.5);
+	return pSpectrumNode->publishedSpectra + pSpectrumNode->publishReadIndex * pSpectrumNode->fftSize * 2;
+}
+
+int ma_spectrum_analyzer_frequency_to_bin(ma_spectrum_analyzer_node *pSpectrumNode, float pFrequency) {
+	int bin = pFrequency * pSpectrumNode->fftSize / ((double)pSpectrumNode->sampleRate * 0.5);
+	return ma_clamp(bin, 0, pSpectrumNode->fftSize - 1);
+}
 
-	beginPos = ma_clamp(beginPos, 0, pSpectrumNode->fftSize - 1);
-	endPos = ma_clamp(endPos, 0, pSpectrumNode->fftSize - 1);
+MagnitudeResult ma_spectrum_analyzer_get_magnitude_for_bin_range(const float *pSpectrum, int pFftSize, int pBeginBin, int pEndBin, ma_spectrum_magnitude_mode pMagnitudeMode) {
+	MagnitudeResult out;
+	out.l = 0.0f;
+	out.r = 0.0f;
 
-	if (beginPos > endPos) {
-		int temp = beginPos;
-		beginPos = endPos;
-		endPos = temp;
+	if (pBeginBin > pEndBin) {
+		int temp = pBeginBin;
+		pBeginBin = pEndBin;
+		pEndBin = temp;
 	}
 
-	float *r = pSpectrumNode->fftHistory[fftIndex];
+	const float *l = pSpectrum;
+	const float *r = pSpectrum + pFftSize;
 
 	if (pMagnitudeMode == MAGNITUDE_AVERAGE) {
-		for (int i = beginPos; i <= endPos; i++) {
-			out.l += r[i];
-			out.r += r[i + 1];
+		for (int i = pBeginBin; i <= pEndBin; i++) {
+			out.l += l[i];
+			out.r += r[i];
 		}
 
-		out.l /= float(endPos - beginPos + 1);
-		out.r /= float(endPos - beginPos + 1);
+		out.l /= float(pEndBin - pBeginBin + 1);
+		out.r /= float(pEndBin - pBeginBin + 1);
 
 	} else {
-		for (int i = beginPos; i <= endPos; i++) {
-			out.l = ma_max(out.l, r[i]);
-			out.r = ma_max(out.r, r[i + 1]);
+		for (int i = pBeginBin; i <= pEndBin; i++) {
+			out.l = ma_max(out.l, l[i]);
+			out.r = ma_max(out.r, r[i]);
 		}
 	}
 	return out;
 }
 
-MA_API void ma_spectrum_analyzer_node_uninit(ma_spectrum_analyzer_node *pSpectrumNode, const ma_allocation_callbacks *pAllocationCallbacks) {
-	for (int i = 0; i < pSpectrumNode->fftCount; i++) {
-		ma_free(pSpectrumNode->fftHistory[i], pAllocationCallbacks);
+MagnitudeResult ma_spectrum_analyzer_get_magnitude_for_frequency_range(float pBegin, float pEnd, ma_spectrum_magnitude_mode pMagnitudeMode, ma_spectrum_analyzer_node *pSpectrumNode) {
+	const float *spectrum = ma_spectrum_analyzer_acquire_spectrum(pSpectrumNode);
+	if (spectrum == NULL) {
+		MagnitudeResult out;
+		out.l = 0.0f;
+		out.r = 0.0f;
+		return out;
 	}
-	ma_free(pSpectrumNode->fftHistory, pAllocationCallbacks);
-	ma_free(pSpectrumNode->temporalFft, pAllocationCallbacks);
+
+	int beginPos = ma_spectrum_analyzer_frequency_to_bin(pSpectrumNode, pBegin);
+	int endPos = ma_spectrum_analyzer_frequency_to_bin(pSpectrumNode, pEnd);
+	return ma_spectrum_analyzer_get_magnitude_for_bin_range(spectrum, pSpectrumNode->fftSize, beginPos, endPos, pMagnitudeMode);
+}
+
+MA_API void ma_spectrum_analyzer_node_uninit(ma_spectrum_analyzer_node *pSpectrumNode, const ma_allocation_callbacks *pAllocationCallbacks) {
 	ma_node_uninit(pSpectrumNode, pAllocationCallbacks);
+	ma_spectrum_analyzer_node_free_buffers(pSpectrumNode, pAllocationCallbacks);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "shinobu_vfs.h"
+
+#include "core/io/file_access.h"
+
+struct ShinobuVFSFile {
+	Ref<FileAccess> file;
+};
+
+static ma_result shinobu_vfs_open(ma_vfs *pVFS, const char *pFilePath, ma_uint32 openMode, ma_vfs_file *pFile) {
+	if (pFile == NULL) {
+		return MA_INVALID_ARGS;
+	}
+	*pFile = NULL;
+
+	// Audio files are only ever read
+	if ((openMode & MA_OPEN_MODE_WRITE) != 0) {
+		return MA_NOT_IMPLEMENTED;
+	}
+
+	Error err;
+	Ref<FileAccess> file = FileAccess::open(String::utf8(pFilePath), FileAccess::READ, &err);
+	if (file.is_null() || err != OK) {
+		return MA_DOES_NOT_EXIST;
+	}
+
+	ShinobuVFSFile *vfs_file = memnew(ShinobuVFSFile);
+	vfs_file->file = file;
+	*pFile = vfs_file;
+	return MA_SUCCESS;
+}
+
+static ma_result shinobu_vfs_close(ma_vfs *pVFS, ma_vfs_file file) {
+	ShinobuVFSFile *vfs_file = (ShinobuVFSFile *)file;
+	if (vfs_file == NULL) {
+		return MA_INVALID_ARGS;
+	}
+	memdelete(vfs_file);
+	return MA_SUCCESS;
+}
+
+static ma_result shinobu_vfs_read(ma_vfs *pVFS, ma_vfs_file file, void *pDst, size_t sizeInBytes, size_t *pBytesRead) {
+	ShinobuVFSFile *vfs_file = (ShinobuVFSFile *)file;
+	if (vfs_file == NULL || pDst == NULL) {
+		return MA_INVALID_ARGS;
+	}
+
+	uint64_t bytes_read = vfs_file->file->get_buffer((uint8_t *)pDst, sizeInBytes);
+	if (pBytesRead != NULL) {
+		*pBytesRead = bytes_read;
+	}
+
+	if (bytes_read == 0 && sizeInBytes > 0) {
+		return MA_AT_END;
+	}
+	return MA_SUCCESS;
+}
+
+static ma_result shinobu_vfs_write(ma_vfs *pVFS, ma_vfs_file file, const void *pSrc, size_t sizeInBytes, size_t *pBytesWritten) {
+	return MA_NOT_IMPLEMENTED;
+}
+
+static ma_result shinobu_vfs_seek(ma_vfs *pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin) {
+	ShinobuVFSFile *vfs_file = (ShinobuVFSFile *)file;
+	if (vfs_file == NULL) {
+		return MA_INVALID_ARGS;
+	}
+
+	switch (origin) {
+		case ma_seek_origin_start: {
+			vfs_file->file->seek(offset);
+		} break;
+		case ma_seek_origin_current: {
+			vfs_file->file->seek(vfs_file->file->get_position() + offset);
+		} break;
+		case ma_seek_origin_end: {
+			vfs_file->file->seek_end(offset);
+		} break;
+	}
+	return MA_SUCCESS;
+}
+
+static ma_result shinobu_vfs_tell(ma_vfs *pVFS, ma_vfs_file file, ma_int64 *pCursor) {
+	ShinobuVFSFile *vfs_file = (ShinobuVFSFile *)file;
+	if (vfs_file == NULL || pCursor == NULL) {
+		return MA_INVALID_ARGS;
+	}
+	*pCursor = vfs_file->file->get_position();
+	return MA_SUCCESS;
+}
+
+static ma_result shinobu_vfs_info(ma_vfs *pVFS, ma_vfs_file file, ma_file_info *pInfo) {
+	ShinobuVFSFile *vfs_file = (ShinobuVFSFile *)file;
+	if (vfs_file == NULL || pInfo == NULL) {
+		return MA_INVALID_ARGS;
+	}
+	pInfo->sizeInBytes = vfs_file->file->get_length();
+	return MA_SUCCESS;
+}
+
+ma_result shinobu_vfs_init(ShinobuVFS *p_vfs) {
+	if (p_vfs == NULL) {
+		return MA_INVALID_ARGS;
+	}
+
+	p_vfs->cb.onOpen = shinobu_vfs_open;
+	p_vfs->cb.onOpenW = NULL;
+	p_vfs->cb.onClose = shinobu_vfs_close;
+	p_vfs->cb.onRead = shinobu_vfs_read;
+	p_vfs->cb.onWrite = shinobu_vfs_write;
+	p_vfs->cb.onSeek = shinobu_vfs_seek;
+	p_vfs->cb.onTell = shinobu_vfs_tell;
+	p_vfs->cb.onInfo = shinobu_vfs_info;
+
+	return MA_SUCCESS;
+}
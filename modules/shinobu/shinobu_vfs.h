@@ -0,0 +1,14 @@
+#ifndef SHINOBU_VFS_H
+#define SHINOBU_VFS_H
+
+#include "miniaudio/miniaudio.h"
+
+// miniaudio VFS that routes every file the resource manager opens through FileAccess,
+// this makes res:// paths inside PCKs and zip packs streamable
+typedef struct {
+	ma_vfs_callbacks cb;
+} ShinobuVFS;
+
+ma_result shinobu_vfs_init(ShinobuVFS *p_vfs);
+
+#endif
@@ -0,0 +1,150 @@
+#include "shinobu_voice_pool.h"
+#include "shinobu.h"
+#include "shinobu_macros.h"
+#include "shinobu_sound_source.h"
+
+void ShinobuVoicePool::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("play"), &ShinobuVoicePool::play);
+	ClassDB::bind_method(D_METHOD("play_at", "dsp_time_msec"), &ShinobuVoicePool::play_at);
+	ClassDB::bind_method(D_METHOD("stop_all"), &ShinobuVoicePool::stop_all);
+	ClassDB::bind_method(D_METHOD("set_volume", "linear_volume"), &ShinobuVoicePool::set_volume);
+	ClassDB::bind_method(D_METHOD("get_volume"), &ShinobuVoicePool::get_volume);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "volume"), "set_volume", "get_volume");
+	ClassDB::bind_method(D_METHOD("set_steal_mode", "steal_mode"), &ShinobuVoicePool::set_steal_mode);
+	ClassDB::bind_method(D_METHOD("get_steal_mode"), &ShinobuVoicePool::get_steal_mode);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "steal_mode", PROPERTY_HINT_ENUM, "Round Robin,Oldest"), "set_steal_mode", "get_steal_mode");
+	ClassDB::bind_method(D_METHOD("get_voice_count"), &ShinobuVoicePool::get_voice_count);
+	ClassDB::bind_method(D_METHOD("get_active_voice_count"), &ShinobuVoicePool::get_active_voice_count);
+
+	BIND_ENUM_CONSTANT(STEAL_ROUND_ROBIN);
+	BIND_ENUM_CONSTANT(STEAL_OLDEST);
+}
+
+bool ShinobuVoicePool::_is_voice_busy(const Voice &p_voice, uint64_t p_now_frames) {
+	if (ma_sound_at_end(&p_voice.sound)) {
+		return false;
+	}
+	// ma_sound_is_playing reports voices scheduled in the future as stopped, they are still taken
+	return ma_sound_is_playing(&p_voice.sound) || (p_voice.started && p_voice.trigger_time_frames > p_now_frames);
+}
+
+uint32_t ShinobuVoicePool::_pick_voice(uint64_t p_now_frames) {
+	// Idle voices are always used first, a voice is only stolen when every voice is busy.
+	// The search starts after the last picked voice so round robin still spreads voices out.
+	uint32_t oldest = next_voice;
+	for (uint32_t i = 0; i < voices.size(); i++) {
+		uint32_t voice = (next_voice + i) % voices.size();
+		if (!_is_voice_busy(voices[voice], p_now_frames)) {
+			next_voice = (voice + 1) % voices.size();
+			return voice;
+		}
+		if (voices[voice].trigger_time_frames < voices[oldest].trigger_time_frames) {
+			oldest = voice;
+		}
+	}
+
+	uint32_t stolen = steal_mode == STEAL_ROUND_ROBIN ? next_voice : oldest;
+	next_voice = (stolen + 1) % voices.size();
+	return stolen;
+}
+
+int ShinobuVoicePool::_trigger(uint64_t p_start_frames) {
+	ERR_FAIL_COND_V_MSG(voices.is_empty(), -1, "Voice pool has no voices: " + error_message);
+
+	ma_engine *engine = Shinobu::get_singleton()->get_engine();
+	uint32_t voice_idx = _pick_voice(ma_engine_get_time(engine));
+	Voice &voice = voices[voice_idx];
+
+	// Sound MUST be stopped before seeking or we crash
+	ma_sound_stop(&voice.sound);
+	ma_result result = ma_sound_seek_to_pcm_frame(&voice.sound, 0);
+	if (result != MA_SUCCESS) {
+		error_message = vformat("%s (%s)", "Error rewinding voice", ma_result_description(result));
+		ERR_FAIL_V_MSG(-1, error_message);
+	}
+	ma_sound_set_start_time_in_pcm_frames(&voice.sound, p_start_frames);
+	ma_sound_set_stop_time_in_pcm_frames(&voice.sound, ~(ma_uint64)0);
+	result = ma_sound_start(&voice.sound);
+	if (result != MA_SUCCESS) {
+		error_message = vformat("%s (%s)", "Error starting voice", ma_result_description(result));
+		ERR_FAIL_V_MSG(-1, error_message);
+	}
+	voice.trigger_time_frames = p_start_frames;
+	voice.started = true;
+
+	return voice_idx;
+}
+
+int ShinobuVoicePool::play() {
+	return _trigger(ma_engine_get_time(Shinobu::get_singleton()->get_engine()));
+}
+
+// Same global engine time base as ShinobuSoundPlayer::schedule_start_time
+int ShinobuVoicePool::play_at(uint64_t p_dsp_time_msec) {
+	ma_engine *engine = Shinobu::get_singleton()->get_engine();
+	return _trigger(p_dsp_time_msec * ma_engine_get_sample_rate(engine) / 1000);
+}
+
+void ShinobuVoicePool::stop_all() {
+	for (Voice &voice : voices) {
+		ma_sound_stop(&voice.sound);
+		voice.started = false;
+	}
+}
+
+void ShinobuVoicePool::set_volume(float p_linear_volume) {
+	volume = p_linear_volume;
+	for (Voice &voice : voices) {
+		ma_sound_set_volume(&voice.sound, volume);
+	}
+}
+
+float ShinobuVoicePool::get_volume() const {
+	return volume;
+}
+
+void ShinobuVoicePool::set_steal_mode(StealMode p_steal_mode) {
+	steal_mode = p_steal_mode;
+}
+
+ShinobuVoicePool::StealMode ShinobuVoicePool::get_steal_mode() const {
+	return steal_mode;
+}
+
+int ShinobuVoicePool::get_voice_count() const {
+	return voices.size();
+}
+
+int ShinobuVoicePool::get_active_voice_count() const {
+	ma_engine *engine = Shinobu::get_singleton()->get_engine();
+	const uint64_t now_frames = ma_engine_get_time(engine);
+	int active = 0;
+	for (const Voice &voice : voices) {
+		if (_is_voice_busy(voice, now_frames)) {
+			active++;
+		}
+	}
+	return active;
+}
+
+ShinobuVoicePool::ShinobuVoicePool(Ref<ShinobuSoundSource> p_sound_source, Ref<ShinobuGroup> p_group, int p_voice_count) {
+	sound_source = p_sound_source;
+	ERR_FAIL_COND_MSG(p_voice_count <= 0, "Voice pools need at least one voice");
+
+	voices.resize(p_voice_count);
+	uint32_t initialized = 0;
+	for (; initialized < voices.size(); initialized++) {
+		if (sound_source->instantiate_sound(p_group, false, &voices[initialized].sound) != OK) {
+			error_message = "Error initializing voice";
+			break;
+		}
+	}
+	// Keep whatever voices did initialize so the pool still works, just with less polyphony
+	voices.resize(initialized);
+}
+
+ShinobuVoicePool::~ShinobuVoicePool() {
+	for (Voice &voice : voices) {
+		sound_source->release_sound(&voice.sound);
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef SHINOBU_VOICE_POOL_H
+#define SHINOBU_VOICE_POOL_H
+
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+#include "miniaudio/miniaudio.h"
+#include "shinobu_group.h"
+
+class ShinobuSoundSource;
+
+// Fixed set of voices for a single source meant for short one-shot sounds such as note hits,
+// every voice is initialized up front so triggering one never allocates or looks up the source by name
+class ShinobuVoicePool : public RefCounted {
+	GDCLASS(ShinobuVoicePool, RefCounted);
+
+public:
+	enum StealMode {
+		STEAL_ROUND_ROBIN,
+		STEAL_OLDEST,
+	};
+
+private:
+	struct Voice {
+		ma_sound sound;
+		uint64_t trigger_time_frames = 0;
+		bool started = false;
+	};
+
+	Ref<ShinobuSoundSource> sound_source;
+	// Sized once in the constructor, ma_sound must never move after being initialized
+	LocalVector<Voice> voices;
+	uint32_t next_voice = 0;
+	StealMode steal_mode = STEAL_OLDEST;
+	float volume = 1.0f;
+	String error_message;
+
+	static bool _is_voice_busy(const Voice &p_voice, uint64_t p_now_frames);
+	uint32_t _pick_voice(uint64_t p_now_frames);
+	int _trigger(uint64_t p_start_frames);
+
+protected:
+	static void _bind_methods();
+
+public:
+	int play();
+	int play_at(uint64_t p_dsp_time_msec);
+	void stop_all();
+
+	void set_volume(float p_linear_volume);
+	float get_volume() const;
+
+	void set_steal_mode(StealMode p_steal_mode);
+	StealMode get_steal_mode() const;
+
+	int get_voice_count() const;
+	int get_active_voice_count() const;
+
+	ShinobuVoicePool(Ref<ShinobuSoundSource> p_sound_source, Ref<ShinobuGroup> p_group, int p_voice_count);
+	~ShinobuVoicePool();
+};
+
+VARIANT_ENUM_CAST(ShinobuVoicePool::StealMode);
+
+#endif // SHINOBU_VOICE_POOL_H
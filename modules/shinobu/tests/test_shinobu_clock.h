@@ -0,0 +1,81 @@
+#ifndef TEST_SHINOBU_CLOCK_H
+#define TEST_SHINOBU_CLOCK_H
+
+#include "../shinobu_clock.h"
+
+#include "tests/test_macros.h"
+
+namespace TestShinobuClock {
+
+static const int64_t TEST_PERIOD_NSEC = 10'000'000;
+static const int64_t TEST_START_NSEC = 1'000'000'000;
+
+// Monotonic time of callback p_index for a device that runs p_rate times slower than the monotonic clock
+static int64_t callback_time(int64_t p_index, double p_rate, int64_t p_jitter_nsec) {
+	return TEST_START_NSEC + int64_t(p_index * TEST_PERIOD_NSEC * p_rate) + p_jitter_nsec;
+}
+
+TEST_CASE("[Shinobu] Filtered clock follows the engine time of a drifting device") {
+	Ref<ShinobuClock> clock;
+	clock.instantiate();
+
+	const double rate = 1.0001;
+	for (int64_t i = 1; i <= 2000; i++) {
+		const int64_t jitter = (i % 2) ? 20'000 : -20'000;
+		clock->measure_at(callback_time(i, rate, jitter), TEST_PERIOD_NSEC, i * TEST_PERIOD_NSEC);
+	}
+
+	// A device 100 ppm slower than the monotonic clock
+	CHECK(clock->get_drift_ppm() == doctest::Approx(-100.0).epsilon(0.1));
+	CHECK(clock->get_jitter_rms_usec() == doctest::Approx(20.0).epsilon(0.1));
+
+	// Half way through the next period the audible position is half a period past the last
+	// mixed one, minus the period that is still queued in the device
+	const int64_t engine_time = 2000 * TEST_PERIOD_NSEC;
+	const ShinobuClock::FilteredPosition position = clock->get_filtered_position(callback_time(2000, rate, 0) + int64_t(TEST_PERIOD_NSEC / 2 * rate));
+	CHECK(position.engine_time_nsec == engine_time);
+	CHECK(position.sequence == clock->get_snapshot_sequence());
+	CHECK(std::abs(position.position_nsec - (engine_time - TEST_PERIOD_NSEC / 2)) < 50'000);
+}
+
+TEST_CASE("[Shinobu] Filtered clock forgets a single late callback") {
+	Ref<ShinobuClock> clock;
+	clock.instantiate();
+
+	for (int64_t i = 1; i <= 1000; i++) {
+		clock->measure_at(callback_time(i, 1.0, 0), TEST_PERIOD_NSEC, i * TEST_PERIOD_NSEC);
+	}
+	clock->measure_at(callback_time(1001, 1.0, 5'000'000), TEST_PERIOD_NSEC, 1001 * TEST_PERIOD_NSEC);
+	CHECK(clock->get_jitter_max_usec() > 4000.0);
+
+	for (int64_t i = 1002; i <= 2000; i++) {
+		clock->measure_at(callback_time(i, 1.0, 0), TEST_PERIOD_NSEC, i * TEST_PERIOD_NSEC);
+	}
+	CHECK(clock->get_jitter_max_usec() < 2000.0);
+}
+
+TEST_CASE("[Shinobu] Filtered clock never goes backwards") {
+	Ref<ShinobuClock> clock;
+	clock.instantiate();
+
+	int64_t last_position = INT64_MIN;
+	bool monotonic = true;
+	for (int64_t i = 1; i <= 200; i++) {
+		// The device stalls for 300 msec half way through, which relocks the loop
+		const int64_t now = callback_time(i, 1.0, i > 100 ? 300'000'000 : 0);
+		const uint32_t sequence = clock->get_snapshot_sequence();
+		clock->measure_at(now, TEST_PERIOD_NSEC, i * TEST_PERIOD_NSEC);
+		CHECK(clock->get_snapshot_sequence() != sequence);
+
+		for (int64_t step = 0; step < 4; step++) {
+			const int64_t position = clock->get_filtered_position(now + step * TEST_PERIOD_NSEC / 4).position_nsec;
+			monotonic = monotonic && position >= last_position;
+			last_position = position;
+		}
+	}
+	CHECK(monotonic);
+}
+
+} // namespace TestShinobuClock
+
+#endif // TEST_SHINOBU_CLOCK_H
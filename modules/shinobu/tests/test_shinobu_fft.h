@@ -0,0 +1,111 @@
+#ifndef TEST_SHINOBU_FFT_H
+#define TEST_SHINOBU_FFT_H
+
+#include "core/math/math_funcs.h"
+#include "core/math/random_pcg.h"
+#include "core/templates/local_vector.h"
+
+#include "../shinobu_fft.h"
+
+#include "tests/test_macros.h"
+
+namespace TestShinobuFFT {
+
+static const int TEST_FFT_SIZES[] = { 2, 4, 8, 256, 4096 };
+
+static LocalVector<float> random_complex_signal(int p_size, uint64_t p_seed) {
+	RandomPCG rng(p_seed);
+	LocalVector<float> signal;
+	signal.resize(p_size * 2);
+	for (uint32_t i = 0; i < signal.size(); i++) {
+		signal[i] = rng.random(-1.0, 1.0);
+	}
+	return signal;
+}
+
+TEST_CASE("[Shinobu] Planned FFT matches the reference transform") {
+	for (int size : TEST_FFT_SIZES) {
+		ma_fft_plan plan;
+		REQUIRE(ma_fft_plan_init(&plan, size, NULL) == MA_SUCCESS);
+
+		for (int sign : { -1, 1 }) {
+			LocalVector<float> planned = random_complex_signal(size, size);
+			LocalVector<float> reference = planned;
+			ma_fft_plan_execute(&plan, planned.ptr(), sign);
+			smbFft(reference.ptr(), size, sign);
+
+			float max_error = 0.0f;
+			for (uint32_t i = 0; i < planned.size(); i++) {
+				max_error = MAX(max_error, Math::abs(planned[i] - reference[i]));
+			}
+			CHECK_MESSAGE(max_error < 1e-5f * size, vformat("Size %d, sign %d: differs from the reference by %f.", size, sign, max_error));
+		}
+
+		ma_fft_plan_uninit(&plan, NULL);
+	}
+}
+
+TEST_CASE("[Shinobu] Planned FFT round-trips") {
+	for (int size : TEST_FFT_SIZES) {
+		ma_fft_plan plan;
+		REQUIRE(ma_fft_plan_init(&plan, size, NULL) == MA_SUCCESS);
+
+		const LocalVector<float> input = random_complex_signal(size, size + 1);
+		LocalVector<float> buffer = input;
+		ma_fft_plan_execute(&plan, buffer.ptr(), -1);
+		ma_fft_plan_execute(&plan, buffer.ptr(), 1);
+
+		// The inverse transform is unscaled
+		float max_error = 0.0f;
+		for (uint32_t i = 0; i < buffer.size(); i++) {
+			max_error = MAX(max_error, Math::abs(buffer[i] / size - input[i]));
+		}
+		CHECK_MESSAGE(max_error < 1e-5f, vformat("Size %d: round trip is off by %f.", size, max_error));
+
+		ma_fft_plan_uninit(&plan, NULL);
+	}
+}
+
+TEST_CASE("[Shinobu] Planned FFT puts a tone in its bin") {
+	const int size = 1024;
+	const int tone_bin = 37;
+	ma_fft_plan plan;
+	REQUIRE(ma_fft_plan_init(&plan, size, NULL) == MA_SUCCESS);
+
+	// A real cosine shows up at its bin and the mirrored one, with half the amplitude each
+	LocalVector<float> buffer;
+	buffer.resize(size * 2);
+	for (int i = 0; i < size; i++) {
+		buffer[i * 2] = Math::cos(Math_TAU * tone_bin * i / size);
+		buffer[i * 2 + 1] = 0.0f;
+	}
+	ma_fft_plan_execute(&plan, buffer.ptr(), -1);
+
+	LocalVector<float> re;
+	LocalVector<float> im;
+	LocalVector<float> magnitudes;
+	re.resize(size);
+	im.resize(size);
+	magnitudes.resize(size);
+	for (int i = 0; i < size; i++) {
+		re[i] = buffer[i * 2];
+		im[i] = buffer[i * 2 + 1];
+	}
+	ma_fft_magnitudes(re.ptr(), im.ptr(), magnitudes.ptr(), size, 2.0f / size);
+
+	CHECK(magnitudes[tone_bin] == doctest::Approx(1.0).epsilon(1e-4));
+	CHECK(magnitudes[size - tone_bin] == doctest::Approx(1.0).epsilon(1e-4));
+	float leakage = 0.0f;
+	for (int i = 0; i < size; i++) {
+		if (i != tone_bin && i != size - tone_bin) {
+			leakage = MAX(leakage, magnitudes[i]);
+		}
+	}
+	CHECK(leakage < 1e-4f);
+
+	ma_fft_plan_uninit(&plan, NULL);
+}
+
+} // namespace TestShinobuFFT
+
+#endif // TEST_SHINOBU_FFT_H
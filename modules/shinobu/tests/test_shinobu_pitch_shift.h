@@ -0,0 +1,133 @@
+#ifndef TEST_SHINOBU_PITCH_SHIFT_H
+#define TEST_SHINOBU_PITCH_SHIFT_H
+
+#include "../shinobu_pitch_shift.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/templates/local_vector.h"
+#include "tests/test_macros.h"
+
+namespace TestShinobuPitchShift {
+
+static const uint32_t TEST_SAMPLE_RATE = 48000;
+static const uint32_t TEST_PERIOD_FRAMES = 512;
+
+// Runs a 440 Hz sine through a pitch shift node one period at a time like the audio thread does, returns the left channel
+// and optionally the time spent mixing the periods
+static LocalVector<float> shift_sine(int p_fft_size_index, float p_pitch_scale, uint32_t p_period_count, uint64_t *r_mix_usec = nullptr) {
+	ma_node_graph node_graph;
+	ma_node_graph_config node_graph_config = ma_node_graph_config_init(2);
+	REQUIRE(ma_node_graph_init(&node_graph_config, NULL, &node_graph) == MA_SUCCESS);
+
+	const uint32_t total_frames = TEST_PERIOD_FRAMES * p_period_count;
+	LocalVector<float> input;
+	input.resize(total_frames * 2);
+	for (uint32_t i = 0; i < total_frames; i++) {
+		input[i * 2] = Math::sin(Math_TAU * 440.0 * i / TEST_SAMPLE_RATE) * 0.5;
+		input[i * 2 + 1] = input[i * 2];
+	}
+
+	ma_audio_buffer_ref buffer_ref;
+	REQUIRE(ma_audio_buffer_ref_init(ma_format_f32, 2, input.ptr(), total_frames, &buffer_ref) == MA_SUCCESS);
+
+	ma_data_source_node source_node;
+	ma_data_source_node_config source_node_config = ma_data_source_node_config_init(&buffer_ref);
+	REQUIRE(ma_data_source_node_init(&node_graph, &source_node_config, NULL, &source_node) == MA_SUCCESS);
+
+	ma_pitch_shift_node pitch_shift_node;
+	ma_pitch_shift_node_config pitch_shift_config = ma_pitch_shift_node_config_init(TEST_SAMPLE_RATE);
+	pitch_shift_config.fftSize = (ma_sps_fft_size)p_fft_size_index;
+	REQUIRE(ma_pitch_shift_node_init(&node_graph, &pitch_shift_config, NULL, &pitch_shift_node) == MA_SUCCESS);
+	ma_pitch_shift_node_set_pitch_scale(&pitch_shift_node, p_pitch_scale);
+
+	ma_node_attach_output_bus(&source_node, 0, &pitch_shift_node, 0);
+	ma_node_attach_output_bus(&pitch_shift_node, 0, ma_node_graph_get_endpoint(&node_graph), 0);
+
+	LocalVector<float> period;
+	period.resize(TEST_PERIOD_FRAMES * 2);
+	LocalVector<float> output;
+	output.resize(total_frames);
+	uint64_t mix_usec = 0;
+	for (uint32_t i = 0; i < p_period_count; i++) {
+		const uint64_t start = OS::get_singleton()->get_ticks_usec();
+		ma_node_graph_read_pcm_frames(&node_graph, period.ptr(), TEST_PERIOD_FRAMES, NULL);
+		mix_usec += OS::get_singleton()->get_ticks_usec() - start;
+		for (uint32_t j = 0; j < TEST_PERIOD_FRAMES; j++) {
+			output[i * TEST_PERIOD_FRAMES + j] = period[j * 2];
+		}
+	}
+
+	if (r_mix_usec) {
+		*r_mix_usec = mix_usec;
+	}
+
+	ma_pitch_shift_node_uninit(&pitch_shift_node, NULL);
+	ma_data_source_node_uninit(&source_node, NULL);
+	ma_audio_buffer_ref_uninit(&buffer_ref);
+	ma_node_graph_uninit(&node_graph, NULL);
+	return output;
+}
+
+// Frequency from the rising zero crossings of the second half, once the STFT latency has passed
+static double measure_frequency(const LocalVector<float> &p_signal) {
+	int64_t first = -1;
+	int64_t last = -1;
+	int crossings = 0;
+	for (uint32_t i = p_signal.size() / 2 + 1; i < p_signal.size(); i++) {
+		if (p_signal[i - 1] < 0.0f && p_signal[i] >= 0.0f) {
+			first = first < 0 ? i : first;
+			last = i;
+			crossings++;
+		}
+	}
+	if (crossings < 2) {
+		return 0.0;
+	}
+	return (crossings - 1) * (double)TEST_SAMPLE_RATE / (last - first);
+}
+
+TEST_CASE("[Shinobu] Pitch shift buffers are sized to the FFT size") {
+	CHECK(ma_pitch_shift_node_get_block_size(256, 4) < ma_pitch_shift_node_get_block_size(2048, 4));
+	CHECK(ma_pitch_shift_node_get_block_size(2048, 4) < ma_pitch_shift_node_get_block_size(4096, 4));
+	CHECK(ma_pitch_shift_node_get_block_size(2048, 4) < ma_pitch_shift_node_get_block_size(2048, 32));
+	// The old fixed size state took 2 * 82k floats per channel regardless of configuration
+	CHECK(ma_pitch_shift_node_get_block_size(4096, 4) < 2 * 82 * 1024 * sizeof(float));
+}
+
+TEST_CASE("[Shinobu] Pitch shift scales the frequency of a sine") {
+	for (int fft_size_index = 0; fft_size_index < FFT_SIZE_MAX; fft_size_index++) {
+		for (float pitch_scale : { 1.5f, 0.75f }) {
+			const LocalVector<float> output = shift_sine(fft_size_index, pitch_scale, 94);
+
+			float peak = 0.0f;
+			bool finite = true;
+			for (uint32_t i = output.size() / 2; i < output.size(); i++) {
+				finite = finite && Math::is_finite(output[i]);
+				peak = MAX(peak, Math::abs(output[i]));
+			}
+			CHECK(finite);
+			CHECK_MESSAGE(peak > 0.1f, vformat("FFT size index %d, pitch scale %f: the shifted tone is silent.", fft_size_index, pitch_scale));
+			CHECK_MESSAGE(peak < 1.0f, vformat("FFT size index %d, pitch scale %f: the shifted tone clips.", fft_size_index, pitch_scale));
+			CHECK_MESSAGE(measure_frequency(output) == doctest::Approx(440.0 * pitch_scale).epsilon(0.01),
+					vformat("FFT size index %d, pitch scale %f: the steady state frequency is off.", fft_size_index, pitch_scale));
+		}
+	}
+}
+
+TEST_CASE("[Shinobu] Pitch shift cost per FFT size") {
+	const double period_usec = TEST_PERIOD_FRAMES * 1000000.0 / TEST_SAMPLE_RATE;
+	for (int fft_size_index = 0; fft_size_index < FFT_SIZE_MAX; fft_size_index++) {
+		const uint32_t period_count = 400;
+		uint64_t mix_usec = 0;
+		const LocalVector<float> output = shift_sine(fft_size_index, 1.5f, period_count, &mix_usec);
+		CHECK(measure_frequency(output) == doctest::Approx(660.0).epsilon(0.01));
+
+		const double usec_per_period = mix_usec / (double)period_count;
+		MESSAGE(vformat("FFT size index %d: %.1f usec per %d frame period, %.2f%% of the period budget", fft_size_index, usec_per_period, TEST_PERIOD_FRAMES, usec_per_period * 100.0 / period_usec));
+	}
+}
+
+} // namespace TestShinobuPitchShift
+
+#endif // TEST_SHINOBU_PITCH_SHIFT_H
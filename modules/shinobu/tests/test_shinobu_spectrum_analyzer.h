@@ -0,0 +1,87 @@
+#ifndef TEST_SHINOBU_SPECTRUM_ANALYZER_H
+#define TEST_SHINOBU_SPECTRUM_ANALYZER_H
+
+#include "../shinobu_spectrum_analyzer.h"
+
+#include "core/os/thread.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+#include "tests/test_macros.h"
+
+namespace TestShinobuSpectrumAnalyzer {
+
+static const int TEST_PUBLISHED_FRAMES = 20000;
+
+struct PublishTest {
+	ma_spectrum_analyzer_node *node = nullptr;
+	SafeFlag done;
+};
+
+// Plays the audio thread, every published spectrum has all of its bins set to its frame number
+static void publish_frames(void *p_userdata) {
+	PublishTest *test = (PublishTest *)p_userdata;
+	LocalVector<float> spectrum;
+	spectrum.resize(test->node->fftSize * 2);
+	for (int frame = 1; frame <= TEST_PUBLISHED_FRAMES; frame++) {
+		for (float &bin : spectrum) {
+			bin = frame;
+		}
+		ma_spectrum_analyzer_publish_spectrum(test->node, spectrum.ptr());
+	}
+	test->done.set();
+}
+
+TEST_CASE("[Shinobu] Spectrum analyzer readers see complete and latest spectra") {
+	ma_node_graph node_graph;
+	ma_node_graph_config node_graph_config = ma_node_graph_config_init(2);
+	REQUIRE(ma_node_graph_init(&node_graph_config, NULL, &node_graph) == MA_SUCCESS);
+
+	ma_spectrum_analyzer_node node;
+	ma_spectrum_analyzer_config config = ma_spectrum_analyzer_config_init(48000);
+	REQUIRE(ma_spectrum_analyzer_node_init(&node_graph, &config, NULL, &node) == MA_SUCCESS);
+	const int bin_count = node.fftSize * 2;
+
+	CHECK(ma_spectrum_analyzer_acquire_spectrum(&node) == nullptr);
+
+	PublishTest test;
+	test.node = &node;
+	Thread writer;
+	writer.start(publish_frames, &test);
+
+	bool complete = true;
+	bool ordered = true;
+	float last_frame = 0.0f;
+	int acquired = 0;
+	while (!test.done.is_set()) {
+		const float *spectrum = ma_spectrum_analyzer_acquire_spectrum(&node);
+		if (spectrum == nullptr) {
+			continue;
+		}
+		acquired++;
+		for (int i = 1; i < bin_count; i++) {
+			complete = complete && spectrum[i] == spectrum[0];
+		}
+		ordered = ordered && spectrum[0] >= last_frame;
+		last_frame = spectrum[0];
+	}
+	writer.wait_to_finish();
+
+	CHECK_MESSAGE(complete, "A spectrum was read while it was being written.");
+	CHECK_MESSAGE(ordered, "An older spectrum was read after a newer one.");
+	MESSAGE(vformat("%d spectra acquired while %d were published.", acquired, TEST_PUBLISHED_FRAMES));
+
+	// Once the writer is done the reader gets the last spectrum, and keeps it until a new one comes
+	for (int i = 0; i < 2; i++) {
+		const float *spectrum = ma_spectrum_analyzer_acquire_spectrum(&node);
+		REQUIRE(spectrum != nullptr);
+		CHECK(spectrum[0] == TEST_PUBLISHED_FRAMES);
+		CHECK(spectrum[bin_count - 1] == TEST_PUBLISHED_FRAMES);
+	}
+
+	ma_spectrum_analyzer_node_uninit(&node, NULL);
+	ma_node_graph_uninit(&node_graph, NULL);
+}
+
+} // namespace TestShinobuSpectrumAnalyzer
+
+#endif // TEST_SHINOBU_SPECTRUM_ANALYZER_H
@@ -0,0 +1,152 @@
+#ifndef TEST_SHINOBU_VOICE_POOL_H
+#define TEST_SHINOBU_VOICE_POOL_H
+
+#include "../shinobu.h"
+#include "../shinobu_sound_source.h"
+#include "../shinobu_voice_pool.h"
+
+#include "core/io/marshalls.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/local_vector.h"
+#include "tests/test_macros.h"
+
+namespace TestShinobuVoicePool {
+
+static const uint32_t TEST_SAMPLE_RATE = 48000;
+static const uint32_t TEST_SOUND_FRAMES = 4800;
+
+// Mono 16 bit PCM WAV file holding a constant signal
+static PackedByteArray make_wav(uint32_t p_frame_count) {
+	const uint32_t data_size = p_frame_count * 2;
+	PackedByteArray wav;
+	wav.resize(44 + data_size);
+	uint8_t *w = wav.ptrw();
+	memcpy(w, "RIFF", 4);
+	encode_uint32(36 + data_size, w + 4);
+	memcpy(w + 8, "WAVEfmt ", 8);
+	encode_uint32(16, w + 16);
+	encode_uint16(1, w + 20); // PCM
+	encode_uint16(1, w + 22); // Channels
+	encode_uint32(TEST_SAMPLE_RATE, w + 24);
+	encode_uint32(TEST_SAMPLE_RATE * 2, w + 28);
+	encode_uint16(2, w + 32); // Block align
+	encode_uint16(16, w + 34); // Bits per sample
+	memcpy(w + 36, "data", 4);
+	encode_uint32(data_size, w + 40);
+	for (uint32_t i = 0; i < p_frame_count; i++) {
+		encode_uint16(8192, w + 44 + i * 2);
+	}
+	return wav;
+}
+
+// Mixes p_frame_count frames on the offline engine, which is what moves engine time forward
+static void render(uint32_t p_frame_count) {
+	LocalVector<float> output;
+	output.resize(p_frame_count * 2);
+	ma_engine_read_pcm_frames(Shinobu::get_singleton()->get_engine(), output.ptr(), p_frame_count, NULL);
+}
+
+static Ref<ShinobuVoicePool> make_pool(int p_voice_count, ShinobuVoicePool::StealMode p_steal_mode) {
+	Shinobu *shinobu = Shinobu::get_singleton();
+	REQUIRE(shinobu != nullptr);
+	if (!shinobu->is_offline()) {
+		REQUIRE(shinobu->initialize_offline(TEST_SAMPLE_RATE) == OK);
+	}
+
+	Ref<ShinobuSoundSourceMemory> source = shinobu->register_sound_from_memory("voice_pool_test", make_wav(TEST_SOUND_FRAMES));
+	REQUIRE(source->get_result() == MA_SUCCESS);
+	Ref<ShinobuGroup> group = memnew(ShinobuGroup("voice_pool_test", Ref<ShinobuGroup>()));
+	Ref<ShinobuVoicePool> pool = source->instantiate_voice_pool(group, p_voice_count);
+	REQUIRE(pool->get_voice_count() == p_voice_count);
+	pool->set_steal_mode(p_steal_mode);
+	return pool;
+}
+
+TEST_CASE("[Shinobu] Voice pool allocates idle voices before stealing") {
+	for (ShinobuVoicePool::StealMode steal_mode : { ShinobuVoicePool::STEAL_ROUND_ROBIN, ShinobuVoicePool::STEAL_OLDEST }) {
+		Ref<ShinobuVoicePool> pool = make_pool(4, steal_mode);
+		CHECK(pool->get_active_voice_count() == 0);
+
+		// Every trigger gets its own voice while there are idle ones
+		HashSet<int> used;
+		for (int i = 0; i < 4; i++) {
+			const int voice = pool->play();
+			CHECK(voice >= 0);
+			CHECK_MESSAGE(!used.has(voice), vformat("Steal mode %d: voice %d was reused while others were idle.", steal_mode, voice));
+			used.insert(voice);
+			CHECK(pool->get_active_voice_count() == i + 1);
+			render(256);
+		}
+
+		// Release one voice by hand, the next trigger must take it instead of stealing a playing one
+		pool->stop_all();
+		CHECK(pool->get_active_voice_count() == 0);
+		const int first = pool->play();
+		render(256);
+		const int second = pool->play();
+		render(256);
+		CHECK(first != second);
+		CHECK(pool->get_active_voice_count() == 2);
+
+		pool->stop_all();
+	}
+}
+
+TEST_CASE("[Shinobu] Voice pool steals only when every voice is busy") {
+	{
+		Ref<ShinobuVoicePool> pool = make_pool(3, ShinobuVoicePool::STEAL_OLDEST);
+		LocalVector<int> order;
+		for (int i = 0; i < 3; i++) {
+			order.push_back(pool->play());
+			render(256);
+		}
+		// The oldest voice goes first, then the next oldest
+		CHECK(pool->play() == order[0]);
+		render(256);
+		CHECK(pool->play() == order[1]);
+		CHECK(pool->get_active_voice_count() == 3);
+		pool->stop_all();
+	}
+	{
+		Ref<ShinobuVoicePool> pool = make_pool(3, ShinobuVoicePool::STEAL_ROUND_ROBIN);
+		LocalVector<int> order;
+		for (int i = 0; i < 3; i++) {
+			order.push_back(pool->play());
+		}
+		CHECK(pool->play() == order[0]);
+		CHECK(pool->play() == order[1]);
+		CHECK(pool->play() == order[2]);
+		CHECK(pool->get_active_voice_count() == 3);
+		pool->stop_all();
+	}
+}
+
+TEST_CASE("[Shinobu] Voice pool releases voices that reached the end") {
+	Ref<ShinobuVoicePool> pool = make_pool(2, ShinobuVoicePool::STEAL_OLDEST);
+	const int first = pool->play();
+	render(TEST_SOUND_FRAMES / 2);
+	const int second = pool->play();
+	CHECK(first != second);
+	CHECK(pool->get_active_voice_count() == 2);
+
+	// The first voice ends half way through the second one and is free again
+	render(TEST_SOUND_FRAMES / 2 + 512);
+	CHECK(pool->get_active_voice_count() == 1);
+	CHECK(pool->play() == first);
+	CHECK(pool->get_active_voice_count() == 2);
+
+	render(TEST_SOUND_FRAMES * 2);
+	CHECK(pool->get_active_voice_count() == 0);
+
+	// Voices scheduled in the future count as busy before they start
+	const uint64_t now_msec = ma_engine_get_time(Shinobu::get_singleton()->get_engine()) * 1000 / TEST_SAMPLE_RATE;
+	const int scheduled = pool->play_at(now_msec + 1000);
+	CHECK(pool->get_active_voice_count() == 1);
+	CHECK(pool->play() != scheduled);
+	pool->stop_all();
+	CHECK(pool->get_active_voice_count() == 0);
+}
+
+} // namespace TestShinobuVoicePool
+
+#endif // TEST_SHINOBU_VOICE_POOL_H
@@ -64,6 +64,8 @@ public:
 		float hb2 = 0.0f;
 		Coeffs incr_coeffs;
 
+		friend class AudioMixKernels;
+
 	public:
 		void set_filter(AudioFilterSW *p_filter, bool p_clear_history = true);
 		void process(float *p_samples, int p_amount, int p_stride = 1, bool p_interpolate = false);
@@ -0,0 +1,295 @@
+/**************************************************************************/
+/*  audio_mix_kernels.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "audio_mix_kernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_MIX_KERNELS_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define AUDIO_MIX_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(AUDIO_MIX_KERNELS_SSE) || defined(AUDIO_MIX_KERNELS_NEON)
+AudioMixKernels::MixRampFunc AudioMixKernels::mix_ramp_func = AudioMixKernels::_mix_ramp_simd;
+AudioMixKernels::MixRampFilteredFunc AudioMixKernels::mix_ramp_filtered_func = AudioMixKernels::_mix_ramp_filtered_simd;
+#else
+AudioMixKernels::MixRampFunc AudioMixKernels::mix_ramp_func = AudioMixKernels::_mix_ramp_scalar;
+AudioMixKernels::MixRampFilteredFunc AudioMixKernels::mix_ramp_filtered_func = AudioMixKernels::_mix_ramp_filtered_scalar;
+#endif
+
+bool AudioMixKernels::is_simd_available() {
+#if defined(AUDIO_MIX_KERNELS_SSE) || defined(AUDIO_MIX_KERNELS_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AudioMixKernels::set_simd_enabled(bool p_enabled) {
+	if (p_enabled && is_simd_available()) {
+		mix_ramp_func = _mix_ramp_simd;
+		mix_ramp_filtered_func = _mix_ramp_filtered_simd;
+	} else {
+		mix_ramp_func = _mix_ramp_scalar;
+		mix_ramp_filtered_func = _mix_ramp_filtered_scalar;
+	}
+}
+
+bool AudioMixKernels::is_simd_enabled() {
+	return mix_ramp_func == _mix_ramp_simd;
+}
+
+void AudioMixKernels::_mix_ramp_scalar(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames) {
+	for (uint32_t i = 0; i < p_frames; i++) {
+		float lerp_param = (float)i / p_frames;
+		r_dst[i] += (p_vol_final * lerp_param + (1 - lerp_param) * p_vol_start) * p_src[i];
+	}
+}
+
+void AudioMixKernels::_mix_ramp_filtered_scalar(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r) {
+	for (uint32_t i = 0; i < p_frames; i++) {
+		float lerp_param = (float)i / p_frames;
+		AudioFrame vol = p_vol_final * lerp_param + (1 - lerp_param) * p_vol_start;
+		AudioFrame mixed = vol * p_src[i];
+		p_processor_l->process_one_interp(mixed.left);
+		p_processor_r->process_one_interp(mixed.right);
+		r_dst[i] += mixed;
+	}
+}
+
+#if defined(AUDIO_MIX_KERNELS_SSE)
+
+void AudioMixKernels::_mix_ramp_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames) {
+	// Two frames per register. Multiplying by the inverse is exact for the usual power of two buffer sizes.
+	const __m128 start = _mm_setr_ps(p_vol_start.left, p_vol_start.right, p_vol_start.left, p_vol_start.right);
+	const __m128 final = _mm_setr_ps(p_vol_final.left, p_vol_final.right, p_vol_final.left, p_vol_final.right);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 four = _mm_set1_ps(4.0f);
+	const __m128 inv_frames = _mm_set1_ps(1.0f / p_frames);
+	// Two independent indices, so the increments don't serialize the loop.
+	__m128 index_a = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+	__m128 index_b = _mm_setr_ps(2.0f, 2.0f, 3.0f, 3.0f);
+
+	float *dst = (float *)r_dst;
+	const float *src = (const float *)p_src;
+	uint32_t i = 0;
+	for (; i + 4 <= p_frames; i += 4) {
+		const __m128 t_a = _mm_mul_ps(index_a, inv_frames);
+		const __m128 t_b = _mm_mul_ps(index_b, inv_frames);
+		const __m128 vol_a = _mm_add_ps(_mm_mul_ps(final, t_a), _mm_mul_ps(_mm_sub_ps(one, t_a), start));
+		const __m128 vol_b = _mm_add_ps(_mm_mul_ps(final, t_b), _mm_mul_ps(_mm_sub_ps(one, t_b), start));
+		_mm_storeu_ps(dst + i * 2, _mm_add_ps(_mm_loadu_ps(dst + i * 2), _mm_mul_ps(vol_a, _mm_loadu_ps(src + i * 2))));
+		_mm_storeu_ps(dst + i * 2 + 4, _mm_add_ps(_mm_loadu_ps(dst + i * 2 + 4), _mm_mul_ps(vol_b, _mm_loadu_ps(src + i * 2 + 4))));
+		index_a = _mm_add_ps(index_a, four);
+		index_b = _mm_add_ps(index_b, four);
+	}
+	for (; i < p_frames; i++) {
+		float lerp_param = (float)i / p_frames;
+		r_dst[i] += (p_vol_final * lerp_param + (1 - lerp_param) * p_vol_start) * p_src[i];
+	}
+}
+
+void AudioMixKernels::_mix_ramp_filtered_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r) {
+	// The biquad feeds back on itself, so left and right run side by side in the low half of one register.
+	AudioFilterSW::Processor &l = *p_processor_l;
+	AudioFilterSW::Processor &r = *p_processor_r;
+	__m128 b0 = _mm_setr_ps(l.coeffs.b0, r.coeffs.b0, 0.0f, 0.0f);
+	__m128 b1 = _mm_setr_ps(l.coeffs.b1, r.coeffs.b1, 0.0f, 0.0f);
+	__m128 b2 = _mm_setr_ps(l.coeffs.b2, r.coeffs.b2, 0.0f, 0.0f);
+	__m128 a1 = _mm_setr_ps(l.coeffs.a1, r.coeffs.a1, 0.0f, 0.0f);
+	__m128 a2 = _mm_setr_ps(l.coeffs.a2, r.coeffs.a2, 0.0f, 0.0f);
+	const __m128 incr_b0 = _mm_setr_ps(l.incr_coeffs.b0, r.incr_coeffs.b0, 0.0f, 0.0f);
+	const __m128 incr_b1 = _mm_setr_ps(l.incr_coeffs.b1, r.incr_coeffs.b1, 0.0f, 0.0f);
+	const __m128 incr_b2 = _mm_setr_ps(l.incr_coeffs.b2, r.incr_coeffs.b2, 0.0f, 0.0f);
+	const __m128 incr_a1 = _mm_setr_ps(l.incr_coeffs.a1, r.incr_coeffs.a1, 0.0f, 0.0f);
+	const __m128 incr_a2 = _mm_setr_ps(l.incr_coeffs.a2, r.incr_coeffs.a2, 0.0f, 0.0f);
+	__m128 ha1 = _mm_setr_ps(l.ha1, r.ha1, 0.0f, 0.0f);
+	__m128 ha2 = _mm_setr_ps(l.ha2, r.ha2, 0.0f, 0.0f);
+	__m128 hb1 = _mm_setr_ps(l.hb1, r.hb1, 0.0f, 0.0f);
+	__m128 hb2 = _mm_setr_ps(l.hb2, r.hb2, 0.0f, 0.0f);
+
+	const __m128 start = _mm_setr_ps(p_vol_start.left, p_vol_start.right, 0.0f, 0.0f);
+	const __m128 final = _mm_setr_ps(p_vol_final.left, p_vol_final.right, 0.0f, 0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (uint32_t i = 0; i < p_frames; i++) {
+		const __m128 t = _mm_set1_ps((float)i / p_frames);
+		const __m128 vol = _mm_add_ps(_mm_mul_ps(final, t), _mm_mul_ps(_mm_sub_ps(one, t), start));
+		const __m128 x = _mm_mul_ps(vol, _mm_castpd_ps(_mm_load_sd((const double *)(p_src + i))));
+		// Same evaluation order as AudioFilterSW::Processor::process_one_interp().
+		__m128 y = _mm_mul_ps(x, b0);
+		y = _mm_add_ps(y, _mm_mul_ps(hb1, b1));
+		y = _mm_add_ps(y, _mm_mul_ps(hb2, b2));
+		y = _mm_add_ps(y, _mm_mul_ps(ha1, a1));
+		y = _mm_add_ps(y, _mm_mul_ps(ha2, a2));
+		ha2 = ha1;
+		hb2 = hb1;
+		hb1 = x;
+		ha1 = y;
+
+		b0 = _mm_add_ps(b0, incr_b0);
+		b1 = _mm_add_ps(b1, incr_b1);
+		b2 = _mm_add_ps(b2, incr_b2);
+		a1 = _mm_add_ps(a1, incr_a1);
+		a2 = _mm_add_ps(a2, incr_a2);
+
+		double *dst = (double *)(r_dst + i);
+		_mm_store_sd(dst, _mm_castps_pd(_mm_add_ps(_mm_castpd_ps(_mm_load_sd(dst)), y)));
+	}
+
+	float values[4];
+#define STORE_LANES(m_register, m_field) \
+	_mm_storeu_ps(values, m_register);   \
+	l.m_field = values[0];               \
+	r.m_field = values[1];
+	STORE_LANES(b0, coeffs.b0);
+	STORE_LANES(b1, coeffs.b1);
+	STORE_LANES(b2, coeffs.b2);
+	STORE_LANES(a1, coeffs.a1);
+	STORE_LANES(a2, coeffs.a2);
+	STORE_LANES(ha1, ha1);
+	STORE_LANES(ha2, ha2);
+	STORE_LANES(hb1, hb1);
+	STORE_LANES(hb2, hb2);
+#undef STORE_LANES
+}
+
+#elif defined(AUDIO_MIX_KERNELS_NEON)
+
+void AudioMixKernels::_mix_ramp_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames) {
+	// Two frames per register. Multiplying by the inverse is exact for the usual power of two buffer sizes.
+	const float start_values[4] = { p_vol_start.left, p_vol_start.right, p_vol_start.left, p_vol_start.right };
+	const float final_values[4] = { p_vol_final.left, p_vol_final.right, p_vol_final.left, p_vol_final.right };
+	const float index_values[8] = { 0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f };
+	const float32x4_t start = vld1q_f32(start_values);
+	const float32x4_t final = vld1q_f32(final_values);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t four = vdupq_n_f32(4.0f);
+	const float32x4_t inv_frames = vdupq_n_f32(1.0f / p_frames);
+	// Two independent indices, so the increments don't serialize the loop.
+	float32x4_t index_a = vld1q_f32(index_values);
+	float32x4_t index_b = vld1q_f32(index_values + 4);
+
+	float *dst = (float *)r_dst;
+	const float *src = (const float *)p_src;
+	uint32_t i = 0;
+	for (; i + 4 <= p_frames; i += 4) {
+		const float32x4_t t_a = vmulq_f32(index_a, inv_frames);
+		const float32x4_t t_b = vmulq_f32(index_b, inv_frames);
+		const float32x4_t vol_a = vaddq_f32(vmulq_f32(final, t_a), vmulq_f32(vsubq_f32(one, t_a), start));
+		const float32x4_t vol_b = vaddq_f32(vmulq_f32(final, t_b), vmulq_f32(vsubq_f32(one, t_b), start));
+		vst1q_f32(dst + i * 2, vaddq_f32(vld1q_f32(dst + i * 2), vmulq_f32(vol_a, vld1q_f32(src + i * 2))));
+		vst1q_f32(dst + i * 2 + 4, vaddq_f32(vld1q_f32(dst + i * 2 + 4), vmulq_f32(vol_b, vld1q_f32(src + i * 2 + 4))));
+		index_a = vaddq_f32(index_a, four);
+		index_b = vaddq_f32(index_b, four);
+	}
+	for (; i < p_frames; i++) {
+		float lerp_param = (float)i / p_frames;
+		r_dst[i] += (p_vol_final * lerp_param + (1 - lerp_param) * p_vol_start) * p_src[i];
+	}
+}
+
+void AudioMixKernels::_mix_ramp_filtered_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r) {
+	// The biquad feeds back on itself, so left and right run side by side in one register.
+	AudioFilterSW::Processor &l = *p_processor_l;
+	AudioFilterSW::Processor &r = *p_processor_r;
+#define LOAD_LANES(m_field) vset_lane_f32(r.m_field, vdup_n_f32(l.m_field), 1)
+	float32x2_t b0 = LOAD_LANES(coeffs.b0);
+	float32x2_t b1 = LOAD_LANES(coeffs.b1);
+	float32x2_t b2 = LOAD_LANES(coeffs.b2);
+	float32x2_t a1 = LOAD_LANES(coeffs.a1);
+	float32x2_t a2 = LOAD_LANES(coeffs.a2);
+	const float32x2_t incr_b0 = LOAD_LANES(incr_coeffs.b0);
+	const float32x2_t incr_b1 = LOAD_LANES(incr_coeffs.b1);
+	const float32x2_t incr_b2 = LOAD_LANES(incr_coeffs.b2);
+	const float32x2_t incr_a1 = LOAD_LANES(incr_coeffs.a1);
+	const float32x2_t incr_a2 = LOAD_LANES(incr_coeffs.a2);
+	float32x2_t ha1 = LOAD_LANES(ha1);
+	float32x2_t ha2 = LOAD_LANES(ha2);
+	float32x2_t hb1 = LOAD_LANES(hb1);
+	float32x2_t hb2 = LOAD_LANES(hb2);
+#undef LOAD_LANES
+
+	const float32x2_t start = vld1_f32(p_vol_start.levels);
+	const float32x2_t final = vld1_f32(p_vol_final.levels);
+	const float32x2_t one = vdup_n_f32(1.0f);
+
+	for (uint32_t i = 0; i < p_frames; i++) {
+		const float32x2_t t = vdup_n_f32((float)i / p_frames);
+		const float32x2_t vol = vadd_f32(vmul_f32(final, t), vmul_f32(vsub_f32(one, t), start));
+		const float32x2_t x = vmul_f32(vol, vld1_f32(p_src[i].levels));
+		// Same evaluation order as AudioFilterSW::Processor::process_one_interp(), without fused multiply-adds.
+		float32x2_t y = vmul_f32(x, b0);
+		y = vadd_f32(y, vmul_f32(hb1, b1));
+		y = vadd_f32(y, vmul_f32(hb2, b2));
+		y = vadd_f32(y, vmul_f32(ha1, a1));
+		y = vadd_f32(y, vmul_f32(ha2, a2));
+		ha2 = ha1;
+		hb2 = hb1;
+		hb1 = x;
+		ha1 = y;
+
+		b0 = vadd_f32(b0, incr_b0);
+		b1 = vadd_f32(b1, incr_b1);
+		b2 = vadd_f32(b2, incr_b2);
+		a1 = vadd_f32(a1, incr_a1);
+		a2 = vadd_f32(a2, incr_a2);
+
+		vst1_f32(r_dst[i].levels, vadd_f32(vld1_f32(r_dst[i].levels), y));
+	}
+
+#define STORE_LANES(m_register, m_field)        \
+	l.m_field = vget_lane_f32(m_register, 0); \
+	r.m_field = vget_lane_f32(m_register, 1);
+	STORE_LANES(b0, coeffs.b0);
+	STORE_LANES(b1, coeffs.b1);
+	STORE_LANES(b2, coeffs.b2);
+	STORE_LANES(a1, coeffs.a1);
+	STORE_LANES(a2, coeffs.a2);
+	STORE_LANES(ha1, ha1);
+	STORE_LANES(ha2, ha2);
+	STORE_LANES(hb1, hb1);
+	STORE_LANES(hb2, hb2);
+#undef STORE_LANES
+}
+
+#else
+
+void AudioMixKernels::_mix_ramp_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames) {
+	_mix_ramp_scalar(r_dst, p_src, p_vol_start, p_vol_final, p_frames);
+}
+
+void AudioMixKernels::_mix_ramp_filtered_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r) {
+	_mix_ramp_filtered_scalar(r_dst, p_src, p_vol_start, p_vol_final, p_frames, p_processor_l, p_processor_r);
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*  audio_mix_kernels.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef AUDIO_MIX_KERNELS_H
+#define AUDIO_MIX_KERNELS_H
+
+#include "core/math/audio_frame.h"
+#include "servers/audio/audio_filter_sw.h"
+
+// Inner loops run for every playback on every bus channel each mix step.
+// SSE or NEON versions are used when the target has them, the scalar ones can be selected at runtime for comparison.
+class AudioMixKernels {
+public:
+	typedef void (*MixRampFunc)(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames);
+	typedef void (*MixRampFilteredFunc)(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r);
+
+private:
+	static MixRampFunc mix_ramp_func;
+	static MixRampFilteredFunc mix_ramp_filtered_func;
+
+	static void _mix_ramp_scalar(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames);
+	static void _mix_ramp_filtered_scalar(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r);
+	static void _mix_ramp_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames);
+	static void _mix_ramp_filtered_simd(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r);
+
+public:
+	static bool is_simd_available();
+	// Falls back to the scalar kernels when the target has no SIMD version.
+	static void set_simd_enabled(bool p_enabled);
+	static bool is_simd_enabled();
+
+	// Adds p_src to r_dst, with the volume going linearly from p_vol_start towards p_vol_final over p_frames.
+	_FORCE_INLINE_ static void mix_ramp(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames) {
+		mix_ramp_func(r_dst, p_src, p_vol_start, p_vol_final, p_frames);
+	}
+	// Same as mix_ramp, but runs each side through its processor's interpolated biquad before adding it.
+	_FORCE_INLINE_ static void mix_ramp_filtered(AudioFrame *r_dst, const AudioFrame *p_src, AudioFrame p_vol_start, AudioFrame p_vol_final, uint32_t p_frames, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r) {
+		mix_ramp_filtered_func(r_dst, p_src, p_vol_start, p_vol_final, p_frames, p_processor_l, p_processor_r);
+	}
+};
+
+#endif // AUDIO_MIX_KERNELS_H
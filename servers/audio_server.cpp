@@ -42,6 +42,7 @@
 #include "scene/resources/audio_stream_wav.h"
 #include "scene/scene_string_names.h"
 #include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_mix_kernels.h"
 #include "servers/audio/effects/audio_effect_compressor.h"
 
 #include <cstring>
@@ -517,134 +518,292 @@ void AudioServer::_mix_step() {
 		}
 	}
 
-	for (int i = buses.size() - 1; i >= 0; i--) {
-		//go bus by bus
-		Bus *bus = buses[i];
+	_update_bus_sends();
 
-		for (int k = 0; k < bus->channels.size(); k++) {
-			if (bus->channels[k].active && !bus->channels[k].used) {
-				//buffer was not used, but it's still active, so it must be cleaned
-				AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+	if (!bus_workers.is_empty() && buses.size() >= parallel_bus_min_count) {
+		_update_bus_levels();
+		bus_work_solo_mode = solo_mode;
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					buf[j] = AudioFrame(0, 0);
-				}
+		for (uint32_t level = 0; level + 1 < bus_level_offsets.size(); level++) {
+			const uint32_t count = bus_level_offsets[level + 1] - bus_level_offsets[level];
+			const int *level_buses = bus_levels.ptr() + bus_level_offsets[level];
+			if (count == 1) {
+				_mix_step_bus(level_buses[0], solo_mode, temp_buffer);
+				continue;
+			}
+
+			bus_work = level_buses;
+			bus_work_count = count;
+			bus_work_next.set(0);
+			bus_workers_done.set(0);
+			// This thread takes jobs too, so it needs one worker less than there are buses.
+			bus_workers_woken = MIN(bus_workers.size(), count - 1);
+			bus_work_semaphore.post(bus_workers_woken);
+
+			_process_bus_work(temp_buffer);
+
+			if (bus_workers_woken > 0) {
+				bus_level_semaphore.wait();
 			}
 		}
+	} else {
+		for (int i = buses.size() - 1; i >= 0; i--) {
+			_mix_step_bus(i, solo_mode, temp_buffer);
+		}
+	}
 
-		//process effects
-		if (!bus->bypass) {
-			for (int j = 0; j < bus->effects.size(); j++) {
-				if (!bus->effects[j].enabled) {
-					continue;
-				}
+	mix_frames += buffer_size;
+	to_mix = buffer_size;
+}
+
+void AudioServer::_mix_step_bus(int p_bus, bool p_solo_mode, Vector<Vector<AudioFrame>> &r_temp_buffer) {
+	Bus *bus = buses[p_bus];
+
+	// Sends are pulled by the receiving bus, highest index first like the buses used to push them.
+	for (int sender_index = bus->first_sender; sender_index != -1; sender_index = buses[sender_index]->next_sender) {
+		const Bus *sender = buses[sender_index];
+		for (int k = 0; k < sender->channels.size(); k++) {
+			if (!sender->channels[k].sending) {
+				continue;
+			}
+			AudioFrame *target_buf = _get_bus_channel_mix_buffer(bus, k);
+			const AudioFrame *buf = sender->channels[k].buffer.ptr();
+
+			for (uint32_t j = 0; j < buffer_size; j++) {
+				target_buf[j] += buf[j];
+			}
+		}
+	}
+
+	for (int k = 0; k < bus->channels.size(); k++) {
+		if (bus->channels[k].active && !bus->channels[k].used) {
+			//buffer was not used, but it's still active, so it must be cleaned
+			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+
+			for (uint32_t j = 0; j < buffer_size; j++) {
+				buf[j] = AudioFrame(0, 0);
+			}
+		}
+	}
+
+	//process effects
+	if (!bus->bypass) {
+		for (int j = 0; j < bus->effects.size(); j++) {
+			if (!bus->effects[j].enabled) {
+				continue;
+			}
 
 #ifdef DEBUG_ENABLED
-				uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+			uint64_t ticks = OS::get_singleton()->get_ticks_usec();
 #endif
 
-				for (int k = 0; k < bus->channels.size(); k++) {
-					if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
-						continue;
-					}
-					bus->channels.write[k].effect_instances.write[j]->process(bus->channels[k].buffer.ptr(), temp_buffer.write[k].ptrw(), buffer_size);
+			for (int k = 0; k < bus->channels.size(); k++) {
+				if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
+					continue;
 				}
+				bus->channels.write[k].effect_instances.write[j]->process(bus->channels[k].buffer.ptr(), r_temp_buffer.write[k].ptrw(), buffer_size);
+			}
 
-				//swap buffers, so internal buffer always has the right data
-				for (int k = 0; k < bus->channels.size(); k++) {
-					if (!(buses[i]->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
-						continue;
-					}
-					SWAP(bus->channels.write[k].buffer, temp_buffer.write[k]);
+			//swap buffers, so internal buffer always has the right data
+			for (int k = 0; k < bus->channels.size(); k++) {
+				if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
+					continue;
 				}
+				SWAP(bus->channels.write[k].buffer, r_temp_buffer.write[k]);
+			}
 
 #ifdef DEBUG_ENABLED
-				bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - ticks;
+			bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - ticks;
 #endif
-			}
 		}
+	}
 
-		//process send
+	for (int k = 0; k < bus->channels.size(); k++) {
+		bus->channels.write[k].sending = false;
+		if (!bus->channels[k].active) {
+			bus->channels.write[k].peak_volume = AudioFrame(AUDIO_MIN_PEAK_DB, AUDIO_MIN_PEAK_DB);
+			continue;
+		}
 
-		Bus *send = nullptr;
+		AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
 
-		if (i > 0) {
-			//everything has a send save for master bus
-			if (!bus_map.has(bus->send)) {
-				send = buses[0];
-			} else {
-				send = bus_map[bus->send];
-				if (send->index_cache >= bus->index_cache) { //invalid, send to master
-					send = buses[0];
-				}
+		AudioFrame peak = AudioFrame(0, 0);
+
+		float volume = Math::db_to_linear(bus->volume_db);
+
+		if (p_solo_mode) {
+			if (!bus->soloed) {
+				volume = 0.0;
+			}
+		} else {
+			if (bus->mute) {
+				volume = 0.0;
 			}
 		}
 
-		for (int k = 0; k < bus->channels.size(); k++) {
-			if (!bus->channels[k].active) {
-				bus->channels.write[k].peak_volume = AudioFrame(AUDIO_MIN_PEAK_DB, AUDIO_MIN_PEAK_DB);
-				continue;
-			}
+		//apply volume and compute peak
+		for (uint32_t j = 0; j < buffer_size; j++) {
+			buf[j] *= volume;
 
-			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+			float l = ABS(buf[j].left);
+			if (l > peak.left) {
+				peak.left = l;
+			}
+			float r = ABS(buf[j].right);
+			if (r > peak.right) {
+				peak.right = r;
+			}
+		}
 
-			AudioFrame peak = AudioFrame(0, 0);
+		bus->channels.write[k].peak_volume = AudioFrame(Math::linear_to_db(peak.left + AUDIO_PEAK_OFFSET), Math::linear_to_db(peak.right + AUDIO_PEAK_OFFSET));
 
-			float volume = Math::db_to_linear(bus->volume_db);
+		if (!bus->channels[k].used) {
+			//see if any audio is contained, because channel was not used
 
-			if (solo_mode) {
-				if (!bus->soloed) {
-					volume = 0.0;
-				}
-			} else {
-				if (bus->mute) {
-					volume = 0.0;
-				}
+			if (MAX(peak.right, peak.left) > Math::db_to_linear(channel_disable_threshold_db)) {
+				bus->channels.write[k].last_mix_with_audio = mix_frames;
+			} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
+				bus->channels.write[k].active = false;
+				continue; //went inactive, don't mix.
 			}
+		}
 
-			//apply volume and compute peak
-			for (uint32_t j = 0; j < buffer_size; j++) {
-				buf[j] *= volume;
+		// Everything has a send save for master bus.
+		bus->channels.write[k].sending = p_bus > 0;
+	}
+}
 
-				float l = ABS(buf[j].left);
-				if (l > peak.left) {
-					peak.left = l;
-				}
-				float r = ABS(buf[j].right);
-				if (r > peak.right) {
-					peak.right = r;
-				}
-			}
+void AudioServer::_update_bus_sends() {
+	if (buses.is_empty()) {
+		return;
+	}
 
-			bus->channels.write[k].peak_volume = AudioFrame(Math::linear_to_db(peak.left + AUDIO_PEAK_OFFSET), Math::linear_to_db(peak.right + AUDIO_PEAK_OFFSET));
+	for (int i = 0; i < buses.size(); i++) {
+		buses[i]->first_sender = -1;
+		buses[i]->next_sender = -1;
+	}
+	buses[0]->send_index = -1;
 
-			if (!bus->channels[k].used) {
-				//see if any audio is contained, because channel was not used
+	// Going up and prepending leaves every sender list sorted from the highest index down.
+	for (int i = 1; i < buses.size(); i++) {
+		Bus *bus = buses[i];
+		int send_index = 0;
+		Bus **send = bus_map.getptr(bus->send);
+		if (send && (*send)->index_cache < bus->index_cache) {
+			//anything else is invalid, send to master
+			send_index = (*send)->index_cache;
+		}
 
-				if (MAX(peak.right, peak.left) > Math::db_to_linear(channel_disable_threshold_db)) {
-					bus->channels.write[k].last_mix_with_audio = mix_frames;
-				} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
-					bus->channels.write[k].active = false;
-					continue; //went inactive, don't mix.
-				}
-			}
+		bus->send_index = send_index;
+		bus->next_sender = buses[send_index]->first_sender;
+		buses[send_index]->first_sender = i;
+	}
+}
 
-			if (send) {
-				//if not master bus, send
-				AudioFrame *target_buf = thread_get_channel_mix_buffer(send->index_cache, k);
+void AudioServer::_update_bus_levels() {
+	// A bus can be processed once everything sending to it is, its depth is the longest chain of sends above it.
+	const int bus_count = buses.size();
+	bus_depths.resize(bus_count);
+	int max_depth = 0;
+	for (int i = bus_count - 1; i >= 0; i--) {
+		int depth = 0;
+		for (int sender_index = buses[i]->first_sender; sender_index != -1; sender_index = buses[sender_index]->next_sender) {
+			depth = MAX(depth, bus_depths[sender_index] + 1);
+		}
+		bus_depths[i] = depth;
+		max_depth = MAX(max_depth, depth);
+	}
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					target_buf[j] += buf[j];
-				}
-			}
+	bus_level_offsets.resize(max_depth + 2);
+	for (uint32_t i = 0; i < bus_level_offsets.size(); i++) {
+		bus_level_offsets[i] = 0;
+	}
+	for (int i = 0; i < bus_count; i++) {
+		bus_level_offsets[bus_depths[i] + 1]++;
+	}
+	for (int i = 0; i <= max_depth; i++) {
+		bus_level_offsets[i + 1] += bus_level_offsets[i];
+	}
+
+	bus_levels.resize(bus_count);
+	for (int i = bus_count - 1; i >= 0; i--) {
+		bus_levels[bus_level_offsets[bus_depths[i]]++] = i;
+	}
+	// Filling moved every offset to the start of the next level.
+	for (int i = max_depth; i > 0; i--) {
+		bus_level_offsets[i] = bus_level_offsets[i - 1];
+	}
+	bus_level_offsets[0] = 0;
+}
+
+void AudioServer::_process_bus_work(Vector<Vector<AudioFrame>> &r_temp_buffer) {
+	uint32_t work_index = bus_work_next.postincrement();
+	while (work_index < bus_work_count) {
+		_mix_step_bus(bus_work[work_index], bus_work_solo_mode, r_temp_buffer);
+		work_index = bus_work_next.postincrement();
+	}
+}
+
+void AudioServer::_bus_worker_thread(void *p_userdata) {
+	BusWorker *worker = (BusWorker *)p_userdata;
+	AudioServer *server = singleton;
+	Thread::set_name("Audio Bus Worker");
+
+	while (true) {
+		server->bus_work_semaphore.wait();
+		if (server->bus_workers_exit.is_set()) {
+			break;
+		}
+		server->_process_bus_work(worker->temp_buffer);
+		// Only the workers woken for this level check out, the audio thread waits for the last one.
+		if (server->bus_workers_done.increment() == server->bus_workers_woken) {
+			server->bus_level_semaphore.post();
 		}
 	}
+}
 
-	mix_frames += buffer_size;
-	to_mix = buffer_size;
+void AudioServer::_start_bus_workers(int p_threads) {
+	bus_workers_exit.clear();
+	for (int i = 0; i < p_threads; i++) {
+		BusWorker *worker = memnew(BusWorker);
+		worker->temp_buffer.resize(channel_count);
+		for (int j = 0; j < channel_count; j++) {
+			worker->temp_buffer.write[j].resize(buffer_size);
+		}
+		Thread::Settings settings;
+		settings.priority = Thread::PRIORITY_HIGH;
+		worker->thread.start(_bus_worker_thread, worker, settings);
+		bus_workers.push_back(worker);
+	}
+}
+
+void AudioServer::_stop_bus_workers() {
+	if (bus_workers.is_empty()) {
+		return;
+	}
+	bus_workers_exit.set();
+	bus_work_semaphore.post(bus_workers.size());
+	for (BusWorker *worker : bus_workers) {
+		worker->thread.wait_to_finish();
+		memdelete(worker);
+	}
+	bus_workers.clear();
+}
+
+void AudioServer::set_parallel_bus_processing(int p_threads, int p_min_buses) {
+	ERR_FAIL_COND(p_threads < 0);
+	// Holding the lock guarantees the workers are idle, waiting for the next mix.
+	lock();
+	_stop_bus_workers();
+	parallel_bus_min_count = p_min_buses;
+	if (p_min_buses > 0) {
+		_start_bus_workers(p_threads);
+	}
+	unlock();
 }
 
 void AudioServer::_mix_step_for_channel(AudioFrame *p_out_buf, AudioFrame *p_source_buf, AudioFrame p_vol_start, AudioFrame p_vol_final, float p_attenuation_filter_cutoff_hz, float p_highshelf_gain, AudioFilterSW::Processor *p_processor_l, AudioFilterSW::Processor *p_processor_r) {
+	// The volume ramps over the whole buffer, make this buffer size invariant if buffer_size ever becomes a project setting.
 	if (p_highshelf_gain != 0) {
 		AudioFilterSW filter;
 		filter.set_mode(AudioFilterSW::HIGHSHELF);
@@ -663,22 +822,9 @@ void AudioServer::_mix_step_for_channel(AudioFrame *p_out_buf, AudioFrame *p_sou
 		p_processor_r->set_filter(&filter, /* clear_history= */ is_just_started);
 		p_processor_r->update_coeffs(buffer_size);
 
-		for (unsigned int frame_idx = 0; frame_idx < buffer_size; frame_idx++) {
-			// Make this buffer size invariant if buffer_size ever becomes a project setting.
-			float lerp_param = (float)frame_idx / buffer_size;
-			AudioFrame vol = p_vol_final * lerp_param + (1 - lerp_param) * p_vol_start;
-			AudioFrame mixed = vol * p_source_buf[frame_idx];
-			p_processor_l->process_one_interp(mixed.left);
-			p_processor_r->process_one_interp(mixed.right);
-			p_out_buf[frame_idx] += mixed;
-		}
-
+		AudioMixKernels::mix_ramp_filtered(p_out_buf, p_source_buf, p_vol_start, p_vol_final, buffer_size, p_processor_l, p_processor_r);
 	} else {
-		for (unsigned int frame_idx = 0; frame_idx < buffer_size; frame_idx++) {
-			// Make this buffer size invariant if buffer_size ever becomes a project setting.
-			float lerp_param = (float)frame_idx / buffer_size;
-			p_out_buf[frame_idx] += (p_vol_final * lerp_param + (1 - lerp_param) * p_vol_start) * p_source_buf[frame_idx];
-		}
+		AudioMixKernels::mix_ramp(p_out_buf, p_source_buf, p_vol_start, p_vol_final, buffer_size);
 	}
 }
 
@@ -705,12 +851,18 @@ AudioFrame *AudioServer::thread_get_channel_mix_buffer(int p_bus, int p_buffer)
 	ERR_FAIL_INDEX_V(p_bus, buses.size(), nullptr);
 	ERR_FAIL_INDEX_V(p_buffer, buses[p_bus]->channels.size(), nullptr);
 
-	AudioFrame *data = buses.write[p_bus]->channels.write[p_buffer].buffer.ptrw();
+	return _get_bus_channel_mix_buffer(buses[p_bus], p_buffer);
+}
+
+AudioFrame *AudioServer::_get_bus_channel_mix_buffer(Bus *p_bus, int p_channel) {
+	// Doesn't touch the bus list, so bus workers can call it for the buses they own.
+	Bus::Channel &channel = p_bus->channels.write[p_channel];
+	AudioFrame *data = channel.buffer.ptrw();
 
-	if (!buses[p_bus]->channels[p_buffer].used) {
-		buses.write[p_bus]->channels.write[p_buffer].used = true;
-		buses.write[p_bus]->channels.write[p_buffer].active = true;
-		buses.write[p_bus]->channels.write[p_buffer].last_mix_with_audio = mix_frames;
+	if (!channel.used) {
+		channel.used = true;
+		channel.active = true;
+		channel.last_mix_with_audio = mix_frames;
 		for (uint32_t i = 0; i < buffer_size; i++) {
 			data[i] = AudioFrame(0, 0);
 		}
@@ -1421,6 +1573,13 @@ void AudioServer::init_channels_and_buffers() {
 		temp_buffer.write[i].resize(buffer_size);
 	}
 
+	for (BusWorker *worker : bus_workers) {
+		worker->temp_buffer.resize(channel_count);
+		for (int i = 0; i < channel_count; i++) {
+			worker->temp_buffer.write[i].resize(buffer_size);
+		}
+	}
+
 	for (int i = 0; i < buses.size(); i++) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
@@ -1437,6 +1596,12 @@ void AudioServer::init() {
 
 	init_channels_and_buffers();
 
+	int parallel_threads = GLOBAL_DEF_RST(PropertyInfo(Variant::INT, "audio/buses/parallel_processing_threads", PROPERTY_HINT_RANGE, "0,16,1"), 2);
+	parallel_bus_min_count = GLOBAL_DEF_RST(PropertyInfo(Variant::INT, "audio/buses/parallel_processing_min_buses", PROPERTY_HINT_RANGE, "0,64,1"), 0);
+	if (parallel_bus_min_count > 0) {
+		_start_bus_workers(parallel_threads);
+	}
+
 	mix_count = 0;
 	set_bus_count(1);
 	set_bus_name(0, "Master");
@@ -1555,6 +1720,8 @@ void AudioServer::finish() {
 		AudioDriverManager::get_driver(i)->finish();
 	}
 
+	_stop_bus_workers();
+
 	for (int i = 0; i < buses.size(); i++) {
 		memdelete(buses[i]);
 	}
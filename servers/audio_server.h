@@ -34,6 +34,9 @@
 #include "core/math/audio_frame.h"
 #include "core/object/class_db.h"
 #include "core/os/os.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/safe_list.h"
 #include "core/variant/variant.h"
 #include "servers/audio/audio_effect.h"
@@ -243,6 +246,7 @@ private:
 			Vector<AudioFrame> buffer;
 			Vector<Ref<AudioEffectInstance>> effect_instances;
 			uint64_t last_mix_with_audio = 0;
+			bool sending = false; // Processed this mix and has to be added to the send bus.
 			Channel() {}
 		};
 
@@ -260,6 +264,11 @@ private:
 		float volume_db = 0.0f;
 		StringName send;
 		int index_cache = 0;
+
+		// Rebuilt every mix from the sends, a bus only ever sends to a lower index.
+		int send_index = -1;
+		int first_sender = -1; // Highest index bus sending here.
+		int next_sender = -1; // Next lower index bus with the same send.
 	};
 
 	struct AudioStreamPlaybackBusDetails {
@@ -307,6 +316,38 @@ private:
 
 	void _update_bus_effects(int p_bus);
 
+	// Buses at the same depth of the send tree don't depend on each other, so they can be processed in parallel.
+	// The workers are dedicated high priority threads, the audio thread can't wait on the general purpose pool.
+	struct BusWorker {
+		Thread thread;
+		Vector<Vector<AudioFrame>> temp_buffer;
+	};
+
+	LocalVector<BusWorker *> bus_workers;
+	int parallel_bus_min_count = 0;
+	LocalVector<int> bus_depths;
+	LocalVector<int> bus_levels; // Bus indices grouped by depth, leaves first.
+	LocalVector<uint32_t> bus_level_offsets;
+
+	const int *bus_work = nullptr;
+	uint32_t bus_work_count = 0;
+	uint32_t bus_workers_woken = 0;
+	bool bus_work_solo_mode = false;
+	SafeNumeric<uint32_t> bus_work_next;
+	SafeNumeric<uint32_t> bus_workers_done;
+	SafeFlag bus_workers_exit;
+	Semaphore bus_work_semaphore;
+	Semaphore bus_level_semaphore;
+
+	static void _bus_worker_thread(void *p_userdata);
+	void _start_bus_workers(int p_threads);
+	void _stop_bus_workers();
+	void _update_bus_sends();
+	void _update_bus_levels();
+	void _process_bus_work(Vector<Vector<AudioFrame>> &r_temp_buffer);
+	void _mix_step_bus(int p_bus, bool p_solo_mode, Vector<Vector<AudioFrame>> &r_temp_buffer);
+	AudioFrame *_get_bus_channel_mix_buffer(Bus *p_bus, int p_channel);
+
 	static AudioServer *singleton;
 
 	void init_channels_and_buffers();
@@ -352,6 +393,9 @@ public:
 	// Do not use from outside audio thread.
 	bool thread_has_channel_mix_buffer(int p_bus, int p_buffer) const;
 	AudioFrame *thread_get_channel_mix_buffer(int p_bus, int p_buffer);
+
+	// Processes buses with that many extra threads once there are at least p_min_buses, 0 disables it.
+	void set_parallel_bus_processing(int p_threads, int p_min_buses);
 	int thread_get_mix_buffer_size() const;
 	int thread_find_bus_index(const StringName &p_name);
 
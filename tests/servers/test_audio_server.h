@@ -0,0 +1,251 @@
+/**************************************************************************/
+/*  test_audio_server.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_AUDIO_SERVER_H
+#define TEST_AUDIO_SERVER_H
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "scene/resources/audio_stream_wav.h"
+#include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_mix_kernels.h"
+#include "servers/audio/effects/audio_effect_delay.h"
+#include "servers/audio/effects/audio_effect_filter.h"
+#include "servers/audio_server.h"
+
+#include "tests/test_macros.h"
+
+namespace TestAudioServer {
+
+static Ref<AudioStreamWAV> make_noise_clip(uint32_t p_seed) {
+	const int mix_rate = AudioServer::get_singleton()->get_mix_rate();
+	RandomPCG rng(p_seed);
+
+	Vector<uint8_t> data;
+	data.resize(mix_rate * 2);
+	uint8_t *ptr = data.ptrw();
+	for (int i = 0; i < mix_rate; i++) {
+		const int16_t sample = int16_t(rng.random(-8192, 8192));
+		ptr[i * 2 + 0] = sample & 0xFF;
+		ptr[i * 2 + 1] = (sample >> 8) & 0xFF;
+	}
+
+	Ref<AudioStreamWAV> clip;
+	clip.instantiate();
+	clip->set_format(AudioStreamWAV::FORMAT_16_BITS);
+	clip->set_mix_rate(mix_rate);
+	clip->set_data(data);
+	clip->set_loop_mode(AudioStreamWAV::LOOP_FORWARD);
+	clip->set_loop_begin(0);
+	clip->set_loop_end(mix_rate);
+	return clip;
+}
+
+// Two groups with their own sub-buses and effects, so there are levels with several buses to spread.
+static void build_bus_layout() {
+	AudioServer *server = AudioServer::get_singleton();
+	const char *names[] = { "Music", "SFX", "Drums", "Strings", "Steps", "Hits", "UI" };
+	const char *sends[] = { "Master", "Master", "Music", "Music", "SFX", "SFX", "Master" };
+
+	server->set_bus_count(1);
+	server->set_bus_count(8);
+	for (int i = 0; i < 7; i++) {
+		server->set_bus_name(i + 1, names[i]);
+	}
+	for (int i = 0; i < 7; i++) {
+		server->set_bus_send(i + 1, sends[i]);
+		server->set_bus_volume_db(i + 1, -1.0 * i);
+
+		Ref<AudioEffectLowPassFilter> filter;
+		filter.instantiate();
+		filter->set_cutoff(500 + i * 1000);
+		server->add_bus_effect(i + 1, filter);
+		if (i % 2 == 0) {
+			Ref<AudioEffectDelay> delay;
+			delay.instantiate();
+			server->add_bus_effect(i + 1, delay);
+		}
+	}
+}
+
+static Vector<int32_t> mix_bus_layout(int p_threads, int p_frames) {
+	AudioServer *server = AudioServer::get_singleton();
+	AudioDriverDummy *driver = AudioDriverDummy::get_dummy_singleton();
+	server->set_parallel_bus_processing(p_threads, p_threads > 0 ? 1 : 0);
+	build_bus_layout();
+
+	Vector<AudioFrame> volume;
+	volume.resize(AudioServer::MAX_CHANNELS_PER_BUS);
+	volume.fill(AudioFrame(0.5, 0.5));
+
+	const char *targets[] = { "Drums", "Strings", "Steps", "Hits", "UI" };
+	LocalVector<Ref<AudioStreamPlayback>> playbacks;
+	for (int i = 0; i < 5; i++) {
+		Ref<AudioStreamPlayback> playback = make_noise_clip(i + 1)->instantiate_playback();
+		server->start_playback_stream(playback, targets[i], volume);
+		playbacks.push_back(playback);
+	}
+
+	Vector<int32_t> output;
+	output.resize(p_frames * driver->get_channels());
+	driver->mix_audio(p_frames, output.ptrw());
+
+	// Let the playbacks fade out and go away, so they don't leak into the next layout.
+	for (Ref<AudioStreamPlayback> &playback : playbacks) {
+		server->stop_playback_stream(playback);
+	}
+	Vector<int32_t> discard;
+	discard.resize(4096 * driver->get_channels());
+	driver->mix_audio(4096, discard.ptrw());
+
+	server->set_bus_count(1);
+	return output;
+}
+
+TEST_CASE("[AudioServer] Parallel bus processing matches serial processing") {
+	AudioServer *server = AudioServer::get_singleton();
+	AudioDriverDummy *driver = AudioDriverDummy::get_dummy_singleton();
+	REQUIRE(driver != nullptr);
+
+	// Keeps the dummy driver thread out, so this thread does all the mixing.
+	server->lock();
+	driver->set_use_threads(false);
+
+	const int frames = 44100;
+	Vector<int32_t> serial = mix_bus_layout(0, frames);
+	Vector<int32_t> parallel = mix_bus_layout(2, frames);
+	Vector<int32_t> oversubscribed = mix_bus_layout(7, frames);
+	server->set_parallel_bus_processing(0, 0);
+
+	driver->set_use_threads(true);
+	server->unlock();
+
+	bool has_audio = false;
+	for (int i = 0; i < serial.size() && !has_audio; i++) {
+		has_audio = serial[i] != 0;
+	}
+	CHECK_MESSAGE(has_audio, "The bus layout mixed silence.");
+	CHECK_MESSAGE(serial == parallel, "Buses processed in parallel don't match the serial mix.");
+	CHECK_MESSAGE(serial == oversubscribed, "Buses processed with more workers than buses don't match the serial mix.");
+}
+
+// Mixes one voice the way AudioServer::_mix_step_for_channel() does, with or without its highshelf filter.
+static void mix_voice(AudioFrame *r_dst, const AudioFrame *p_src, uint32_t p_frames, AudioFilterSW *p_filter, AudioFilterSW::Processor *p_processors) {
+	if (p_filter) {
+		p_processors[0].set_filter(p_filter, false);
+		p_processors[0].update_coeffs(p_frames);
+		p_processors[1].set_filter(p_filter, false);
+		p_processors[1].update_coeffs(p_frames);
+		AudioMixKernels::mix_ramp_filtered(r_dst, p_src, AudioFrame(0.25, 0.75), AudioFrame(0.5, 0.5), p_frames, &p_processors[0], &p_processors[1]);
+	} else {
+		AudioMixKernels::mix_ramp(r_dst, p_src, AudioFrame(0.25, 0.75), AudioFrame(0.5, 0.5), p_frames);
+	}
+}
+
+static Vector<AudioFrame> make_noise_frames(uint32_t p_frames) {
+	RandomPCG rng(7);
+	Vector<AudioFrame> frames;
+	frames.resize(p_frames);
+	for (uint32_t i = 0; i < p_frames; i++) {
+		frames.write[i] = AudioFrame(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f));
+	}
+	return frames;
+}
+
+TEST_CASE("[AudioServer] SIMD mix kernels match the scalar ones") {
+	const bool simd_was_enabled = AudioMixKernels::is_simd_enabled();
+	AudioFilterSW filter;
+	filter.set_mode(AudioFilterSW::HIGHSHELF);
+	filter.set_sampling_rate(44100);
+	filter.set_cutoff(5000);
+	filter.set_resonance(1);
+	filter.set_stages(1);
+	filter.set_gain(0.5);
+
+	// An odd length goes through the tail of the vector loops too.
+	for (uint32_t frames : { 512u, 509u }) {
+		const Vector<AudioFrame> source = make_noise_frames(frames);
+		Vector<AudioFrame> results[2];
+		for (int simd = 0; simd < 2; simd++) {
+			AudioMixKernels::set_simd_enabled(simd);
+			AudioFilterSW::Processor processors[2];
+			results[simd].resize(frames);
+			results[simd].fill(AudioFrame(0, 0));
+			for (int step = 0; step < 4; step++) {
+				mix_voice(results[simd].ptrw(), source.ptr(), frames, step % 2 ? &filter : nullptr, processors);
+			}
+		}
+
+		bool matches = true;
+		for (uint32_t i = 0; i < frames; i++) {
+			matches = matches && Math::is_equal_approx(results[0][i].left, results[1][i].left, 0.0001f) && Math::is_equal_approx(results[0][i].right, results[1][i].right, 0.0001f);
+		}
+		CHECK_MESSAGE(matches, vformat("The SIMD kernels don't match the scalar ones over %d frames.", frames));
+	}
+
+	AudioMixKernels::set_simd_enabled(simd_was_enabled);
+}
+
+TEST_CASE("[AudioServer] Benchmark mixing voices") {
+	const bool simd_was_enabled = AudioMixKernels::is_simd_enabled();
+	const uint32_t frames = 512;
+	const int voices = 20000;
+	const Vector<AudioFrame> source = make_noise_frames(frames);
+	Vector<AudioFrame> bus;
+	bus.resize(frames);
+	bus.fill(AudioFrame(0, 0));
+
+	AudioFilterSW filter;
+	filter.set_mode(AudioFilterSW::HIGHSHELF);
+	filter.set_sampling_rate(44100);
+	filter.set_cutoff(5000);
+	filter.set_resonance(1);
+	filter.set_stages(1);
+	filter.set_gain(0.5);
+	AudioFilterSW::Processor processors[2];
+
+	for (int simd = 0; simd < (AudioMixKernels::is_simd_available() ? 2 : 1); simd++) {
+		AudioMixKernels::set_simd_enabled(simd);
+		for (int filtered = 0; filtered < 2; filtered++) {
+			uint64_t start = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < voices; i++) {
+				mix_voice(bus.ptrw(), source.ptr(), frames, filtered ? &filter : nullptr, processors);
+			}
+			uint64_t elapsed = MAX(OS::get_singleton()->get_ticks_usec() - start, uint64_t(1));
+			MESSAGE(vformat("%s kernels, %s: %d voices of %d frames mixed per millisecond", simd ? "SIMD" : "Scalar", filtered ? "highshelf" : "plain", int64_t(voices) * 1000 / elapsed, frames));
+		}
+	}
+
+	AudioMixKernels::set_simd_enabled(simd_was_enabled);
+}
+
+} // namespace TestAudioServer
+
+#endif // TEST_AUDIO_SERVER_H
@@ -125,6 +125,7 @@
 #include "tests/scene/test_visual_shader.h"
 #include "tests/scene/test_window.h"
 #include "tests/servers/rendering/test_shader_preprocessor.h"
+#include "tests/servers/test_audio_server.h"
 #include "tests/servers/test_text_server.h"
 #include "tests/test_validate_testing.h"
 